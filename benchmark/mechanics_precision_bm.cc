@@ -0,0 +1,210 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "biodynamo.h"
+
+namespace bdm {
+namespace mechanics_precision {
+
+// Validates the mechanical displacements computed with the configured
+// `real_t` (e.g. single precision storage with double precision
+// accumulation if BioDynaMo was built with `-Dreal_t=float`) against a
+// reference that performs all operations in double precision.
+// The benchmark measures the time to calculate the displacement of all
+// agents and reports the largest deviation from the reference relative to
+// the largest reference displacement as `max_rel_error`.
+// Afterwards, it integrates the trajectories of all agents for
+// `kTrajectorySteps` iterations with both implementations and reports the
+// largest distance between the resulting positions as `max_drift`.
+
+/// Number of iterations to measure the drift of the trajectories
+constexpr uint64_t kTrajectorySteps = 20;
+
+using Vec3 = std::array<double, 3>;
+
+// Reference implementation of `InteractionForce::ForceBetweenSpheres`
+// and `Cell::CalculateDisplacement` in double precision.
+static Vec3 ReferenceDisplacement(const std::vector<Vec3>& positions,
+                                     const std::vector<double>& diameters,
+                                     uint64_t idx, double squared_radius,
+                                     double dt, double adherence,
+                                     double density, double max_displacement) {
+  Vec3 force = {0, 0, 0};
+  const auto& c1 = positions[idx];
+  for (uint64_t j = 0; j < positions.size(); ++j) {
+    if (j == idx) {
+      continue;
+    }
+    const auto& c2 = positions[j];
+    double comp1 = c1[0] - c2[0];
+    double comp2 = c1[1] - c2[1];
+    double comp3 = c1[2] - c2[2];
+    double squared_distance = comp1 * comp1 + comp2 * comp2 + comp3 * comp3;
+    if (squared_distance >= squared_radius) {
+      continue;
+    }
+    double r1 = 0.5 * diameters[idx] + 1.5;
+    double r2 = 0.5 * diameters[j] + 1.5;
+    double center_distance = std::sqrt(squared_distance);
+    double delta = r1 + r2 - center_distance;
+    if (delta < 0) {
+      continue;
+    }
+    double r = (r1 * r2) / (r1 + r2);
+    double f = 2 * delta - std::sqrt(r * delta);
+    double force_module = f / center_distance;
+    force[0] += force_module * comp1;
+    force[1] += force_module * comp2;
+    force[2] += force_module * comp3;
+  }
+
+  double norm_of_force = std::sqrt(force[0] * force[0] + force[1] * force[1] +
+                                   force[2] * force[2]);
+  Vec3 movement = {0, 0, 0};
+  if (norm_of_force > adherence) {
+    double volume = TMath::Pi() / 6 * std::pow(diameters[idx], 3);
+    double mh = dt / (density * volume);
+    for (int i = 0; i < 3; ++i) {
+      movement[i] = force[i] * mh;
+    }
+    if (norm_of_force * mh > max_displacement) {
+      for (int i = 0; i < 3; ++i) {
+        movement[i] *= max_displacement / (norm_of_force * mh);
+      }
+    }
+  }
+  return movement;
+}
+
+static void MechanicsPrecision(benchmark::State& state) {
+  const uint64_t num_agents = state.range(0);
+  auto set_param = [](Param* param) {
+    param->simulation_time_step = 0.01;
+    param->detect_static_agents = false;
+  };
+  Simulation simulation("mechanics_precision_bm", set_param);
+  auto* rm = simulation.GetResourceManager();
+  auto* random = simulation.GetRandom();
+  auto* param = simulation.GetParam();
+  random->SetSeed(4357);
+
+  // Large coordinates and densely packed cells maximize the cancellation
+  // errors in the overlap computation.
+  const real_t offset = 1e4;
+  const real_t space = std::cbrt(static_cast<real_t>(num_agents)) * 8;
+  for (uint64_t i = 0; i < num_agents; ++i) {
+    auto* cell = new Cell(random->UniformArray<3>(offset, offset + space));
+    cell->SetDiameter(random->Uniform(8, 12));
+    cell->SetAdherence(0.01);
+    rm->AddAgent(cell);
+  }
+  // Initializes the environment and the execution context
+  simulation.GetScheduler()->Simulate(1);
+
+  std::vector<Agent*> agents;
+  std::vector<Vec3> positions;
+  std::vector<double> diameters;
+  rm->ForEachAgent([&](Agent* agent) {
+    const auto& pos = agent->GetPosition();
+    agents.push_back(agent);
+    positions.push_back({pos[0], pos[1], pos[2]});
+    diameters.push_back(agent->GetDiameter());
+  });
+
+  auto* env = simulation.GetEnvironment();
+  env->ForcedUpdate();
+  real_t largest = env->GetLargestAgentSize();
+  real_t squared_radius = largest * largest;
+  real_t dt = param->simulation_time_step;
+  InteractionForce force;
+
+  std::vector<Real3> displacements(agents.size());
+  for (auto _ : state) {
+#pragma omp parallel for
+    for (uint64_t i = 0; i < agents.size(); ++i) {
+      displacements[i] =
+          agents[i]->CalculateDisplacement(&force, squared_radius, dt);
+    }
+    benchmark::DoNotOptimize(displacements.data());
+  }
+
+  double max_error = 0;
+  double max_reference = 0;
+  for (uint64_t i = 0; i < agents.size(); ++i) {
+    auto* cell = bdm_static_cast<Cell*>(agents[i]);
+    auto ref = ReferenceDisplacement(
+        positions, diameters, i, squared_radius, dt, cell->GetAdherence(),
+        cell->GetDensity(), param->simulation_max_displacement);
+    for (int d = 0; d < 3; ++d) {
+      double error = std::abs(ref[d] - displacements[i][d]);
+      max_error = std::max(max_error, error);
+      max_reference = std::max(max_reference, std::abs(ref[d]));
+    }
+  }
+  state.counters["max_rel_error"] =
+      max_reference != 0 ? max_error / max_reference : max_error;
+
+  // Integrate the trajectories. All displacements of one iteration are
+  // calculated before they are applied, so that both implementations see
+  // the same neighbor positions.
+  std::vector<Vec3> reference_displacements(agents.size());
+  for (uint64_t step = 0; step < kTrajectorySteps; ++step) {
+#pragma omp parallel for
+    for (uint64_t i = 0; i < agents.size(); ++i) {
+      auto* cell = bdm_static_cast<Cell*>(agents[i]);
+      displacements[i] =
+          agents[i]->CalculateDisplacement(&force, squared_radius, dt);
+      reference_displacements[i] = ReferenceDisplacement(
+          positions, diameters, i, squared_radius, dt, cell->GetAdherence(),
+          cell->GetDensity(), param->simulation_max_displacement);
+    }
+#pragma omp parallel for
+    for (uint64_t i = 0; i < agents.size(); ++i) {
+      agents[i]->ApplyDisplacement(displacements[i]);
+      for (int d = 0; d < 3; ++d) {
+        positions[i][d] += reference_displacements[i][d];
+      }
+    }
+    env->ForcedUpdate();
+  }
+
+  double max_drift = 0;
+  for (uint64_t i = 0; i < agents.size(); ++i) {
+    const auto& pos = agents[i]->GetPosition();
+    double squared_drift = 0;
+    for (int d = 0; d < 3; ++d) {
+      double diff = pos[d] - positions[i][d];
+      squared_drift += diff * diff;
+    }
+    max_drift = std::max(max_drift, std::sqrt(squared_drift));
+  }
+  state.counters["max_drift"] = max_drift;
+  state.SetLabel(kRealtName);
+}
+
+BENCHMARK(MechanicsPrecision)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->MeasureProcessCPUTime()
+    ->UseRealTime();
+
+}  // namespace mechanics_precision
+}  // namespace bdm
@@ -0,0 +1,84 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+
+#include "biodynamo.h"
+
+namespace bdm {
+namespace neighbor_prefetch {
+
+// Measures `UniformGridEnvironment::ForEachNeighbor` for all agents with
+// different `Param::neighbor_prefetch_distance` values (second argument,
+// 0 = no software prefetching) and agent densities (first argument, average
+// number of agents per box of the uniform grid).
+// Agents are created at random positions. Therefore, agents that are close
+// in space are not close in memory, which is the worst case for the
+// dependent loads in the neighbor search.
+
+static constexpr uint64_t kNumAgents = 200000;
+static constexpr real_t kDiameter = 10;
+
+static void NeighborPrefetch(benchmark::State& state) {
+  const uint64_t agents_per_box = state.range(0);
+  const uint64_t prefetch_distance = state.range(1);
+  auto set_param = [&](Param* param) {
+    param->neighbor_prefetch_distance = prefetch_distance;
+  };
+  Simulation simulation("neighbor_prefetch_bm", set_param);
+  auto* rm = simulation.GetResourceManager();
+  auto* random = simulation.GetRandom();
+  random->SetSeed(4357);
+
+  const real_t num_boxes = static_cast<real_t>(kNumAgents) / agents_per_box;
+  const real_t space = std::cbrt(num_boxes) * kDiameter;
+  for (uint64_t i = 0; i < kNumAgents; ++i) {
+    auto* cell = new Cell(random->UniformArray<3>(0, space));
+    cell->SetDiameter(kDiameter);
+    rm->AddAgent(cell);
+  }
+  auto* env = simulation.GetEnvironment();
+  env->ForcedUpdate();
+  auto squared_radius = env->GetLargestAgentSizeSquared();
+
+  std::vector<uint64_t> counts(kNumAgents);
+  for (auto _ : state) {
+    auto count_neighbors = L2F([&](Agent* agent, AgentHandle) {
+      uint64_t count = 0;
+      auto increment = L2F([&](Agent*, real_t) { count++; });
+      env->ForEachNeighbor(increment, *agent, squared_radius);
+      counts[agent->GetUid().GetIndex()] = count;
+    });
+    rm->ForEachAgentParallel(count_neighbors);
+    benchmark::DoNotOptimize(counts.data());
+  }
+
+  uint64_t total = 0;
+  for (auto count : counts) {
+    total += count;
+  }
+  state.counters["neighbors_per_agent"] =
+      static_cast<double>(total) / kNumAgents;
+  state.SetItemsProcessed(state.iterations() * kNumAgents);
+}
+
+BENCHMARK(NeighborPrefetch)
+    ->ArgsProduct({{1, 4, 16}, {0, 2, 4, 8, 16}})
+    ->MeasureProcessCPUTime()
+    ->UseRealTime();
+
+}  // namespace neighbor_prefetch
+}  // namespace bdm
@@ -14,6 +14,9 @@
 #ifndef SBML_INTEGRATION_H_
 #define SBML_INTEGRATION_H_
 
+#include <atomic>
+#include <memory>
+
 #include "biodynamo.h"
 #include "core/util/io.h"
 #include "core/util/timing.h"
@@ -50,53 +53,95 @@ class MyCell : public Cell {
   real_t s1_ = 100;
 };
 
-// Define SbmlBehavior to simulate intracellular chemical reaction network.
-class SbmlBehavior : public Behavior {
-  BDM_BEHAVIOR_HEADER(SbmlBehavior, Behavior, 1)
-
+// Wraps an SBML model for the intracellular network of all cells.
+// RoadRunner instances are not thread-safe. Therefore, the model is
+// instantiated once per thread instead of once per agent. RoadRunner caches
+// the compiled model, so it is only compiled once. The amounts of each cell
+// are stored by `IntracellularNetwork` and loaded into the instance of the
+// calling thread before each integration step.
+class RoadRunnerModel : public IntracellularModel {
  public:
-  SbmlBehavior() {}
-  SbmlBehavior(const std::string& sbml_file, const rr::SimulateOptions& opt) {
-    Initialize(sbml_file, opt);
+  RoadRunnerModel(const std::string& sbml_file,
+                  const rr::SimulateOptions& opt) {
+    auto dt = opt.duration / opt.steps;
+    auto max_threads = ThreadInfo::GetInstance()->GetMaxThreads();
+    for (int i = 0; i < max_threads; i++) {
+      auto* rr = new rr::RoadRunner(sbml_file);
+      rr->getSimulateOptions() = opt;
+      // setup integrator
+      rr->setIntegrator("gillespie");
+      auto* integrator = rr->getIntegrator();
+      integrator->setValue("variable_step_size", false);
+      integrator->setValue("initial_time_step", dt);
+      integrator->setValue("maximum_time_step", dt);
+      runners_.emplace_back(rr);
+    }
+
+    species_names_ = runners_[0]->getFloatingSpeciesIds();
+    std::vector<double> amounts(species_names_.size());
+    runners_[0]->getModel()->getFloatingSpeciesAmounts(
+        amounts.size(), nullptr, amounts.data());
+    initial_amounts_.assign(amounts.begin(), amounts.end());
   }
 
-  SbmlBehavior(const SbmlBehavior& other) {
-    auto other_sbml_behavior = bdm_static_cast<const SbmlBehavior*>(&other);
-    Initialize(other_sbml_behavior->sbml_file_,
-               other_sbml_behavior->initial_options_);
-    result_ = other_sbml_behavior->result_;
+  const std::vector<std::string>& GetSpeciesNames() const override {
+    return species_names_;
   }
 
-  virtual ~SbmlBehavior() { delete rr_; }
+  std::vector<real_t> GetInitialAmounts() const override {
+    return initial_amounts_;
+  }
 
-  void Initialize(const std::string& sbml_file,
-                  const rr::SimulateOptions& opt) {
-    sbml_file_ = sbml_file;
-    initial_options_ = opt;
-
-    rr_ = new rr::RoadRunner(sbml_file);
-    rr_->getSimulateOptions() = opt;
-    // setup integrator
-    rr_->setIntegrator("gillespie");
-    dt_ = opt.duration / opt.steps;
-    auto* integrator = rr_->getIntegrator();
-    integrator->setValue("variable_step_size", false);
-    integrator->setValue("initial_time_step", dt_);
-    integrator->setValue("maximum_time_step", dt_);
-
-    result_.resize(opt.steps, 4);
+  void Integrate(const Param* param, real_t time, real_t dt,
+                 real_t* amounts) const override {
+    auto* rr = runners_[ThreadInfo::GetInstance()->GetMyThreadId()].get();
+    auto* model = rr->getModel();
+    auto* integrator = rr->getIntegrator();
+    int num_species = species_names_.size();
+    thread_local std::vector<double> buffer;
+    buffer.assign(amounts, amounts + num_species);
+    model->setFloatingSpeciesAmounts(num_species, nullptr, buffer.data());
+    integrator->restart(time);
+    integrator->integrate(time, dt);
+    model->getFloatingSpeciesAmounts(num_species, nullptr, buffer.data());
+    std::copy(buffer.begin(), buffer.end(), amounts);
   }
 
+ private:
+  std::vector<std::unique_ptr<rr::RoadRunner>> runners_;
+  std::vector<std::string> species_names_;
+  std::vector<real_t> initial_amounts_;
+};
+
+// Define SbmlBehavior to react to the intracellular chemical reaction network.
+// The amounts of the species are integrated by `IntracellularNetworkOp` for
+// all cells in parallel.
+class SbmlBehavior : public IntracellularBehavior {
+  BDM_BEHAVIOR_HEADER(SbmlBehavior, IntracellularBehavior, 1)
+
+ public:
+  SbmlBehavior() {}
+  SbmlBehavior(const std::shared_ptr<IntracellularNetwork>& network,
+               uint64_t num_steps, bool record)
+      : Base(network) {
+    if (record) {
+      result_.resize(num_steps, 4);
+    }
+  }
+
+  virtual ~SbmlBehavior() {}
+
   void Run(Agent* agent) override {
     if (auto* cell = static_cast<MyCell*>(agent)) {
-      auto i = Simulation::GetActive()->GetScheduler()->GetSimulatedSteps();
-      rr_->getIntegrator()->integrate(i * dt_, dt_);
-      // FIXME model time not the same as
-      const auto& partial_result = rr_->getFloatingSpeciesAmountsNamedArray();
-      cell->SetS1(partial_result(0, 0));
-      result_(i, 0) = i * dt_;
-      for (unsigned j = 0; j < partial_result.numCols(); j++) {
-        result_(i, j + 1) = partial_result(0, j);
+      auto* sim = Simulation::GetActive();
+      auto i = sim->GetScheduler()->GetSimulatedSteps();
+      auto dt = sim->GetParam()->simulation_time_step;
+      cell->SetS1(GetAmount(0));
+      if (i < static_cast<uint64_t>(result_.numRows())) {
+        result_(i, 0) = (i + 1) * dt;
+        for (unsigned j = 0; j < 3; j++) {
+          result_(i, j + 1) = GetAmount(j);
+        }
       }
 
       if (cell->GetS1() < 30 && active_) {
@@ -109,12 +154,9 @@ class SbmlBehavior : public Behavior {
   const ls::DoubleMatrix& GetResult() const { return result_; }
 
  private:
-  std::string sbml_file_;
-  rr::SimulateOptions initial_options_;
+  // Only recorded for a few cells to keep the memory footprint low.
   ls::DoubleMatrix result_;
   bool active_ = true;
-  rr::RoadRunner* rr_;
-  real_t dt_;
 };
 
 inline void AddToPlot(TMultiGraph* mg, const ls::Matrix<real_t>* result) {
@@ -159,7 +201,11 @@ inline void PlotSbmlBehaviors(const char* filename) {
         auto* cell = static_cast<MyCell*>(agent);
         const auto& behaviour = cell->GetAllBehaviors();
         if (behaviour.size() == 1) {
-          AddToPlot(mg, &static_cast<SbmlBehavior*>(behaviour[0])->GetResult());
+          const auto& result =
+              static_cast<SbmlBehavior*>(behaviour[0])->GetResult();
+          if (result.numRows() != 0) {
+            AddToPlot(mg, &result);
+          }
         }
       });
 
@@ -175,6 +221,9 @@ inline void PlotSbmlBehaviors(const char* filename) {
   c.SaveAs(filename);
 }
 
+// Number of cells whose species amounts are plotted.
+static constexpr uint64_t kNumRecordedCells = 10;
+
 inline int Simulate(int argc, const char** argv) {
   auto opts = CommandLineOptions(argc, argv);
   opts.AddOption<uint64_t>("n, num-cells", "10", "The total number of cells");
@@ -200,12 +249,18 @@ inline int Simulate(int argc, const char** argv) {
     }
   }
 
+  // The SBML model is loaded once and shared by all cells.
+  auto model = std::make_shared<RoadRunnerModel>(sbml_file, opt);
+  auto network = IntracellularNetwork::Create(model);
+
   // Define initial model
+  std::atomic<uint64_t> num_recorded(0);
   auto construct = [&](const Real3& position) {
     auto* cell = new MyCell();
     cell->SetPosition(position);
     cell->SetDiameter(10);
-    cell->AddBehavior(new SbmlBehavior(sbml_file, opt));
+    bool record = num_recorded++ < kNumRecordedCells;
+    cell->AddBehavior(new SbmlBehavior(network, opt.steps, record));
     return cell;
   };
   ModelInitializer::CreateAgentsRandom(0, 200, num_cells, construct);
@@ -17,7 +17,14 @@
 
 #include "BDMGlyph.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+#include <vector>
+
 #include "vtkCell.h"
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkFloatArray.h"
 #include "vtkIdList.h"
@@ -25,19 +32,196 @@
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkMath.h"
+#include "vtkMatrix4x4.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkPolyDataNormals.h"
+#include "vtkQuadricDecimation.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTransform.h"
+#include "vtkTriangleFilter.h"
 #include "vtkTrivialProducer.h"
 #include "vtkUniformGrid.h"
 #include "vtkUnsignedCharArray.h"
 
 vtkStandardNewMacro(BDMGlyph);
 
+namespace {
+
+/// Number of consecutive input points that are processed by one task.
+constexpr vtkIdType kBlockSize = 4096;
+
+/// vtkPolyData stores vertices, lines, polygons and triangle strips in
+/// separate cell arrays.
+constexpr int kNumCellTypes = 4;
+
+vtkCellArray *GetCells(vtkPolyData *polydata, int type) {
+  switch (type) {
+    case 0:
+      return polydata->GetVerts();
+    case 1:
+      return polydata->GetLines();
+    case 2:
+      return polydata->GetPolys();
+    default:
+      return polydata->GetStrips();
+  }
+}
+
+/// Geometry of a glyph that is copied to each glyphed input point.
+struct GlyphSource {
+  vtkSmartPointer<vtkPolyData> polydata;
+  vtkIdType numPoints = 0;
+  /// Points after applying the source transform.
+  std::vector<std::array<double, 3>> points;
+  bool hasNormals = false;
+  std::vector<std::array<double, 3>> normals;
+  int numTCoordComponents = 0;
+  std::vector<double> tcoords;
+  /// Cells of each cell type in the format of vtkCellArray.
+  std::array<std::vector<vtkIdType>, kNumCellTypes> offsets;
+  std::array<std::vector<vtkIdType>, kNumCellTypes> connectivity;
+
+  void Initialize(vtkPolyData *source, vtkTransform *transform) {
+    this->polydata = source;
+    this->numPoints = source->GetNumberOfPoints();
+    vtkSmartPointer<vtkPoints> sourcePts = source->GetPoints();
+    if (transform && sourcePts) {
+      vtkNew<vtkPoints> transformed;
+      transformed->SetDataTypeToDouble();
+      transform->TransformPoints(source->GetPoints(), transformed);
+      sourcePts = transformed.GetPointer();
+    }
+    this->points.resize(this->numPoints);
+    for (vtkIdType i = 0; i < this->numPoints; i++) {
+      sourcePts->GetPoint(i, this->points[i].data());
+    }
+
+    vtkDataArray *sourceNormals = source->GetPointData()->GetNormals();
+    this->hasNormals = sourceNormals != nullptr;
+    if (sourceNormals) {
+      this->normals.resize(this->numPoints);
+      for (vtkIdType i = 0; i < this->numPoints; i++) {
+        sourceNormals->GetTuple(i, this->normals[i].data());
+      }
+    }
+
+    vtkDataArray *sourceTCoords = source->GetPointData()->GetTCoords();
+    if (sourceTCoords) {
+      this->numTCoordComponents = sourceTCoords->GetNumberOfComponents();
+      this->tcoords.resize(this->numPoints * this->numTCoordComponents);
+      for (vtkIdType i = 0; i < this->numPoints; i++) {
+        sourceTCoords->GetTuple(i, &this->tcoords[i * numTCoordComponents]);
+      }
+    }
+
+    vtkNew<vtkIdList> cellPts;
+    for (int t = 0; t < kNumCellTypes; t++) {
+      vtkCellArray *cells = GetCells(source, t);
+      vtkIdType numCells = cells ? cells->GetNumberOfCells() : 0;
+      this->offsets[t].assign(1, 0);
+      this->connectivity[t].clear();
+      for (vtkIdType c = 0; c < numCells; c++) {
+        cells->GetCellAtId(c, cellPts);
+        for (vtkIdType i = 0; i < cellPts->GetNumberOfIds(); i++) {
+          this->connectivity[t].push_back(cellPts->GetId(i));
+        }
+        this->offsets[t].push_back(this->connectivity[t].size());
+      }
+    }
+  }
+};
+
+/// Position of a glyph in the output arrays.
+struct GlyphOffsets {
+  vtkIdType points = 0;
+  std::array<vtkIdType, kNumCellTypes> cells = {{0, 0, 0, 0}};
+  std::array<vtkIdType, kNumCellTypes> connectivity = {{0, 0, 0, 0}};
+
+  /// Advances the offsets by the size of one glyph of `source`.
+  void Add(const GlyphSource &source) {
+    this->points += source.numPoints;
+    for (int t = 0; t < kNumCellTypes; t++) {
+      this->cells[t] += source.offsets[t].size() - 1;
+      this->connectivity[t] += source.connectivity[t].size();
+    }
+  }
+};
+
+/// Returns a copy of `source` with `targetReduction` times fewer triangles.
+/// Sources that contain vertices or lines are returned unchanged.
+vtkSmartPointer<vtkPolyData> Decimate(vtkPolyData *source,
+                                      double targetReduction) {
+  if (source->GetNumberOfVerts() > 0 || source->GetNumberOfLines() > 0 ||
+      source->GetNumberOfPolys() + source->GetNumberOfStrips() == 0) {
+    return source;
+  }
+  vtkNew<vtkTriangleFilter> triangles;
+  triangles->SetInputData(source);
+  vtkNew<vtkQuadricDecimation> decimation;
+  decimation->SetInputConnection(triangles->GetOutputPort());
+  decimation->SetTargetReduction(targetReduction);
+  vtkSmartPointer<vtkPolyData> result;
+  if (source->GetPointData()->GetNormals()) {
+    vtkNew<vtkPolyDataNormals> normals;
+    normals->SetInputConnection(decimation->GetOutputPort());
+    normals->Update();
+    result = normals->GetOutput();
+  } else {
+    decimation->Update();
+    result = decimation->GetOutput();
+  }
+  if (result->GetNumberOfPoints() == 0) {
+    return source;
+  }
+  return result;
+}
+
+using ArrayPair = std::pair<vtkAbstractArray *, vtkAbstractArray *>;
+
+/// Adds an array with `numTuples` tuples to `out` for each array of `in`.
+/// Active vectors, normals and texture coordinates are skipped if
+/// `skipGeometry` is true. Arrays named `skipName` are skipped as well.
+/// Returns the pairs of input and output arrays.
+std::vector<ArrayPair> AllocateArrays(vtkPointData *in,
+                                      vtkDataSetAttributes *out,
+                                      vtkIdType numTuples, bool skipGeometry,
+                                      const char *skipName) {
+  std::vector<ArrayPair> arrays;
+  for (int i = 0; i < in->GetNumberOfArrays(); i++) {
+    vtkAbstractArray *inArray = in->GetAbstractArray(i);
+    int attribute = in->IsArrayAnAttribute(i);
+    if (skipGeometry && (attribute == vtkDataSetAttributes::VECTORS ||
+                         attribute == vtkDataSetAttributes::NORMALS ||
+                         attribute == vtkDataSetAttributes::TCOORDS)) {
+      continue;
+    }
+    if (skipName && inArray->GetName() &&
+        strcmp(skipName, inArray->GetName()) == 0) {
+      continue;
+    }
+    vtkSmartPointer<vtkAbstractArray> outArray =
+        vtk::TakeSmartPointer(inArray->NewInstance());
+    outArray->SetName(inArray->GetName());
+    outArray->SetNumberOfComponents(inArray->GetNumberOfComponents());
+    outArray->CopyComponentNames(inArray);
+    outArray->SetNumberOfTuples(numTuples);
+    int idx = out->AddArray(outArray);
+    if (attribute >= 0) {
+      out->SetActiveAttribute(idx, attribute);
+    }
+    arrays.emplace_back(inArray, outArray);
+  }
+  return arrays;
+}
+
+}  // namespace
+
 //----------------------------------------------------------------------------
 BDMGlyph::BDMGlyph() {
   // by default process active point scalars
@@ -52,6 +236,8 @@ BDMGlyph::BDMGlyph() {
   // by default process active point scalars
   this->SetInputArrayToProcess(7, 0, 0, vtkDataObject::FIELD_ASSOCIATION_POINTS,
                                vtkDataSetAttributes::VECTORS);
+  this->LODThreshold = 0;
+  this->LODTargetReduction = 0.8;
 }
 
 //----------------------------------------------------------------------------
@@ -82,46 +268,17 @@ bool BDMGlyph::Execute(vtkDataSet *input, vtkInformationVector *sourceVector,
   vtkDataArray *inCScalars;  // Scalars for Coloring
   vtkDataArray *x_scaling, *y_scaling, *z_scaling, *end_position = NULL;
   unsigned char *inGhostLevels = 0;
-  vtkDataArray *inNormals, *sourceNormals = NULL;
-  vtkDataArray *sourceTCoords = NULL;
-  vtkIdType numPts, numSourcePts, numSourceCells, inPtId, i;
-  vtkPoints *sourcePts = NULL;
-  vtkSmartPointer<vtkPoints> transformedSourcePts =
-      vtkSmartPointer<vtkPoints>::New();
-  vtkSmartPointer<vtkPoints> transformedSourcePts2 =
-      vtkSmartPointer<vtkPoints>::New();
-  vtkPoints *newPts;
-  vtkDataArray *newScalars = NULL;
-  vtkDataArray *newVectors = NULL;
-  vtkDataArray *newNormals = NULL;
-  vtkDataArray *newTCoords = NULL;
-  double x[3], v[3], ep[3], s = 0.0, vMag = 0.0, value, tc[3],
-                                     xs = 0.0, ys = 0.0, zs = 0.0;
-  vtkTransform *trans = vtkTransform::New();
-  vtkTransform *trans2 = vtkTransform::New();
-  vtkNew<vtkIdList> pointIdList;
-  vtkIdList *cellPts;
-  int npts;
-  vtkIdList *pts;
-  vtkIdType ptIncr, cellIncr, cellId;
+  vtkDataArray *inNormals;
+  vtkIdType numPts;
   int haveVectors, haveNormals, haveTCoords = 0;
-  double scalex, scaley, scalez, den;
+  double den;
   vtkPointData *outputPD = output->GetPointData();
   vtkCellData *outputCD = output->GetCellData();
   int numberOfSources = this->GetNumberOfInputConnections(1);
-  vtkPolyData *defaultSource = NULL;
-  vtkIdTypeArray *pointIds = 0;
   vtkPolyData *source = this->GetSource(0, sourceVector);
-  vtkNew<vtkIdList> srcPointIdList;
-  vtkNew<vtkIdList> dstPointIdList;
-  vtkNew<vtkIdList> srcCellIdList;
-  vtkNew<vtkIdList> dstCellIdList;
 
   vtkDebugMacro(<< "Generating glyphs");
 
-  pts = vtkIdList::New();
-  pts->Allocate(VTK_CELL_SIZE);
-
   pd = input->GetPointData();
   inNormals = this->GetInputArrayToProcess(2, input);
   inCScalars = this->GetInputArrayToProcess(3, input);
@@ -147,9 +304,6 @@ bool BDMGlyph::Execute(vtkDataSet *input, vtkInformationVector *sourceVector,
   numPts = input->GetNumberOfPoints();
   if (numPts < 1) {
     vtkDebugMacro(<< "No points to glyph!");
-    pts->Delete();
-    trans->Delete();
-    trans2->Delete();
     return 1;
   }
 
@@ -165,6 +319,13 @@ bool BDMGlyph::Execute(vtkDataSet *input, vtkInformationVector *sourceVector,
   } else {
     haveVectors = 0;
   }
+  vtkDataArray *array3D =
+      this->VectorMode == VTK_USE_NORMAL ? inNormals : inVectors;
+  if (haveVectors && array3D->GetNumberOfComponents() > 3) {
+    vtkErrorMacro(<< "vtkDataArray " << array3D->GetName()
+                  << " has more than 3 components.\n");
+    return false;
+  }
 
   if ((this->IndexMode == VTK_INDEXING_BY_SCALAR && !inSScalars) ||
       (this->IndexMode == VTK_INDEXING_BY_VECTOR &&
@@ -172,9 +333,6 @@ bool BDMGlyph::Execute(vtkDataSet *input, vtkInformationVector *sourceVector,
         (!inNormals && this->VectorMode == VTK_USE_NORMAL)))) {
     if (!source) {
       vtkErrorMacro(<< "Indexing on but don't have data to index with");
-      pts->Delete();
-      trans->Delete();
-      trans2->Delete();
       return true;
     } else {
       vtkWarningMacro(<< "Turning indexing off: no data to index with");
@@ -182,16 +340,13 @@ bool BDMGlyph::Execute(vtkDataSet *input, vtkInformationVector *sourceVector,
     }
   }
 
-  // Allocate storage for output PolyData
+  // Prepare the glyph sources
   //
-  outputPD->CopyVectorsOff();
-  outputPD->CopyNormalsOff();
-  outputPD->CopyTCoordsOff();
-
+  vtkSmartPointer<vtkPolyData> defaultSource;
   if (!source) {
-    defaultSource = vtkPolyData::New();
+    defaultSource = vtkSmartPointer<vtkPolyData>::New();
     defaultSource->Allocate();
-    vtkPoints *defaultPoints = vtkPoints::New();
+    vtkNew<vtkPoints> defaultPoints;
     defaultPoints->Allocate(6);
     defaultPoints->InsertNextPoint(0, 0, 0);
     defaultPoints->InsertNextPoint(1, 0, 0);
@@ -200,394 +355,444 @@ bool BDMGlyph::Execute(vtkDataSet *input, vtkInformationVector *sourceVector,
     defaultPointIds[1] = 1;
     defaultSource->SetPoints(defaultPoints);
     defaultSource->InsertNextCell(VTK_LINE, 2, defaultPointIds);
-    defaultSource->Delete();
-    defaultSource = NULL;
-    defaultPoints->Delete();
-    defaultPoints = NULL;
     source = defaultSource;
   }
 
+  bool lowResolution = this->LODThreshold > 0 && numPts > this->LODThreshold;
+  if (lowResolution) {
+    vtkDebugMacro(<< "Using low resolution glyphs for " << numPts
+                  << " points");
+  }
+  auto prepareSource = [&](vtkPolyData *polydata, GlyphSource *glyphSource) {
+    vtkSmartPointer<vtkPolyData> glyph = polydata;
+    if (lowResolution) {
+      glyph = Decimate(polydata, this->LODTargetReduction);
+    }
+    glyphSource->Initialize(glyph, this->SourceTransform);
+  };
+
+  std::vector<GlyphSource> sources;
   if (this->IndexMode != VTK_INDEXING_OFF) {
     pd = NULL;
     haveNormals = 1;
-    for (numSourcePts = numSourceCells = i = 0; i < numberOfSources; i++) {
+    sources.resize(numberOfSources);
+    for (int i = 0; i < numberOfSources; i++) {
       source = this->GetSource(i, sourceVector);
       if (source != NULL) {
-        if (source->GetNumberOfPoints() > numSourcePts) {
-          numSourcePts = source->GetNumberOfPoints();
-        }
-        if (source->GetNumberOfCells() > numSourceCells) {
-          numSourceCells = source->GetNumberOfCells();
-        }
-        if (!(sourceNormals = source->GetPointData()->GetNormals())) {
+        prepareSource(source, &sources[i]);
+        if (!sources[i].hasNormals) {
           haveNormals = 0;
         }
       }
     }
   } else {
-    sourcePts = source->GetPoints();
-    numSourcePts = sourcePts->GetNumberOfPoints();
-    numSourceCells = source->GetNumberOfCells();
+    sources.resize(1);
+    prepareSource(source, &sources[0]);
+    haveNormals = sources[0].hasNormals;
+    haveTCoords = sources[0].numTCoordComponents > 0;
+  }
 
-    sourceNormals = source->GetPointData()->GetNormals();
-    if (sourceNormals) {
-      haveNormals = 1;
-    } else {
-      haveNormals = 0;
+  // Select the input points that are glyphed and compute the position of
+  // their glyphs in the output arrays. The visibility of the points must be
+  // determined sequentially, because IsPointVisible expects increasing point
+  // ids.
+  //
+  vtkIdType numBlocks = (numPts + kBlockSize - 1) / kBlockSize;
+  std::vector<int> glyphSource(numPts, -1);
+  std::vector<GlyphOffsets> blockOffsets(numBlocks + 1);
+  GlyphOffsets offsets;
+  for (vtkIdType inPtId = 0; inPtId < numPts; inPtId++) {
+    if (!(inPtId % kBlockSize)) {
+      blockOffsets[inPtId / kBlockSize] = offsets;
+    }
+    if (!(inPtId % 10000)) {
+      this->UpdateProgress(0.5 * static_cast<double>(inPtId) / numPts);
+      if (this->GetAbortExecute()) {
+        for (vtkIdType b = inPtId / kBlockSize + 1; b < numBlocks; b++) {
+          blockOffsets[b] = offsets;
+        }
+        break;
+      }
     }
 
-    sourceTCoords = source->GetPointData()->GetTCoords();
-    if (sourceTCoords) {
-      haveTCoords = 1;
-    } else {
-      haveTCoords = 0;
+    // Compute index into table of glyphs
+    int index = 0;
+    if (this->IndexMode != VTK_INDEXING_OFF) {
+      double value;
+      if (this->IndexMode == VTK_INDEXING_BY_SCALAR) {
+        value = inSScalars->GetComponent(inPtId, 0);
+      } else {
+        double v[3] = {0, 0, 0};
+        array3D->GetTuple(inPtId, v);
+        value = vtkMath::Norm(v);
+      }
+      index =
+          static_cast<int>((value - this->Range[0]) * numberOfSources / den);
+      index = (index < 0 ? 0 : (index >= numberOfSources ? (numberOfSources - 1)
+                                                         : index));
     }
 
-    // Prepare to copy output.
-    pd = input->GetPointData();
-    outputPD->CopyAllocate(pd, numPts * numSourcePts);
-    if (this->FillCellData) {
-      outputCD->CopyAllocate(pd, numPts * numSourceCells);
+    // Make sure we're not indexing into empty glyph
+    if (!sources[index].polydata) {
+      continue;
+    }
+
+    // Check ghost points.
+    // If we are processing a piece, we do not want to duplicate
+    // glyphs on the borders.
+    if (inGhostLevels &&
+        inGhostLevels[inPtId] & vtkDataSetAttributes::DUPLICATEPOINT) {
+      continue;
     }
+
+    if (inputUG && !inputUG->IsPointVisible(inPtId)) {
+      // input is a vtkUniformGrid and the current point is blanked. Don't glyph
+      // it.
+      continue;
+    }
+
+    if (!this->IsPointVisible(input, inPtId)) {
+      continue;
+    }
+
+    glyphSource[inPtId] = index;
+    offsets.Add(sources[index]);
   }
+  blockOffsets[numBlocks] = offsets;
+  const GlyphOffsets &totals = offsets;
 
-  srcPointIdList->SetNumberOfIds(numSourcePts);
-  dstPointIdList->SetNumberOfIds(numSourcePts);
-  srcCellIdList->SetNumberOfIds(numSourceCells);
-  dstCellIdList->SetNumberOfIds(numSourceCells);
+  // Allocate storage for output PolyData
+  //
+  vtkIdType numNewPts = totals.points;
+  vtkDataArray *newScalars = NULL;
+  vtkDataArray *newVectors = NULL;
+  vtkDataArray *newNormals = NULL;
+  vtkDataArray *newTCoords = NULL;
+  vtkIdTypeArray *pointIds = 0;
 
-  newPts = vtkPoints::New();
-  newPts->Allocate(numPts * numSourcePts);
+  vtkNew<vtkPoints> newPts;
+  newPts->SetNumberOfPoints(numNewPts);
   if (this->GeneratePointIds) {
     pointIds = vtkIdTypeArray::New();
     pointIds->SetName(this->PointIdsName);
-    pointIds->Allocate(numPts * numSourcePts);
+    pointIds->SetNumberOfValues(numNewPts);
     outputPD->AddArray(pointIds);
     pointIds->Delete();
   }
   if (this->ColorMode == VTK_COLOR_BY_SCALAR && inCScalars) {
     newScalars = inCScalars->NewInstance();
     newScalars->SetNumberOfComponents(inCScalars->GetNumberOfComponents());
-    newScalars->Allocate(inCScalars->GetNumberOfComponents() * numPts *
-                         numSourcePts);
+    newScalars->SetNumberOfTuples(numNewPts);
     newScalars->SetName(inCScalars->GetName());
   } else if ((this->ColorMode == VTK_COLOR_BY_SCALE) && inSScalars) {
     newScalars = vtkFloatArray::New();
-    newScalars->Allocate(numPts * numSourcePts);
+    newScalars->SetNumberOfTuples(numNewPts);
     newScalars->SetName("GlyphScale");
     if (this->ScaleMode == VTK_SCALE_BY_SCALAR) {
       newScalars->SetName(inSScalars->GetName());
     }
   } else if ((this->ColorMode == VTK_COLOR_BY_VECTOR) && haveVectors) {
     newScalars = vtkFloatArray::New();
-    newScalars->Allocate(numPts * numSourcePts);
+    newScalars->SetNumberOfTuples(numNewPts);
     newScalars->SetName("VectorMagnitude");
   }
   if (haveVectors) {
     newVectors = vtkFloatArray::New();
     newVectors->SetNumberOfComponents(3);
-    newVectors->Allocate(3 * numPts * numSourcePts);
+    newVectors->SetNumberOfTuples(numNewPts);
     newVectors->SetName("GlyphVector");
   }
   if (haveNormals) {
     newNormals = vtkFloatArray::New();
     newNormals->SetNumberOfComponents(3);
-    newNormals->Allocate(3 * numPts * numSourcePts);
+    newNormals->SetNumberOfTuples(numNewPts);
     newNormals->SetName("Normals");
   }
   if (haveTCoords) {
     newTCoords = vtkFloatArray::New();
-    int numComps = sourceTCoords->GetNumberOfComponents();
-    newTCoords->SetNumberOfComponents(numComps);
-    newTCoords->Allocate(numComps * numPts * numSourcePts);
+    newTCoords->SetNumberOfComponents(sources[0].numTCoordComponents);
+    newTCoords->SetNumberOfTuples(numNewPts);
     newTCoords->SetName("TCoords");
   }
 
-  // Setting up for calls to PolyData::InsertNextCell()
-  if (this->IndexMode != VTK_INDEXING_OFF) {
-    output->Allocate(3 * numPts * numSourceCells, numPts * numSourceCells);
-  } else {
-    output->Allocate(source, 3 * numPts * numSourceCells,
-                     numPts * numSourceCells);
-  }
-
-  transformedSourcePts->SetDataTypeToDouble();
-  transformedSourcePts2->SetDataTypeToDouble();
-  transformedSourcePts->Allocate(numSourcePts);
-  transformedSourcePts2->Allocate(numSourcePts);
-
-  // Traverse all Input points, transforming Source points and copying
-  // point attributes.
-  //
-  ptIncr = 0;
-  cellIncr = 0;
-  for (inPtId = 0; inPtId < numPts; inPtId++) {
-    scalex = scaley = scalez = 1.0;
-    if (!(inPtId % 10000)) {
-      this->UpdateProgress(static_cast<double>(inPtId) / numPts);
-      if (this->GetAbortExecute()) {
-        break;
+  // Point data of the input is copied to the points (and cells) of each glyph.
+  const char *newScalarsName = newScalars ? newScalars->GetName() : NULL;
+  std::vector<ArrayPair> pointArrays, cellArrays;
+  if (pd) {
+    pointArrays =
+        AllocateArrays(pd, outputPD, numNewPts, true, newScalarsName);
+    if (this->FillCellData) {
+      vtkIdType numNewCells = 0;
+      for (int t = 0; t < kNumCellTypes; t++) {
+        numNewCells += totals.cells[t];
       }
+      cellArrays = AllocateArrays(pd, outputCD, numNewCells, false, NULL);
     }
+  }
 
-    // Get the scalar and vector data
-    if (inSScalars) {
-      s = inSScalars->GetComponent(inPtId, 0);
-      if (this->ScaleMode == VTK_SCALE_BY_SCALAR ||
-          this->ScaleMode == VTK_DATA_SCALING_OFF) {
-        scalex = scaley = scalez = s;
-      }
-    }
+  // Cells are stored in the format of vtkCellArray. Cell ids are assigned in
+  // the order vertices, lines, polygons, triangle strips.
+  std::array<vtkSmartPointer<vtkIdTypeArray>, kNumCellTypes> newOffsets,
+      newConnectivity;
+  std::array<vtkIdType, kNumCellTypes> firstCellId;
+  for (int t = 0; t < kNumCellTypes; t++) {
+    newOffsets[t] = vtkSmartPointer<vtkIdTypeArray>::New();
+    newOffsets[t]->SetNumberOfValues(totals.cells[t] + 1);
+    newOffsets[t]->SetValue(totals.cells[t], totals.connectivity[t]);
+    newConnectivity[t] = vtkSmartPointer<vtkIdTypeArray>::New();
+    newConnectivity[t]->SetNumberOfValues(totals.connectivity[t]);
+    firstCellId[t] = t == 0 ? 0 : firstCellId[t - 1] + totals.cells[t - 1];
+  }
 
-    if (haveVectors) {
-      vtkDataArray *array3D =
-          this->VectorMode == VTK_USE_NORMAL ? inNormals : inVectors;
-      if (array3D->GetNumberOfComponents() > 3) {
-        vtkErrorMacro(<< "vtkDataArray " << array3D->GetName()
-                      << " has more than 3 components.\n");
-        pts->Delete();
-        trans->Delete();
-        trans2->Delete();
-        if (newPts) {
-          newPts->Delete();
+  // Generate the glyphs in parallel. Each task processes a range of blocks
+  // and writes to the precomputed positions in the output arrays.
+  //
+  vtkSMPThreadLocalObject<vtkTransform> localTrans;
+  vtkSMPThreadLocalObject<vtkTransform> localTrans2;
+  auto generateGlyphs = [&](vtkIdType beginBlock, vtkIdType endBlock) {
+    vtkTransform *trans = localTrans.Local();
+    vtkTransform *trans2 = localTrans2.Local();
+    double matrix[16], normalMatrix[16];
+    for (vtkIdType block = beginBlock; block < endBlock; block++) {
+      GlyphOffsets glyph = blockOffsets[block];
+      vtkIdType end = std::min(numPts, (block + 1) * kBlockSize);
+      for (vtkIdType inPtId = block * kBlockSize; inPtId < end; inPtId++) {
+        if (glyphSource[inPtId] < 0) {
+          continue;
         }
-        if (newVectors) {
-          newVectors->Delete();
+        const GlyphSource &src = sources[glyphSource[inPtId]];
+        vtkIdType ptIncr = glyph.points;
+        double v[3] = {0, 0, 0}, ep[3], s = 0.0, vMag = 0.0, xs = 0.0,
+               ys = 0.0, zs = 0.0;
+        double scalex, scaley, scalez;
+        scalex = scaley = scalez = 1.0;
+
+        // Get the scalar and vector data
+        if (inSScalars) {
+          s = inSScalars->GetComponent(inPtId, 0);
+          if (this->ScaleMode == VTK_SCALE_BY_SCALAR ||
+              this->ScaleMode == VTK_DATA_SCALING_OFF) {
+            scalex = scaley = scalez = s;
+          }
         }
-        return false;
-      }
 
-      v[0] = 0;
-      v[1] = 0;
-      v[2] = 0;
-      array3D->GetTuple(inPtId, v);
-      vMag = vtkMath::Norm(v);
-
-      if (this->ScaleMode == VTK_SCALE_BY_VECTORCOMPONENTS) {
-        scalex = v[0];
-        scaley = v[1];
-        scalez = v[2];
-      } else if (this->ScaleMode == VTK_SCALE_BY_VECTOR) {
-        scalex = scaley = scalez = vMag;
-      }
-    }
+        if (haveVectors) {
+          array3D->GetTuple(inPtId, v);
+          vMag = vtkMath::Norm(v);
 
-    if (x_scaling || y_scaling || z_scaling) {
-      if (x_scaling) {
-        xs = x_scaling->GetComponent(inPtId, 0);
-      }
-      if (y_scaling) {
-        ys = y_scaling->GetComponent(inPtId, 0);
-      }
-      if (z_scaling) {
-        zs = z_scaling->GetComponent(inPtId, 0);
-      }
-
-      if (this->ScaleMode == VTK_SCALE_BY_NORMAL) {
-        scalex = xs;
-        scaley = ys;
-        scalez = zs;
-      }
-    }
-
-    // Clamp data scale if enabled
-    if (this->Clamping) {
-      scalex = (scalex < this->Range[0]
-                    ? this->Range[0]
-                    : (scalex > this->Range[1] ? this->Range[1] : scalex));
-      scalex = (scalex - this->Range[0]) / den;
-      scaley = (scaley < this->Range[0]
-                    ? this->Range[0]
-                    : (scaley > this->Range[1] ? this->Range[1] : scaley));
-      scaley = (scaley - this->Range[0]) / den;
-      scalez = (scalez < this->Range[0]
-                    ? this->Range[0]
-                    : (scalez > this->Range[1] ? this->Range[1] : scalez));
-      scalez = (scalez - this->Range[0]) / den;
-    }
-
-    // Compute index into table of glyphs
-    if (this->IndexMode != VTK_INDEXING_OFF) {
-      if (this->IndexMode == VTK_INDEXING_BY_SCALAR) {
-        value = s;
-      } else {
-        value = vMag;
-      }
-
-      int index =
-          static_cast<int>((value - this->Range[0]) * numberOfSources / den);
-      index = (index < 0 ? 0 : (index >= numberOfSources ? (numberOfSources - 1)
-                                                         : index));
-
-      source = this->GetSource(index, sourceVector);
-      if (source != NULL) {
-        sourcePts = source->GetPoints();
-        sourceNormals = source->GetPointData()->GetNormals();
-        numSourcePts = sourcePts->GetNumberOfPoints();
-        numSourceCells = source->GetNumberOfCells();
-      }
-    }
-
-    // Make sure we're not indexing into empty glyph
-    if (!source) {
-      continue;
-    }
+          if (this->ScaleMode == VTK_SCALE_BY_VECTORCOMPONENTS) {
+            scalex = v[0];
+            scaley = v[1];
+            scalez = v[2];
+          } else if (this->ScaleMode == VTK_SCALE_BY_VECTOR) {
+            scalex = scaley = scalez = vMag;
+          }
+        }
 
-    // Check ghost points.
-    // If we are processing a piece, we do not want to duplicate
-    // glyphs on the borders.
-    if (inGhostLevels &&
-        inGhostLevels[inPtId] & vtkDataSetAttributes::DUPLICATEPOINT) {
-      continue;
-    }
+        if (x_scaling || y_scaling || z_scaling) {
+          if (x_scaling) {
+            xs = x_scaling->GetComponent(inPtId, 0);
+          }
+          if (y_scaling) {
+            ys = y_scaling->GetComponent(inPtId, 0);
+          }
+          if (z_scaling) {
+            zs = z_scaling->GetComponent(inPtId, 0);
+          }
 
-    if (inputUG && !inputUG->IsPointVisible(inPtId)) {
-      // input is a vtkUniformGrid and the current point is blanked. Don't glyph
-      // it.
-      continue;
-    }
+          if (this->ScaleMode == VTK_SCALE_BY_NORMAL) {
+            scalex = xs;
+            scaley = ys;
+            scalez = zs;
+          }
+        }
 
-    if (!this->IsPointVisible(input, inPtId)) {
-      continue;
-    }
+        // Clamp data scale if enabled
+        if (this->Clamping) {
+          scalex = (scalex < this->Range[0]
+                        ? this->Range[0]
+                        : (scalex > this->Range[1] ? this->Range[1] : scalex));
+          scalex = (scalex - this->Range[0]) / den;
+          scaley = (scaley < this->Range[0]
+                        ? this->Range[0]
+                        : (scaley > this->Range[1] ? this->Range[1] : scaley));
+          scaley = (scaley - this->Range[0]) / den;
+          scalez = (scalez < this->Range[0]
+                        ? this->Range[0]
+                        : (scalez > this->Range[1] ? this->Range[1] : scalez));
+          scalez = (scalez - this->Range[0]) / den;
+        }
 
-    // Now begin copying/transforming glyph
-    trans->Identity();
-    trans2->Identity();
-
-    // Copy all topology (transformation independent)
-    for (cellId = 0; cellId < numSourceCells; cellId++) {
-      source->GetCellPoints(cellId, pointIdList.GetPointer());
-      cellPts = pointIdList.GetPointer();
-      npts = cellPts->GetNumberOfIds();
-      for (pts->Reset(), i = 0; i < npts; i++) {
-        pts->InsertId(i, cellPts->GetId(i) + ptIncr);
-      }
-      output->InsertNextCell(source->GetCellType(cellId), pts);
-    }
+        // Now begin copying/transforming glyph
+        trans->Identity();
+        trans2->Identity();
+
+        // Copy all topology (transformation independent)
+        for (int t = 0; t < kNumCellTypes; t++) {
+          vtkIdType *offsetsOut = newOffsets[t]->GetPointer(0);
+          vtkIdType *connectivityOut = newConnectivity[t]->GetPointer(0);
+          const auto &srcOffsets = src.offsets[t];
+          const auto &srcConnectivity = src.connectivity[t];
+          for (size_t c = 0; c + 1 < srcOffsets.size(); c++) {
+            offsetsOut[glyph.cells[t] + c] =
+                glyph.connectivity[t] + srcOffsets[c];
+          }
+          for (size_t i = 0; i < srcConnectivity.size(); i++) {
+            connectivityOut[glyph.connectivity[t] + i] =
+                srcConnectivity[i] + ptIncr;
+          }
+        }
 
-    // translate Source to Input point
-    input->GetPoint(inPtId, x);
-    // trans->Translate(x[0], x[1], x[2]);
+        if (haveVectors) {
+          // Copy Input vector
+          for (vtkIdType i = 0; i < src.numPoints; i++) {
+            newVectors->SetTuple(i + ptIncr, v);
+          }
+          if (this->Orient && (vMag > 0.0)) {
+            double rotation_axis[3] = {v[0] / vMag, v[1] / vMag + 1,
+                                       v[2] / vMag};
+            trans->RotateWXYZ(180.0, rotation_axis);
+
+            if (end_position) {
+              double middle_position[3];
+              end_position->GetTuple(inPtId, ep);
+              for (uint64_t i = 0; i < 3; i++) {
+                middle_position[i] = ep[i] - v[i] / 2.0;
+              }
+              trans2->Translate(middle_position[0], middle_position[1],
+                                middle_position[2]);
+            }
+          }
+        }
 
-    if (haveVectors) {
-      // Copy Input vector
-      for (i = 0; i < numSourcePts; i++) {
-        newVectors->InsertTuple(i + ptIncr, v);
-      }
-      if (this->Orient && (vMag > 0.0)) {
-        double rotation_axis[3] = {v[0] / vMag, v[1] / vMag + 1, v[2] / vMag};
-        trans->RotateWXYZ(180.0, rotation_axis);
-        // trans->RotateX(45.0);
-
-        if (end_position) {
-          double middle_position[3];
-          end_position->GetTuple(inPtId, ep);
-          for (uint64_t i = 0; i < 3; i++) {
-            middle_position[i] = ep[i] - v[i] / 2.0;
+        if (haveTCoords) {
+          for (vtkIdType i = 0; i < src.numPoints; i++) {
+            newTCoords->SetTuple(
+                i + ptIncr, &src.tcoords[i * src.numTCoordComponents]);
           }
-          trans2->Translate(middle_position[0], middle_position[1],
-                            middle_position[2]);
         }
-      }
-    }
 
-    if (haveTCoords) {
-      for (i = 0; i < numSourcePts; i++) {
-        sourceTCoords->GetTuple(i, tc);
-        newTCoords->InsertTuple(i + ptIncr, tc);
-      }
-    }
+        // determine scale factor from scalars if appropriate
+        // Copy scalar value
+        if (inSScalars && (this->ColorMode == VTK_COLOR_BY_SCALE)) {
+          for (vtkIdType i = 0; i < src.numPoints; i++) {
+            newScalars->SetTuple(i + ptIncr, &scalex);  // = scaley = scalez
+          }
+        } else if (inCScalars && (this->ColorMode == VTK_COLOR_BY_SCALAR)) {
+          for (vtkIdType i = 0; i < src.numPoints; i++) {
+            newScalars->SetTuple(ptIncr + i, inPtId, inCScalars);
+          }
+        }
+        if (haveVectors && this->ColorMode == VTK_COLOR_BY_VECTOR) {
+          for (vtkIdType i = 0; i < src.numPoints; i++) {
+            newScalars->SetTuple(i + ptIncr, &vMag);
+          }
+        }
 
-    // determine scale factor from scalars if appropriate
-    // Copy scalar value
-    if (inSScalars && (this->ColorMode == VTK_COLOR_BY_SCALE)) {
-      for (i = 0; i < numSourcePts; i++) {
-        newScalars->InsertTuple(i + ptIncr, &scalex);  // = scaley = scalez
-      }
-    } else if (inCScalars && (this->ColorMode == VTK_COLOR_BY_SCALAR)) {
-      for (i = 0; i < numSourcePts; i++) {
-        outputPD->CopyTuple(inCScalars, newScalars, inPtId, ptIncr + i);
-      }
-    }
-    if (haveVectors && this->ColorMode == VTK_COLOR_BY_VECTOR) {
-      for (i = 0; i < numSourcePts; i++) {
-        newScalars->InsertTuple(i + ptIncr, &vMag);
-      }
-    }
+        // scale data if appropriate
+        if (this->Scaling) {
+          if (this->ScaleMode == VTK_DATA_SCALING_OFF) {
+            scalex = scaley = scalez = this->ScaleFactor;
+          } else {
+            scalex *= this->ScaleFactor;
+            scaley *= this->ScaleFactor;
+            scalez *= this->ScaleFactor;
+          }
 
-    // scale data if appropriate
-    if (this->Scaling) {
-      if (this->ScaleMode == VTK_DATA_SCALING_OFF) {
-        scalex = scaley = scalez = this->ScaleFactor;
-      } else {
-        scalex *= this->ScaleFactor;
-        scaley *= this->ScaleFactor;
-        scalez *= this->ScaleFactor;
-      }
+          if (scalex == 0.0) {
+            scalex = 1.0e-10;
+          }
+          if (scaley == 0.0) {
+            scaley = 1.0e-10;
+          }
+          if (scalez == 0.0) {
+            scalez = 1.0e-10;
+          }
+          trans->Scale(scalex, scaley, scalez);
+        }
 
-      if (scalex == 0.0) {
-        scalex = 1.0e-10;
-      }
-      if (scaley == 0.0) {
-        scaley = 1.0e-10;
-      }
-      if (scalez == 0.0) {
-        scalez = 1.0e-10;
-      }
-      trans->Scale(scalex, scaley, scalez);
-    }
+        // multiply points and normals by resulting matrix
+        vtkMatrix4x4::Multiply4x4(trans2->GetMatrix()->GetData(),
+                                  trans->GetMatrix()->GetData(), matrix);
+        for (vtkIdType i = 0; i < src.numPoints; i++) {
+          const double *p = src.points[i].data();
+          double x[3];
+          for (int r = 0; r < 3; r++) {
+            x[r] = matrix[4 * r] * p[0] + matrix[4 * r + 1] * p[1] +
+                   matrix[4 * r + 2] * p[2] + matrix[4 * r + 3];
+          }
+          newPts->SetPoint(ptIncr + i, x);
+        }
 
-    // multiply points and normals by resulting matrix
-    if (this->SourceTransform) {
-      transformedSourcePts->Reset();
-      transformedSourcePts2->Reset();
-      this->SourceTransform->TransformPoints(sourcePts, transformedSourcePts);
-      trans->TransformPoints(transformedSourcePts, transformedSourcePts2);
-      trans2->TransformPoints(transformedSourcePts2, newPts);
-    } else {
-      transformedSourcePts->Reset();
-      trans->TransformPoints(sourcePts, transformedSourcePts);
-      trans2->TransformPoints(transformedSourcePts, newPts);
-    }
+        if (haveNormals) {
+          vtkMatrix4x4::Invert(trans->GetMatrix()->GetData(), normalMatrix);
+          vtkMatrix4x4::Transpose(normalMatrix, normalMatrix);
+          for (vtkIdType i = 0; i < src.numPoints; i++) {
+            const double *n = src.normals[i].data();
+            double x[3];
+            for (int r = 0; r < 3; r++) {
+              x[r] = normalMatrix[4 * r] * n[0] +
+                     normalMatrix[4 * r + 1] * n[1] +
+                     normalMatrix[4 * r + 2] * n[2];
+            }
+            vtkMath::Normalize(x);
+            newNormals->SetTuple(ptIncr + i, x);
+          }
+        }
 
-    if (haveNormals) {
-      trans->TransformNormals(sourceNormals, newNormals);
-    }
+        // Copy point data from source (if possible)
+        for (auto &arrays : pointArrays) {
+          for (vtkIdType i = 0; i < src.numPoints; ++i) {
+            arrays.second->SetTuple(ptIncr + i, inPtId, arrays.first);
+          }
+        }
+        for (auto &arrays : cellArrays) {
+          for (int t = 0; t < kNumCellTypes; t++) {
+            vtkIdType first = firstCellId[t] + glyph.cells[t];
+            vtkIdType numCells =
+                static_cast<vtkIdType>(src.offsets[t].size()) - 1;
+            for (vtkIdType i = 0; i < numCells; ++i) {
+              arrays.second->SetTuple(first + i, inPtId, arrays.first);
+            }
+          }
+        }
 
-    // Copy point data from source (if possible)
-    if (pd) {
-      for (i = 0; i < numSourcePts; ++i) {
-        srcPointIdList->SetId(i, inPtId);
-        dstPointIdList->SetId(i, ptIncr + i);
-      }
-      outputPD->CopyData(pd, srcPointIdList.GetPointer(),
-                         dstPointIdList.GetPointer());
-      if (this->FillCellData) {
-        for (i = 0; i < numSourceCells; ++i) {
-          srcCellIdList->SetId(i, inPtId);
-          dstCellIdList->SetId(i, cellIncr + i);
+        // If point ids are to be generated, do it here
+        if (this->GeneratePointIds) {
+          for (vtkIdType i = 0; i < src.numPoints; i++) {
+            pointIds->SetValue(ptIncr + i, inPtId);
+          }
         }
-        outputCD->CopyData(pd, srcCellIdList.GetPointer(),
-                           dstCellIdList.GetPointer());
-      }
-    }
 
-    // If point ids are to be generated, do it here
-    if (this->GeneratePointIds) {
-      for (i = 0; i < numSourcePts; i++) {
-        pointIds->InsertNextValue(inPtId);
+        glyph.Add(src);
       }
     }
-
-    ptIncr += numSourcePts;
-    cellIncr += numSourceCells;
-  }
+  };
+  vtkSMPTools::For(0, numBlocks, generateGlyphs);
 
   // Update ourselves and release memory
   //
   output->SetPoints(newPts);
-  newPts->Delete();
+  for (int t = 0; t < kNumCellTypes; t++) {
+    if (totals.cells[t] == 0) {
+      continue;
+    }
+    vtkNew<vtkCellArray> cells;
+    cells->SetData(newOffsets[t], newConnectivity[t]);
+    switch (t) {
+      case 0:
+        output->SetVerts(cells);
+        break;
+      case 1:
+        output->SetLines(cells);
+        break;
+      case 2:
+        output->SetPolys(cells);
+        break;
+      default:
+        output->SetStrips(cells);
+    }
+  }
 
   if (newScalars) {
     int idx = outputPD->AddArray(newScalars);
@@ -610,14 +815,12 @@ bool BDMGlyph::Execute(vtkDataSet *input, vtkInformationVector *sourceVector,
     newTCoords->Delete();
   }
 
-  output->Squeeze();
-  trans->Delete();
-  pts->Delete();
-
   return true;
 }
 
 //----------------------------------------------------------------------------
 void BDMGlyph::PrintSelf(ostream &os, vtkIndent indent) {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "LODThreshold: " << this->LODThreshold << "\n";
+  os << indent << "LODTargetReduction: " << this->LODTargetReduction << "\n";
 }
@@ -21,12 +21,29 @@
 
 #define VTK_SCALE_BY_NORMAL 4
 
+/// vtkGlyph3D that generates the glyphs of all input points in parallel with
+/// vtkSMPTools. Only depends on VTK and can therefore also be used without
+/// ParaView (e.g. offscreen).
 class VTK_EXPORT BDMGlyph : public vtkGlyph3D {
  public:
   static BDMGlyph* New();
   vtkTypeMacro(BDMGlyph, vtkGlyph3D);
   void PrintSelf(ostream& os, vtkIndent indent) override;
 
+  //@{
+  /**
+   * Set/Get the number of input points above which low resolution glyphs are
+   * generated. The polygons of the glyph source are decimated by
+   * \c LODTargetReduction (e.g. 0.8 removes 80% of the triangles).
+   * Glyph sources with vertices or lines are not decimated.
+   * A threshold of 0 (default) disables low resolution glyphs.
+   */
+  vtkSetClampMacro(LODThreshold, vtkIdType, 0, VTK_ID_MAX);
+  vtkGetMacro(LODThreshold, vtkIdType);
+  vtkSetClampMacro(LODTargetReduction, double, 0.0, 0.99);
+  vtkGetMacro(LODTargetReduction, double);
+  //@}
+
  protected:
   BDMGlyph();
   ~BDMGlyph();
@@ -43,6 +60,9 @@ class VTK_EXPORT BDMGlyph : public vtkGlyph3D {
                vtkPolyData* output, vtkDataArray* inSScalars,
                vtkDataArray* inVectors) override;
 
+  vtkIdType LODThreshold;
+  double LODTargetReduction;
+
  private:
   BDMGlyph(const BDMGlyph&) = delete;
   void operator=(const BDMGlyph&) = delete;
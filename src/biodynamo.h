@@ -26,14 +26,17 @@
 #include "core/analysis/reduce.h"
 #include "core/analysis/style.h"
 #include "core/analysis/time_series.h"
+#include "core/analysis/time_series_sink.h"
 #include "core/behavior/behavior.h"
 #include "core/behavior/chemotaxis.h"
 #include "core/behavior/gene_regulation.h"
 #include "core/behavior/growth_division.h"
+#include "core/behavior/intracellular_network.h"
 #include "core/behavior/secretion.h"
 #include "core/behavior/stateless_behavior.h"
 #include "core/environment/environment.h"
 #include "core/execution_context/copy_execution_context.h"
+#include "core/iteration_context.h"
 #include "core/model_initializer.h"
 #include "core/param/command_line_options.h"
 #include "core/param/param.h"
@@ -42,6 +45,7 @@
 #include "core/resource_manager.h"
 #include "core/scheduler.h"
 #include "core/shape.h"
+#include "core/simulation_snapshot.h"
 #include "core/substance_initializers.h"
 #include "core/util/filesystem.h"
 #include "core/util/root.h"
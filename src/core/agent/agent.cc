@@ -52,13 +52,19 @@ Agent::Agent(const Agent& other)
           other.propagate_staticness_neighborhood_),
       is_static_next_ts_(other.is_static_next_ts_) {
   for (auto* behavior : other.behaviors_) {
-    behaviors_.push_back(behavior->NewCopy());
+    if (behavior->IsShared()) {
+      behaviors_.push_back(behavior);
+    } else {
+      behaviors_.push_back(behavior->NewCopy());
+    }
   }
 }
 
 Agent::~Agent() {
   for (auto* el : behaviors_) {
-    delete el;
+    if (!el->IsShared()) {
+      delete el;
+    }
   }
 }
 
@@ -122,6 +128,28 @@ void Agent::AssignNewUid() {
 
 const AgentUid& Agent::GetUid() const { return uid_; }
 
+void Agent::UpdateAgentUids(const AgentUidMap<AgentUid>& new_uids) {
+  uid_ = new_uids[uid_];
+}
+
+void Agent::WriteBinary(BinaryWriter* writer) const {
+  writer->WriteVersion(1);
+  writer->Write(uid_, box_idx_, run_behavior_loop_idx_,
+                static_cast<uint64_t>(behaviors_.size()));
+  for (auto* behavior : behaviors_) {
+    WriteBehavior(writer, behavior);
+  }
+}
+
+void Agent::ReadBinary(BinaryReader* reader) {
+  reader->ReadVersion(1, "Agent");
+  uint64_t num_behaviors;
+  reader->Read(uid_, box_idx_, run_behavior_loop_idx_, num_behaviors);
+  for (uint64_t i = 0; i < num_behaviors; ++i) {
+    behaviors_.push_back(ReadBehavior(reader));
+  }
+}
+
 uint32_t Agent::GetBoxIdx() const { return box_idx_; }
 
 void Agent::SetBoxIdx(uint32_t idx) { box_idx_ = idx; }
@@ -134,7 +162,9 @@ void Agent::AddBehavior(Behavior* behavior) { behaviors_.push_back(behavior); }
 void Agent::RemoveBehavior(const Behavior* behavior) {
   for (unsigned int i = 0; i < behaviors_.size(); i++) {
     if (behaviors_[i] == behavior) {
-      delete behavior;
+      if (!behavior->IsShared()) {
+        delete behavior;
+      }
       behaviors_.erase(behaviors_.begin() + i);
       // if behavior was before or at the current run_behavior_loop_idx_,
       // correct it by subtracting one.
@@ -151,9 +181,29 @@ void Agent::RunBehaviors() {
   }
 }
 
+void Agent::RunBehaviors(const IterationContext& ctxt) {
+  for (run_behavior_loop_idx_ = 0; run_behavior_loop_idx_ < behaviors_.size();
+       ++run_behavior_loop_idx_) {
+    auto* behavior = behaviors_[run_behavior_loop_idx_];
+    behavior->Run(this, ctxt);
+  }
+}
+
 const InlineVector<Behavior*, 2>& Agent::GetAllBehaviors() const {
   return behaviors_;
 }
+
+Behavior* Agent::UnshareBehavior(const Behavior* behavior) {
+  for (uint16_t i = 0; i < behaviors_.size(); i++) {
+    if (behaviors_[i] == behavior) {
+      if (behavior->IsShared()) {
+        behaviors_[i] = behavior->NewCopy();
+      }
+      return behaviors_[i];
+    }
+  }
+  return nullptr;
+}
 // ---------------------------------------------------------------------------
 
 void Agent::RemoveFromSimulation() {
@@ -171,10 +221,14 @@ void Agent::InitializeBehaviors(const NewAgentEvent& event) {
       for (auto* nagent : event.new_agents) {
         event.new_behaviors.push_back(nagent->behaviors_[cnt]);
       }
-      event.existing_behavior = behavior;
-      auto* new_behavior = behavior->New();
-      new_behavior->Initialize(event);
-      behaviors_.push_back(new_behavior);
+      if (behavior->IsShared()) {
+        behaviors_.push_back(behavior);
+      } else {
+        event.existing_behavior = behavior;
+        auto* new_behavior = behavior->New();
+        new_behavior->Initialize(event);
+        behaviors_.push_back(new_behavior);
+      }
       cnt++;
     }
   }
@@ -185,7 +239,7 @@ void Agent::UpdateBehaviors(const NewAgentEvent& event) {
   uint64_t cnt = 0;
   for (auto* behavior : behaviors_) {
     bool copied = behavior->WillBeCopied(event.GetUid());
-    if (!behavior->WillBeRemoved(event.GetUid())) {
+    if (!behavior->IsShared() && !behavior->WillBeRemoved(event.GetUid())) {
       event.new_behaviors.clear();
       if (copied) {
         for (auto* new_agent : event.new_agents) {
@@ -202,7 +256,9 @@ void Agent::UpdateBehaviors(const NewAgentEvent& event) {
   for (auto it = behaviors_.begin(); it != behaviors_.end();) {
     auto* behavior = *it;
     if (behavior->WillBeRemoved(event.GetUid())) {
-      delete *it;
+      if (!behavior->IsShared()) {
+        delete behavior;
+      }
       it = behaviors_.erase(it);
     } else {
       ++it;
@@ -29,12 +29,14 @@
 #include "core/agent/agent_pointer.h"
 #include "core/agent/agent_uid.h"
 #include "core/agent/new_agent_event.h"
+#include "core/container/agent_uid_map.h"
 #include "core/container/inline_vector.h"
 #include "core/container/math_array.h"
 #include "core/interaction_force.h"
 #include "core/shape.h"
 #include "core/util/macros.h"
 #include "core/util/root.h"
+#include "core/util/serialization.h"
 #include "core/util/spinlock.h"
 #include "core/util/type.h"
 
@@ -74,6 +76,7 @@ namespace bdm {
 // -----------------------------------------------------------------------------
 
 class Behavior;
+struct IterationContext;
 
 /// Contains code required by all agents
 class Agent {
@@ -147,6 +150,33 @@ class Agent {
 
   const AgentUid& GetUid() const;
 
+  /// Replaces the uid of this agent with its new value in `new_uids`.
+  /// This function is called after the AgentUid index space has been
+  /// compacted. Subclasses that store `AgentPointer`s or `AgentUid`s must
+  /// override this method and update them as well
+  /// (see `AgentPointer::UpdateUid`).\n
+  /// NB: Don't forget to call the implementation of the base class first.
+  /// `Base::UpdateAgentUids(new_uids);`
+  /// \see `ResourceManager::CompactAgentUids`
+  virtual void UpdateAgentUids(const AgentUidMap<AgentUid>& new_uids);
+
+  // ---------------------------------------------------------------------------
+  // Binary serialization (see `BDM_SERIALIZE`)
+  using BinaryRoot = Agent;
+
+  /// Returns nullptr if the most derived class of this agent has not been
+  /// declared with `BDM_SERIALIZE`. Such agents are written with ROOT.
+  virtual const BinaryTypeInfo* GetBinaryType() const { return nullptr; }
+
+  /// Writes the data members of this agent including its behaviors.
+  virtual void WriteBinary(BinaryWriter* writer) const;
+
+  /// Reads the data members that have been written with `WriteBinary`.
+  /// Must only be called for an agent that has been created with the I/O
+  /// constructor.
+  virtual void ReadBinary(BinaryReader* reader);
+  // ---------------------------------------------------------------------------
+
   Spinlock* GetLock() { return &lock_; }
 
   /// If the thread-safety mechanism is set to user-specified this function
@@ -177,6 +207,8 @@ class Agent {
     is_static_next_ts_ = value;
   }
 
+  bool GetStaticnessNextTimestep() const { return is_static_next_ts_; }
+
   bool GetPropagateStaticness() const {
     return propagate_staticness_neighborhood_;
   }
@@ -224,13 +256,24 @@ class Agent {
   /// Remove a behavior from this agent
   /// The parameter `behavior` will be deleted if the instance is  stored in
   /// this agent and must not be used after the call to `RemoveBehavior`.
+  /// Shared behaviors are not deleted. \see `Behavior::Share`
   void RemoveBehavior(const Behavior* behavior);
 
   /// Execute all behaviorsq
   void RunBehaviors();
 
+  /// Execute all behaviors with the state of the current iteration.
+  /// \see `Behavior::Run(Agent*, const IterationContext&)`
+  void RunBehaviors(const IterationContext& ctxt);
+
   /// Return all behaviors
   const InlineVector<Behavior*, 2>& GetAllBehaviors() const;
+
+  /// Replaces the shared `behavior` with a private copy for this agent and
+  /// returns it (copy-on-write). Behaviors that are not shared are returned
+  /// unchanged. Returns nullptr if `behavior` is not stored in this agent.
+  /// \see `Behavior::Share`
+  Behavior* UnshareBehavior(const Behavior* behavior);
   // ---------------------------------------------------------------------------
 
   virtual Real3 CalculateDisplacement(const InteractionForce* force,
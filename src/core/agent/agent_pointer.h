@@ -21,6 +21,7 @@
 #include <type_traits>
 
 #include "core/agent/agent_uid.h"
+#include "core/container/agent_uid_map.h"
 #include "core/execution_context/execution_context.h"
 #include "core/simulation.h"
 #include "core/util/root.h"
@@ -233,6 +234,23 @@ class AgentPointer {
     }
   }
 
+  /// Replaces the stored AgentUid with the one given in `new_uids`.
+  /// Required after the AgentUid index space has been compacted.
+  /// Agent pointers to agents that do not exist anymore are set to nullptr.
+  /// Has no effect in the direct mode.
+  /// \see `ResourceManager::CompactAgentUids`
+  void UpdateUid(const AgentUidMap<AgentUid>& new_uids) {
+    if (gAgentPointerMode != AgentPointerMode::kIndirect ||
+        d_.uid == AgentUid()) {
+      return;
+    }
+    if (new_uids.Contains(d_.uid)) {
+      d_.uid = new_uids[d_.uid];
+    } else {
+      d_.uid = AgentUid();
+    }
+  }
+
   /// Replace with std::variant once we move to >= c++17
   union Data {
     AgentUid uid;
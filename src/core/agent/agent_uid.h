@@ -16,6 +16,7 @@
 #define CORE_AGENT_AGENT_UID_H_
 
 #include <limits>
+#include <ostream>
 #include "core/util/root.h"
 
 namespace bdm {
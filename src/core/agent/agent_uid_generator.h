@@ -18,6 +18,7 @@
 #include <atomic>
 #include <limits>
 #include <mutex>
+#include <vector>
 #include "core/agent/agent_handle.h"
 #include "core/agent/agent_uid.h"
 #include "core/container/agent_uid_map.h"
@@ -61,11 +62,62 @@ class AgentUidGenerator {
     tl_uids_[tinfo_->GetMyThreadId()].push_back(uid);
   }
 
+  /// Batched version of `ReuseAgentUid`.
+  /// Thread-safe.
+  void ReuseAgentUids(const std::vector<AgentUid>& uids) {
+    auto& tl_uids = tl_uids_[tinfo_->GetMyThreadId()];
+    tl_uids.insert(tl_uids.end(), uids.begin(), uids.end());
+  }
+
   /// Resizes internal data structures to the number of threads.
   /// NB: If Update is called, calls to GenerateUid or ReuseAgentUid are not
   /// allowed!
   void Update() { tl_uids_.resize(tinfo_->GetMaxThreads()); }
 
+  /// Redistributes the AgentUids that can be reused evenly among all threads.
+  /// Without balancing, uids freed on one thread can only be reused by the
+  /// same thread.
+  /// NB: Not thread-safe! Calls to GenerateUid or ReuseAgentUid are not
+  /// allowed while this function is executed.
+  void BalanceReusableUids() {
+    uint64_t total = 0;
+    for (auto& uids : tl_uids_) {
+      total += uids.size();
+    }
+    if (total == 0) {
+      return;
+    }
+    auto num_threads = tl_uids_.size();
+    uint64_t target = total / num_threads + (total % num_threads == 0 ? 0 : 1);
+
+    std::vector<AgentUid> surplus;
+    for (auto& uids : tl_uids_) {
+      while (uids.size() > target) {
+        surplus.push_back(uids.back());
+        uids.pop_back();
+      }
+    }
+    for (auto& uids : tl_uids_) {
+      while (uids.size() < target && surplus.size()) {
+        uids.push_back(surplus.back());
+        surplus.pop_back();
+      }
+    }
+  }
+
+  /// Discards all AgentUids that can be reused and continues to generate
+  /// AgentUids starting from index `highest_index`.
+  /// Used after the AgentUid index space has been compacted.
+  /// \see `ResourceManager::CompactAgentUids`
+  /// NB: Not thread-safe!
+  void Reset(AgentUid::Index_t highest_index) {
+    counter_ = highest_index;
+    for (auto& uids : tl_uids_) {
+      uids.clear();
+      uids.shrink_to_fit();
+    }
+  }
+
  private:
   std::atomic<typename AgentUid::Index_t> counter_;  //!
   /// ROOT can't persist std::atomic.
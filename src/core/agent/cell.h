@@ -28,6 +28,7 @@
 #include "core/agent/new_agent_event.h"
 #include "core/container/inline_vector.h"
 #include "core/container/math_array.h"
+#include "core/container/math_array_3xn.h"
 #include "core/execution_context/in_place_exec_ctxt.h"
 #include "core/functor.h"
 #include "core/interaction_force.h"
@@ -39,6 +40,8 @@ namespace bdm {
 
 class Cell : public Agent {
   BDM_AGENT_HEADER(Cell, Agent, 1);
+  BDM_SERIALIZE(Cell, 1, position_, tractor_force_, diameter_, volume_,
+                adherence_, density_);
 
  public:
   /// First axis of the local coordinate system.
@@ -226,6 +229,9 @@ class Cell : public Agent {
   }
 
   void SetTractorForce(const Real3& tractor_force) {
+    if (tractor_force != Real3{0, 0, 0}) {
+      SetPropagateStaticness();
+    }
     tractor_force_ = tractor_force;
   }
 
@@ -278,17 +284,21 @@ class Cell : public Agent {
     bool physical_translation = false;
     // bool physical_rotation = false;
 
-    real_t h = dt;
-    Real3 movement_at_next_step{0, 0, 0};
+    // Forces and displacement are accumulated in `real_acc_t` to avoid
+    // cancellation errors if `real_t` is a single precision type.
+    real_acc_t h = dt;
+    RealAcc3 movement_at_next_step{0, 0, 0};
 
     // BIOLOGY :
     // 0) Start with tractor force : What the biology defined as active
     // movement------------
-    movement_at_next_step += tf * h;
+    movement_at_next_step[0] += tf[0] * h;
+    movement_at_next_step[1] += tf[1] * h;
+    movement_at_next_step[2] += tf[2] * h;
 
     // PHYSICS
     // the physics force to move the point mass
-    Real3 translation_force_on_point_mass{0, 0, 0};
+    RealAcc3 translation_force_on_point_mass{0, 0, 0};
 
     // the physics force to rotate the cell
     // Real3 rotation_force { 0, 0, 0 };
@@ -304,19 +314,38 @@ class Cell : public Agent {
 
     uint64_t non_zero_neighbor_forces = 0;
     if (!IsStatic()) {
+      // Neighbors are gathered into batches, whose forces are calculated
+      // together (see `InteractionForce::CalculateBatch`).
+      Agent* neighbors[kSimdBatchSize];
+      Real4 neighbor_forces[kSimdBatchSize];
+      uint64_t num_neighbors = 0;
+      auto add_neighbor_forces = [&]() {
+        force->CalculateBatch(this, neighbors, num_neighbors,
+                              neighbor_forces);
+        for (uint64_t i = 0; i < num_neighbors; ++i) {
+          const auto& neighbor_force = neighbor_forces[i];
+          if (neighbor_force[0] != 0 || neighbor_force[1] != 0 ||
+              neighbor_force[2] != 0) {
+            non_zero_neighbor_forces++;
+            translation_force_on_point_mass[0] += neighbor_force[0];
+            translation_force_on_point_mass[1] += neighbor_force[1];
+            translation_force_on_point_mass[2] += neighbor_force[2];
+          }
+        }
+        num_neighbors = 0;
+      };
       auto* ctxt = Simulation::GetActive()->GetExecutionContext();
       auto calculate_neighbor_forces =
           L2F([&](Agent* neighbor, real_t squared_distance) {
-            auto neighbor_force = force->Calculate(this, neighbor);
-            if (neighbor_force[0] != 0 || neighbor_force[1] != 0 ||
-                neighbor_force[2] != 0) {
-              non_zero_neighbor_forces++;
-              translation_force_on_point_mass[0] += neighbor_force[0];
-              translation_force_on_point_mass[1] += neighbor_force[1];
-              translation_force_on_point_mass[2] += neighbor_force[2];
+            neighbors[num_neighbors] = neighbor;
+            if (++num_neighbors == kSimdBatchSize) {
+              add_neighbor_forces();
             }
           });
       ctxt->ForEachNeighbor(calculate_neighbor_forces, *this, squared_radius);
+      if (num_neighbors != 0) {
+        add_neighbor_forces();
+      }
 
       if (non_zero_neighbor_forces > 1) {
         SetStaticnessNextTimestep(false);
@@ -325,8 +354,8 @@ class Cell : public Agent {
 
     // 4) PhysicalBonds
     // How the physics influences the next displacement
-    real_t norm_of_force = std::sqrt(translation_force_on_point_mass *
-                                     translation_force_on_point_mass);
+    real_acc_t norm_of_force = std::sqrt(translation_force_on_point_mass *
+                                         translation_force_on_point_mass);
 
     // is there enough force to :
     //  - make us biologically move (Tractor) :
@@ -334,7 +363,7 @@ class Cell : public Agent {
     physical_translation = norm_of_force > GetAdherence();
 
     assert(GetMass() != 0 && "The mass of a cell was found to be zero!");
-    real_t mh = h / GetMass();
+    real_acc_t mh = h / GetMass();
     // adding the physics translation (scale by weight) if important enough
     if (physical_translation) {
       // We scale the move with mass and time step
@@ -346,10 +375,13 @@ class Cell : public Agent {
       auto* param = Simulation::GetActive()->GetParam();
       if (norm_of_force * mh > param->simulation_max_displacement) {
         movement_at_next_step.Normalize();
-        movement_at_next_step *= param->simulation_max_displacement;
+        movement_at_next_step *=
+            static_cast<real_acc_t>(param->simulation_max_displacement);
       }
     }
-    return movement_at_next_step;
+    return {static_cast<real_t>(movement_at_next_step[0]),
+            static_cast<real_t>(movement_at_next_step[1]),
+            static_cast<real_t>(movement_at_next_step[2])};
   }
 
   void ApplyDisplacement(const Real3& displacement) override;
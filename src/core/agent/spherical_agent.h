@@ -25,6 +25,7 @@ namespace bdm {
 
 class SphericalAgent : public Agent {
   BDM_AGENT_HEADER(SphericalAgent, Agent, 1);
+  BDM_SERIALIZE(SphericalAgent, 1, position_, diameter_);
 
  public:
   SphericalAgent() : diameter_(1.0) {}
@@ -15,8 +15,12 @@
 #ifndef CORE_ALGORITHM_H_
 #define CORE_ALGORITHM_H_
 
+#include <omp.h>
+#include <array>
 #include <cmath>
 #include <cstdint>
+#include <utility>
+#include <vector>
 
 namespace bdm {
 
@@ -97,6 +101,65 @@ uint64_t BinarySearch(const TSearch& search_val, const TContainer& container,
   }
 }
 
+// -----------------------------------------------------------------------------
+/// Sorts `v` by `key(element)` with a parallel least significant digit radix
+/// sort. `key` must return an unsigned integer with at most `num_bits`
+/// significant bits. The sort is stable. `buffer` is used as temporary
+/// storage to avoid reallocations between calls.
+template <typename T, typename TKey>
+void ParallelRadixSort(std::vector<T>* v, std::vector<T>* buffer, TKey key,
+                       uint64_t num_bits) {
+  constexpr uint64_t kRadixBits = 8;
+  constexpr uint64_t kBuckets = 1 << kRadixBits;
+  auto n = v->size();
+  buffer->resize(n);
+  std::vector<std::array<uint64_t, kBuckets>> histograms(omp_get_max_threads());
+
+  for (uint64_t shift = 0; shift < num_bits; shift += kRadixBits) {
+    const T* src = v->data();
+    T* dst = buffer->data();
+    // skip digits that are equal for all elements (e.g. the high digits of
+    // small keys)
+    bool skip = false;
+#pragma omp parallel
+    {
+      uint64_t tid = omp_get_thread_num();
+      uint64_t num_threads = omp_get_num_threads();
+      uint64_t begin = n * tid / num_threads;
+      uint64_t end = n * (tid + 1) / num_threads;
+      auto& histogram = histograms[tid];
+      histogram.fill(0);
+      for (uint64_t i = begin; i < end; ++i) {
+        histogram[(key(src[i]) >> shift) & (kBuckets - 1)]++;
+      }
+#pragma omp barrier
+#pragma omp single
+      {
+        // exclusive prefix sum in the order (bucket, thread) to keep the
+        // sort stable
+        uint64_t sum = 0;
+        for (uint64_t b = 0; b < kBuckets; ++b) {
+          uint64_t bucket_begin = sum;
+          for (uint64_t t = 0; t < num_threads; ++t) {
+            auto count = histograms[t][b];
+            histograms[t][b] = sum;
+            sum += count;
+          }
+          skip = skip || sum - bucket_begin == n;
+        }
+      }
+      if (!skip) {
+        for (uint64_t i = begin; i < end; ++i) {
+          dst[histogram[(key(src[i]) >> shift) & (kBuckets - 1)]++] = src[i];
+        }
+      }
+    }
+    if (!skip) {
+      std::swap(*v, *buffer);
+    }
+  }
+}
+
 }  // namespace bdm
 
 #endif  // CORE_ALGORITHM_H_
@@ -14,7 +14,10 @@
 
 #include "core/analysis/time_series.h"
 #include <TBufferJSON.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include "core/analysis/reduce.h"
 #include "core/scheduler.h"
 #include "core/simulation.h"
@@ -92,34 +95,50 @@ real_t TimeSeries::ComputeError(const TimeSeries& ts1, const TimeSeries& ts2) {
     }
   }
 
+  real_t error = 0.0;
   for (auto& pair : ts1.data_) {
     auto& key = pair.first;
+    auto& data1 = pair.second;
+    auto& data2 = ts2.data_.at(key);
     // check that all time series objects have the same x values
-    auto& xref = ts1.data_.at(key).x_values;
-    auto& xcurrent = ts2.data_.at(key).x_values;
-    if (xref.size() != xcurrent.size()) {
+    if (data1.x_values.size() != data2.x_values.size()) {
       Log::Warning("TimeSeries::ComputeError",
                    "The time series objects for entry (", key,
                    ") have different x_values. Operation aborted.");
       return std::numeric_limits<real_t>::infinity();
-    } else {
-      for (uint64_t j = 0; j < xref.size(); ++j) {
-        if (std::abs(xref[j] - xcurrent[j]) > 1e-5) {
-          Log::Warning("TimeSeries::ComputeError",
-                       "The time series objects for entry (", key,
-                       ") have different x_values. Operation aborted.");
-          return std::numeric_limits<real_t>::infinity();
-        }
+    }
+    const auto* x1 = data1.x_values.data();
+    const auto* x2 = data2.x_values.data();
+    int x_mismatch = 0;
+#pragma omp parallel for reduction(+ : x_mismatch)
+    for (uint64_t i = 0; i < data1.x_values.size(); ++i) {
+      if (std::abs(x1[i] - x2[i]) > 1e-5) {
+        x_mismatch++;
       }
     }
-  }
+    if (x_mismatch != 0) {
+      Log::Warning("TimeSeries::ComputeError",
+                   "The time series objects for entry (", key,
+                   ") have different x_values. Operation aborted.");
+      return std::numeric_limits<real_t>::infinity();
+    }
 
-  real_t error = 0.0;
-  for (auto& pair : ts1.data_) {
-    auto& key = pair.first;
-    auto& yref = ts1.data_.at(key).y_values;
-    auto& ycurrent = ts2.data_.at(key).y_values;
-    error += Math::MSE(yref, ycurrent);
+    // Same error as `Math::MSE`, which was used before.
+    if (data1.y_values.size() != data2.y_values.size()) {
+      Log::Fatal("Math::MSE", "vectors must have same length");
+    }
+
+    // mean squared error
+    const auto* y1 = data1.y_values.data();
+    const auto* y2 = data2.y_values.data();
+    uint64_t num_y = data1.y_values.size();
+    real_t sum = 0;
+#pragma omp parallel for simd reduction(+ : sum)
+    for (uint64_t i = 0; i < num_y; ++i) {
+      auto diff = y2[i] - y1[i];
+      sum += diff * diff;
+    }
+    error += sum / num_y;
   }
   return error;
 }
@@ -130,30 +149,28 @@ void TimeSeries::Load(const std::string& full_filepath, TimeSeries** restored) {
 }
 
 // -----------------------------------------------------------------------------
-void TimeSeries::Merge(
-    TimeSeries* merged, const std::vector<TimeSeries>& time_series,
-    const std::function<void(const std::vector<real_t>&, real_t*, real_t*,
-                             real_t*)>& merger) {
+bool TimeSeries::PrepareMerge(TimeSeries* merged,
+                              const std::vector<TimeSeries>& time_series) {
   if (!merged) {
     Log::Warning("TimeSeries::Merge",
                  "Parameter 'merged' is a nullptr. Operation aborted.");
-    return;
+    return false;
   }
 
   // check that merged is empty
   if (merged->data_.size() != 0) {
     Log::Warning("TimeSeries::Merge",
                  "Parameter 'merged' is not empty. Operation aborted.");
-    return;
+    return false;
   }
 
   if (time_series.size() == 0) {
     Log::Warning("TimeSeries::Merge",
                  "The given time series vector is empty. Operation aborted.");
-    return;
+    return false;
   } else if (time_series.size() == 1) {
     *merged = time_series[0];
-    return;
+    return false;
   }
 
   // verify that all TimeSeries contain the same entries
@@ -164,14 +181,14 @@ void TimeSeries::Merge(
       Log::Warning("TimeSeries::Merge",
                    "The time series objects that should be merged do not "
                    "contain the same entries. Operation aborted.");
-      return;
+      return false;
     }
     for (auto& p : ref.data_) {
       if (current.data_.find(p.first) == current.data_.end()) {
         Log::Warning("TimeSeries::Merge",
                      "The time series objects that should be merged do not "
                      "contain the same entries. Operation aborted");
-        return;
+        return false;
       }
     }
   }
@@ -179,40 +196,84 @@ void TimeSeries::Merge(
   for (auto& pair : ref.data_) {
     auto& key = pair.first;
     // check that all time series objects have the same x values
-    auto& xref = ref.data_.at(key).x_values;
-    for (uint64_t i = 1; i < time_series.size(); ++i) {
-      auto& xcurrent = time_series[i].data_.at(key).x_values;
+    auto& xref = pair.second.x_values;
+    int mismatch = 0;
+    // The merge reads `x_values.size()` y values from each time series.
+    int y_mismatch = 0;
+#pragma omp parallel for reduction(+ : mismatch, y_mismatch)
+    for (uint64_t i = 0; i < time_series.size(); ++i) {
+      auto& current = time_series[i].data_.at(key);
+      auto& xcurrent = current.x_values;
+      if (current.y_values.size() != xcurrent.size()) {
+        y_mismatch++;
+      }
       if (xref.size() != xcurrent.size()) {
-        Log::Warning("TimeSeries::Merge", "The time series objects for entry (",
-                     key, ") have different x_values. Operation aborted.");
-        return;
-      } else {
-        for (uint64_t j = 0; j < xref.size(); ++j) {
-          if (std::abs(xref[j] - xcurrent[j]) > 1e-5) {
-            Log::Warning("TimeSeries::Merge",
-                         "The time series objects for entry (", key,
-                         ") have different x_values. Operation aborted.");
-            return;
-          }
+        mismatch++;
+        continue;
+      }
+      for (uint64_t j = 0; j < xref.size(); ++j) {
+        if (std::abs(xref[j] - xcurrent[j]) > 1e-5) {
+          mismatch++;
+          break;
         }
       }
     }
+    if (mismatch != 0) {
+      Log::Warning("TimeSeries::Merge", "The time series objects for entry (",
+                   key, ") have different x_values. Operation aborted.");
+      return false;
+    }
+    if (y_mismatch != 0) {
+      Log::Warning("TimeSeries::Merge", "The time series objects for entry (",
+                   key,
+                   ") have a different number of x_values and y_values. "
+                   "Operation aborted.");
+      return false;
+    }
+  }
+  return true;
+}
 
-    // merge
-    //  initialize
-    merged->data_.emplace(key, Data());
-    auto& mdata = merged->data_[key];
-    mdata.x_values.resize(xref.size());
-    mdata.y_values.resize(xref.size());
-    mdata.y_error_low.resize(xref.size());
-    mdata.y_error_high.resize(xref.size());
+// -----------------------------------------------------------------------------
+std::vector<const real_t*> TimeSeries::InitMergedEntry(
+    TimeSeries* merged, const std::vector<TimeSeries>& time_series,
+    const std::string& id, const std::vector<real_t>& x_values) {
+  auto& mdata = merged->data_[id];
+  mdata.x_values = x_values;
+  mdata.y_values.resize(x_values.size());
+  mdata.y_error_low.resize(x_values.size());
+  mdata.y_error_high.resize(x_values.size());
+
+  std::vector<const real_t*> columns(time_series.size());
+  for (uint64_t i = 0; i < time_series.size(); ++i) {
+    columns[i] = time_series[i].data_.at(id).y_values.data();
+  }
+  return columns;
+}
 
-#pragma omp parallel for
-    for (uint64_t i = 0; i < xref.size(); ++i) {
-      mdata.x_values[i] = xref[i];
-      std::vector<real_t> all_y_values(time_series.size());
-      for (uint64_t j = 0; j < time_series.size(); ++j) {
-        all_y_values[j] = time_series[j].data_.at(key).y_values[i];
+// -----------------------------------------------------------------------------
+void TimeSeries::Merge(
+    TimeSeries* merged, const std::vector<TimeSeries>& time_series,
+    const std::function<void(const std::vector<real_t>&, real_t*, real_t*,
+                             real_t*)>& merger) {
+  if (!PrepareMerge(merged, time_series)) {
+    return;
+  }
+
+  for (auto& pair : time_series[0].data_) {
+    auto& x_values = pair.second.x_values;
+    auto columns =
+        InitMergedEntry(merged, time_series, pair.first, x_values);
+    auto& mdata = merged->data_[pair.first];
+
+#pragma omp parallel
+    {
+      std::vector<real_t> all_y_values(columns.size());
+#pragma omp for
+      for (uint64_t i = 0; i < x_values.size(); ++i) {
+        for (uint64_t j = 0; j < columns.size(); ++j) {
+          all_y_values[j] = columns[j][i];
+        }
         merger(all_y_values, &mdata.y_values[i], &mdata.y_error_low[i],
                &mdata.y_error_high[i]);
       }
@@ -220,28 +281,261 @@ void TimeSeries::Merge(
   }
 }
 
+namespace {
+
+/// Number of data points that are processed together by the built-in
+/// reducers.
+constexpr uint64_t kMergeBlockSize = 64;
+
+/// Returns the `q`-quantile of `values`. Interpolates linearly between the
+/// closest ranks. Reorders `values`.
+real_t Quantile(real_t* values, uint64_t size, real_t q) {
+  real_t h = (size - 1) * q;
+  auto lo = static_cast<uint64_t>(h);
+  std::nth_element(values, values + lo, values + size);
+  real_t result = values[lo];
+  if (lo + 1 < size && h > lo) {
+    auto next = *std::min_element(values + lo + 1, values + size);
+    result += (h - lo) * (next - result);
+  }
+  return result;
+}
+
+/// Computes the mean and the sample standard deviation of each data point.
+/// Iterates over whole columns for each block of data points to benefit from
+/// vectorization.
+void MergeMeanStd(const std::vector<const real_t*>& columns,
+                  uint64_t num_points, bool compute_std, real_t* y,
+                  real_t* error_low, real_t* error_high) {
+  real_t n = columns.size();
+  uint64_t num_blocks = (num_points + kMergeBlockSize - 1) / kMergeBlockSize;
+#pragma omp parallel for
+  for (uint64_t b = 0; b < num_blocks; ++b) {
+    uint64_t start = b * kMergeBlockSize;
+    uint64_t len = std::min(kMergeBlockSize, num_points - start);
+    auto* mean = y + start;
+    auto* var = error_low + start;
+    std::fill(mean, mean + len, 0);
+    std::fill(var, var + len, 0);
+
+    for (auto* column : columns) {
+      auto* values = column + start;
+#pragma omp simd
+      for (uint64_t i = 0; i < len; ++i) {
+        mean[i] += values[i];
+      }
+    }
+    for (uint64_t i = 0; i < len; ++i) {
+      mean[i] /= n;
+    }
+
+    if (compute_std) {
+      for (auto* column : columns) {
+        auto* values = column + start;
+#pragma omp simd
+        for (uint64_t i = 0; i < len; ++i) {
+          auto diff = values[i] - mean[i];
+          var[i] += diff * diff;
+        }
+      }
+      for (uint64_t i = 0; i < len; ++i) {
+        var[i] = std::sqrt(var[i] / (n - 1));
+      }
+    }
+    std::copy(var, var + len, error_high + start);
+  }
+}
+
+/// Computes the median and the distance to the given quantiles (or to the
+/// minimum and maximum) of each data point.
+void MergeMedian(const std::vector<const real_t*>& columns,
+                 uint64_t num_points, bool quantiles, real_t lower_quantile,
+                 real_t upper_quantile, real_t* y, real_t* error_low,
+                 real_t* error_high) {
+  uint64_t n = columns.size();
+  uint64_t num_blocks = (num_points + kMergeBlockSize - 1) / kMergeBlockSize;
+#pragma omp parallel
+  {
+    // Row i contains the values of data point i of the current block.
+    std::vector<real_t> block(kMergeBlockSize * n);
+#pragma omp for
+    for (uint64_t b = 0; b < num_blocks; ++b) {
+      uint64_t start = b * kMergeBlockSize;
+      uint64_t len = std::min(kMergeBlockSize, num_points - start);
+      for (uint64_t j = 0; j < n; ++j) {
+        auto* values = columns[j] + start;
+        for (uint64_t i = 0; i < len; ++i) {
+          block[i * n + j] = values[i];
+        }
+      }
+
+      for (uint64_t i = 0; i < len; ++i) {
+        auto* values = block.data() + i * n;
+        real_t median = Quantile(values, n, 0.5);
+        real_t low, high;
+        if (quantiles) {
+          low = Quantile(values, n, lower_quantile);
+          high = Quantile(values, n, upper_quantile);
+        } else {
+          auto minmax = std::minmax_element(values, values + n);
+          low = *minmax.first;
+          high = *minmax.second;
+        }
+        y[start + i] = median;
+        error_low[start + i] = median - low;
+        error_high[start + i] = high - median;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+void TimeSeries::Merge(TimeSeries* merged,
+                       const std::vector<TimeSeries>& time_series,
+                       MergeReducer reducer, real_t lower_quantile,
+                       real_t upper_quantile) {
+  if (lower_quantile < 0 || lower_quantile > upper_quantile ||
+      upper_quantile > 1) {
+    Log::Warning("TimeSeries::Merge",
+                 "The quantiles must satisfy 0 <= lower_quantile <= "
+                 "upper_quantile <= 1. Operation aborted.");
+    return;
+  }
+  if (!PrepareMerge(merged, time_series)) {
+    return;
+  }
+
+  for (auto& pair : time_series[0].data_) {
+    auto& x_values = pair.second.x_values;
+    auto columns =
+        InitMergedEntry(merged, time_series, pair.first, x_values);
+    auto& mdata = merged->data_[pair.first];
+    auto* y = mdata.y_values.data();
+    auto* error_low = mdata.y_error_low.data();
+    auto* error_high = mdata.y_error_high.data();
+
+    switch (reducer) {
+      case MergeReducer::kMean:
+      case MergeReducer::kMeanStd:
+        MergeMeanStd(columns, x_values.size(),
+                     reducer == MergeReducer::kMeanStd, y, error_low,
+                     error_high);
+        break;
+      case MergeReducer::kMedianQuantiles:
+      case MergeReducer::kMedianMinMax:
+        MergeMedian(columns, x_values.size(),
+                    reducer == MergeReducer::kMedianQuantiles, lower_quantile,
+                    upper_quantile, y, error_low, error_high);
+        break;
+    }
+  }
+}
+
 // -----------------------------------------------------------------------------
 TimeSeries::TimeSeries() = default;
 
 // -----------------------------------------------------------------------------
-TimeSeries::TimeSeries(const TimeSeries& other) : data_(other.data_) {}
+TimeSeries::TimeSeries(const TimeSeries& other)
+    : data_(other.data_), max_points_in_memory_(other.max_points_in_memory_) {}
 
 // -----------------------------------------------------------------------------
 TimeSeries::TimeSeries(TimeSeries&& other) noexcept
-    : data_(std::move(other.data_)) {}
+    : data_(std::move(other.data_)),
+      writer_(other.writer_),
+      pending_(std::move(other.pending_)),
+      pending_updates_(other.pending_updates_),
+      batch_size_(other.batch_size_),
+      max_points_in_memory_(other.max_points_in_memory_) {
+  other.writer_ = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+TimeSeries::~TimeSeries() {
+  if (writer_) {
+    writer_->Append(std::move(pending_));
+    delete writer_;
+  }
+}
 
 // -----------------------------------------------------------------------------
 TimeSeries& TimeSeries::operator=(TimeSeries&& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  if (writer_) {
+    writer_->Append(std::move(pending_));
+    delete writer_;
+  }
   data_ = std::move(other.data_);
+  writer_ = other.writer_;
+  other.writer_ = nullptr;
+  pending_ = std::move(other.pending_);
+  pending_updates_ = other.pending_updates_;
+  batch_size_ = other.batch_size_;
+  max_points_in_memory_ = other.max_points_in_memory_;
   return *this;
 }
 
 // -----------------------------------------------------------------------------
 TimeSeries& TimeSeries::operator=(const TimeSeries& other) {
+  // The sink is not copied. Thus, data points are not written twice.
   data_ = other.data_;
+  max_points_in_memory_ = other.max_points_in_memory_;
   return *this;
 }
 
+// -----------------------------------------------------------------------------
+void TimeSeries::StreamTo(TimeSeriesSink* sink, uint64_t batch_size) {
+  if (writer_) {
+    writer_->Append(std::move(pending_));
+    delete writer_;
+  }
+  pending_.clear();
+  pending_updates_ = 0;
+  batch_size_ = std::max(batch_size, uint64_t{1});
+  writer_ = new TimeSeriesStreamWriter(sink);
+}
+
+// -----------------------------------------------------------------------------
+void TimeSeries::FlushStream() {
+  if (writer_) {
+    writer_->Append(std::move(pending_));
+    pending_.clear();
+    pending_updates_ = 0;
+    writer_->Flush();
+  }
+}
+
+// -----------------------------------------------------------------------------
+void TimeSeries::SetMaxPointsInMemory(uint64_t max_points) {
+  max_points_in_memory_ = max_points;
+  DiscardOldPoints();
+}
+
+// -----------------------------------------------------------------------------
+void TimeSeries::DiscardOldPoints() {
+  if (max_points_in_memory_ == 0) {
+    return;
+  }
+  auto discard = [&](std::vector<real_t>* values) {
+    if (values->size() > max_points_in_memory_) {
+      values->erase(values->begin(), values->end() - max_points_in_memory_);
+    }
+  };
+  for (auto& entry : data_) {
+    auto& data = entry.second;
+    if (data.ycollector == nullptr && data.y_reducer_collector == nullptr) {
+      continue;
+    }
+    discard(&data.x_values);
+    discard(&data.y_values);
+    discard(&data.y_error_low);
+    discard(&data.y_error_high);
+  }
+}
+
 // -----------------------------------------------------------------------------
 void TimeSeries::AddCollector(const std::string& id,
                               real_t (*ycollector)(Simulation*),
@@ -317,6 +611,25 @@ void TimeSeries::Update() {
         result_data.x_values.push_back(result_data.xcollector(sim));
       }
     }
+
+    // Stream the new data points
+    if (writer_) {
+      for (auto& entry : data_) {
+        auto& result_data = entry.second;
+        if (result_data.ycollector == nullptr &&
+            result_data.y_reducer_collector == nullptr) {
+          continue;
+        }
+        pending_.push_back({entry.first, result_data.x_values.back(),
+                            result_data.y_values.back()});
+      }
+      if (++pending_updates_ >= batch_size_) {
+        writer_->Append(std::move(pending_));
+        pending_.clear();
+        pending_updates_ = 0;
+      }
+    }
+    DiscardOldPoints();
   }
 }
 
@@ -443,5 +756,50 @@ void TimeSeries::SaveJson(const std::string& full_filepath) const {
   TBufferJSON::ExportToFile(full_filepath.c_str(), this, Class());
 }
 
+// -----------------------------------------------------------------------------
+void TimeSeries::WriteBinary(BinaryWriter* writer,
+                             const std::vector<std::string>& ids) const {
+  auto write_entry = [&](const std::string& id, const Data& data) {
+    writer->Write(id, data.x_values, data.y_values, data.y_error_low,
+                  data.y_error_high);
+  };
+  writer->WriteVersion(1);
+  if (ids.empty()) {
+    writer->Write(static_cast<uint64_t>(data_.size()));
+    for (auto& el : data_) {
+      write_entry(el.first, el.second);
+    }
+    return;
+  }
+
+  std::vector<const std::string*> found;
+  for (auto& id : ids) {
+    if (data_.find(id) != data_.end()) {
+      found.push_back(&id);
+    } else {
+      Log::Warning("TimeSeries::WriteBinary", "TimeSeries with id (", id,
+                   ") does not exist.");
+    }
+  }
+  writer->Write(static_cast<uint64_t>(found.size()));
+  for (auto* id : found) {
+    write_entry(*id, data_.at(*id));
+  }
+}
+
+// -----------------------------------------------------------------------------
+void TimeSeries::ReadBinary(BinaryReader* reader) {
+  reader->ReadVersion(1, "TimeSeries");
+  uint64_t size;
+  reader->Read(size);
+  for (uint64_t i = 0; i < size; ++i) {
+    std::string id;
+    reader->Read(id);
+    auto& data = data_[id];
+    reader->Read(data.x_values, data.y_values, data.y_error_low,
+                 data.y_error_high);
+  }
+}
+
 }  // namespace experimental
 }  // namespace bdm
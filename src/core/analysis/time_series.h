@@ -18,8 +18,10 @@
 #include <unordered_map>
 #include <vector>
 #include "core/analysis/reduce.h"
+#include "core/analysis/time_series_sink.h"
 #include "core/real_t.h"
 #include "core/util/root.h"
+#include "core/util/serialization.h"
 
 namespace bdm {
 
@@ -52,6 +54,21 @@ class TimeSeries {
     BDM_CLASS_DEF_NV(Data, 1);
   };
 
+  /// Built-in reducers for `Merge`. They combine the y values of all time
+  /// series at one x value into the y value and the error bars of the merged
+  /// time series.
+  enum class MergeReducer {
+    /// y = mean; no error bars
+    kMean,
+    /// y = mean; error_low = error_high = sample standard deviation
+    kMeanStd,
+    /// y = median; error_low = median - lower quantile;
+    /// error_high = upper quantile - median
+    kMedianQuantiles,
+    /// y = median; error_low = median - minimum; error_high = maximum - median
+    kMedianMinMax
+  };
+
   /// Restore a saved TimeSeries object.
   /// Usage example:
   /// \code
@@ -97,12 +114,28 @@ class TimeSeries {
       const std::function<void(const std::vector<real_t>&, real_t*, real_t*,
                                real_t*)>& merger);
 
+  /// Same as the overload above, but combines the data points with a
+  /// built-in `reducer`. This version does not allocate memory per data
+  /// point and processes the data points of each entry in parallel. It is
+  /// therefore much faster for large ensembles.\n
+  /// `lower_quantile` and `upper_quantile` are only used by
+  /// `MergeReducer::kMedianQuantiles`. Quantiles are linearly interpolated
+  /// between the closest ranks (e.g. the median of {1, 2, 3, 4} is 2.5).
+  /// \code
+  /// TimeSeries::Merge(&merged, tss, TimeSeries::MergeReducer::kMeanStd);
+  /// \endcode
+  static void Merge(TimeSeries* merged,
+                    const std::vector<TimeSeries>& time_series,
+                    MergeReducer reducer, real_t lower_quantile = 0.25,
+                    real_t upper_quantile = 0.75);
+
   /// Computes the mean squared error between `ts1` and `ts2`
   static real_t ComputeError(const TimeSeries& ts1, const TimeSeries& ts2);
 
   TimeSeries();
   TimeSeries(const TimeSeries& other);
   TimeSeries(TimeSeries&& other) noexcept;
+  ~TimeSeries();
 
   TimeSeries& operator=(TimeSeries&& other) noexcept;
   TimeSeries& operator=(const TimeSeries& other);
@@ -177,6 +210,31 @@ class TimeSeries {
   /// Adds a new data point to all time series with a collector.
   void Update();
 
+  /// Streams all data points which are collected during `Update` to `sink`.
+  /// This object takes ownership of `sink`.
+  /// Data points are handed over in batches of `batch_size` iterations and
+  /// are written on a background thread. In combination with
+  /// `SetMaxPointsInMemory`, the memory consumption of long simulations
+  /// stays bounded, and the data collected so far survives a crash.
+  /// \code
+  /// auto* ts = simulation.GetTimeSeries();
+  /// ts->StreamTo(new CsvTimeSeriesSink("output/time-series.csv"));
+  /// ts->SetMaxPointsInMemory(1000);
+  /// \endcode
+  /// \see Param::time_series_stream_file
+  void StreamTo(TimeSeriesSink* sink, uint64_t batch_size = 100);
+
+  /// Hands over buffered data points to the sink and blocks until they have
+  /// been written.
+  void FlushStream();
+
+  /// Keep only the last `max_points` data points of each entry with a
+  /// collector in memory. Older data points are discarded after they have
+  /// been passed to the sink (see `StreamTo`).
+  /// Default value: `0` (keep all data points)\n
+  /// Entries that have been added with `Add` are not affected.
+  void SetMaxPointsInMemory(uint64_t max_points);
+
   /// Returns whether a times series with given id exists in this object.
   bool Contains(const std::string& id) const;
   uint64_t Size() const;
@@ -194,8 +252,41 @@ class TimeSeries {
   /// Saves a json representation to disk
   void SaveJson(const std::string& full_filepath) const;
 
+  /// Writes the data arrays of the entries in `ids`, or of all entries if
+  /// `ids` is empty, with the binary serialization layer. Collectors are not
+  /// written. Much faster than ROOT I/O, e.g. to send results between
+  /// processes.
+  void WriteBinary(BinaryWriter* writer,
+                   const std::vector<std::string>& ids = {}) const;
+
+  /// Adds the entries that have been written with `WriteBinary`.
+  void ReadBinary(BinaryReader* reader);
+
  private:
   std::unordered_map<std::string, Data> data_;
+  /// Writes collected data points to the sink on a background thread.
+  TimeSeriesStreamWriter* writer_ = nullptr;  //!
+  /// Data points which have not been handed over to `writer_` yet.
+  std::vector<TimeSeriesPoint> pending_;  //!
+  uint64_t pending_updates_ = 0;          //!
+  uint64_t batch_size_ = 100;             //!
+  uint64_t max_points_in_memory_ = 0;     //!
+
+  /// Discards old data points of entries with a collector.
+  /// \see SetMaxPointsInMemory
+  void DiscardOldPoints();
+
+  /// Checks the preconditions of `Merge`. Returns false if there is nothing
+  /// left to merge.
+  static bool PrepareMerge(TimeSeries* merged,
+                           const std::vector<TimeSeries>& time_series);
+
+  /// Adds an entry with the given x values to `merged` and returns the
+  /// y values of this entry of all `time_series`. Element i of the result
+  /// points to the y values of `time_series[i]`.
+  static std::vector<const real_t*> InitMergedEntry(
+      TimeSeries* merged, const std::vector<TimeSeries>& time_series,
+      const std::string& id, const std::vector<real_t>& x_values);
 
   BDM_CLASS_DEF_NV(TimeSeries, 1);
 };
@@ -0,0 +1,173 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/analysis/time_series_sink.h"
+#include <cstring>
+#include <limits>
+#include "core/util/log.h"
+
+namespace bdm {
+namespace experimental {
+
+// -----------------------------------------------------------------------------
+std::vector<char> TimeSeriesSink::Pack(
+    const std::vector<TimeSeriesPoint>& batch) {
+  uint64_t size = 0;
+  for (auto& point : batch) {
+    size += sizeof(uint16_t) + point.id.size() + 2 * sizeof(real_t);
+  }
+  std::vector<char> buffer(size);
+  char* pos = buffer.data();
+  for (auto& point : batch) {
+    if (point.id.size() > std::numeric_limits<uint16_t>::max()) {
+      Log::Fatal("TimeSeriesSink::Pack", "TimeSeries id '", point.id,
+                 "' is too long.");
+    }
+    uint16_t length = point.id.size();
+    std::memcpy(pos, &length, sizeof(uint16_t));
+    pos += sizeof(uint16_t);
+    std::memcpy(pos, point.id.data(), length);
+    pos += length;
+    std::memcpy(pos, &point.x, sizeof(real_t));
+    pos += sizeof(real_t);
+    std::memcpy(pos, &point.y, sizeof(real_t));
+    pos += sizeof(real_t);
+  }
+  return buffer;
+}
+
+// -----------------------------------------------------------------------------
+std::vector<TimeSeriesPoint> TimeSeriesSink::Unpack(const char* buffer,
+                                                    uint64_t size) {
+  std::vector<TimeSeriesPoint> batch;
+  const char* pos = buffer;
+  const char* end = buffer + size;
+  while (pos < end) {
+    TimeSeriesPoint point;
+    uint16_t length;
+    std::memcpy(&length, pos, sizeof(uint16_t));
+    pos += sizeof(uint16_t);
+    point.id.assign(pos, length);
+    pos += length;
+    std::memcpy(&point.x, pos, sizeof(real_t));
+    pos += sizeof(real_t);
+    std::memcpy(&point.y, pos, sizeof(real_t));
+    pos += sizeof(real_t);
+    batch.push_back(std::move(point));
+  }
+  return batch;
+}
+
+// -----------------------------------------------------------------------------
+static std::function<TimeSeriesSink*()>& SinkFactory() {
+  static std::function<TimeSeriesSink*()> factory;
+  return factory;
+}
+
+// -----------------------------------------------------------------------------
+void TimeSeriesSink::SetFactory(
+    const std::function<TimeSeriesSink*()>& factory) {
+  SinkFactory() = factory;
+}
+
+// -----------------------------------------------------------------------------
+const std::function<TimeSeriesSink*()>& TimeSeriesSink::GetFactory() {
+  return SinkFactory();
+}
+
+// -----------------------------------------------------------------------------
+CsvTimeSeriesSink::CsvTimeSeriesSink(const std::string& filepath)
+    : file_(filepath, std::ios::out | std::ios::app) {
+  if (!file_.is_open()) {
+    Log::Fatal("CsvTimeSeriesSink", "Could not open file ", filepath);
+  }
+  file_.precision(std::numeric_limits<real_t>::max_digits10);
+  // A restored simulation continues to write to the file of the original
+  // run. Only new or empty files get a header.
+  file_.seekp(0, std::ios::end);
+  if (file_.tellp() == 0) {
+    file_ << "id,x,y\n";
+  }
+}
+
+// -----------------------------------------------------------------------------
+CsvTimeSeriesSink::~CsvTimeSeriesSink() { file_.close(); }
+
+// -----------------------------------------------------------------------------
+void CsvTimeSeriesSink::Write(const std::vector<TimeSeriesPoint>& batch) {
+  for (auto& point : batch) {
+    file_ << point.id << ',' << point.x << ',' << point.y << '\n';
+  }
+}
+
+// -----------------------------------------------------------------------------
+void CsvTimeSeriesSink::Flush() { file_.flush(); }
+
+// -----------------------------------------------------------------------------
+TimeSeriesStreamWriter::TimeSeriesStreamWriter(TimeSeriesSink* sink)
+    : sink_(sink), thread_([this]() { Run(); }) {}
+
+// -----------------------------------------------------------------------------
+TimeSeriesStreamWriter::~TimeSeriesStreamWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+  sink_->Flush();
+  delete sink_;
+}
+
+// -----------------------------------------------------------------------------
+void TimeSeriesStreamWriter::Append(std::vector<TimeSeriesPoint>&& batch) {
+  if (batch.empty()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(batch));
+  }
+  cv_.notify_all();
+}
+
+// -----------------------------------------------------------------------------
+void TimeSeriesStreamWriter::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this]() { return queue_.empty() && in_flight_ == 0; });
+  sink_->Flush();
+}
+
+// -----------------------------------------------------------------------------
+void TimeSeriesStreamWriter::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      // stop_ is set and all batches have been written
+      return;
+    }
+    auto batch = std::move(queue_.front());
+    queue_.pop_front();
+    in_flight_++;
+    lock.unlock();
+    sink_->Write(batch);
+    lock.lock();
+    in_flight_--;
+    cv_.notify_all();
+  }
+}
+
+}  // namespace experimental
+}  // namespace bdm
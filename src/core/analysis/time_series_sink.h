@@ -0,0 +1,117 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+#ifndef CORE_ANALYSIS_TIME_SERIES_SINK_H_
+#define CORE_ANALYSIS_TIME_SERIES_SINK_H_
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/real_t.h"
+
+namespace bdm {
+namespace experimental {
+
+/// A single data point of a time series entry.
+struct TimeSeriesPoint {
+  std::string id;
+  real_t x;
+  real_t y;
+};
+
+/// Destination of the data points which are collected by a `TimeSeries`
+/// during a simulation. \see TimeSeries::StreamTo
+class TimeSeriesSink {
+ public:
+  virtual ~TimeSeriesSink() = default;
+
+  /// Writes a batch of data points.
+  /// Is called from a background thread (see `TimeSeriesStreamWriter`).
+  virtual void Write(const std::vector<TimeSeriesPoint>& batch) = 0;
+
+  /// Makes sure that all written data points reached their destination.
+  virtual void Flush() {}
+
+  /// Encodes `batch` in a compact binary format.\n
+  /// For each point: id length (uint16_t), id characters, x and y value.
+  static std::vector<char> Pack(const std::vector<TimeSeriesPoint>& batch);
+
+  /// Decodes a buffer created by `Pack`.
+  static std::vector<TimeSeriesPoint> Unpack(const char* buffer,
+                                             uint64_t size);
+
+  /// Sets a function that creates the sink for the TimeSeries of each new
+  /// simulation. Takes precedence over `Param::time_series_stream_file`.
+  /// Multi-simulation workers use it to stream partial results to the
+  /// manager. Pass an empty function to unset it.
+  static void SetFactory(const std::function<TimeSeriesSink*()>& factory);
+
+  /// Returns the function set with `SetFactory`.
+  static const std::function<TimeSeriesSink*()>& GetFactory();
+};
+
+/// Appends data points to a CSV file with the columns `id,x,y`.
+/// An existing file is not truncated and the header is only written if the
+/// file is new or empty.
+class CsvTimeSeriesSink : public TimeSeriesSink {
+ public:
+  explicit CsvTimeSeriesSink(const std::string& filepath);
+  ~CsvTimeSeriesSink() override;
+
+  void Write(const std::vector<TimeSeriesPoint>& batch) override;
+  void Flush() override;
+
+ private:
+  std::ofstream file_;
+};
+
+/// Forwards batches of data points to a `TimeSeriesSink` on a background
+/// thread. Thus, the simulation does not have to wait for I/O.
+class TimeSeriesStreamWriter {
+ public:
+  /// Takes ownership of `sink`.
+  explicit TimeSeriesStreamWriter(TimeSeriesSink* sink);
+  ~TimeSeriesStreamWriter();
+
+  TimeSeriesStreamWriter(const TimeSeriesStreamWriter&) = delete;
+  TimeSeriesStreamWriter& operator=(const TimeSeriesStreamWriter&) = delete;
+
+  /// Enqueues `batch` and returns immediately.
+  void Append(std::vector<TimeSeriesPoint>&& batch);
+
+  /// Blocks until all enqueued batches have been written and flushed.
+  void Flush();
+
+ private:
+  TimeSeriesSink* sink_;
+  std::deque<std::vector<TimeSeriesPoint>> queue_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  /// Number of batches that have been dequeued, but not written yet.
+  uint64_t in_flight_ = 0;
+  bool stop_ = false;
+  std::thread thread_;
+
+  void Run();
+};
+
+}  // namespace experimental
+}  // namespace bdm
+
+#endif  // CORE_ANALYSIS_TIME_SERIES_SINK_H_
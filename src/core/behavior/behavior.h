@@ -18,6 +18,7 @@
 #include <limits>
 #include "core/agent/agent.h"
 #include "core/agent/new_agent_event.h"
+#include "core/util/serialization.h"
 #include "core/util/type.h"
 
 namespace bdm {
@@ -30,6 +31,27 @@ class Behavior {
  public:
   Behavior() : copy_mask_(0), remove_mask_(0) {}
 
+  /// Copies of a shared behavior are not shared.
+  Behavior(const Behavior& other)
+      : copy_mask_(other.copy_mask_), remove_mask_(other.remove_mask_) {}
+
+  Behavior(Behavior&& other) noexcept
+      : copy_mask_(other.copy_mask_), remove_mask_(other.remove_mask_) {}
+
+  /// The shared state is not assigned, because it determines who owns this
+  /// instance (see `Behavior::Share`).
+  Behavior& operator=(const Behavior& other) {
+    copy_mask_ = other.copy_mask_;
+    remove_mask_ = other.remove_mask_;
+    return *this;
+  }
+
+  Behavior& operator=(Behavior&& other) noexcept {
+    copy_mask_ = other.copy_mask_;
+    remove_mask_ = other.remove_mask_;
+    return *this;
+  }
+
   virtual ~Behavior() = default;
 
   /// Create a new instance of this object using the default constructor.
@@ -38,6 +60,25 @@ class Behavior {
   /// Create a new copy of this behavior.
   virtual Behavior* NewCopy() const = 0;
 
+  // ---------------------------------------------------------------------------
+  // Binary serialization (see `BDM_SERIALIZE`)
+  using BinaryRoot = Behavior;
+
+  /// Returns nullptr if the most derived class of this behavior has not been
+  /// declared with `BDM_SERIALIZE`. Such behaviors are written with ROOT.
+  virtual const BinaryTypeInfo* GetBinaryType() const { return nullptr; }
+
+  virtual void WriteBinary(BinaryWriter* writer) const {
+    writer->WriteVersion(1);
+    writer->Write(copy_mask_, remove_mask_, shared_);
+  }
+
+  virtual void ReadBinary(BinaryReader* reader) {
+    reader->ReadVersion(1, "Behavior");
+    reader->Read(copy_mask_, remove_mask_, shared_);
+  }
+  // ---------------------------------------------------------------------------
+
   /// This method is called to initialize new behaviors that are created
   /// during a NewAgentEvent. Override this method to initialize attributes of
   /// your own Behavior subclasses.
@@ -59,6 +100,42 @@ class Behavior {
 
   virtual void Run(Agent* agent) = 0;
 
+  /// Same as `Run(Agent*)`, but with the state of the current iteration for
+  /// the calling thread (e.g. `ctxt.random`, `ctxt.dt`). This function is
+  /// called by the scheduler. The default implementation ignores `ctxt`.
+  /// Behaviors that override it can implement `Run(Agent*)` as follows:
+  /// \code
+  /// void Run(Agent* agent) override {
+  ///   auto* scheduler = Simulation::GetActive()->GetScheduler();
+  ///   Run(agent, scheduler->GetIterationContext());
+  /// }
+  /// \endcode
+  virtual void Run(Agent* agent, const IterationContext& ctxt) { Run(agent); }
+
+  /// Marks this behavior as shared (flyweight). A shared behavior is stored
+  /// only once and referenced by all agents it has been added to. It is not
+  /// copied if an agent is copied (e.g. during load balancing) or if it is
+  /// passed on to a new agent (e.g. during cell division). Therefore, it must
+  /// not contain per-agent state, and `Initialize` and `Update` are not
+  /// called for shared behaviors. An agent that wants to modify a shared
+  /// behavior must first obtain its own copy with `Agent::UnshareBehavior`
+  /// (copy-on-write).\n
+  /// The ResourceManager takes over the ownership of shared behaviors.
+  /// Therefore, this function must only be called for heap objects. \n
+  /// \code
+  /// auto* secretion = new Secretion("substance");
+  /// secretion->AlwaysCopyToNew();
+  /// secretion->Share();
+  /// for (auto* cell : cells) {
+  ///   cell->AddBehavior(secretion);
+  /// }
+  /// \endcode
+  void Share();
+
+  /// Returns true if this behavior is shared between agents.
+  /// \see `Behavior::Share`
+  bool IsShared() const { return shared_; }
+
   /// Always copy this behavior to new agents
   void AlwaysCopyToNew() {
     copy_mask_ = std::numeric_limits<NewAgentEventUid>::max();
@@ -123,7 +200,9 @@ class Behavior {
  private:
   NewAgentEventUid copy_mask_ = 0;
   NewAgentEventUid remove_mask_ = 0;
-  BDM_CLASS_DEF(Behavior, 2);
+  /// \see `Behavior::Share`
+  bool shared_ = false;
+  BDM_CLASS_DEF(Behavior, 3);
 };
 
 /// Inserts boilerplate code for behaviors with state
@@ -25,6 +25,7 @@ namespace bdm {
 /// Move cells along the diffusion gradient (from low concentration to high)
 class Chemotaxis : public Behavior {
   BDM_BEHAVIOR_HEADER(Chemotaxis, Behavior, 1);
+  BDM_SERIALIZE(Chemotaxis, 1, substance_, dgrid_, speed_);
 
  public:
   Chemotaxis() = default;
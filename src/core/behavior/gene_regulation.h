@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "core/behavior/behavior.h"
+#include "core/iteration_context.h"
 #include "core/param/param.h"
 #include "core/scheduler.h"
 #include "core/simulation.h"
@@ -75,11 +76,25 @@ class GeneRegulation : public Behavior {
   /// methods for solving ODE.
   void Run(Agent* agent) override {
     auto* sim = Simulation::GetActive();
-    auto* param = sim->GetParam();
-    auto* scheduler = sim->GetScheduler();
+    Solve(sim->GetParam(), sim->GetScheduler()->GetSimulatedSteps());
+  }
+
+  void Run(Agent* agent, const IterationContext& ctxt) override {
+    Solve(ctxt.param, ctxt.step);
+  }
 
+ private:
+  /// Store the current concentration for each gene
+  std::vector<real_t> concentrations_ = {};
+
+  /// Store the gene differential equations, which define how the concentration
+  /// change.
+  /// New functions can be added through method AddGene()
+  std::vector<std::function<real_t(real_t, real_t)>> first_derivatives_ = {};
+
+  /// Advances the concentrations by one time step.
+  void Solve(const Param* param, uint64_t simulated_steps) {
     const auto& timestep = param->simulation_time_step;
-    uint64_t simulated_steps = scheduler->GetSimulatedSteps();
     const auto absolute_time = simulated_steps * timestep;
 
     if (param->numerical_ode_solver == Param::NumericalODESolver::kEuler) {
@@ -106,15 +121,6 @@ class GeneRegulation : public Behavior {
       }
     }
   }
-
- private:
-  /// Store the current concentration for each gene
-  std::vector<real_t> concentrations_ = {};
-
-  /// Store the gene differential equations, which define how the concentration
-  /// change.
-  /// New functions can be added through method AddGene()
-  std::vector<std::function<real_t(real_t, real_t)>> first_derivatives_ = {};
 };
 
 }  // namespace bdm
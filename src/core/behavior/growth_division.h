@@ -27,6 +27,7 @@ namespace bdm {
 /// the specified threshold and divides the object afterwards.
 class GrowthDivision : public Behavior {
   BDM_BEHAVIOR_HEADER(GrowthDivision, Behavior, 1);
+  BDM_SERIALIZE(GrowthDivision, 1, threshold_, growth_rate_);
 
  public:
   GrowthDivision() { AlwaysCopyToNew(); }
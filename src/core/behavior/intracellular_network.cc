@@ -0,0 +1,292 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/behavior/intracellular_network.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "core/operation/intracellular_network_op.h"
+#include "core/param/param.h"
+#include "core/scheduler.h"
+#include "core/simulation.h"
+#include "core/util/log.h"
+
+namespace bdm {
+
+constexpr uint64_t IntracellularNetwork::kBlockSize;
+
+// -----------------------------------------------------------------------------
+void IntracellularModel::IntegrateBatch(const Param* param, real_t time,
+                                        real_t dt, real_t* amounts,
+                                        const char* active,
+                                        uint64_t num_agents) const {
+  auto num_species = GetNumSpecies();
+  for (uint64_t i = 0; i < num_agents; ++i) {
+    if (active[i]) {
+      Integrate(param, time, dt, amounts + i * num_species);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+size_t IntracellularModel::GetSpeciesIndex(const std::string& name) const {
+  const auto& names = GetSpeciesNames();
+  auto it = std::find(names.begin(), names.end(), name);
+  if (it == names.end()) {
+    Log::Fatal("IntracellularModel::GetSpeciesIndex", "Species ", name,
+               " does not exist.");
+  }
+  return static_cast<size_t>(it - names.begin());
+}
+
+// -----------------------------------------------------------------------------
+OdeModel::OdeModel(const std::vector<std::string>& species_names,
+                   const std::vector<real_t>& initial_amounts,
+                   const Derivatives& derivatives)
+    : species_names_(species_names),
+      initial_amounts_(initial_amounts),
+      derivatives_(derivatives) {
+  if (species_names_.size() != initial_amounts_.size()) {
+    Log::Fatal("OdeModel::OdeModel",
+               "The number of species names and initial amounts differ.");
+  }
+}
+
+// -----------------------------------------------------------------------------
+void OdeModel::Integrate(const Param* param, real_t time, real_t dt,
+                         real_t* amounts) const {
+  auto n = species_names_.size();
+  // scratch buffers are reused across agents
+  thread_local std::vector<real_t> k1;
+  thread_local std::vector<real_t> k2;
+  thread_local std::vector<real_t> k3;
+  thread_local std::vector<real_t> k4;
+  thread_local std::vector<real_t> tmp;
+  k1.resize(n);
+
+  auto solver = param->numerical_ode_solver;
+  if (solver == Param::NumericalODESolver::kEuler) {
+    derivatives_(time, amounts, k1.data());
+    for (size_t i = 0; i < n; ++i) {
+      amounts[i] += dt * k1[i];
+    }
+  } else if (solver == Param::NumericalODESolver::kRK4) {
+    k2.resize(n);
+    k3.resize(n);
+    k4.resize(n);
+    tmp.resize(n);
+    derivatives_(time, amounts, k1.data());
+    for (size_t i = 0; i < n; ++i) {
+      tmp[i] = amounts[i] + dt * k1[i] / 2.0;
+    }
+    derivatives_(time + dt / 2.0, tmp.data(), k2.data());
+    for (size_t i = 0; i < n; ++i) {
+      tmp[i] = amounts[i] + dt * k2[i] / 2.0;
+    }
+    derivatives_(time + dt / 2.0, tmp.data(), k3.data());
+    for (size_t i = 0; i < n; ++i) {
+      tmp[i] = amounts[i] + dt * k3[i];
+    }
+    derivatives_(time + dt, tmp.data(), k4.data());
+    for (size_t i = 0; i < n; ++i) {
+      amounts[i] += dt / 6.0 * (k1[i] + 2 * k2[i] + 2 * k3[i] + k4[i]);
+    }
+  } else {
+    Log::Fatal("OdeModel::Integrate", "Unknown numerical ODE solver (",
+               static_cast<int>(solver), ").");
+  }
+}
+
+// -----------------------------------------------------------------------------
+std::shared_ptr<IntracellularNetwork> IntracellularNetwork::Create(
+    const std::shared_ptr<IntracellularModel>& model) {
+  auto network = std::make_shared<IntracellularNetwork>(model);
+  auto* scheduler = Simulation::GetActive()->GetScheduler();
+  auto ops = scheduler->GetOps("intracellular network");
+  Operation* op = nullptr;
+  if (ops.empty()) {
+    op = NewOperation("intracellular network");
+    scheduler->ScheduleOp(op, OpType::kPreSchedule);
+  } else {
+    op = ops[0];
+  }
+  op->GetImplementation<IntracellularNetworkOp>()->AddNetwork(network);
+  return network;
+}
+
+// -----------------------------------------------------------------------------
+IntracellularNetwork::IntracellularNetwork(
+    const std::shared_ptr<IntracellularModel>& model)
+    : model_(model),
+      num_species_(model->GetNumSpecies()),
+      initial_amounts_(model->GetInitialAmounts()) {
+  if (initial_amounts_.size() != num_species_) {
+    Log::Fatal("IntracellularNetwork::IntracellularNetwork",
+               "The number of species and initial amounts differ.");
+  }
+}
+
+// -----------------------------------------------------------------------------
+real_t* IntracellularNetwork::Allocate(const real_t* amounts, uint64_t* slot) {
+  real_t* ptr = nullptr;
+  {
+    std::lock_guard<Spinlock> guard(lock_);
+    if (!free_slots_.empty()) {
+      *slot = free_slots_.back();
+      free_slots_.pop_back();
+    } else {
+      if (num_slots_ % kBlockSize == 0) {
+        blocks_.emplace_back(new real_t[kBlockSize * num_species_]);
+        active_.emplace_back(new char[kBlockSize]());
+      }
+      *slot = num_slots_++;
+    }
+    active_[*slot / kBlockSize][*slot % kBlockSize] = 1;
+    num_agents_++;
+    ptr = blocks_[*slot / kBlockSize].get() +
+          (*slot % kBlockSize) * num_species_;
+  }
+  // The memory of the slot is not accessed by other threads. Thus, the
+  // amounts can be copied outside of the critical section.
+  if (amounts == nullptr) {
+    amounts = initial_amounts_.data();
+  }
+  std::copy(amounts, amounts + num_species_, ptr);
+  return ptr;
+}
+
+// -----------------------------------------------------------------------------
+void IntracellularNetwork::Release(uint64_t slot) {
+  std::lock_guard<Spinlock> guard(lock_);
+  active_[slot / kBlockSize][slot % kBlockSize] = 0;
+  free_slots_.push_back(slot);
+  num_agents_--;
+}
+
+// -----------------------------------------------------------------------------
+void IntracellularNetwork::Integrate(const Param* param, real_t time,
+                                     real_t dt) {
+  auto num_blocks = blocks_.size();
+#pragma omp parallel for schedule(dynamic, 1)
+  for (uint64_t b = 0; b < num_blocks; ++b) {
+    auto num_agents = std::min(kBlockSize, num_slots_ - b * kBlockSize);
+    model_->IntegrateBatch(param, time, dt, blocks_[b].get(),
+                           active_[b].get(), num_agents);
+  }
+}
+
+// -----------------------------------------------------------------------------
+IntracellularBehavior::IntracellularBehavior(
+    const std::shared_ptr<IntracellularNetwork>& network) {
+  AlwaysCopyToNew();
+  Connect(network, nullptr);
+}
+
+// -----------------------------------------------------------------------------
+IntracellularBehavior::IntracellularBehavior(
+    const IntracellularBehavior& other)
+    : Behavior(other) {
+  if (other.network_) {
+    Connect(other.network_, other.amounts_);
+  }
+}
+
+// -----------------------------------------------------------------------------
+IntracellularBehavior::~IntracellularBehavior() {
+  if (network_) {
+    network_->Release(slot_);
+  }
+}
+
+// -----------------------------------------------------------------------------
+void IntracellularBehavior::Initialize(const NewAgentEvent& event) {
+  Base::Initialize(event);
+  auto* other = event.existing_behavior;
+  if (auto* ib = dynamic_cast<IntracellularBehavior*>(other)) {
+    if (ib->network_) {
+      Connect(ib->network_, ib->amounts_);
+    }
+  } else {
+    Log::Fatal("IntracellularBehavior::Initialize",
+               "other was not of type IntracellularBehavior");
+  }
+}
+
+// -----------------------------------------------------------------------------
+void IntracellularBehavior::Connect(
+    const std::shared_ptr<IntracellularNetwork>& network,
+    const real_t* amounts) {
+  if (network_) {
+    network_->Release(slot_);
+  }
+  network_ = network;
+  amounts_ = network_->Allocate(amounts, &slot_);
+}
+
+// -----------------------------------------------------------------------------
+static IntracellularNetworkOp* GetIntracellularNetworkOp() {
+  auto* sim = Simulation::GetActive();
+  if (sim == nullptr) {
+    return nullptr;
+  }
+  auto ops = sim->GetScheduler()->GetOps("intracellular network");
+  if (ops.empty()) {
+    return nullptr;
+  }
+  return ops[0]->GetImplementation<IntracellularNetworkOp>();
+}
+
+// -----------------------------------------------------------------------------
+void IntracellularBehavior::BeforeWrite() {
+  io_amounts_.clear();
+  io_network_idx_ = -1;
+  if (!network_) {
+    return;
+  }
+  io_amounts_.assign(amounts_, amounts_ + network_->GetNumSpecies());
+  if (auto* op = GetIntracellularNetworkOp()) {
+    const auto& networks = op->GetNetworks();
+    for (size_t i = 0; i < networks.size(); ++i) {
+      if (networks[i] == network_) {
+        io_network_idx_ = static_cast<int64_t>(i);
+        break;
+      }
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+void IntracellularBehavior::AfterRead() {
+  auto* op = GetIntracellularNetworkOp();
+  if (io_network_idx_ >= 0 && op != nullptr &&
+      static_cast<size_t>(io_network_idx_) < op->GetNetworks().size()) {
+    const auto& network = op->GetNetworks()[io_network_idx_];
+    if (network->GetNumSpecies() == io_amounts_.size()) {
+      Connect(network, io_amounts_.data());
+    } else {
+      Log::Warning("IntracellularBehavior",
+                   "The restored amounts do not match the number of species "
+                   "of the network. The behavior is not connected.");
+    }
+  } else if (io_network_idx_ >= 0) {
+    Log::Warning("IntracellularBehavior",
+                 "The network of the restored behavior does not exist in the "
+                 "active simulation. The behavior is not connected.");
+  }
+  io_amounts_.clear();
+  io_network_idx_ = -1;
+}
+
+}  // namespace bdm
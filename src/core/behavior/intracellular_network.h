@@ -0,0 +1,265 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_BEHAVIOR_INTRACELLULAR_NETWORK_H_
+#define CORE_BEHAVIOR_INTRACELLULAR_NETWORK_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/behavior/behavior.h"
+#include "core/param/param.h"
+#include "core/real_t.h"
+#include "core/util/log.h"
+#include "core/util/spinlock.h"
+
+namespace bdm {
+
+/// Interface of a chemical reaction network that is simulated inside each
+/// agent (e.g. a model loaded from an SBML file).\n
+/// A model is created once and shared by all agents. It does not contain
+/// per-agent state: the amounts of the species of each agent are stored by
+/// `IntracellularNetwork` and passed to the integration functions.
+/// Therefore, `Integrate` and `IntegrateBatch` are called concurrently by
+/// multiple threads and must be thread-safe.\n
+/// Implementations can wrap an external simulator (e.g. one
+/// `rr::RoadRunner` instance per thread), or use `OdeModel`.
+class IntracellularModel {
+ public:
+  virtual ~IntracellularModel() = default;
+
+  virtual const std::vector<std::string>& GetSpeciesNames() const = 0;
+
+  /// Returns the amounts of the species of a newly created agent.
+  virtual std::vector<real_t> GetInitialAmounts() const = 0;
+
+  /// Advances the amounts of one agent from `time` to `time + dt`.
+  /// `param` are the parameters of the active simulation.
+  virtual void Integrate(const Param* param, real_t time, real_t dt,
+                         real_t* amounts) const = 0;
+
+  /// Advances the amounts of `num_agents` agents, which are stored
+  /// contiguously (`amounts[agent * num_species + species]`).
+  /// Agents with `active[agent] == 0` must be skipped.
+  /// The default implementation calls `Integrate` for each agent.
+  /// Override this function to vectorize across agents.
+  virtual void IntegrateBatch(const Param* param, real_t time, real_t dt,
+                              real_t* amounts, const char* active,
+                              uint64_t num_agents) const;
+
+  size_t GetNumSpecies() const { return GetSpeciesNames().size(); }
+
+  /// Returns the index of species `name`. Fatal if the species does not
+  /// exist.
+  size_t GetSpeciesIndex(const std::string& name) const;
+};
+
+/// Intracellular model defined by a system of ordinary differential
+/// equations. The equations are solved with the method specified in
+/// `Param::numerical_ode_solver`. Fatal if the solver is unknown.
+/// \code
+/// // A <-> B with rate constants 0.1 and 0.05
+/// auto model = std::make_shared<OdeModel>(
+///     std::vector<std::string>{"A", "B"}, std::vector<real_t>{100, 0},
+///     [](real_t time, const real_t* x, real_t* dxdt) {
+///       auto flux = 0.1 * x[0] - 0.05 * x[1];
+///       dxdt[0] = -flux;
+///       dxdt[1] = flux;
+///     });
+/// \endcode
+class OdeModel : public IntracellularModel {
+ public:
+  /// Computes the derivatives `dxdt` at `time` for the amounts `x`.
+  using Derivatives =
+      std::function<void(real_t time, const real_t* x, real_t* dxdt)>;
+
+  OdeModel(const std::vector<std::string>& species_names,
+           const std::vector<real_t>& initial_amounts,
+           const Derivatives& derivatives);
+
+  const std::vector<std::string>& GetSpeciesNames() const override {
+    return species_names_;
+  }
+
+  std::vector<real_t> GetInitialAmounts() const override {
+    return initial_amounts_;
+  }
+
+  void Integrate(const Param* param, real_t time, real_t dt,
+                 real_t* amounts) const override;
+
+ private:
+  std::vector<std::string> species_names_;
+  std::vector<real_t> initial_amounts_;
+  Derivatives derivatives_;
+};
+
+/// Stores the amounts of the species of all agents that simulate the same
+/// `IntracellularModel` in contiguous blocks of memory and integrates them
+/// in parallel once per iteration (see `IntracellularNetworkOp`).
+/// Agents refer to their amounts through an `IntracellularBehavior`.
+class IntracellularNetwork {
+ public:
+  /// Creates a network for `model` and schedules it for integration in the
+  /// active simulation.
+  static std::shared_ptr<IntracellularNetwork> Create(
+      const std::shared_ptr<IntracellularModel>& model);
+
+  explicit IntracellularNetwork(
+      const std::shared_ptr<IntracellularModel>& model);
+
+  const IntracellularModel* GetModel() const { return model_.get(); }
+
+  size_t GetNumSpecies() const { return num_species_; }
+
+  /// Returns the number of agents that use this network.
+  uint64_t GetNumAgents() const { return num_agents_; }
+
+  /// Reserves memory for the amounts of one agent and initializes them with
+  /// `amounts`, or the initial amounts of the model if `amounts` is a
+  /// nullptr. The returned memory stays valid until `Release(slot)` is
+  /// called. Thread-safe.
+  real_t* Allocate(const real_t* amounts, uint64_t* slot);
+
+  /// Thread-safe.
+  void Release(uint64_t slot);
+
+  /// Advances the amounts of all agents from `time` to `time + dt` in
+  /// parallel. Must not be called concurrently with `Allocate` or
+  /// `Release`.
+  void Integrate(const Param* param, real_t time, real_t dt);
+
+ private:
+  /// Number of agents per block.
+  static constexpr uint64_t kBlockSize = 1024;
+
+  std::shared_ptr<IntracellularModel> model_;
+  size_t num_species_;
+  std::vector<real_t> initial_amounts_;
+  /// Amounts of `kBlockSize` agents each. Blocks are never moved or freed
+  /// before the network is destroyed.
+  std::vector<std::unique_ptr<real_t[]>> blocks_;
+  /// Indicates for each slot whether it is used by an agent.
+  std::vector<std::unique_ptr<char[]>> active_;
+  std::vector<uint64_t> free_slots_;
+  uint64_t num_slots_ = 0;
+  uint64_t num_agents_ = 0;
+  Spinlock lock_;
+};
+
+/// Connects an agent to an `IntracellularNetwork`.\n
+/// The amounts of the species are integrated by `IntracellularNetworkOp`
+/// before the agent operations are executed. Override `Run` to react to the
+/// current amounts (e.g. to divide the cell).\n
+/// New agents (e.g. daughter cells) inherit a copy of the amounts.\n
+/// Backups and snapshots contain the amounts. A restored behavior is
+/// connected to the network that was created at the same position (see
+/// `IntracellularNetwork::Create`) in the active simulation. Thus, networks
+/// must be created in the same order before the simulation is restored.
+/// \code
+/// auto network = IntracellularNetwork::Create(model);
+/// cell->AddBehavior(new IntracellularBehavior(network));
+/// \endcode
+class IntracellularBehavior : public Behavior {
+  BDM_BEHAVIOR_HEADER(IntracellularBehavior, Behavior, 1);
+
+ public:
+  IntracellularBehavior() { AlwaysCopyToNew(); }
+
+  explicit IntracellularBehavior(
+      const std::shared_ptr<IntracellularNetwork>& network);
+
+  IntracellularBehavior(const IntracellularBehavior& other);
+
+  ~IntracellularBehavior() override;
+
+  void Initialize(const NewAgentEvent& event) override;
+
+  void Run(Agent* agent) override {}
+
+  IntracellularNetwork* GetNetwork() const { return network_.get(); }
+
+  /// Returns false if a restored behavior could not be connected to a
+  /// network. The amounts must not be accessed in this case.
+  bool IsConnected() const { return amounts_ != nullptr; }
+
+  real_t GetAmount(size_t species) const {
+    AssertConnected();
+    return amounts_[species];
+  }
+
+  real_t GetAmount(const std::string& species) const {
+    AssertConnected();
+    return amounts_[network_->GetModel()->GetSpeciesIndex(species)];
+  }
+
+  void SetAmount(size_t species, real_t amount) {
+    AssertConnected();
+    amounts_[species] = amount;
+  }
+
+  /// Returns the amounts of all species (`GetNumSpecies()` elements).
+  const real_t* GetAmounts() const { return amounts_; }
+
+ private:
+  std::shared_ptr<IntracellularNetwork> network_;  //!
+  uint64_t slot_ = 0;                              //!
+  real_t* amounts_ = nullptr;                      //!
+  /// Copy of the amounts and position of the network in the
+  /// `IntracellularNetworkOp`. Only used during I/O (see `Streamer`).
+  std::vector<real_t> io_amounts_;
+  int64_t io_network_idx_ = -1;
+
+  void Connect(const std::shared_ptr<IntracellularNetwork>& network,
+               const real_t* amounts);
+
+  void AssertConnected() const {
+    if (amounts_ == nullptr) {
+      Log::Fatal("IntracellularBehavior",
+                 "The behavior is not connected to an IntracellularNetwork. "
+                 "Create the networks before the simulation is restored.");
+    }
+  }
+
+  /// Copies the state of the network into the persistent data members.
+  void BeforeWrite();
+
+  /// Connects a restored behavior to the network at position
+  /// `io_network_idx_` in the active simulation.
+  void AfterRead();
+};
+
+// The following custom streamer should be visible to rootcling for dictionary
+// generation, but not to the interpreter!
+#if (!defined(__CLING__) || defined(__ROOTCLING__)) && defined(USE_DICT)
+
+// The custom streamer is needed because the amounts are stored by the shared
+// `IntracellularNetwork`.
+inline void IntracellularBehavior::Streamer(TBuffer& R__b) {
+  if (R__b.IsReading()) {
+    R__b.ReadClassBuffer(IntracellularBehavior::Class(), this);
+    AfterRead();
+  } else {
+    BeforeWrite();
+    R__b.WriteClassBuffer(IntracellularBehavior::Class(), this);
+  }
+}
+
+#endif  // !defined(__CLING__) || defined(__ROOTCLING__)
+
+}  // namespace bdm
+
+#endif  // CORE_BEHAVIOR_INTRACELLULAR_NETWORK_H_
@@ -27,6 +27,7 @@ namespace bdm {
 /// Secrete substance at Agent position
 class Secretion : public Behavior {
   BDM_BEHAVIOR_HEADER(Secretion, Behavior, 2);
+  BDM_SERIALIZE(Secretion, 1, substance_, dgrid_, quantity_, mode_);
 
  public:
   Secretion() = default;
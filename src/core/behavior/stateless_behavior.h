@@ -43,6 +43,9 @@ namespace bdm {
 ///   }
 /// };
 /// \endcode
+/// Since a StatelessBehavior does not contain per-agent state, a single
+/// instance can be shared between all agents to reduce memory consumption
+/// and to speed up agent copies. \see `Behavior::Share`
 class StatelessBehavior : public Behavior {
   BDM_BEHAVIOR_HEADER(StatelessBehavior, Behavior, 1);
 
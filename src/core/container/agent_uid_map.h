@@ -50,6 +50,14 @@ class AgentUidMap {
     agent_uid_reused_.resize(new_size, AgentUid::kReusedMax);
   }
 
+  /// Removes all elements and releases the memory that is not required to
+  /// store `new_size` elements.
+  void Reset(uint64_t new_size) {
+    std::vector<TValue>(new_size).swap(data_);
+    std::vector<typename AgentUid::Reused_t>(new_size, AgentUid::kReusedMax)
+        .swap(agent_uid_reused_);
+  }
+
   void clear() {  // NOLINT
     for (auto& el : agent_uid_reused_) {
       el = AgentUid::kReusedMax;
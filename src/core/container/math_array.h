@@ -434,6 +434,8 @@ MathArray<T, N> operator*(T const& scalar, MathArray<T, N> array) {
 using Real3 = MathArray<real_t, 3>;
 using Float3 = MathArray<float, 3>;
 using Double3 = MathArray<double, 3>;
+/// Size 3 MathArray used to accumulate values (see `real_acc_t`)
+using RealAcc3 = MathArray<real_acc_t, 3>;
 
 /// Aliases for a size 4 MathArray
 using Real4 = MathArray<real_t, 4>;
@@ -0,0 +1,270 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_CONTAINER_MATH_ARRAY_3XN_H_
+#define CORE_CONTAINER_MATH_ARRAY_3XN_H_
+
+#include <cmath>
+#include <cstddef>
+
+#include "core/container/math_array.h"
+#include "core/real_t.h"
+
+namespace bdm {
+
+/// Number of vectors that are processed together by `Real3xN` and
+/// `RealAcc3xN`. Eight doubles fill one 512-bit register (or two 256-bit
+/// registers).
+constexpr std::size_t kSimdBatchSize = 8;
+
+/// Batch of `N` three dimensional vectors stored as structure of arrays
+/// (all x components, then all y and z components).\n
+/// In contrast to `MathArray<T, 3>`, which operates on one vector at a time,
+/// each operation is applied to all `N` vectors ("lanes") in one loop that
+/// the compiler vectorizes. Use it to process agents or neighbors in
+/// batches of `kSimdBatchSize`.\n
+/// Operations always process all `N` lanes. If a batch is not completely
+/// filled, the unused lanes are zero after `Load` and can be ignored.
+/// \code
+/// Real3xN a, b;
+/// a.Load(positions, n);
+/// b.Fill(center);
+/// a -= b;
+/// real_t distances[kSimdBatchSize];
+/// a.Norm(distances);
+/// \endcode
+template <typename T, std::size_t N>
+class MathArray3xN {  // NOLINT
+ public:
+  MathArray3xN() { Fill(0, 0, 0); }
+
+  static constexpr std::size_t size() { return N; }  // NOLINT
+
+  T* X() { return x_; }
+  T* Y() { return y_; }
+  T* Z() { return z_; }
+  const T* X() const { return x_; }
+  const T* Y() const { return y_; }
+  const T* Z() const { return z_; }
+
+  /// Returns the vector of lane `i`.
+  MathArray<T, 3> Get(std::size_t i) const { return {x_[i], y_[i], z_[i]}; }
+
+  /// Sets the vector of lane `i`.
+  template <typename U>
+  void Set(std::size_t i, const MathArray<U, 3>& value) {
+    x_[i] = value[0];
+    y_[i] = value[1];
+    z_[i] = value[2];
+  }
+
+  /// Sets all lanes to the same vector.
+  void Fill(T x, T y, T z) {
+#pragma omp simd
+    for (std::size_t i = 0; i < N; ++i) {
+      x_[i] = x;
+      y_[i] = y;
+      z_[i] = z;
+    }
+  }
+
+  template <typename U>
+  void Fill(const MathArray<U, 3>& value) {
+    Fill(value[0], value[1], value[2]);
+  }
+
+  /// Copies `n <= N` vectors into the first lanes. The remaining lanes are
+  /// set to zero.
+  template <typename U>
+  void Load(const MathArray<U, 3>* values, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      Set(i, values[i]);
+    }
+    ZeroFrom(n);
+  }
+
+  /// Copies `n <= N` vectors from separate arrays of the x, y, and z
+  /// components. The remaining lanes are set to zero.
+  template <typename U>
+  void Load(const U* x, const U* y, const U* z, std::size_t n) {
+#pragma omp simd
+    for (std::size_t i = 0; i < n; ++i) {
+      x_[i] = x[i];
+      y_[i] = y[i];
+      z_[i] = z[i];
+    }
+    ZeroFrom(n);
+  }
+
+  /// Copies the first `n <= N` lanes into separate arrays of the x, y, and
+  /// z components.
+  template <typename U>
+  void Store(U* x, U* y, U* z, std::size_t n) const {
+#pragma omp simd
+    for (std::size_t i = 0; i < n; ++i) {
+      x[i] = x_[i];
+      y[i] = y_[i];
+      z[i] = z_[i];
+    }
+  }
+
+  MathArray3xN& operator+=(const MathArray3xN& rhs) {
+#pragma omp simd
+    for (std::size_t i = 0; i < N; ++i) {
+      x_[i] += rhs.x_[i];
+      y_[i] += rhs.y_[i];
+      z_[i] += rhs.z_[i];
+    }
+    return *this;
+  }
+
+  MathArray3xN& operator-=(const MathArray3xN& rhs) {
+#pragma omp simd
+    for (std::size_t i = 0; i < N; ++i) {
+      x_[i] -= rhs.x_[i];
+      y_[i] -= rhs.y_[i];
+      z_[i] -= rhs.z_[i];
+    }
+    return *this;
+  }
+
+  MathArray3xN& operator*=(T k) {
+#pragma omp simd
+    for (std::size_t i = 0; i < N; ++i) {
+      x_[i] *= k;
+      y_[i] *= k;
+      z_[i] *= k;
+    }
+    return *this;
+  }
+
+  /// Multiplies lane `i` with `k[i]`.
+  MathArray3xN& operator*=(const T* k) {
+#pragma omp simd
+    for (std::size_t i = 0; i < N; ++i) {
+      x_[i] *= k[i];
+      y_[i] *= k[i];
+      z_[i] *= k[i];
+    }
+    return *this;
+  }
+
+  /// Computes `this += a * k[i]` for each lane `i`.
+  /// The compiler contracts the multiplication and addition into fused
+  /// multiply-add instructions if the target supports them. (`std::fma`
+  /// would be a slow library call otherwise.)
+  MathArray3xN& FusedMultiplyAdd(const MathArray3xN& a, const T* k) {
+#pragma omp simd
+    for (std::size_t i = 0; i < N; ++i) {
+      x_[i] = a.x_[i] * k[i] + x_[i];
+      y_[i] = a.y_[i] * k[i] + y_[i];
+      z_[i] = a.z_[i] * k[i] + z_[i];
+    }
+    return *this;
+  }
+
+  /// Computes `this += a * k`.
+  MathArray3xN& FusedMultiplyAdd(const MathArray3xN& a, T k) {
+#pragma omp simd
+    for (std::size_t i = 0; i < N; ++i) {
+      x_[i] = a.x_[i] * k + x_[i];
+      y_[i] = a.y_[i] * k + y_[i];
+      z_[i] = a.z_[i] * k + z_[i];
+    }
+    return *this;
+  }
+
+  /// Stores the dot product of each lane with the same lane of `rhs` in
+  /// `result` (`N` elements).
+  void Dot(const MathArray3xN& rhs, T* result) const {
+#pragma omp simd
+    for (std::size_t i = 0; i < N; ++i) {
+      result[i] = x_[i] * rhs.x_[i] + y_[i] * rhs.y_[i] + z_[i] * rhs.z_[i];
+    }
+  }
+
+  /// Returns the cross product of each lane with the same lane of `rhs`.
+  MathArray3xN Cross(const MathArray3xN& rhs) const {
+    MathArray3xN result;
+#pragma omp simd
+    for (std::size_t i = 0; i < N; ++i) {
+      result.x_[i] = y_[i] * rhs.z_[i] - z_[i] * rhs.y_[i];
+      result.y_[i] = z_[i] * rhs.x_[i] - x_[i] * rhs.z_[i];
+      result.z_[i] = x_[i] * rhs.y_[i] - y_[i] * rhs.x_[i];
+    }
+    return result;
+  }
+
+  /// Stores the squared norm of each lane in `result` (`N` elements).
+  void SquaredNorm(T* result) const { Dot(*this, result); }
+
+  /// Stores the norm of each lane in `result` (`N` elements).
+  void Norm(T* result) const {
+#pragma omp simd
+    for (std::size_t i = 0; i < N; ++i) {
+      result[i] = std::sqrt(x_[i] * x_[i] + y_[i] * y_[i] + z_[i] * z_[i]);
+    }
+  }
+
+  /// Normalizes each lane in-place.\n
+  /// In contrast to `MathArray::Normalize`, lanes whose norm is not larger
+  /// than `epsilon` are left unchanged, because a single zero vector (e.g. an
+  /// unused lane) must not abort the whole batch.
+  void Normalize(T epsilon = 0) {
+#pragma omp simd
+    for (std::size_t i = 0; i < N; ++i) {
+      T norm = std::sqrt(x_[i] * x_[i] + y_[i] * y_[i] + z_[i] * z_[i]);
+      T factor = norm > epsilon ? 1 / norm : 1;
+      x_[i] *= factor;
+      y_[i] *= factor;
+      z_[i] *= factor;
+    }
+  }
+
+  /// Returns the sum of all lanes.
+  MathArray<T, 3> Sum() const {
+    T x = 0;
+    T y = 0;
+    T z = 0;
+#pragma omp simd reduction(+ : x, y, z)
+    for (std::size_t i = 0; i < N; ++i) {
+      x += x_[i];
+      y += y_[i];
+      z += z_[i];
+    }
+    return {x, y, z};
+  }
+
+ private:
+  alignas(64) T x_[N];
+  alignas(64) T y_[N];
+  alignas(64) T z_[N];
+
+  void ZeroFrom(std::size_t n) {
+    for (std::size_t i = n; i < N; ++i) {
+      x_[i] = 0;
+      y_[i] = 0;
+      z_[i] = 0;
+    }
+  }
+};
+
+/// Batch of `kSimdBatchSize` `Real3` vectors.
+using Real3xN = MathArray3xN<real_t, kSimdBatchSize>;
+/// Batch of `kSimdBatchSize` `RealAcc3` vectors (see `real_acc_t`).
+using RealAcc3xN = MathArray3xN<real_acc_t, kSimdBatchSize>;
+
+}  // namespace bdm
+
+#endif  // CORE_CONTAINER_MATH_ARRAY_3XN_H_
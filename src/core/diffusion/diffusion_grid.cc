@@ -17,6 +17,7 @@
 #include "core/environment/environment.h"
 #include "core/simulation.h"
 #include "core/util/log.h"
+#include "core/util/thread_info.h"
 
 namespace bdm {
 
@@ -307,6 +308,17 @@ void DiffusionGrid::ChangeConcentrationBy(size_t idx, real_t amount,
                "the diffusion grid! The change was ignored.");
     return;
   }
+  if (async_step_) {
+    // c1_ is being integrated on another thread
+    auto tid = ThreadInfo::GetInstance()->GetMyThreadId();
+    pending_changes_[tid].push_back({idx, amount, mode});
+    return;
+  }
+  ApplyConcentrationChange(idx, amount, mode);
+}
+
+void DiffusionGrid::ApplyConcentrationChange(size_t idx, real_t amount,
+                                             InteractionMode mode) {
   std::lock_guard<Spinlock> guard(locks_[idx]);
   assert(idx < locks_.size());
   switch (mode) {
@@ -345,6 +357,9 @@ real_t DiffusionGrid::GetValue(const Real3& position) const {
                "the diffusion grid!");
     return 0;
   }
+  if (async_step_) {
+    return snapshot_c_[idx];
+  }
   assert(idx < locks_.size());
   std::lock_guard<Spinlock> guard(locks_[idx]);
   return c1_[idx];
@@ -359,7 +374,7 @@ void DiffusionGrid::GetGradient(const Real3& position, Real3* gradient,
                "the diffusion grid! Returning zero gradient.");
     return;
   }
-  *gradient = gradients_[idx];
+  *gradient = async_step_ ? snapshot_gradients_[idx] : gradients_[idx];
   if (normalize) {
     auto norm = gradient->Norm();
     if (norm > 1e-10) {
@@ -368,6 +383,31 @@ void DiffusionGrid::GetGradient(const Real3& position, Real3* gradient,
   }
 }
 
+void DiffusionGrid::BeginAsynchronousStep() {
+  // The snapshot is invalid if the grid has been resized.
+  if (snapshot_c_.size() != c1_.size() || snapshot_age_ >= max_staleness_) {
+    snapshot_c_ = c1_;
+    snapshot_gradients_ = gradients_;
+    snapshot_age_ = 0;
+  }
+  snapshot_age_++;
+  pending_changes_.resize(ThreadInfo::GetInstance()->GetMaxThreads());
+  async_step_ = true;
+}
+
+void DiffusionGrid::EndAsynchronousStep() {
+  async_step_ = false;
+  // Changes of different threads might affect the same box.
+  // ApplyConcentrationChange acquires the lock of the box.
+#pragma omp parallel for schedule(dynamic, 1)
+  for (size_t t = 0; t < pending_changes_.size(); t++) {
+    for (auto& change : pending_changes_[t]) {
+      ApplyConcentrationChange(change.idx, change.amount, change.mode);
+    }
+    pending_changes_[t].clear();
+  }
+}
+
 std::array<uint32_t, 3> DiffusionGrid::GetBoxCoordinates(
     const Real3& position) const {
   std::array<uint32_t, 3> box_coord;
@@ -142,9 +142,19 @@ class DiffusionGrid : public ScalarField {
   // Returns the lower threshold for allowed values in the diffusion grid.
   real_t GetLowerThreshold() const { return lower_threshold_; }
 
-  const real_t* GetAllConcentrations() const { return c1_.data(); }
+  /// Returns the concentrations of all boxes. During an asynchronous step
+  /// (see `SetMaxStaleness`), the grid is integrated concurrently. Thus, the
+  /// concentrations of the snapshot are returned.
+  const real_t* GetAllConcentrations() const {
+    return async_step_ ? snapshot_c_.data() : c1_.data();
+  }
 
-  const real_t* GetAllGradients() const { return gradients_.data()->data(); }
+  /// Returns the gradients of all boxes. Returns the gradients of the
+  /// snapshot during an asynchronous step.
+  const real_t* GetAllGradients() const {
+    return async_step_ ? snapshot_gradients_.data()->data()
+                       : gradients_.data()->data();
+  }
 
   std::array<size_t, 3> GetNumBoxesArray() const {
     std::array<size_t, 3> ret;
@@ -218,6 +228,29 @@ class DiffusionGrid : public ScalarField {
   /// Returns if the gird has been initialized
   bool IsInitialized() const { return initialized_; }
 
+  /// Enables the asynchronous coupling between this grid and the agents for
+  /// slowly varying substances. The `ContinuumOp` then integrates the grid
+  /// concurrently with the agent operations of the same iteration.
+  /// During the agent operations, `GetValue` and `GetGradient` return values
+  /// from a snapshot which is at most `steps` iterations old, and
+  /// `ChangeConcentrationBy` is buffered and applied after the integration.
+  /// `steps = 0` (default) disables the asynchronous coupling.
+  void SetMaxStaleness(uint64_t steps) { max_staleness_ = steps; }
+
+  uint64_t GetMaxStaleness() const { return max_staleness_; }
+
+  bool IsAsynchronouslyCoupled() const { return max_staleness_ != 0; }
+
+  /// Refreshes the snapshot if it is older than the maximum staleness and
+  /// redirects agent reads and writes to the snapshot and the change buffer.
+  /// Called by `ContinuumOp` before the grid is integrated asynchronously.
+  void BeginAsynchronousStep();
+
+  /// Applies all buffered concentration changes and redirects reads and writes
+  /// to the integrated grid again. Called by `ContinuumOp` after the
+  /// asynchronous integration has finished.
+  void EndAsynchronousStep();
+
  private:
   friend class RungeKuttaGrid;
   friend class EulerGrid;
@@ -225,6 +258,17 @@ class DiffusionGrid : public ScalarField {
 
   void ParametersCheck(real_t dt);
 
+  /// Implements `ChangeConcentrationBy` on the integrated grid `c1_`.
+  void ApplyConcentrationChange(size_t idx, real_t amount,
+                                InteractionMode mode);
+
+  /// Concentration change that has been buffered during an asynchronous step.
+  struct PendingChange {
+    size_t idx;
+    real_t amount;
+    InteractionMode mode;
+  };
+
   /// Copies the concentration and gradients values to the new
   /// (larger) grid. In the 2D case it looks like the following:
   ///
@@ -286,6 +330,18 @@ class DiffusionGrid : public ScalarField {
   /// Flag to indicate if we want to print information about the grid after
   /// initialization
   bool print_info_with_initialization_ = false;
+  /// Maximum number of iterations between two snapshots in the asynchronous
+  /// coupling mode. 0 disables the asynchronous coupling.
+  uint64_t max_staleness_ = 0;
+  /// Number of iterations the snapshot has been used for.
+  uint64_t snapshot_age_ = 0;  //!
+  /// True between `BeginAsynchronousStep` and `EndAsynchronousStep`
+  bool async_step_ = false;  //!
+  /// Concentrations and gradients that are read during an asynchronous step
+  ParallelResizeVector<real_t> snapshot_c_ = {};          //!
+  ParallelResizeVector<Real3> snapshot_gradients_ = {};  //!
+  /// Concentration changes of an asynchronous step (one vector per thread)
+  std::vector<std::vector<PendingChange>> pending_changes_;  //!
 
   BDM_CLASS_DEF_OVERRIDE(DiffusionGrid, 1);
 };
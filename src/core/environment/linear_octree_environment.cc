@@ -0,0 +1,349 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/environment/linear_octree_environment.h"
+#include <morton/morton.h>  // NOLINT
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "core/algorithm.h"
+#include "core/container/agent_flat_idx_map.h"
+#include "core/functor.h"
+#include "core/param/param.h"
+#include "core/resource_manager.h"
+#include "core/simulation.h"
+#include "core/util/log.h"
+
+namespace bdm {
+
+constexpr uint64_t LinearOctreeEnvironment::kBitsPerDim;
+constexpr uint64_t LinearOctreeEnvironment::kMaxDepth;
+
+// -----------------------------------------------------------------------------
+void LinearOctreeEnvironment::UpdateImplementation() {
+  auto* sim = Simulation::GetActive();
+  auto* rm = sim->GetResourceManager();
+  auto* param = sim->GetParam();
+
+  if (rm->GetNumAgents() != 0) {
+    Clear();
+    auto inf = Math::kInfinity;
+    std::array<real_t, 6> tmp_dim = {{inf, -inf, inf, -inf, inf, -inf}};
+    CalcSimDimensionsAndLargestAgent(&tmp_dim);
+    RoundOffGridDimensions(tmp_dim);
+    CheckGridGrowth();
+
+    SortAgents(tmp_dim);
+    BuildNodes(std::max<uint64_t>(param->linear_octree_leaf_size, 1));
+  } else {
+    // There are no agents in this simulation
+    // The grid dimensions still have the values assigned in the constructor
+    // if the simulation never had any agents.
+    bool uninitialized =
+        grid_dimensions_[0] == std::numeric_limits<int32_t>::max();
+    keys_.clear();
+    positions_.clear();
+    agents_.clear();
+    nodes_.clear();
+    if (uninitialized && param->bound_space) {
+      // Simulation has never had any agents
+      // Initialize grid dimensions with `Param::min_bound_` and
+      // `Param::max_bound_`
+      // This is required for the DiffusionGrid
+      int min = param->min_bound;
+      int max = param->max_bound;
+      grid_dimensions_ = {min, max, min, max, min, max};
+      threshold_dimensions_ = {min, max};
+      has_grown_ = true;
+    } else if (!uninitialized) {
+      // all agents have been removed in the last iteration
+      // grid state remains the same, but we have to set has_grown_ to false
+      // otherwise the DiffusionGrid will attempt to resize
+      has_grown_ = false;
+    } else {
+      Log::Fatal(
+          "LinearOctreeEnvironment",
+          "You tried to initialize an empty simulation without bound space. "
+          "Therefore we cannot determine the size of the simulation space. "
+          "Please add agents, or set Param::bound_space, "
+          "Param::min_bound, and Param::max_bound.");
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+void LinearOctreeEnvironment::SortAgents(
+    const std::array<real_t, 6>& dimensions) {
+  auto* rm = Simulation::GetActive()->GetResourceManager();
+  auto num_agents = rm->GetNumAgents();
+  if (num_agents > std::numeric_limits<uint32_t>::max()) {
+    Log::Fatal("LinearOctreeEnvironment::SortAgents",
+               "The number of agents exceeds the supported maximum of ",
+               std::numeric_limits<uint32_t>::max());
+  }
+  keys_.resize(num_agents);
+  unsorted_agents_.resize(num_agents);
+  positions_.resize(num_agents);
+  agents_.resize(num_agents);
+
+  // map the bounding cube of all agents to [0, 2^21[ in each dimension
+  const Real3 origin = {dimensions[0], dimensions[2], dimensions[4]};
+  real_t extent = std::max({dimensions[1] - dimensions[0],
+                            dimensions[3] - dimensions[2],
+                            dimensions[5] - dimensions[4]});
+  const real_t max_coord = static_cast<real_t>((1 << kBitsPerDim) - 1);
+  const real_t scale = extent > 0 ? max_coord / extent : 0;
+
+  AgentFlatIdxMap flat_idx_map;
+  flat_idx_map.Update();
+  auto compute_keys = L2F([&](Agent* agent, AgentHandle ah) {
+    auto idx = flat_idx_map.GetFlatIdx(ah);
+    const auto& pos = agent->GetPosition();
+    std::array<uint_fast32_t, 3> coord;
+    for (int d = 0; d < 3; ++d) {
+      auto c = std::min((pos[d] - origin[d]) * scale, max_coord);
+      coord[d] = static_cast<uint_fast32_t>(std::max(c, real_t(0)));
+    }
+    keys_[idx] = {libmorton::morton3D_64_encode(coord[0], coord[1], coord[2]),
+                  static_cast<uint32_t>(idx)};
+    unsorted_agents_[idx] = agent;
+  });
+  rm->ForEachAgentParallel(1000, compute_keys);
+
+  ParallelRadixSort(
+      &keys_, &keys_buffer_,
+      [](const std::pair<uint64_t, uint32_t>& key) { return key.first; },
+      3 * kBitsPerDim);
+
+#pragma omp parallel for
+  for (uint64_t i = 0; i < num_agents; ++i) {
+    auto* agent = unsorted_agents_[keys_[i].second];
+    agents_[i] = agent;
+    positions_[i] = agent->GetPosition();
+  }
+}
+
+// -----------------------------------------------------------------------------
+void LinearOctreeEnvironment::BuildNodes(uint64_t leaf_size) {
+  // Calls `f(begin, end)` for the range of each child of `node`.
+  // Keys in a node share the prefix of `depth` octal digits. Therefore, the
+  // children are contiguous ranges with the same next digit.
+  auto for_each_child = [&](const Node& node, uint64_t depth, auto f) {
+    uint64_t shift = 3 * (kMaxDepth - depth - 1);
+    auto digit = [&](const std::pair<uint64_t, uint32_t>& key) {
+      return (key.first >> shift) & 7;
+    };
+    auto begin = keys_.begin() + node.begin;
+    auto end = keys_.begin() + node.end;
+    while (begin != end) {
+      auto d = digit(*begin);
+      auto child_end = std::partition_point(
+          begin, end,
+          [&](const std::pair<uint64_t, uint32_t>& k) { return digit(k) == d; });
+      f(static_cast<uint32_t>(begin - keys_.begin()),
+        static_cast<uint32_t>(child_end - keys_.begin()));
+      begin = child_end;
+    }
+  };
+
+  nodes_.clear();
+  nodes_.push_back({0, static_cast<uint32_t>(keys_.size()), 0, 0, {}, {}});
+  std::vector<uint64_t> level_offsets = {0, 1};
+  std::vector<uint64_t> child_offsets;
+  for (uint64_t depth = 0; depth < kMaxDepth; ++depth) {
+    uint64_t level_begin = level_offsets[depth];
+    uint64_t level_end = level_offsets[depth + 1];
+    uint64_t num_nodes = level_end - level_begin;
+    if (num_nodes == 0) {
+      break;
+    }
+
+    child_offsets.resize(num_nodes + 1);
+#pragma omp parallel for
+    for (uint64_t i = 0; i < num_nodes; ++i) {
+      const auto& node = nodes_[level_begin + i];
+      uint64_t count = 0;
+      if (node.end - node.begin > leaf_size) {
+        for_each_child(node, depth, [&](uint32_t, uint32_t) { count++; });
+      }
+      child_offsets[i] = count;
+    }
+    ExclusivePrefixSum(&child_offsets, num_nodes);
+
+    nodes_.resize(level_end + child_offsets[num_nodes]);
+#pragma omp parallel for
+    for (uint64_t i = 0; i < num_nodes; ++i) {
+      auto& node = nodes_[level_begin + i];
+      node.first_child = static_cast<uint32_t>(level_end + child_offsets[i]);
+      node.num_children =
+          static_cast<uint32_t>(child_offsets[i + 1] - child_offsets[i]);
+      if (node.num_children != 0) {
+        auto child = node.first_child;
+        for_each_child(node, depth, [&](uint32_t begin, uint32_t end) {
+          nodes_[child++] = {begin, end, 0, 0, {}, {}};
+        });
+      }
+    }
+    level_offsets.push_back(nodes_.size());
+  }
+
+  // bounding boxes bottom-up
+  for (uint64_t l = level_offsets.size() - 1; l > 0; --l) {
+#pragma omp parallel for
+    for (uint64_t n = level_offsets[l - 1]; n < level_offsets[l]; ++n) {
+      auto& node = nodes_[n];
+      auto inf = Math::kInfinity;
+      node.min = {inf, inf, inf};
+      node.max = {-inf, -inf, -inf};
+      if (node.num_children == 0) {
+        for (uint32_t i = node.begin; i < node.end; ++i) {
+          for (int d = 0; d < 3; ++d) {
+            node.min[d] = std::min(node.min[d], positions_[i][d]);
+            node.max[d] = std::max(node.max[d], positions_[i][d]);
+          }
+        }
+      } else {
+        for (uint32_t c = 0; c < node.num_children; ++c) {
+          const auto& child = nodes_[node.first_child + c];
+          for (int d = 0; d < 3; ++d) {
+            node.min[d] = std::min(node.min[d], child.min[d]);
+            node.max[d] = std::max(node.max[d], child.max[d]);
+          }
+        }
+      }
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+void LinearOctreeEnvironment::ForEachNeighbor(
+    Functor<void, Agent*, real_t>& lambda, const Agent& query,
+    real_t squared_radius) {
+  ForEachNeighbor(lambda, query.GetPosition(), squared_radius, &query);
+}
+
+// -----------------------------------------------------------------------------
+void LinearOctreeEnvironment::ForEachNeighbor(
+    Functor<void, Agent*, real_t>& lambda, const Real3& query_position,
+    real_t squared_radius, const Agent* query_agent) {
+  if (nodes_.empty()) {
+    return;
+  }
+  // depth-first traversal: at most 8 nodes are pushed per level
+  std::array<uint32_t, 8 * (kMaxDepth + 1)> stack;
+  uint64_t size = 0;
+  stack[size++] = 0;
+  while (size != 0) {
+    const auto& node = nodes_[stack[--size]];
+    // squared distance between the query position and the bounding box
+    real_t box_distance = 0;
+    for (int d = 0; d < 3; ++d) {
+      real_t v = std::max({node.min[d] - query_position[d], real_t(0),
+                           query_position[d] - node.max[d]});
+      box_distance += v * v;
+    }
+    if (box_distance >= squared_radius) {
+      continue;
+    }
+    if (node.num_children != 0) {
+      for (uint32_t c = 0; c < node.num_children; ++c) {
+        stack[size++] = node.first_child + c;
+      }
+      continue;
+    }
+    for (uint32_t i = node.begin; i < node.end; ++i) {
+      const auto& pos = positions_[i];
+      real_t dx = pos[0] - query_position[0];
+      real_t dy = pos[1] - query_position[1];
+      real_t dz = pos[2] - query_position[2];
+      real_t squared_distance = dx * dx + dy * dy + dz * dz;
+      if (squared_distance < squared_radius && agents_[i] != query_agent) {
+        lambda(agents_[i], squared_distance);
+      }
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+void LinearOctreeEnvironment::ForEachNeighbor(Functor<void, Agent*>& lambda,
+                                              const Agent& query,
+                                              void* criteria) {
+  Log::Fatal("LinearOctreeEnvironment::ForEachNeighbor",
+             "You tried to call a specific ForEachNeighbor in an "
+             "environment that does not yet support it.");
+}
+
+// -----------------------------------------------------------------------------
+std::array<int32_t, 6> LinearOctreeEnvironment::GetDimensions() const {
+  return grid_dimensions_;
+}
+
+// -----------------------------------------------------------------------------
+std::array<int32_t, 2> LinearOctreeEnvironment::GetDimensionThresholds()
+    const {
+  return threshold_dimensions_;
+}
+
+// -----------------------------------------------------------------------------
+LoadBalanceInfo* LinearOctreeEnvironment::GetLoadBalanceInfo() {
+  Log::Fatal("LinearOctreeEnvironment::GetLoadBalanceInfo",
+             "You tried to call GetLoadBalanceInfo in an environment that does "
+             "not support it.");
+  return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+Environment::NeighborMutexBuilder*
+LinearOctreeEnvironment::GetNeighborMutexBuilder() {
+  return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+void LinearOctreeEnvironment::Clear() {
+  int32_t inf = std::numeric_limits<int32_t>::max();
+  grid_dimensions_ = {inf, -inf, inf, -inf, inf, -inf};
+  threshold_dimensions_ = {inf, -inf};
+}
+
+// -----------------------------------------------------------------------------
+void LinearOctreeEnvironment::RoundOffGridDimensions(
+    const std::array<real_t, 6>& grid_dimensions) {
+  grid_dimensions_[0] = floor(grid_dimensions[0]);
+  grid_dimensions_[2] = floor(grid_dimensions[2]);
+  grid_dimensions_[4] = floor(grid_dimensions[4]);
+  grid_dimensions_[1] = ceil(grid_dimensions[1]);
+  grid_dimensions_[3] = ceil(grid_dimensions[3]);
+  grid_dimensions_[5] = ceil(grid_dimensions[5]);
+}
+
+// -----------------------------------------------------------------------------
+void LinearOctreeEnvironment::CheckGridGrowth() {
+  // Determine if the grid dimensions have changed (changed in the sense that
+  // the grid has grown outwards)
+  auto min_gd =
+      *std::min_element(grid_dimensions_.begin(), grid_dimensions_.end());
+  auto max_gd =
+      *std::max_element(grid_dimensions_.begin(), grid_dimensions_.end());
+  if (min_gd < threshold_dimensions_[0]) {
+    threshold_dimensions_[0] = min_gd;
+    has_grown_ = true;
+  }
+  if (max_gd > threshold_dimensions_[1]) {
+    threshold_dimensions_[1] = max_gd;
+    has_grown_ = true;
+  }
+}
+
+}  // namespace bdm
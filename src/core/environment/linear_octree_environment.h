@@ -0,0 +1,117 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_ENVIRONMENT_LINEAR_OCTREE_ENVIRONMENT_H_
+#define CORE_ENVIRONMENT_LINEAR_OCTREE_ENVIRONMENT_H_
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "core/container/math_array.h"
+#include "core/environment/environment.h"
+
+namespace bdm {
+
+/// Octree that is stored in flat arrays instead of pointer-based nodes.\n
+/// During each update, the agent positions are mapped to 63-bit Morton keys
+/// and radix sorted in parallel. Agents that are close in space are therefore
+/// close in the sorted arrays. The nodes of the octree are contiguous ranges
+/// of the sorted arrays (all keys with the same prefix) and are built level
+/// by level in parallel. Each node stores the bounding box of its agents,
+/// which is used to prune radius queries.\n
+/// Neighbor searches use the agent positions at the time of the last update.
+/// Selected if `Param::environment` is set to "linear_octree".
+class LinearOctreeEnvironment : public Environment {
+ public:
+  struct Node {
+    /// Range of the node in the sorted arrays.
+    uint32_t begin;
+    uint32_t end;
+    /// Children are stored contiguously. Leaves have no children.
+    uint32_t first_child;
+    uint32_t num_children;
+    /// Bounding box of the positions of all agents in the node.
+    Real3 min;
+    Real3 max;
+  };
+
+  LinearOctreeEnvironment() { Clear(); }
+
+  std::array<int32_t, 6> GetDimensions() const override;
+
+  std::array<int32_t, 2> GetDimensionThresholds() const override;
+
+  LoadBalanceInfo* GetLoadBalanceInfo() override;
+
+  NeighborMutexBuilder* GetNeighborMutexBuilder() override;
+
+  void Clear() override;
+
+  void ForEachNeighbor(Functor<void, Agent*, real_t>& lambda,
+                       const Agent& query, real_t squared_radius) override;
+
+  void ForEachNeighbor(Functor<void, Agent*>& lambda, const Agent& query,
+                       void* criteria) override;
+
+  /// Calls `lambda(neighbor, squared_distance)` for all agents with a
+  /// squared distance smaller than `squared_radius`.
+  void ForEachNeighbor(Functor<void, Agent*, real_t>& lambda,
+                       const Real3& query_position, real_t squared_radius,
+                       const Agent* query_agent = nullptr) override;
+
+  const std::vector<Node>& GetNodes() const { return nodes_; }
+
+ protected:
+  void UpdateImplementation() override;
+
+ private:
+  /// Number of bits of a Morton key per dimension.
+  static constexpr uint64_t kBitsPerDim = 21;
+  static constexpr uint64_t kMaxDepth = kBitsPerDim;
+
+  /// Morton keys and the flat agent indices, sorted by key.
+  std::vector<std::pair<uint64_t, uint32_t>> keys_;
+  /// Buffer for the radix sort.
+  std::vector<std::pair<uint64_t, uint32_t>> keys_buffer_;
+  /// Positions and agents in the order of `keys_`.
+  std::vector<Real3> positions_;
+  std::vector<Agent*> agents_;
+  /// Agents in the order of the flat agent indices.
+  std::vector<Agent*> unsorted_agents_;
+  /// Nodes sorted by level. The root is `nodes_[0]`.
+  std::vector<Node> nodes_;
+
+  /// Cube which contains all simulation objects
+  /// {x_min, x_max, y_min, y_max, z_min, z_max}
+  std::array<int32_t, 6> grid_dimensions_;
+  /// Stores the min / max dimension value that need to be surpassed in order
+  /// to trigger a diffusion grid change
+  std::array<int32_t, 2> threshold_dimensions_;
+
+  /// Computes the Morton keys of all agents and sorts them.
+  void SortAgents(const std::array<real_t, 6>& dimensions);
+
+  /// Builds the nodes on top of the sorted arrays.
+  void BuildNodes(uint64_t leaf_size);
+
+  void RoundOffGridDimensions(const std::array<real_t, 6>& grid_dimensions);
+
+  void CheckGridGrowth();
+};
+
+}  // namespace bdm
+
+#endif  // CORE_ENVIRONMENT_LINEAR_OCTREE_ENVIRONMENT_H_
@@ -37,6 +37,10 @@ void UniformGridEnvironment::LoadBalanceInfoUG::Update() {
   AllocateMemory();
   InitializeVectors();
   InPlaceParallelPrefixSum(cummulated_agents_, grid_->total_num_boxes_);
+  if (Simulation::GetActive()->GetParam()->weighted_load_balancing) {
+    InitializeCosts();
+    InPlaceParallelPrefixSum(cummulated_costs_, grid_->total_num_boxes_);
+  }
 }
 
 // -----------------------------------------------------------------------------
@@ -67,6 +71,62 @@ void UniformGridEnvironment::LoadBalanceInfoUG::InitializeVectors() {
   }
 }
 
+// -----------------------------------------------------------------------------
+void UniformGridEnvironment::LoadBalanceInfoUG::InitializeCosts() {
+  if (cummulated_costs_.capacity() < grid_->boxes_.size()) {
+    cummulated_costs_.reserve(grid_->boxes_.capacity());
+  }
+  cummulated_costs_.resize(grid_->total_num_boxes_);
+  const auto* first_box = &(grid_->boxes_[0]);
+  auto timestamp = grid_->timestamp_;
+#pragma omp parallel for
+  for (uint64_t i = 0; i < grid_->total_num_boxes_; ++i) {
+    const auto* box = sorted_boxes_[i];
+    uint64_t num_agents = box->Size(timestamp);
+    if (num_agents == 0) {
+      cummulated_costs_[i] = 0;
+      continue;
+    }
+    FixedSizeVector<uint64_t, 27> neighbor_boxes;
+    grid_->GetMooreBoxIndices(&neighbor_boxes, box - first_box);
+    uint64_t candidates = 0;
+    for (size_t j = 0; j < neighbor_boxes.size(); ++j) {
+      candidates += grid_->boxes_[neighbor_boxes[j]].Size(timestamp);
+    }
+    cummulated_costs_[i] = num_agents * (candidates + 1);
+  }
+}
+
+// -----------------------------------------------------------------------------
+uint64_t UniformGridEnvironment::LoadBalanceInfoUG::GetCostSplitPoint(
+    real_t fraction, uint64_t num_agents) const {
+  auto num_boxes = grid_->total_num_boxes_;
+  if (num_boxes == 0 || cummulated_costs_.size() != num_boxes ||
+      cummulated_costs_[num_boxes - 1] == 0) {
+    return LoadBalanceInfo::GetCostSplitPoint(fraction, num_agents);
+  }
+  auto target = fraction * cummulated_costs_[num_boxes - 1];
+  // first box in which the cummulated cost reaches the target
+  const auto* begin = cummulated_costs_.data();
+  auto i = std::lower_bound(begin, begin + num_boxes, target) - begin;
+  if (i >= static_cast<int64_t>(num_boxes)) {
+    return num_agents;
+  }
+  uint64_t agents_before = i == 0 ? 0 : cummulated_agents_[i - 1];
+  uint64_t cost_before = i == 0 ? 0 : cummulated_costs_[i - 1];
+  uint64_t agents_in_box = cummulated_agents_[i] - agents_before;
+  if (agents_in_box == 0) {
+    return agents_before;
+  }
+  // all agents in a box have the same cost
+  real_t cost_per_agent =
+      static_cast<real_t>(cummulated_costs_[i] - cost_before) / agents_in_box;
+  auto in_box = static_cast<uint64_t>(
+      std::round((target - cost_before) / cost_per_agent));
+  return std::min(agents_before + std::min(in_box, agents_in_box),
+                  num_agents);
+}
+
 // -----------------------------------------------------------------------------
 struct AgentHandleIterator : public Iterator<AgentHandle> {
   UniformGridEnvironment* grid_;
@@ -117,6 +177,7 @@ void UniformGridEnvironment::UpdateImplementation() {
     timestamp_++;
 
     auto* param = Simulation::GetActive()->GetParam();
+    prefetch_distance_ = param->neighbor_prefetch_distance;
     if (determine_sim_size_) {
       auto inf = Math::kInfinity;
       std::array<real_t, 6> tmp_dim = {{inf, -inf, inf, -inf, inf, -inf}};
@@ -211,9 +272,16 @@ void UniformGridEnvironment::UpdateImplementation() {
         Param::ThreadSafetyMechanism::kAutomatic) {
       nb_mutex_builder_->Update();
     }
+
+    if (param->detect_static_agents && param->detect_static_boxes) {
+      UpdateStaticBoxes();
+    }
   } else {
     // There are no agents in this simulation
     auto* param = Simulation::GetActive()->GetParam();
+    static_boxes_.clear();
+    last_box_lengths_.clear();
+    moved_boxes_.clear();
 
     bool uninitialized = boxes_.size() == 0;
     if (uninitialized && param->bound_space) {
@@ -242,6 +310,87 @@ void UniformGridEnvironment::UpdateImplementation() {
   }
 }
 
+// -----------------------------------------------------------------------------
+void UniformGridEnvironment::UpdateStaticBoxes() {
+  auto* rm = Simulation::GetActive()->GetResourceManager();
+
+  std::array<int64_t, 7> layout = {
+      {static_cast<int64_t>(num_boxes_axis_[0]),
+       static_cast<int64_t>(num_boxes_axis_[1]),
+       static_cast<int64_t>(num_boxes_axis_[2]), grid_dimensions_[0],
+       grid_dimensions_[2], grid_dimensions_[4], box_length_}};
+  // If the layout changed, box indices of the last update refer to different
+  // regions of the simulation space. Thus, all boxes are woken up.
+  bool layout_changed = layout != last_layout_ ||
+                        last_box_lengths_.size() != total_num_boxes_;
+  last_layout_ = layout;
+
+  // Only the update at the end of an iteration consumes the propagation
+  // flags. Otherwise, an additional update in the same iteration (e.g. a
+  // `ForcedUpdate` of an operation) would not see the agents that changed
+  // and put their boxes to sleep.
+  bool consume = consume_propagate_staticness_;
+  if (consume || layout_changed) {
+    moved_boxes_.assign(total_num_boxes_, 0);
+  }
+
+  // A box moved if one of its agents changed (moved, grew, was created)
+  // since the last update, or if the number of agents in it changed.
+  auto& moved = moved_boxes_;
+#pragma omp parallel for schedule(static, 1024)
+  for (uint64_t i = 0; i < total_num_boxes_; ++i) {
+    auto& box = boxes_[i];
+    auto length = box.Size(timestamp_);
+    moved[i] = moved[i] || layout_changed || length != last_box_lengths_[i];
+    for (auto it = box.begin(this); !it.IsAtEnd(); ++it) {
+      auto* agent = rm->GetAgent(*it);
+      if (agent->GetPropagateStaticness()) {
+        moved[i] = true;
+        if (consume) {
+          agent->SetPropagateStaticness(false);
+        }
+      }
+    }
+  }
+
+  last_box_lengths_.resize(total_num_boxes_);
+  static_boxes_.resize(total_num_boxes_);
+  // Wake-ups propagate to the adjacent boxes. Since the box length is at
+  // least the size of the largest agent, all agents that might interact with
+  // a changed agent are located in the adjacent boxes.
+#pragma omp parallel for schedule(static, 1024)
+  for (uint64_t i = 0; i < total_num_boxes_; ++i) {
+    auto& box = boxes_[i];
+    last_box_lengths_[i] = box.Size(timestamp_);
+    if (box.IsEmpty(timestamp_)) {
+      // Empty boxes are located inside the padding of the grid or do not
+      // contain agents that could be processed.
+      static_boxes_[i] = true;
+      continue;
+    }
+    bool is_static = true;
+    FixedSizeVector<uint64_t, 27> neighbor_boxes;
+    GetMooreBoxIndices(&neighbor_boxes, i);
+    for (uint64_t n = 0; n < neighbor_boxes.size(); ++n) {
+      if (moved[neighbor_boxes[n]]) {
+        is_static = false;
+        break;
+      }
+    }
+    for (auto it = box.begin(this); !it.IsAtEnd(); ++it) {
+      auto* agent = rm->GetAgent(*it);
+      if (!is_static) {
+        agent->SetStaticnessNextTimestep(false);
+      } else if (!agent->GetStaticnessNextTimestep()) {
+        // e.g. an agent with several neighbor forces
+        // (see `Cell::CalculateDisplacement`)
+        is_static = false;
+      }
+    }
+    static_boxes_[i] = is_static;
+  }
+}
+
 // -----------------------------------------------------------------------------
 void UniformGridEnvironment::LoadBalanceInfoUG::CallHandleIteratorConsumer(
     uint64_t start, uint64_t end,
@@ -62,6 +62,7 @@ class UniformGridEnvironment : public Environment {
   friend struct MechanicalForcesOpCuda;
   friend struct ::bdm::detail::InitializeGPUData;
   friend struct MechanicalForcesOpOpenCL;
+  friend struct MechanicalForcesOpCpuSimd;
   friend class SchedulerTest;
 
  public:
@@ -275,6 +276,27 @@ class UniformGridEnvironment : public Environment {
 
   int32_t GetBoxLength() { return box_length_; }
 
+  /// Updates the environment at the end of an iteration (operation
+  /// "update environment"). Unlike `Update` and `ForcedUpdate`, it consumes
+  /// the staticness propagation flags of the agents
+  /// (see `Agent::GetPropagateStaticness`). Thus, additional updates in the
+  /// same iteration keep the boxes awake that changed before this update.
+  void IterationUpdate() {
+    consume_propagate_staticness_ = true;
+    ForcedUpdate();
+    consume_propagate_staticness_ = false;
+  }
+
+  /// Returns true if all agents in the box with index `box_idx` are static
+  /// in the current iteration and no agent in the box or its adjacent boxes
+  /// moved, grew, or was added or removed during the last iteration.
+  /// Operations can use it to skip whole regions of the simulation space.\n
+  /// Requires `Param::detect_static_agents` and
+  /// `Param::detect_static_boxes`. Returns false otherwise.
+  bool IsBoxStatic(size_t box_idx) const {
+    return box_idx < static_boxes_.size() && static_boxes_[box_idx];
+  }
+
   /// @brief      Calculates the squared euclidian distance between two points
   ///             in 3D
   ///
@@ -467,9 +489,22 @@ class UniformGridEnvironment : public Environment {
 
     auto* rm = Simulation::GetActive()->GetResourceManager();
 
+    // Prefetch the heads of the linked lists of all non-empty boxes, so that
+    // the first dependent loads through `successors_` of each box overlap.
+    const uint64_t prefetch_distance = prefetch_distance_;
+    if (prefetch_distance != 0) {
+      for (uint64_t i = 0; i < neighbor_boxes.size(); ++i) {
+        auto* box = neighbor_boxes[i];
+        if (!box->IsEmpty(timestamp_)) {
+          __builtin_prefetch(&successors_[box->start_]);
+        }
+      }
+    }
+
     NeighborIterator ni(this, neighbor_boxes, timestamp_);
     const unsigned batch_size = 64;
     uint64_t size = 0;
+    AgentHandle handles[batch_size];
     Agent* agents[batch_size] __attribute__((aligned(64)));
     real_t x[batch_size] __attribute__((aligned(64)));
     real_t y[batch_size] __attribute__((aligned(64)));
@@ -477,8 +512,36 @@ class UniformGridEnvironment : public Environment {
     real_t squared_distance[batch_size] __attribute__((aligned(64)));
 
     auto process_batch = [&]() {
-#pragma omp simd
+      // The agent pointers of a batch do not depend on each other. Resolving
+      // them first lets the memory system serve these loads in parallel.
       for (uint64_t i = 0; i < size; ++i) {
+        agents[i] = rm->GetAgent(handles[i]);
+      }
+      for (uint64_t i = 0; i < std::min(prefetch_distance, size); ++i) {
+        PrefetchAgent(agents[i]);
+      }
+
+      uint64_t num_candidates = 0;
+      for (uint64_t i = 0; i < size; ++i) {
+        if (i + prefetch_distance < size) {
+          PrefetchAgent(agents[i + prefetch_distance]);
+        }
+        auto* agent = agents[i];
+        if (agent == query_agent) {
+          continue;
+        }
+        // num_candidates <= i: does not overwrite pointers that will still be
+        // prefetched
+        agents[num_candidates] = agent;
+        const auto& pos = agent->GetPosition();
+        x[num_candidates] = pos[0];
+        y[num_candidates] = pos[1];
+        z[num_candidates] = pos[2];
+        num_candidates++;
+      }
+
+#pragma omp simd
+      for (uint64_t i = 0; i < num_candidates; ++i) {
         const real_t dx = x[i] - position[0];
         const real_t dy = y[i] - position[1];
         const real_t dz = z[i] - position[2];
@@ -486,7 +549,7 @@ class UniformGridEnvironment : public Environment {
         squared_distance[i] = dx * dx + dy * dy + dz * dz;
       }
 
-      for (uint64_t i = 0; i < size; ++i) {
+      for (uint64_t i = 0; i < num_candidates; ++i) {
         if (squared_distance[i] < squared_radius) {
           lambda(agents[i], squared_distance[i]);
         }
@@ -495,20 +558,11 @@ class UniformGridEnvironment : public Environment {
     };
 
     while (!ni.IsAtEnd()) {
-      auto ah = *ni;
+      handles[size++] = *ni;
       // increment iterator already here to hide memory latency
       ++ni;
-      auto* agent = rm->GetAgent(ah);
-      if (agent != query_agent) {
-        agents[size] = agent;
-        const auto& pos = agent->GetPosition();
-        x[size] = pos[0];
-        y[size] = pos[1];
-        z[size] = pos[2];
-        size++;
-        if (size == batch_size) {
-          process_batch();
-        }
+      if (size == batch_size) {
+        process_batch();
       }
     }
     process_batch();
@@ -620,12 +674,17 @@ class UniformGridEnvironment : public Environment {
     void CallHandleIteratorConsumer(
         uint64_t start, uint64_t end,
         Functor<void, Iterator<AgentHandle>*>& f) const override;
+    uint64_t GetCostSplitPoint(real_t fraction,
+                               uint64_t num_agents) const override;
 
    private:
     UniformGridEnvironment* grid_;
     MortonOrder mo_;
     ParallelResizeVector<Box*> sorted_boxes_;
     ParallelResizeVector<uint64_t> cummulated_agents_;
+    /// Inclusive prefix sum of the estimated box costs in Morton order.
+    /// Only computed if `Param::weighted_load_balancing` is set.
+    ParallelResizeVector<uint64_t> cummulated_costs_;
 
     struct InitializeVectorFunctor : public Functor<void, Iterator<uint64_t>*> {
       UniformGridEnvironment* grid;
@@ -643,6 +702,9 @@ class UniformGridEnvironment : public Environment {
 
     void AllocateMemory();
     void InitializeVectors();
+    /// The cost of an agent is estimated by the number of neighbor candidates
+    /// in the surrounding boxes plus one.
+    void InitializeCosts();
   };
 
   /// The vector containing all the boxes in the grid
@@ -683,6 +745,22 @@ class UniformGridEnvironment : public Environment {
   /// to trigger a diffusion grid change
   std::array<int32_t, 2> threshold_dimensions_;
 
+  /// Box-level staticness (see `Param::detect_static_boxes`).
+  /// Element is 1 if the corresponding box is static.
+  std::vector<char> static_boxes_;  //!
+  /// Number of agents in each box during the last update.
+  /// Used to detect agents that have been added or removed.
+  std::vector<uint16_t> last_box_lengths_;  //!
+  /// Number of boxes per axis, lower grid bounds and box length during the
+  /// last update. Box indices can only be compared between two updates if
+  /// the layout of the grid did not change.
+  std::array<int64_t, 7> last_layout_ = {{0}};  //!
+  /// Element is 1 if the corresponding box changed before the last
+  /// `IterationUpdate` or afterwards.
+  std::vector<char> moved_boxes_;  //!
+  /// True during `IterationUpdate`.
+  bool consume_propagate_staticness_ = false;  //!
+
   LoadBalanceInfoUG lbi_;  //!
 
   /// Holds instance of NeighborMutexBuilder.
@@ -691,6 +769,23 @@ class UniformGridEnvironment : public Environment {
   std::unique_ptr<GridNeighborMutexBuilder> nb_mutex_builder_ =
       std::make_unique<GridNeighborMutexBuilder>();
 
+  /// Number of neighbor candidates that are prefetched ahead in
+  /// `ForEachNeighbor`. \see `Param::neighbor_prefetch_distance`
+  uint64_t prefetch_distance_ = 8;  //!
+
+  /// Prefetches the first two cache lines of an agent, which contain the
+  /// virtual table pointer and the most frequently accessed data members.
+  static void PrefetchAgent(const Agent* agent) {
+    auto* address = reinterpret_cast<const char*>(agent);
+    __builtin_prefetch(address);
+    __builtin_prefetch(address + 64);
+  }
+
+  /// Determines which boxes are static and wakes up all agents in non-static
+  /// boxes. Replaces the neighbor searches of `Agent::PropagateStaticness`
+  /// if `Param::detect_static_boxes` is set.
+  void UpdateStaticBoxes();
+
   void CheckGridGrowth() {
     // Determine if the grid dimensions have changed (changed in the sense that
     // the grid has grown outwards)
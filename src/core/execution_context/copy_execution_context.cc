@@ -93,5 +93,16 @@ void CopyExecutionContext::Execute(Agent* agent, AgentHandle ah,
   (*agents_.get())[ah.GetNumaNode()][ah.GetElementIdx()] = copy;
 }
 
+// -----------------------------------------------------------------------------
+void CopyExecutionContext::Execute(Agent* agent, AgentHandle ah,
+                                   const std::vector<Operation*>& operations,
+                                   const IterationContext& ctxt) {
+  auto* copy = agent->NewCopy();
+  InPlaceExecutionContext::Execute(copy, ah, operations, ctxt);
+  assert(ah.GetNumaNode() < agents_->size());
+  assert(ah.GetElementIdx() < agents_->at(ah.GetNumaNode()).size());
+  (*agents_.get())[ah.GetNumaNode()][ah.GetElementIdx()] = copy;
+}
+
 }  // namespace experimental
 }  // namespace bdm
@@ -54,6 +54,10 @@ class CopyExecutionContext : public InPlaceExecutionContext {
   void Execute(Agent* agent, AgentHandle ah,
                const std::vector<Operation*>& operations) override;
 
+  void Execute(Agent* agent, AgentHandle ah,
+               const std::vector<Operation*>& operations,
+               const IterationContext& ctxt) override;
+
  protected:
   /// Pointer container for all agents shared between all
   /// CopyExecutionContext instances of a simulation.
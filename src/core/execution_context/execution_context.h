@@ -27,6 +27,7 @@
 namespace bdm {
 
 class Agent;
+struct IterationContext;
 
 class ExecutionContext {
  public:
@@ -63,6 +64,15 @@ class ExecutionContext {
   virtual void Execute(Agent* agent, AgentHandle ah,
                        const std::vector<Operation*>& operations) = 0;
 
+  /// Same as `Execute(agent, ah, operations)`, but passes the state of the
+  /// current iteration to the operations.
+  /// The default implementation ignores `ctxt`.
+  virtual void Execute(Agent* agent, AgentHandle ah,
+                       const std::vector<Operation*>& operations,
+                       const IterationContext& ctxt) {
+    Execute(agent, ah, operations);
+  }
+
   /// Applies the lambda `lambda` for each neighbor of the given `query`
   /// agent within the given `criteria`. Does not support caching.
   virtual void ForEachNeighbor(Functor<void, Agent*>& lambda,
@@ -21,6 +21,7 @@
 #include "core/agent/agent.h"
 #include "core/environment/environment.h"
 #include "core/functor.h"
+#include "core/iteration_context.h"
 #include "core/resource_manager.h"
 #include "core/scheduler.h"
 
@@ -149,6 +150,27 @@ void InPlaceExecutionContext::Execute(
     Agent* agent, AgentHandle ah, const std::vector<Operation*>& operations) {
   auto* env = Simulation::GetActive()->GetEnvironment();
   auto* param = Simulation::GetActive()->GetParam();
+  ExecuteImpl(agent, env, param, [&]() {
+    for (auto* op : operations) {
+      (*op)(agent);
+    }
+  });
+}
+
+void InPlaceExecutionContext::Execute(Agent* agent, AgentHandle ah,
+                                      const std::vector<Operation*>& operations,
+                                      const IterationContext& ctxt) {
+  ExecuteImpl(agent, ctxt.env, ctxt.param, [&]() {
+    for (auto* op : operations) {
+      (*op)(agent, ctxt);
+    }
+  });
+}
+
+template <typename TRunOps>
+void InPlaceExecutionContext::ExecuteImpl(Agent* agent, Environment* env,
+                                          const Param* param,
+                                          const TRunOps& run_ops) {
 
   if (param->thread_safety_mechanism ==
       Param::ThreadSafetyMechanism::kUserSpecified) {
@@ -199,9 +221,7 @@ void InPlaceExecutionContext::Execute(
     }
     neighbor_cache_.clear();
     cached_squared_search_radius_ = 0;
-    for (auto& op : operations) {
-      (*op)(agent);
-    }
+    run_ops();
     for (int i = locks_.size() - 1; i >= 0; --i) {
       locks_[i]->unlock();
     }
@@ -212,16 +232,12 @@ void InPlaceExecutionContext::Execute(
     std::lock_guard<decltype(*mutex)> guard(*mutex);
     neighbor_cache_.clear();
     cached_squared_search_radius_ = 0;
-    for (auto* op : operations) {
-      (*op)(agent);
-    }
+    run_ops();
   } else if (param->thread_safety_mechanism ==
              Param::ThreadSafetyMechanism::kNone) {
     neighbor_cache_.clear();
     cached_squared_search_radius_ = 0;
-    for (auto* op : operations) {
-      (*op)(agent);
-    }
+    run_ops();
   } else {
     Log::Fatal("InPlaceExecutionContext::Execute",
                "Invalid value for parameter thread_safety_mechanism: ",
@@ -34,6 +34,9 @@
 
 namespace bdm {
 
+class Environment;
+struct Param;
+
 namespace in_place_exec_ctxt_detail {
 class InPlaceExecutionContext_NeighborCacheValidity_Test;
 }
@@ -108,6 +111,10 @@ class InPlaceExecutionContext : public ExecutionContext {
   void Execute(Agent* agent, AgentHandle ah,
                const std::vector<Operation*>& operations) override;
 
+  void Execute(Agent* agent, AgentHandle ah,
+               const std::vector<Operation*>& operations,
+               const IterationContext& ctxt) override;
+
   /// Applies the lambda `lambda` for each neighbor of the given `query`
   /// agent within the given `criteria`. Does not support caching.
   void ForEachNeighbor(Functor<void, Agent*>& lambda, const Agent& query,
@@ -175,6 +182,12 @@ class InPlaceExecutionContext : public ExecutionContext {
   std::vector<AgentPointer<>> critical_region_2_;
 
   std::vector<Spinlock*> locks_;
+
+  /// Acquires the locks required by `param->thread_safety_mechanism` and
+  /// calls `run_ops()`.
+  template <typename TRunOps>
+  void ExecuteImpl(Agent* agent, Environment* env, const Param* param,
+                   const TRunOps& run_ops);
 };
 
 }  // namespace bdm
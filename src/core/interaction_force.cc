@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <typeinfo>
 
 #include "core/agent/agent.h"
 #include "core/shape.h"
@@ -57,34 +58,133 @@ Real4 InteractionForce::Calculate(const Agent* lhs, const Agent* rhs) const {
   }
 }
 
+void InteractionForce::CalculateBatch(const Agent* lhs, Agent* const* rhs,
+                                      uint64_t num_neighbors,
+                                      Real4* results) const {
+  // Subclasses might override `Calculate`.
+  if (typeid(*this) != typeid(InteractionForce) ||
+      lhs->GetShape() != Shape::kSphere) {
+    for (uint64_t i = 0; i < num_neighbors; ++i) {
+      results[i] = Calculate(lhs, rhs[i]);
+    }
+    return;
+  }
+
+  // Spherical neighbors are gathered into batches. Other neighbors are
+  // calculated directly.
+  const Agent* spheres[kSimdBatchSize];
+  uint64_t indices[kSimdBatchSize];
+  Real4 batch_results[kSimdBatchSize];
+  uint64_t num_spheres = 0;
+  auto flush = [&]() {
+    ForceBetweenSpheres(lhs, spheres, num_spheres, batch_results);
+    for (uint64_t s = 0; s < num_spheres; ++s) {
+      results[indices[s]] = batch_results[s];
+    }
+    num_spheres = 0;
+  };
+  for (uint64_t i = 0; i < num_neighbors; ++i) {
+    if (rhs[i]->GetShape() != Shape::kSphere) {
+      results[i] = Calculate(lhs, rhs[i]);
+      continue;
+    }
+    spheres[num_spheres] = rhs[i];
+    indices[num_spheres] = i;
+    if (++num_spheres == kSimdBatchSize) {
+      flush();
+    }
+  }
+  if (num_spheres != 0) {
+    flush();
+  }
+}
+
+void InteractionForce::ForceBetweenSpheres(const Agent* sphere_lhs,
+                                           const Agent* const* spheres_rhs,
+                                           uint64_t num,
+                                           Real4* results) const {
+  // Same as `ForceBetweenSpheres` for a single neighbor, but each step is
+  // applied to all neighbors of the batch.
+  const real_acc_t iof_coefficient = 0.15;
+  const real_acc_t additional_radius = 10.0 * iof_coefficient;
+  real_acc_t r1 = 0.5 * sphere_lhs->GetDiameter() + additional_radius;
+
+  // the vectors c2 -> c1
+  RealAcc3xN comp;
+  RealAcc3xN c2;
+  real_acc_t r2[kSimdBatchSize] = {0};
+  for (uint64_t i = 0; i < num; ++i) {
+    c2.Set(i, spheres_rhs[i]->GetPosition());
+    r2[i] = 0.5 * spheres_rhs[i]->GetDiameter() + additional_radius;
+  }
+  comp.Fill(sphere_lhs->GetPosition());
+  comp -= c2;
+  real_acc_t center_distance[kSimdBatchSize];
+  comp.Norm(center_distance);
+
+  real_acc_t force_module[kSimdBatchSize];
+#pragma omp simd
+  for (uint64_t i = 0; i < kSimdBatchSize; ++i) {
+    // the overlap distance (how much one penetrates in the other)
+    real_acc_t delta = r1 + r2[i] - center_distance[i];
+    real_acc_t r = (r1 * r2[i]) / (r1 + r2[i]);
+    // k = 2 (repulsion coeff), gamma = 1 (attraction coeff)
+    real_acc_t f = 2 * delta - std::sqrt(r * std::max(delta, real_acc_t(0)));
+    bool apply = delta >= 0 && center_distance[i] >= 0.00000001;
+    force_module[i] = apply ? f / center_distance[i] : 0;
+  }
+  comp *= force_module;
+
+  for (uint64_t i = 0; i < num; ++i) {
+    if (r1 + r2[i] - center_distance[i] >= 0 &&
+        center_distance[i] < 0.00000001) {
+      // to avoid a division by 0 if the centers are (almost) at the same
+      // location
+      auto* random = Simulation::GetActive()->GetRandom();
+      auto force2on1 = random->template UniformArray<3>(-3.0, 3.0);
+      results[i] = {force2on1[0], force2on1[1], force2on1[2], 0};
+    } else {
+      results[i] = {static_cast<real_t>(comp.X()[i]),
+                    static_cast<real_t>(comp.Y()[i]),
+                    static_cast<real_t>(comp.Z()[i]), 0};
+    }
+  }
+}
+
 void InteractionForce::ForceBetweenSpheres(const Agent* sphere_lhs,
                                            const Agent* sphere_rhs,
                                            Real3* result) const {
+  // Intermediate values are computed in `real_acc_t`. If agent attributes
+  // are stored in single precision, this avoids cancellation errors in the
+  // overlap `delta`, which is the small difference of large values.
   const Real3& ref_mass_location = sphere_lhs->GetPosition();
-  real_t ref_diameter = sphere_lhs->GetDiameter();
-  real_t ref_iof_coefficient = 0.15;
+  real_acc_t ref_diameter = sphere_lhs->GetDiameter();
+  real_acc_t ref_iof_coefficient = 0.15;
   const Real3& nb_mass_location = sphere_rhs->GetPosition();
-  real_t nb_diameter = sphere_rhs->GetDiameter();
-  real_t nb_iof_coefficient = 0.15;
+  real_acc_t nb_diameter = sphere_rhs->GetDiameter();
+  real_acc_t nb_iof_coefficient = 0.15;
 
-  auto c1 = ref_mass_location;
-  real_t r1 = 0.5 * ref_diameter;
-  auto c2 = nb_mass_location;
-  real_t r2 = 0.5 * nb_diameter;
+  const auto& c1 = ref_mass_location;
+  real_acc_t r1 = 0.5 * ref_diameter;
+  const auto& c2 = nb_mass_location;
+  real_acc_t r2 = 0.5 * nb_diameter;
   // We take virtual bigger radii to have a distant interaction, to get a
   // desired density.
-  real_t additional_radius =
+  real_acc_t additional_radius =
       10.0 * std::min(ref_iof_coefficient, nb_iof_coefficient);
   r1 += additional_radius;
   r2 += additional_radius;
   // the 3 components of the vector c2 -> c1
-  real_t comp1 = c1[0] - c2[0];
-  real_t comp2 = c1[1] - c2[1];
-  real_t comp3 = c1[2] - c2[2];
-  real_t center_distance =
+  real_acc_t comp1 =
+      static_cast<real_acc_t>(c1[0]) - static_cast<real_acc_t>(c2[0]);
+  real_acc_t comp2 =
+      static_cast<real_acc_t>(c1[1]) - static_cast<real_acc_t>(c2[1]);
+  real_acc_t comp3 =
+      static_cast<real_acc_t>(c1[2]) - static_cast<real_acc_t>(c2[2]);
+  real_acc_t center_distance =
       std::sqrt(comp1 * comp1 + comp2 * comp2 + comp3 * comp3);
   // the overlap distance (how much one penetrates in the other)
-  real_t delta = r1 + r2 - center_distance;
+  real_acc_t delta = r1 + r2 - center_distance;
   // if no overlap : no force
   if (delta < 0) {
     *result = {0.0, 0.0, 0.0};
@@ -99,15 +199,15 @@ void InteractionForce::ForceBetweenSpheres(const Agent* sphere_lhs,
     return;
   }
   // the force itself
-  real_t r = (r1 * r2) / (r1 + r2);
-  real_t gamma = 1;  // attraction coeff
-  real_t k = 2;      // repulsion coeff
-  real_t f = k * delta - gamma * std::sqrt(r * delta);
-
-  real_t force_module = f / center_distance;
-  Real3 force2on1(
-      {force_module * comp1, force_module * comp2, force_module * comp3});
-  *result = force2on1;
+  real_acc_t r = (r1 * r2) / (r1 + r2);
+  real_acc_t gamma = 1;  // attraction coeff
+  real_acc_t k = 2;      // repulsion coeff
+  real_acc_t f = k * delta - gamma * std::sqrt(r * delta);
+
+  real_acc_t force_module = f / center_distance;
+  *result = {static_cast<real_t>(force_module * comp1),
+             static_cast<real_t>(force_module * comp2),
+             static_cast<real_t>(force_module * comp3)};
 }
 
 void InteractionForce::ForceOnACylinderFromASphere(const Agent* cylinder,
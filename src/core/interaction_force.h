@@ -16,8 +16,10 @@
 #define CORE_INTERACTION_FORCE_H_
 
 #include <array>
+#include <cstdint>
 
 #include "core/container/math_array.h"
+#include "core/container/math_array_3xn.h"
 
 namespace bdm {
 
@@ -29,6 +31,15 @@ class InteractionForce {
   virtual ~InteractionForce() = default;
 
   virtual Real4 Calculate(const Agent* lhs, const Agent* rhs) const;
+
+  /// Calculates the forces of `num_neighbors` agents `rhs` on `lhs` and
+  /// stores them in `results`. Returns the same values as calling `Calculate`
+  /// for each neighbor.\n
+  /// Forces between spheres are computed for `kSimdBatchSize` neighbors at a
+  /// time. If a subclass overrides `Calculate`, this function calls the
+  /// overridden `Calculate` for each neighbor instead.
+  virtual void CalculateBatch(const Agent* lhs, Agent* const* rhs,
+                              uint64_t num_neighbors, Real4* results) const;
   virtual InteractionForce* NewCopy() const {
     return new InteractionForce(*this);
   }
@@ -37,6 +48,11 @@ class InteractionForce {
   void ForceBetweenSpheres(const Agent* sphere_lhs, const Agent* sphere_rhs,
                            Real3* result) const;
 
+  /// Same as `ForceBetweenSpheres` for up to `kSimdBatchSize` neighbors.
+  void ForceBetweenSpheres(const Agent* sphere_lhs,
+                           const Agent* const* spheres_rhs, uint64_t num,
+                           Real4* results) const;
+
   void ForceOnACylinderFromASphere(const Agent* cylinder, const Agent* sphere,
                                    Real4* result) const;
 
@@ -0,0 +1,39 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/iteration_context.h"
+#include "core/scheduler.h"
+#include "core/simulation.h"
+
+namespace bdm {
+
+IterationContext::IterationContext(Simulation* sim, int thread_id)
+    : sim(sim),
+      param(sim->GetParam()),
+      scheduler(sim->GetScheduler()),
+      env(sim->GetEnvironment()),
+      exec_ctxt(sim->GetAllExecCtxts()[thread_id]),
+      random(sim->GetAllRandom()[thread_id]),
+      thread_id(thread_id),
+      step(sim->GetScheduler()->GetSimulatedSteps()),
+      dt(param->simulation_time_step) {
+  for (auto& el : param->groups_) {
+    if (el.first >= param_groups_.size()) {
+      param_groups_.resize(el.first + 1, nullptr);
+    }
+    param_groups_[el.first] = el.second;
+  }
+}
+
+}  // namespace bdm
@@ -0,0 +1,85 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_ITERATION_CONTEXT_H_
+#define CORE_ITERATION_CONTEXT_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "core/param/param.h"
+#include "core/real_t.h"
+#include "core/util/type.h"
+
+namespace bdm {
+
+class Environment;
+class ExecutionContext;
+class Random;
+class Scheduler;
+class Simulation;
+
+/// State of the current iteration for one thread.\n
+/// The scheduler creates one instance per thread at the beginning of each
+/// iteration and passes it to operations (`OperationImpl::operator()`) and
+/// behaviors (`Behavior::Run`) that override the overload with an
+/// `IterationContext` parameter. This avoids repeated lookups through
+/// `Simulation::GetActive()` in hot per-agent code.
+/// The members must not be modified.
+/// \code
+/// void Run(Agent* agent, const IterationContext& ctxt) override {
+///   auto time = ctxt.step * ctxt.dt;
+///   if (ctxt.random->Uniform() < 0.1) { ... }
+/// }
+/// \endcode
+struct IterationContext {
+  IterationContext() = default;
+
+  /// Collects the state of the current iteration of `sim` for the thread
+  /// `thread_id`.
+  IterationContext(Simulation* sim, int thread_id);
+
+  Simulation* sim = nullptr;
+  const Param* param = nullptr;
+  Scheduler* scheduler = nullptr;
+  Environment* env = nullptr;
+  /// Execution context of thread `thread_id`.
+  ExecutionContext* exec_ctxt = nullptr;
+  /// Random number generator of thread `thread_id`.
+  Random* random = nullptr;
+  int thread_id = 0;
+  /// Number of simulated steps at the beginning of the iteration
+  /// (`Scheduler::GetSimulatedSteps()`).
+  uint64_t step = 0;
+  /// `Param::simulation_time_step`
+  real_t dt = 0;
+
+  /// Same as `Param::Get<TParamGroup>()`, but without a hash map lookup.
+  template <typename TParamGroup>
+  const TParamGroup* GetParamGroup() const {
+    auto uid = TParamGroup::kUid;
+    if (uid < param_groups_.size() && param_groups_[uid] != nullptr) {
+      return bdm_static_cast<const TParamGroup*>(param_groups_[uid]);
+    }
+    return param->Get<TParamGroup>();
+  }
+
+ private:
+  /// Parameter groups of `param` indexed by their uid.
+  std::vector<const ParamGroup*> param_groups_;
+};
+
+}  // namespace bdm
+
+#endif  // CORE_ITERATION_CONTEXT_H_
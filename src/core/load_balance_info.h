@@ -17,6 +17,7 @@
 
 #include "core/agent/agent_handle.h"
 #include "core/functor.h"
+#include "core/real_t.h"
 #include "core/util/iterator.h"
 
 namespace bdm {
@@ -27,6 +28,16 @@ class LoadBalanceInfo {
   virtual void CallHandleIteratorConsumer(
       uint64_t start, uint64_t end,
       Functor<void, Iterator<AgentHandle>*>& f) const = 0;
+
+  /// Returns the number of agents (in the order of
+  /// `CallHandleIteratorConsumer`) whose estimated computational cost is
+  /// `fraction` of the total estimated cost.\n
+  /// Used if `Param::weighted_load_balancing` is set. Environments that do not
+  /// estimate costs treat all agents equally.
+  virtual uint64_t GetCostSplitPoint(real_t fraction,
+                                     uint64_t num_agents) const {
+    return static_cast<uint64_t>(fraction * num_agents);
+  }
 };
 
 }  // namespace bdm
@@ -25,6 +25,7 @@
 #include "core/diffusion/diffusion_grid.h"
 #include "core/resource_manager.h"
 #include "core/simulation.h"
+#include "core/util/parallel_csv_reader.h"
 #include "core/util/random.h"
 
 class EulerGrid;
@@ -135,6 +136,29 @@ struct ModelInitializer {
     }
   }
 
+  /// Creates one agent for each row of a CSV or TSV file and adds them to the
+  /// ExecutionContext. Rows are parsed and agents are created in parallel
+  /// without loading the whole table into memory.
+  ///
+  /// @param      reader        file that contains the agent attributes
+  /// @param      columns       names of the columns that are passed to
+  ///                           `agent_builder`
+  /// @param      agent_builder  function containing the logic to instantiate a
+  ///                           new agent. Takes `const std::vector<real_t>&`
+  ///                           with the values of `columns` as input parameter
+  ///
+  template <typename Function>
+  static void CreateAgentsFromCsv(const ParallelCSVReader& reader,
+                                  const std::vector<std::string>& columns,
+                                  Function agent_builder) {
+    reader.ForEachRow(columns,
+                      [&](uint64_t, const std::vector<real_t>& values) {
+                        auto* ctxt =
+                            Simulation::GetActive()->GetExecutionContext();
+                        ctxt->AddAgent(agent_builder(values));
+                      });
+  }
+
   /// Creates agents with random positions and adds them to the
   /// ExecutionContext. Agent creation is parallelized.
   ///
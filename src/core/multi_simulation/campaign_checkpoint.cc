@@ -0,0 +1,154 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/multi_simulation/campaign_checkpoint.h"
+
+#include <algorithm>
+#include <experimental/filesystem>
+#include <iterator>
+
+#include "core/util/log.h"
+#include "core/util/serialization.h"
+
+namespace fs = std::experimental::filesystem;
+
+namespace bdm {
+namespace experimental {
+
+// -----------------------------------------------------------------------------
+static constexpr char kMagic[8] = {'B', 'D', 'M', 'C', 'K', 'P', 'T', '1'};
+
+// -----------------------------------------------------------------------------
+/// FNV-1a hash. Unlike `std::hash`, the result does not depend on the
+/// standard library implementation.
+static uint64_t Fnv1a(const std::string& str) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : str) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// -----------------------------------------------------------------------------
+CampaignCheckpoint::CampaignCheckpoint(const std::string& file,
+                                       const std::string& default_params) {
+  std::vector<char> content;
+  {
+    std::ifstream ifs(file, std::ios::binary);
+    content.assign(std::istreambuf_iterator<char>(ifs),
+                   std::istreambuf_iterator<char>());
+  }
+
+  // The header consists of the magic number and the hash of the default
+  // parameters.
+  uint64_t hash = Fnv1a(default_params);
+  constexpr uint64_t kHeaderSize = sizeof(kMagic) + sizeof(uint64_t);
+  bool has_header = content.size() >= kHeaderSize;
+  if (has_header) {
+    if (!std::equal(kMagic, kMagic + sizeof(kMagic), content.begin())) {
+      Log::Fatal("CampaignCheckpoint", "The file ", file,
+                 " is not a checkpoint file.");
+    }
+    uint64_t file_hash;
+    BinaryReader reader(content.data() + sizeof(kMagic), sizeof(uint64_t));
+    reader.Read(file_hash);
+    if (file_hash != hash) {
+      Log::Fatal("CampaignCheckpoint", "The checkpoint file ", file,
+                 " has been written by a campaign with different default "
+                 "parameters. Remove the file, or specify another one.");
+    }
+  }
+
+  // Each record consists of its size followed by the patch and the result.
+  uint64_t pos = has_header ? kHeaderSize : 0;
+  while (has_header && content.size() - pos >= sizeof(uint64_t)) {
+    uint64_t record_size;
+    BinaryReader size_reader(content.data() + pos, sizeof(uint64_t));
+    size_reader.Read(record_size);
+    if (content.size() - pos - sizeof(uint64_t) < record_size) {
+      break;
+    }
+    BinaryReader reader(content.data() + pos + sizeof(uint64_t), record_size);
+    std::string patch;
+    std::vector<char> result;
+    reader.Read(patch, result);
+    entries_[patch].results.push_back(std::move(result));
+    size_++;
+    pos += sizeof(uint64_t) + record_size;
+  }
+
+  if (pos != content.size()) {
+    Log::Warning("CampaignCheckpoint",
+                 "Ignoring the incomplete last record of checkpoint file ",
+                 file);
+    // Drop the incomplete record, so that new records can be appended.
+    fs::resize_file(file, pos);
+  }
+  if (size_ != 0) {
+    Log::Info("CampaignCheckpoint", "Loaded ", size_,
+              " completed tasks from checkpoint file ", file);
+  }
+
+  file_.open(file, std::ios::binary | std::ios::app);
+  if (!file_) {
+    Log::Fatal("CampaignCheckpoint", "Could not open checkpoint file ", file);
+  }
+  if (!has_header) {
+    file_.write(kMagic, sizeof(kMagic));
+    file_.write(reinterpret_cast<const char*>(&hash), sizeof(uint64_t));
+    file_.flush();
+  }
+}
+
+// -----------------------------------------------------------------------------
+bool CampaignCheckpoint::Lookup(const std::string& patch,
+                                std::vector<char>* result) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& entry = entries_[patch];
+  if (entry.num_lookups >= entry.results.size()) {
+    return false;
+  }
+  *result = entry.results[entry.num_lookups++];
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+void CampaignCheckpoint::Append(const std::string& patch,
+                                const std::vector<char>& result) {
+  std::vector<char> record;
+  BinaryWriter writer(&record);
+  writer.Write(patch, result);
+  uint64_t record_size = record.size();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  file_.write(reinterpret_cast<const char*>(&record_size), sizeof(uint64_t));
+  file_.write(record.data(), record.size());
+  file_.flush();
+  auto& entry = entries_[patch];
+  entry.results.push_back(result);
+  // This result has been created in this run and must not be returned by
+  // `Lookup`.
+  entry.num_lookups++;
+  size_++;
+}
+
+// -----------------------------------------------------------------------------
+uint64_t CampaignCheckpoint::Size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+}  // namespace experimental
+}  // namespace bdm
@@ -0,0 +1,76 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_MULTI_SIMULATION_CAMPAIGN_CHECKPOINT_H_
+#define CORE_MULTI_SIMULATION_CAMPAIGN_CHECKPOINT_H_
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bdm {
+namespace experimental {
+
+/// Records the results of completed multi-simulation tasks in a file, so that
+/// a restarted campaign does not have to run them again.\n
+/// A task is identified by the JSON merge patch of its parameters. The same
+/// parameters can be dispatched several times (e.g. repetitions of an
+/// experiment). Therefore, the n-th lookup of a patch returns the n-th
+/// recorded result of this patch.\n
+/// Records are appended to the file as soon as a task completes. An
+/// incomplete last record, which is left behind if the manager dies while
+/// writing it, is ignored.\n
+/// The file starts with a hash of the default parameters of the campaign.
+/// A file that has been written by a campaign with different default
+/// parameters is rejected, because its results would not match the patches.\n
+/// All member functions are thread-safe.
+class CampaignCheckpoint {
+ public:
+  /// Loads all records that are already stored in `file`.
+  /// `default_params` is the JSON representation of the default parameters,
+  /// to which the patches of the records refer.
+  CampaignCheckpoint(const std::string& file,
+                     const std::string& default_params);
+
+  /// Stores the next recorded result for `patch` in `result` and returns
+  /// true. Returns false if all results of `patch` have already been
+  /// returned.
+  bool Lookup(const std::string& patch, std::vector<char>* result);
+
+  /// Appends the result of a completed task to the file.
+  void Append(const std::string& patch, const std::vector<char>& result);
+
+  /// Returns the number of records.
+  uint64_t Size() const;
+
+ private:
+  struct Entry {
+    std::vector<std::vector<char>> results;
+    /// Number of results that have been returned by `Lookup`
+    uint64_t num_lookups = 0;
+  };
+
+  std::unordered_map<std::string, Entry> entries_;
+  uint64_t size_ = 0;
+  std::ofstream file_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace experimental
+}  // namespace bdm
+
+#endif  // CORE_MULTI_SIMULATION_CAMPAIGN_CHECKPOINT_H_
@@ -18,8 +18,6 @@
 #include <functional>
 #include <vector>
 
-#include "TMath.h"
-
 #include "core/analysis/time_series.h"
 #include "core/functor.h"
 #include "core/multi_simulation/database.h"
@@ -59,12 +57,7 @@ inline real_t Experiment(
 
   // Compute the mean result values of the N iterations
   TimeSeries simulated;
-  TimeSeries::Merge(&simulated, results,
-                    [](const std::vector<real_t> all_y_values, real_t* y,
-                       real_t* eh, real_t* el) {
-                      *y =
-                          TMath::Mean(all_y_values.begin(), all_y_values.end());
-                    });
+  TimeSeries::Merge(&simulated, results, TimeSeries::MergeReducer::kMean);
 
   // Execute post-simulation lambda (e.g. plotting or exporting of simulated
   // data)
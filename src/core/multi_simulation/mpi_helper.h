@@ -74,6 +74,25 @@ T* MPI_Recv_Obj_ROOT(int size, int source, int tag,
   return obj;
 }
 
+/// Send a raw byte buffer. Like `MPI_Send_Obj_ROOT` the size of the buffer
+/// is sent first.
+inline int MPI_Send_Buffer(const std::vector<char>& buffer, int dest,
+                           int tag) {
+  int size = buffer.size();
+  MPI_Send(&size, 1, MPI_INT, dest, tag, MPI_COMM_WORLD);
+  return MPI_Send(buffer.data(), size, MPI_BYTE, dest, tag, MPI_COMM_WORLD);
+}
+
+/// Receive a raw byte buffer of the given size that has been sent with
+/// `MPI_Send_Buffer`.
+inline std::vector<char> MPI_Recv_Buffer(
+    int size, int source, int tag, MPI_Status* status = MPI_STATUS_IGNORE) {
+  std::vector<char> buffer(size);
+  MPI_Recv(buffer.data(), size, MPI_BYTE, source, tag, MPI_COMM_WORLD,
+           status);
+  return buffer;
+}
+
 #endif  // __ROOTCLING__
 
 }  // namespace experimental
@@ -14,6 +14,9 @@
 
 #ifdef USE_MPI
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
 #include "mpi.h"
@@ -23,6 +26,9 @@
 #include "core/multi_simulation/multi_simulation_manager.h"
 #include "core/multi_simulation/optimization_param.h"
 #include "core/scheduler.h"
+#include "core/util/compression.h"
+#include "core/util/serialization.h"
+#include "core/util/string.h"
 #include "core/util/timing.h"
 
 using std::cout;
@@ -47,6 +53,7 @@ MultiSimulationManager::MultiSimulationManager(
   Log("Started Master process");
   availability_.resize(ws);
   timings_.resize(ws);
+  partial_results_.resize(ws);
 }
 
 void MultiSimulationManager::WriteTimingsToFile() {
@@ -76,9 +83,12 @@ void MultiSimulationManager::RecordTiming(int worker, TimingAggregator *agg) {
   timings_[worker] = *agg;
 }
 
-// Send kill message to all workers
+// Send kill message to all workers that have not been lost
 void MultiSimulationManager::KillAllWorkers() {
   ForAllWorkers([&](int worker) {
+    if (availability_[worker] == Status::kLost) {
+      return;
+    }
     {
       Timing t_mpi("MPI_CALL", &ta_);
       MPI_Send(nullptr, 0, MPI_INT, worker, Tag::kKill, MPI_COMM_WORLD);
@@ -86,20 +96,32 @@ void MultiSimulationManager::KillAllWorkers() {
   });
 }
 
-// Receive timing objects of all workers
+// Receive timing objects of all workers that have not been lost
 void MultiSimulationManager::GetTimingsFromWorkers() {
   ForAllWorkers([&](int worker) {
+    if (availability_[worker] == Status::kLost) {
+      return;
+    }
     int size;
-    MPI_Status status;
     {
       Timing t_mpi("MPI_CALL", &ta_);
-      MPI_Recv(&size, 1, MPI_INT, MPI_ANY_SOURCE, Tag::kKill, MPI_COMM_WORLD,
-               &status);
+      MPI_Recv(&size, 1, MPI_INT, worker, Tag::kKill, MPI_COMM_WORLD,
+               MPI_STATUS_IGNORE);
     }
-    TimingAggregator *agg = MPI_Recv_Obj_ROOT<TimingAggregator>(
-        size, status.MPI_SOURCE, Tag::kKill);
-    RecordTiming(status.MPI_SOURCE, agg);
+    auto buffer = MPI_Recv_Buffer(size, worker, Tag::kKill);
+    TimingAggregator agg;
+    BinaryReader reader(buffer.data(), buffer.size());
+    agg.ReadBinary(&reader);
+    RecordTiming(worker, &agg);
+  });
+}
+
+void MultiSimulationManager::SendDefaultParams() {
+  ForAllWorkers([&](int worker) {
+    Timing t_mpi("MPI_CALL", &ta_);
+    MPI_Send_Obj_ROOT(default_params_, worker, Tag::kParams);
   });
+  default_params_json_ = default_params_->ToJsonString();
 }
 
 int MultiSimulationManager::Start() {
@@ -113,6 +135,18 @@ int MultiSimulationManager::Start() {
     // reached
     ForAllWorkers(
         [&](int worker) { ChangeStatusWorker(worker, Status::kAvail); });
+    if (worldsize_ > 1) {
+      SendDefaultParams();
+    }
+
+    // From default_params read out the OptimizationParam section to
+    // determine the algorithm type: e.g. ParameterSweep, Differential
+    // Evolution, Particle Swarm Optimization
+    OptimizationParam *opt_params = default_params_->Get<OptimizationParam>();
+    if (worldsize_ > 1 && !opt_params->checkpoint_file.empty()) {
+      checkpoint_.reset(new CampaignCheckpoint(opt_params->checkpoint_file,
+                                               default_params_json_));
+    }
 
     auto dispatch_experiment =
         L2F([&](Param *final_params, TimeSeries *result) {
@@ -121,47 +155,42 @@ int MultiSimulationManager::Start() {
           if (worldsize_ == 1) {
             simulate_(final_params, result);
           } else {  // Otherwise we dispatch the work to the worker(s)
-            auto worker = GetFirstAvailableWorker();
-
-            // If there is no available worker, wait for one to finish
-            while (worker == -1) {
-              std::this_thread::sleep_for(std::chrono::milliseconds(100));
-              worker = GetFirstAvailableWorker();
-            }
-
-            // Send parameters to worker
-            {
-              Timing t_mpi("MPI_CALL", &ta_);
-              MPI_Send_Obj_ROOT(final_params, worker, Tag::kTask);
+            // The difference to the default parameters identifies the task
+            auto patch = final_params->GetJsonMergePatch(default_params_json_);
+            std::vector<char> buffer;
+            if (checkpoint_ && checkpoint_->Lookup(patch, &buffer)) {
+              Log("Skipping task that has been completed in a previous run");
+            } else {
+              // Re-dispatch the task if its worker gets lost
+              for (int attempt = 0;; attempt++) {
+                auto worker = WaitForAvailableWorker();
+                if (RunTask(worker, patch, &buffer)) {
+                  ChangeStatusWorker(worker, Status::kAvail);
+                  break;
+                }
+                ChangeStatusWorker(worker, Status::kLost);
+                if (attempt >= opt_params->max_task_retries) {
+                  Log::Fatal("MultiSimulationManager",
+                             "Task has been lost ", attempt + 1,
+                             " times. Giving up.");
+                }
+                Log("Re-dispatching task of lost worker " + to_string(worker));
+              }
+              if (checkpoint_) {
+                checkpoint_->Append(patch, buffer);
+              }
             }
 
-            // Wait for results
-            MPI_Status status;
-            {
-              int size;
-              MPI_Recv(&size, 1, MPI_INT, worker, Tag::kResult, MPI_COMM_WORLD,
-                       &status);
-              string msg = "Receiving results from worker " +
-                           to_string(status.MPI_SOURCE);
-              Log(msg);
-              Timing t_mpi("MPI_CALL", &ta_);
-              TimeSeries *tmp_result =
-                  MPI_Recv_Obj_ROOT<TimeSeries>(size, worker, Tag::kResult);
-              msg = "Successfully received results from worker " +
-                    to_string(status.MPI_SOURCE);
-              Log(msg);
-              *result = *tmp_result;
-              delete tmp_result;
+            // Some algorithms are not interested in the results
+            if (result != nullptr) {
+              std::vector<char> data;
+              Decompress(buffer.data(), buffer.size(), &data);
+              BinaryReader reader(data.data(), data.size());
+              result->ReadBinary(&reader);
             }
-
-            ChangeStatusWorker(status.MPI_SOURCE, Status::kAvail);
           }
         });
 
-    // From default_params read out the OptimizationParam section to
-    // determine the algorithm type: e.g. ParameterSweep, Differential
-    // Evolution, Particle Swarm Optimization
-    OptimizationParam *opt_params = default_params_->Get<OptimizationParam>();
     auto algorithm = CreateOptimizationAlgorithm(opt_params);
 
     if (algorithm) {
@@ -180,6 +209,15 @@ int MultiSimulationManager::Start() {
   // Write all timing info to file
   WriteTimingsToFile();
 
+  // Lost workers do not respond to the kill message and would block
+  // MPI_Finalize.
+  if (auto num_lost = GetNumLostWorkers()) {
+    Log::Warning("MultiSimulationManager", num_lost,
+                 " worker(s) have been lost during the campaign. Aborting "
+                 "them.");
+    MPI_Abort(MPI_COMM_WORLD, 0);
+  }
+
   return 0;
 }
 
@@ -189,7 +227,8 @@ int MultiSimulationManager::GetFirstAvailableWorker() {
   int ret = -1;
 #pragma omp critical
   {
-    auto it = std::find(begin(availability_), end(availability_), true);
+    auto it =
+        std::find(begin(availability_), end(availability_), Status::kAvail);
     if (it != end(availability_)) {
       ret = std::distance(begin(availability_), it);
       ChangeStatusWorker(ret, Status::kBusy);
@@ -198,6 +237,95 @@ int MultiSimulationManager::GetFirstAvailableWorker() {
   return ret;
 }
 
+// Waits until a worker becomes available and returns its ID. Stops the
+// campaign if all workers have been lost.
+int MultiSimulationManager::WaitForAvailableWorker() {
+  auto worker = GetFirstAvailableWorker();
+  while (worker == -1) {
+    if (GetNumLostWorkers() == worldsize_ - 1) {
+      Log::Fatal("MultiSimulationManager",
+                 "All workers have been lost. Completed tasks have been "
+                 "recorded in OptimizationParam::checkpoint_file if it has "
+                 "been set.");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    worker = GetFirstAvailableWorker();
+  }
+  return worker;
+}
+
+// Returns true if `timeout` seconds have passed since `start`. A timeout of
+// zero never expires.
+static bool Expired(std::chrono::steady_clock::time_point start,
+                    double timeout) {
+  if (timeout <= 0) {
+    return false;
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() > timeout;
+}
+
+bool MultiSimulationManager::RunTask(int worker, const std::string &patch,
+                                     std::vector<char> *result) {
+  auto *opt_params = default_params_->Get<OptimizationParam>();
+  // Send the difference to the default parameters to the worker
+  {
+    Timing t_mpi("MPI_CALL", &ta_);
+    MPI_Send_Buffer(std::vector<char>(patch.begin(), patch.end()), worker,
+                    Tag::kTask);
+  }
+
+  // Wait for results. Heartbeats and partial results might arrive
+  // beforehand. Probe instead of blocking, to detect lost workers.
+  auto start = std::chrono::steady_clock::now();
+  auto last_message = start;
+  while (true) {
+    int flag;
+    MPI_Status status;
+    MPI_Iprobe(worker, MPI_ANY_TAG, MPI_COMM_WORLD, &flag, &status);
+    if (!flag) {
+      if (Expired(start, opt_params->task_timeout)) {
+        Log("Worker " + to_string(worker) + " exceeded the task deadline");
+        return false;
+      }
+      if (Expired(last_message, opt_params->heartbeat_timeout)) {
+        Log("Worker " + to_string(worker) + " stopped sending heartbeats");
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      continue;
+    }
+
+    last_message = std::chrono::steady_clock::now();
+    if (status.MPI_TAG == Tag::kHeartbeat) {
+      MPI_Recv(nullptr, 0, MPI_INT, worker, Tag::kHeartbeat, MPI_COMM_WORLD,
+               MPI_STATUS_IGNORE);
+      continue;
+    }
+    int size;
+    MPI_Recv(&size, 1, MPI_INT, worker, status.MPI_TAG, MPI_COMM_WORLD,
+             MPI_STATUS_IGNORE);
+    if (status.MPI_TAG == Tag::kPartialResult) {
+      ReceivePartialResult(worker, size);
+      continue;
+    }
+
+    Log("Receiving results from worker " + to_string(worker));
+    {
+      Timing t_mpi("MPI_CALL", &ta_);
+      *result = MPI_Recv_Buffer(size, worker, Tag::kResult);
+    }
+    Log("Successfully received results from worker " + to_string(worker));
+    return true;
+  }
+}
+
+// Returns the number of workers that have been lost
+int MultiSimulationManager::GetNumLostWorkers() const {
+  return std::count(begin(availability_), end(availability_), Status::kLost);
+}
+
 // Changes the status of a worker
 void MultiSimulationManager::ChangeStatusWorker(int worker, Status s) {
   std::stringstream msg;
@@ -215,6 +343,73 @@ void MultiSimulationManager::ForAllWorkers(
   }
 }
 
+void MultiSimulationManager::ReceivePartialResult(int worker, int size) {
+  std::vector<char> buffer(size);
+  {
+    Timing t_mpi("MPI_CALL", &ta_);
+    MPI_Recv(buffer.data(), size, MPI_BYTE, worker, Tag::kPartialResult,
+             MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  }
+  // Only one task is dispatched to a worker at a time. Therefore, there is no
+  // concurrent access to the same element of partial_results_.
+  auto &sink = partial_results_[worker];
+  if (!sink) {
+    sink.reset(new CsvTimeSeriesSink(Concat(
+        "w", worker, "-", default_params_->time_series_stream_file)));
+  }
+  sink->Write(TimeSeriesSink::Unpack(buffer.data(), size));
+  sink->Flush();
+}
+
+/// Sends the data points collected by a worker to the master.
+class MpiTimeSeriesSink : public TimeSeriesSink {
+ public:
+  void Write(const std::vector<TimeSeriesPoint> &batch) override {
+    auto buffer = Pack(batch);
+    int size = buffer.size();
+    MPI_Send(&size, 1, MPI_INT, kMaster, Tag::kPartialResult, MPI_COMM_WORLD);
+    MPI_Send(buffer.data(), size, MPI_BYTE, kMaster, Tag::kPartialResult,
+             MPI_COMM_WORLD);
+  }
+};
+
+/// Signals the master periodically that the worker is still alive, as long as
+/// this object exists.
+/// \see OptimizationParam::heartbeat_interval
+class HeartbeatSender {
+ public:
+  explicit HeartbeatSender(double interval) {
+    if (interval <= 0) {
+      return;
+    }
+    thread_ = std::thread([this, interval]() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      auto period = std::chrono::duration<double>(interval);
+      while (!cv_.wait_for(lock, period, [this]() { return stop_; })) {
+        MPI_Send(nullptr, 0, MPI_INT, kMaster, Tag::kHeartbeat,
+                 MPI_COMM_WORLD);
+      }
+    });
+  }
+
+  ~HeartbeatSender() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+  }
+
+ private:
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+};
+
 /// The Worker class in a Master-Worker design pattern.
 Worker::Worker(int myrank, std::function<void(Param *, TimeSeries *)> simulate)
     : myrank_(myrank), simulate_(simulate) {
@@ -245,29 +440,65 @@ int Worker::Start() {
 
     // The tag tells us what kind of message we received from Master
     switch (status.MPI_TAG) {
+      case Tag::kParams: {
+        Timing t("MPI_CALL", &ta_);
+        default_params_.reset(
+            MPI_Recv_Obj_ROOT<Param>(size, kMaster, Tag::kParams));
+        break;
+      }
       case Tag::kTask: {
-        Param *params = nullptr;
+        if (!default_params_) {
+          Log("Received a task before the default parameters. Stopping...");
+          return 1;
+        }
+        std::vector<char> patch;
         {
           Timing t("MPI_CALL", &ta_);
-          params = MPI_Recv_Obj_ROOT<Param>(size, kMaster, Tag::kTask);
+          patch = MPI_Recv_Buffer(size, kMaster, Tag::kTask);
+        }
+        Param params(*default_params_);
+        std::string patch_str(patch.begin(), patch.end());
+        if (patch_str != "{}") {
+          params.MergeJsonPatch(patch_str);
+        }
+        // Stream the data points collected during the simulation to the
+        // master, if requested. The simulation waits for all partial results
+        // to be sent before it returns.
+        if (!params.time_series_stream_file.empty()) {
+          TimeSeriesSink::SetFactory([]() { return new MpiTimeSeriesSink(); });
+        } else {
+          TimeSeriesSink::SetFactory(nullptr);
         }
         TimeSeries result;
         {
+          HeartbeatSender heartbeat(
+              params.Get<OptimizationParam>()->heartbeat_interval);
           Timing sim("SIMULATE", &ta_);
-          simulate_(params, &result);
+          simulate_(&params, &result);
         }
         IncrementTaskCount();
         {
           Timing t("MPI_CALL", &ta_);
           Log("Sending back results");
-          MPI_Send_Obj_ROOT(&result, kMaster, Tag::kResult);
+          auto *opt_params = default_params_->Get<OptimizationParam>();
+          std::vector<char> data;
+          BinaryWriter writer(&data);
+          result.WriteBinary(&writer, opt_params->result_columns);
+          std::vector<char> buffer;
+          Compress(data.data(), data.size(), opt_params->result_compression,
+                   &buffer);
+          MPI_Send_Buffer(buffer, kMaster, Tag::kResult);
         }
         break;
       }
-      case Tag::kKill:
+      case Tag::kKill: {
         // Send back the timing results to the master for writing to file
-        MPI_Send_Obj_ROOT<TimingAggregator>(&ta_, kMaster, Tag::kKill);
+        std::vector<char> buffer;
+        BinaryWriter writer(&buffer);
+        ta_.WriteBinary(&writer);
+        MPI_Send_Buffer(buffer, kMaster, Tag::kKill);
         return 0;
+      }
       default:
         Log("Received unknown message tag. Stopping...");
         return 1;
@@ -21,13 +21,17 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include "core/analysis/time_series.h"
+#include "core/analysis/time_series_sink.h"
 #include "core/multi_simulation/algorithm/algorithm_registry.h"
+#include "core/multi_simulation/campaign_checkpoint.h"
 #include "core/multi_simulation/dynamic_loop.h"
+#include "core/param/param.h"
 #include "core/util/timing_aggregator.h"
 
 using std::cout;
@@ -41,8 +45,16 @@ namespace experimental {
 
 static const unsigned int kMaster = 0;
 
-enum Status { kBusy, kAvail };
-enum Tag { kReady, kResult, kTask, kKill };
+enum Status { kBusy, kAvail, kLost };
+enum Tag {
+  kReady,
+  kResult,
+  kTask,
+  kKill,
+  kPartialResult,
+  kParams,
+  kHeartbeat
+};
 
 /// The Master in a Master-Worker design pattern. Maintains the status of all
 /// the workers in the multi-simulation runtime.
@@ -63,10 +75,10 @@ class MultiSimulationManager {
   // Copy the timing results of the specified worker
   void RecordTiming(int worker, TimingAggregator *agg);
 
-  // Send kill message to all workers
+  // Send kill message to all workers that have not been lost
   void KillAllWorkers();
 
-  // Receive timing objects of all workers
+  // Receive timing objects of all workers that have not been lost
   void GetTimingsFromWorkers();
 
   int Start();
@@ -77,6 +89,21 @@ class MultiSimulationManager {
   // there is no available worker.
   int GetFirstAvailableWorker();
 
+  // Waits until a worker becomes available and returns its ID. Stops the
+  // campaign if all workers have been lost.
+  int WaitForAvailableWorker();
+
+  // Sends the task with the given parameter patch to `worker` and waits for
+  // the encoded result. Returns false if the task exceeds its deadline or
+  // the worker stops sending heartbeats.
+  // \see OptimizationParam::task_timeout
+  // \see OptimizationParam::heartbeat_timeout
+  bool RunTask(int worker, const std::string &patch,
+               std::vector<char> *result);
+
+  // Returns the number of workers that have been lost
+  int GetNumLostWorkers() const;
+
   // Changes the status
   void ChangeStatusWorker(int worker, Status s);
 
@@ -84,12 +111,27 @@ class MultiSimulationManager {
   // because 0 is the master's ID.
   void ForAllWorkers(const std::function<void(int w)> &lambda);
 
+  // Receives a batch of data points that the worker collected so far and
+  // appends it to the worker's partial result file.
+  // \see Param::time_series_stream_file
+  void ReceivePartialResult(int worker, int size);
+
+  // Sends the default parameters to all workers. Tasks only contain the
+  // difference to these parameters.
+  void SendDefaultParams();
+
   vector<Status> availability_;
   int worldsize_;
   TimingAggregator ta_;
   Param *default_params_;
+  // JSON representation of `default_params_` as known by the workers
+  std::string default_params_json_;
   std::function<void(Param *, TimeSeries *)> simulate_;
   std::vector<TimingAggregator> timings_;
+  // One file per worker for the streamed partial results
+  std::vector<std::unique_ptr<CsvTimeSeriesSink>> partial_results_;
+  // Results of completed tasks (\see OptimizationParam::checkpoint_file)
+  std::unique_ptr<CampaignCheckpoint> checkpoint_;
 };
 
 /// The Worker class in a Master-Worker design pattern of the multi-simulation
@@ -112,6 +154,8 @@ class Worker {
   void IncrementTaskCount();
 
   int myrank_;
+  // Parameters that the tasks of the master are applied to
+  std::unique_ptr<Param> default_params_;
   unsigned int task_count_ = 0;
   std::function<void(Param *, TimeSeries *)> simulate_;
   TimingAggregator ta_;
@@ -22,7 +22,7 @@
 namespace bdm {
 
 struct OptimizationParam : public ParamGroup {
-  BDM_PARAM_GROUP_HEADER(OptimizationParam, 1);
+  BDM_PARAM_GROUP_HEADER(OptimizationParam, 3);
 
   OptimizationParam(const OptimizationParam& other) {
     this->params.resize(other.params.size());
@@ -33,6 +33,14 @@ struct OptimizationParam : public ParamGroup {
     }
     this->algorithm = other.algorithm;
     this->repetition = other.repetition;
+    this->max_iterations = other.max_iterations;
+    this->result_columns = other.result_columns;
+    this->result_compression = other.result_compression;
+    this->task_timeout = other.task_timeout;
+    this->heartbeat_interval = other.heartbeat_interval;
+    this->heartbeat_timeout = other.heartbeat_timeout;
+    this->max_task_retries = other.max_task_retries;
+    this->checkpoint_file = other.checkpoint_file;
   }
 
   std::string algorithm;
@@ -41,6 +49,30 @@ struct OptimizationParam : public ParamGroup {
   size_t repetition = 1;
   // Maximum number of optimization iterations
   size_t max_iterations = 100;
+  // TimeSeries entries that workers send back to the master. All entries are
+  // sent if empty.
+  std::vector<std::string> result_columns;
+  // Compression setting for the results that workers send back to the
+  // master. Uses the same encoding as ROOT files (e.g. 404 for LZ4 with
+  // level 4). 0 disables compression.
+  int result_compression = 0;
+  // Maximum wall-clock time in seconds that a worker may spend on a task.
+  // Afterwards, the worker is considered lost and the task is dispatched to
+  // another worker. 0 disables the deadline.
+  double task_timeout = 0;
+  // Interval in seconds in which busy workers signal the master that they
+  // are still alive.
+  double heartbeat_interval = 1;
+  // Time in seconds without any message from a busy worker after which the
+  // worker is considered lost. 0 disables the check.
+  double heartbeat_timeout = 0;
+  // Number of times a task is dispatched to another worker after its worker
+  // has been lost.
+  int max_task_retries = 3;
+  // File in which the results of completed tasks are recorded. A restarted
+  // campaign with the same checkpoint file does not dispatch these tasks
+  // again. Checkpointing is disabled if empty.
+  std::string checkpoint_file;
 };
 
 }  // namespace bdm
@@ -0,0 +1,49 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_OPERATION_COMPACT_AGENT_UIDS_OP_H_
+#define CORE_OPERATION_COMPACT_AGENT_UIDS_OP_H_
+
+#include "core/agent/agent_uid_generator.h"
+#include "core/operation/operation.h"
+#include "core/param/param.h"
+#include "core/resource_manager.h"
+#include "core/simulation.h"
+
+namespace bdm {
+
+/// An operation that renumbers the AgentUid indices densely if the highest
+/// index exceeds the number of agents by more than
+/// `Param::agent_uid_compaction_threshold`.
+/// \see `ResourceManager::CompactAgentUids`
+struct CompactAgentUidsOp : public StandaloneOperationImpl {
+  BDM_OP_HEADER(CompactAgentUidsOp);
+
+  void operator()() override {
+    auto* sim = Simulation::GetActive();
+    auto threshold = sim->GetParam()->agent_uid_compaction_threshold;
+    if (threshold <= 0) {
+      return;
+    }
+    auto* rm = sim->GetResourceManager();
+    auto highest_idx = sim->GetAgentUidGenerator()->GetHighestIndex();
+    if (highest_idx > threshold * rm->GetNumAgents()) {
+      rm->CompactAgentUids();
+    }
+  }
+};
+
+}  // namespace bdm
+
+#endif  // CORE_OPERATION_COMPACT_AGENT_UIDS_OP_H_
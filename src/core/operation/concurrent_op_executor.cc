@@ -0,0 +1,106 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/operation/concurrent_op_executor.h"
+#include <algorithm>
+#include <omp.h>
+#include "core/operation/operation.h"
+#include "core/util/timing.h"
+#include "core/util/timing_aggregator.h"
+
+namespace bdm {
+
+// -----------------------------------------------------------------------------
+ConcurrentOpExecutor::ConcurrentOpExecutor(uint64_t num_threads)
+    : num_threads_(std::max<uint64_t>(num_threads, 1)),
+      thread_([this]() { Run(); }) {}
+
+// -----------------------------------------------------------------------------
+ConcurrentOpExecutor::~ConcurrentOpExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+}
+
+// -----------------------------------------------------------------------------
+void ConcurrentOpExecutor::Launch(Operation* op) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back({op, op->name_, [op]() { (*op)(); }});
+    pending_.push_back(op);
+  }
+  cv_.notify_all();
+}
+
+// -----------------------------------------------------------------------------
+void ConcurrentOpExecutor::Launch(const std::string& name,
+                                  const std::function<void()>& task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back({nullptr, name, task});
+    pending_.push_back(nullptr);
+  }
+  cv_.notify_all();
+}
+
+// -----------------------------------------------------------------------------
+bool ConcurrentOpExecutor::IsRunning(const Operation* op) {
+  if (op == nullptr) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::find(pending_.begin(), pending_.end(), op) != pending_.end();
+}
+
+// -----------------------------------------------------------------------------
+void ConcurrentOpExecutor::Wait(TimingAggregator* timings) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this]() { return pending_.empty(); });
+  if (timings != nullptr) {
+    for (auto& entry : durations_) {
+      timings->AddEntry(entry.first, entry.second);
+    }
+  }
+  durations_.clear();
+}
+
+// -----------------------------------------------------------------------------
+void ConcurrentOpExecutor::Run() {
+  // The OpenMP thread team of this thread is created at the first parallel
+  // region and reused afterwards.
+  omp_set_num_threads(num_threads_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      // stop_ is set and all operations have been executed
+      return;
+    }
+    auto task = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    auto start = Timing::Timestamp();
+    task.function();
+    auto duration = Timing::Timestamp() - start;
+    lock.lock();
+    durations_.emplace_back(task.name, duration);
+    pending_.erase(std::find(pending_.begin(), pending_.end(), task.op));
+    cv_.notify_all();
+  }
+}
+
+}  // namespace bdm
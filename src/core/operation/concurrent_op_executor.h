@@ -0,0 +1,91 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_OPERATION_CONCURRENT_OP_EXECUTOR_H_
+#define CORE_OPERATION_CONCURRENT_OP_EXECUTOR_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace bdm {
+
+struct Operation;
+class TimingAggregator;
+
+/// Executes operations on a persistent background thread, while the main
+/// thread continues with the next operations of the iteration.\n
+/// The background thread is created once and reused in every iteration.
+/// It has its own OpenMP thread team, which is independent of the thread
+/// team of the main thread. The OpenMP thread ids of both teams overlap.
+/// Hence, tasks must not use state that is indexed by the thread id
+/// (see `OperationImpl::SupportsConcurrentExecution`).\n
+/// Used by the `Scheduler` for the operations listed in
+/// `Param::concurrent_ops`.
+class ConcurrentOpExecutor {
+ public:
+  explicit ConcurrentOpExecutor(uint64_t num_threads);
+  ~ConcurrentOpExecutor();
+
+  ConcurrentOpExecutor(const ConcurrentOpExecutor&) = delete;
+  ConcurrentOpExecutor& operator=(const ConcurrentOpExecutor&) = delete;
+
+  /// Enqueues `op` and returns immediately.
+  /// Operations are executed in the order in which they were launched.
+  void Launch(Operation* op);
+
+  /// Enqueues `task` and returns immediately. `name` is used for the
+  /// execution time statistics.
+  void Launch(const std::string& name, const std::function<void()>& task);
+
+  /// Returns true if `op` has been launched and has not finished yet.
+  bool IsRunning(const Operation* op);
+
+  /// Blocks until all launched operations have finished.
+  /// If `timings` is not a nullptr, the execution times of the finished
+  /// operations are added to it. Thus, the (non thread-safe) aggregator is
+  /// only modified by the calling thread.
+  void Wait(TimingAggregator* timings = nullptr);
+
+ private:
+  struct Task {
+    /// Identifies the launched operation. Is a nullptr for other tasks.
+    const Operation* op;
+    std::string name;
+    std::function<void()> function;
+  };
+
+  uint64_t num_threads_;
+  std::deque<Task> queue_;
+  /// Tasks that have been launched, but have not finished yet.
+  std::vector<const Operation*> pending_;
+  /// Execution times (name, duration in ms) of finished operations.
+  std::vector<std::pair<std::string, int64_t>> durations_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+  std::thread thread_;
+
+  void Run();
+};
+
+}  // namespace bdm
+
+#endif  // CORE_OPERATION_CONCURRENT_OP_EXECUTOR_H_
@@ -15,6 +15,8 @@
 #ifndef CORE_OPERATION_DIFFUSION_OP_H_
 #define CORE_OPERATION_DIFFUSION_OP_H_
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -22,10 +24,12 @@
 #include "core/container/inline_vector.h"
 #include "core/diffusion/diffusion_grid.h"
 #include "core/environment/environment.h"
+#include "core/operation/concurrent_op_executor.h"
 #include "core/operation/operation.h"
 #include "core/operation/operation_registry.h"
 #include "core/param/param.h"
 #include "core/resource_manager.h"
+#include "core/scheduler.h"
 #include "core/simulation.h"
 #include "core/util/log.h"
 
@@ -36,45 +40,133 @@ class ContinuumOp : public StandaloneOperationImpl {
   BDM_OP_HEADER(ContinuumOp);
 
  public:
+  /// Updates the continuum dimensions before the operation is executed.
+  /// Thus, `operator()` does not access the environment and can run
+  /// concurrently with the environment update (see `Param::concurrent_ops`).
+  /// Launches the integration of asynchronously coupled diffusion grids
+  /// (see `DiffusionGrid::SetMaxStaleness`), which overlaps with the agent
+  /// operations.
+  void SetUp() override {
+    UpdateDimensions();
+    UpdateTimeStep();
+    set_up_ = true;
+    if (delta_t_ == 0.0) {
+      return;
+    }
+
+    auto* sim = Simulation::GetActive();
+    const auto* param = sim->GetParam();
+    async_grids_.clear();
+    sim->GetResourceManager()->ForEachContinuum([this](Continuum* cm) {
+      auto* dgrid = dynamic_cast<DiffusionGrid*>(cm);
+      if (dgrid && dgrid->IsAsynchronouslyCoupled()) {
+        async_grids_.push_back(dgrid);
+      }
+    });
+    if (async_grids_.empty()) {
+      return;
+    }
+
+    if (!executor_) {
+      executor_ =
+          std::make_shared<ConcurrentOpExecutor>(param->concurrent_op_threads);
+    }
+    for (auto* dgrid : async_grids_) {
+      dgrid->BeginAsynchronousStep();
+    }
+    auto grids = async_grids_;
+    auto delta_t = delta_t_;
+    bool calculate_gradients = param->calculate_gradients;
+    executor_->Launch("continuum (asynchronous)", [=]() {
+      for (auto* dgrid : grids) {
+        dgrid->IntegrateTimeAsynchronously(delta_t);
+        if (calculate_gradients) {
+          dgrid->CalculateGradient();
+        }
+      }
+    });
+  }
+
+  /// The diffusion grids do not use thread-indexed state.
+  bool SupportsConcurrentExecution() override { return true; }
+
+  void ResetTime(real_t last_time_run) override {
+    last_time_run_ = last_time_run < 0 ? 0 : last_time_run;
+  }
+
   void operator()() override {
     // Get active simulation and related pointers
     auto* sim = Simulation::GetActive();
     const auto* rm = sim->GetResourceManager();
-    const auto* env = sim->GetEnvironment();
     const auto* param = sim->GetParam();
 
-    // Compute the passed time to update the diffusion grid accordingly.
-    real_t current_time = sim->GetScheduler()->GetSimulatedTime();
-    delta_t_ = current_time - last_time_run_;
-    last_time_run_ = current_time;
-
-    // Avoid computation if delta_t_ is zero
-    if (delta_t_ == 0.0) {
-      return;
+    // Operations that are not scheduled as default operations are not set up.
+    if (!set_up_) {
+      UpdateDimensions();
+      UpdateTimeStep();
     }
+    set_up_ = false;
 
-    rm->ForEachContinuum([this, &env, &param](Continuum* cm) {
-      // Update the diffusion grid dimension if the environment dimensions
-      // have changed. If the space is bound, we do not need to update the
-      // dimensions, because these should not be changing anyway
-      if (env->HasGrown() &&
-          param->bound_space == Param::BoundSpaceMode::kOpen) {
-        cm->Update();
+    if (!async_grids_.empty()) {
+      executor_->Wait(param->statistics ? sim->GetScheduler()->GetOpTimes()
+                                        : nullptr);
+      for (auto* dgrid : async_grids_) {
+        dgrid->EndAsynchronousStep();
       }
-      cm->IntegrateTimeAsynchronously(delta_t_);
-      auto* dgrid = dynamic_cast<DiffusionGrid*>(cm);
-      if (dgrid && param->calculate_gradients) {
-        dgrid->CalculateGradient();
-      }
-    });
+    }
+
+    // Avoid computation if delta_t_ is zero
+    if (delta_t_ != 0.0) {
+      rm->ForEachContinuum([this, &param](Continuum* cm) {
+        auto* dgrid = dynamic_cast<DiffusionGrid*>(cm);
+        if (std::find(async_grids_.begin(), async_grids_.end(), dgrid) !=
+            async_grids_.end()) {
+          // has already been integrated
+          return;
+        }
+        cm->IntegrateTimeAsynchronously(delta_t_);
+        if (dgrid && param->calculate_gradients) {
+          dgrid->CalculateGradient();
+        }
+      });
+    }
+    async_grids_.clear();
   }
 
  private:
+  /// True if `SetUp` has been called in this iteration.
+  bool set_up_ = false;
   /// Last time when the operation was executed
   real_t last_time_run_ = 0.0;
   /// Timestep that is useded for `Diffuse(delta_t)` and computed from this and
   /// the last time the grid was updated.
   real_t delta_t_ = 0.0;
+  /// Diffusion grids that are integrated asynchronously in this iteration.
+  std::vector<DiffusionGrid*> async_grids_;
+  /// Integrates the asynchronously coupled diffusion grids.
+  /// Created the first time such a grid is encountered.
+  std::shared_ptr<ConcurrentOpExecutor> executor_;
+
+  void UpdateDimensions() {
+    auto* sim = Simulation::GetActive();
+    const auto* env = sim->GetEnvironment();
+    const auto* param = sim->GetParam();
+    // Update the diffusion grid dimension if the environment dimensions
+    // have changed. If the space is bound, we do not need to update the
+    // dimensions, because these should not be changing anyway
+    if (env->HasGrown() && param->bound_space == Param::BoundSpaceMode::kOpen) {
+      sim->GetResourceManager()->ForEachContinuum(
+          [](Continuum* cm) { cm->Update(); });
+    }
+  }
+
+  /// Compute the passed time to update the diffusion grid accordingly.
+  void UpdateTimeStep() {
+    real_t current_time =
+        Simulation::GetActive()->GetScheduler()->GetSimulatedTime();
+    delta_t_ = current_time - last_time_run_;
+    last_time_run_ = current_time;
+  }
 };
 
 }  // namespace bdm
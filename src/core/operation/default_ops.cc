@@ -13,13 +13,18 @@
 // -----------------------------------------------------------------------------
 
 #include "core/analysis/time_series.h"
+#include "core/environment/uniform_grid_environment.h"
 #include "core/operation/bound_space_op.h"
+#include "core/operation/compact_agent_uids_op.h"
 #include "core/operation/continuum_op.h"
 #include "core/operation/dividing_cell_op.h"
+#include "core/operation/intracellular_network_op.h"
 #include "core/operation/load_balancing_op.h"
 #include "core/operation/mechanical_forces_op.h"
+#include "core/operation/mechanical_forces_op_cpu_simd.h"
 #include "core/operation/mechanical_forces_op_cuda.h"
 #include "core/operation/mechanical_forces_op_opencl.h"
+#include "core/operation/neighbor_density_op.h"
 #include "core/operation/operation.h"
 #include "core/operation/visualization_op.h"
 
@@ -33,8 +38,16 @@ BDM_REGISTER_OP(ContinuumOp, "continuum", kCpu);
 BDM_REGISTER_OP_WITH_FREQ(LoadBalancingOp, "load balancing", kCpu,
                           std::numeric_limits<uint32_t>::max());
 
+BDM_REGISTER_OP(CompactAgentUidsOp, "compact agent uids", kCpu);
+
 BDM_REGISTER_OP(MechanicalForcesOp, "mechanical forces", kCpu);
 
+BDM_REGISTER_OP(MechanicalForcesOpCpuSimd, "mechanical forces", kCpuSimd);
+
+BDM_REGISTER_OP(NeighborDensityOp, "neighbor density", kCpu);
+
+BDM_REGISTER_OP(IntracellularNetworkOp, "intracellular network", kCpu);
+
 #ifdef USE_CUDA
 BDM_REGISTER_OP(MechanicalForcesOpCuda, "mechanical forces", kCuda);
 #endif
@@ -66,6 +79,10 @@ struct BehaviorOp : public AgentOperationImpl {
   BDM_OP_HEADER(BehaviorOp);
 
   void operator()(Agent* agent) override { agent->RunBehaviors(); }
+
+  void operator()(Agent* agent, const IterationContext& ctxt) override {
+    agent->RunBehaviors(ctxt);
+  }
 };
 
 BDM_REGISTER_OP(BehaviorOp, "behavior", kCpu);
@@ -83,6 +100,8 @@ struct SetUpIterationOp : public StandaloneOperationImpl {
 
   void operator()() override {
     auto* sim = Simulation::GetActive();
+    // delete the agents that have been removed in the last iteration
+    sim->GetResourceManager()->EmptyGraveyards();
     const auto& all_exec_ctxts = sim->GetAllExecCtxts();
     all_exec_ctxts[0]->SetupIterationAll(all_exec_ctxts);
     sim->GetEnvironment()->Update();
@@ -117,8 +136,12 @@ struct UpdateEnvironmentOp : public StandaloneOperationImpl {
   BDM_OP_HEADER(UpdateEnvironmentOp);
 
   void operator()() override {
-    auto* sim = Simulation::GetActive();
-    sim->GetEnvironment()->ForcedUpdate();
+    auto* env = Simulation::GetActive()->GetEnvironment();
+    if (auto* grid = dynamic_cast<UniformGridEnvironment*>(env)) {
+      grid->IterationUpdate();
+    } else {
+      env->ForcedUpdate();
+    }
   }
 };
 
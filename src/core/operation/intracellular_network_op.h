@@ -0,0 +1,77 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_OPERATION_INTRACELLULAR_NETWORK_OP_H_
+#define CORE_OPERATION_INTRACELLULAR_NETWORK_OP_H_
+
+#include <memory>
+#include <vector>
+
+#include "core/behavior/intracellular_network.h"
+#include "core/operation/operation.h"
+#include "core/operation/operation_registry.h"
+#include "core/param/param.h"
+#include "core/scheduler.h"
+#include "core/simulation.h"
+
+namespace bdm {
+
+/// Integrates all `IntracellularNetwork`s of the simulation. Each network
+/// advances the amounts of all its agents in one parallel batch.\n
+/// The operation is scheduled as pre-scheduled operation by
+/// `IntracellularNetwork::Create`. Therefore, behaviors observe the amounts
+/// at the end of the current time step.
+struct IntracellularNetworkOp : public StandaloneOperationImpl {
+  BDM_OP_HEADER(IntracellularNetworkOp);
+
+  void AddNetwork(const std::shared_ptr<IntracellularNetwork>& network) {
+    networks_.push_back(network);
+  }
+
+  /// Returns the networks in the order in which they have been added.
+  const std::vector<std::shared_ptr<IntracellularNetwork>>& GetNetworks()
+      const {
+    return networks_;
+  }
+
+  void operator()() override {
+    auto* sim = Simulation::GetActive();
+    auto* param = sim->GetParam();
+    real_t current_time = (sim->GetScheduler()->GetSimulatedSteps() + 1) *
+                          param->simulation_time_step;
+    real_t dt = current_time - last_time_run_;
+    for (auto& network : networks_) {
+      network->Integrate(param, last_time_run_, dt);
+    }
+    last_time_run_ = current_time;
+  }
+
+  void ResetTime(real_t last_time_run) override {
+    // `last_time_run_` stores the time at the end of the iteration.
+    if (last_time_run < 0) {
+      last_time_run_ = 0;
+    } else {
+      auto* param = Simulation::GetActive()->GetParam();
+      last_time_run_ = last_time_run + param->simulation_time_step;
+    }
+  }
+
+ private:
+  std::vector<std::shared_ptr<IntracellularNetwork>> networks_;
+  real_t last_time_run_ = 0;
+};
+
+}  // namespace bdm
+
+#endif  // CORE_OPERATION_INTRACELLULAR_NETWORK_OP_H_
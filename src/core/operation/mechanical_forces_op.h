@@ -15,6 +15,7 @@
 #ifndef CORE_OPERATION_MECHANICAL_FORCES_OP_H_
 #define CORE_OPERATION_MECHANICAL_FORCES_OP_H_
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <limits>
@@ -22,7 +23,9 @@
 
 #include "core/agent/agent.h"
 #include "core/environment/environment.h"
+#include "core/environment/uniform_grid_environment.h"
 #include "core/interaction_force.h"
+#include "core/iteration_context.h"
 #include "core/operation/bound_space_op.h"
 #include "core/operation/operation.h"
 #include "core/operation/operation_registry.h"
@@ -34,7 +37,13 @@
 
 namespace bdm {
 
-/// Defines the 3D physical interactions between physical objects
+/// Defines the 3D physical interactions between physical objects.\n
+/// If `Param::mechanics_max_substeps` is larger than one, agents whose
+/// displacement is limited by `Param::simulation_max_displacement` are
+/// integrated with multiple smaller time steps (see `SubCycle`).\n
+/// If `Param::detect_static_boxes` is set, agents in static boxes of the
+/// `UniformGridEnvironment` are skipped, unless they changed in the current
+/// iteration.
 class MechanicalForcesOp : public AgentOperationImpl {
   BDM_OP_HEADER(MechanicalForcesOp);
 
@@ -75,26 +84,62 @@ class MechanicalForcesOp : public AgentOperationImpl {
 
   void operator()(Agent* agent) override {
     auto* sim = Simulation::GetActive();
-    auto* scheduler = sim->GetScheduler();
-    auto* param = sim->GetParam();
+    Run(agent, sim->GetEnvironment(), sim->GetParam(),
+        sim->GetScheduler()->GetSimulatedSteps(), omp_get_thread_num());
+  }
+
+  void operator()(Agent* agent, const IterationContext& ctxt) override {
+    Run(agent, ctxt.env, ctxt.param, ctxt.step, ctxt.thread_id);
+  }
+
+  void ResetTime(real_t last_time_run) override {
+    // `last_time_run_` stores the time at the end of the iteration.
+    real_acc_t time_step =
+        Simulation::GetActive()->GetParam()->simulation_time_step;
+    std::fill(last_time_run_.begin(), last_time_run_.end(),
+              last_time_run < 0 ? 0 : last_time_run + time_step);
+    std::fill(last_iteration_.begin(), last_iteration_.end(),
+              std::numeric_limits<uint64_t>::max());
+  }
 
+ private:
+  void Run(Agent* agent, Environment* grid, const Param* param,
+           uint64_t current_iteration, int tid) {
     // Update search radius and delta_time_ at beginning of each iteration, and
     // avoid updating them within an iteration
-    auto current_iteration = scheduler->GetSimulatedSteps();
-    auto tid = omp_get_thread_num();
     if (last_iteration_[tid] != current_iteration) {
       last_iteration_[tid] = current_iteration;
 
-      auto* grid = sim->GetEnvironment();
       auto search_radius = grid->GetLargestAgentSize();
       squared_radius_ = search_radius * search_radius;
-      auto current_time = (current_iteration + 1) * param->simulation_time_step;
+      static_boxes_ = nullptr;
+      if (param->detect_static_agents && param->detect_static_boxes) {
+        static_boxes_ = dynamic_cast<UniformGridEnvironment*>(grid);
+      }
+      // Computed in `real_acc_t`, because `real_t` might not have enough
+      // precision to resolve the time step after many iterations.
+      real_acc_t current_time =
+          (current_iteration + 1) *
+          static_cast<real_acc_t>(param->simulation_time_step);
       delta_time_[tid] = current_time - last_time_run_[tid];
       last_time_run_[tid] = current_time;
     }
 
+    // No agent in a static box or in its adjacent boxes changed since the
+    // last environment update. Thus, the agent is neither moved by its
+    // neighbors nor by itself.
+    if (static_boxes_ != nullptr && !agent->GetPropagateStaticness() &&
+        static_boxes_->IsBoxStatic(agent->GetBoxIdx())) {
+      return;
+    }
+
     const auto& displacement =
         agent->CalculateDisplacement(force_, squared_radius_, delta_time_[tid]);
+    if (param->mechanics_max_substeps > 1 && delta_time_[tid] > 0 &&
+        displacement.Norm() >= param->simulation_max_displacement * 0.999) {
+      SubCycle(agent, delta_time_[tid], param);
+      return;
+    }
     agent->ApplyDisplacement(displacement);
     if (param->bound_space) {
       ApplyBoundingBox(agent, param->bound_space, param->min_bound,
@@ -102,11 +147,45 @@ class MechanicalForcesOp : public AgentOperationImpl {
     }
   }
 
- private:
+  /// Integrates `agent` over `dt` with 2, 4, 8, ... substeps, up to
+  /// `Param::mechanics_max_substeps`. The number of substeps is the smallest
+  /// one for which the displacement of a substep is not limited by
+  /// `Param::simulation_max_displacement`. It is estimated from the
+  /// displacement with the smallest substep. The forces are recalculated at
+  /// the beginning of each substep.
+  void SubCycle(Agent* agent, real_acc_t dt, const Param* param) {
+    uint64_t max_substeps = param->mechanics_max_substeps;
+    real_acc_t max_displacement = param->simulation_max_displacement;
+    auto probe = agent->CalculateDisplacement(force_, squared_radius_,
+                                              dt / max_substeps);
+    real_acc_t required = probe.Norm() * max_substeps / max_displacement;
+    uint64_t substeps = 2;
+    while (substeps < max_substeps && substeps < required) {
+      substeps *= 2;
+    }
+    substeps = std::min(substeps, max_substeps);
+
+    real_acc_t sub_dt = dt / substeps;
+    for (uint64_t i = 0; i < substeps; ++i) {
+      // The probe has been calculated with the same time step.
+      auto displacement =
+          (i == 0 && substeps == max_substeps)
+              ? probe
+              : agent->CalculateDisplacement(force_, squared_radius_, sub_dt);
+      agent->ApplyDisplacement(displacement);
+      if (param->bound_space) {
+        ApplyBoundingBox(agent, param->bound_space, param->min_bound,
+                         param->max_bound);
+      }
+    }
+  }
+
   InteractionForce* force_ = nullptr;
   real_t squared_radius_ = 0;
-  std::vector<real_t> last_time_run_;
-  std::vector<real_t> delta_time_;
+  /// Set if agents in static boxes are skipped in the current iteration.
+  UniformGridEnvironment* static_boxes_ = nullptr;
+  std::vector<real_acc_t> last_time_run_;
+  std::vector<real_acc_t> delta_time_;
   std::vector<uint64_t> last_iteration_;
 };
 
@@ -0,0 +1,330 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "core/agent/agent_handle.h"
+#include "core/agent/cell.h"
+#include "core/container/fixed_size_vector.h"
+#include "core/container/math_array_3xn.h"
+#include "core/environment/uniform_grid_environment.h"
+#include "core/functor.h"
+#include "core/operation/bound_space_op.h"
+#include "core/operation/mechanical_forces_op_cpu_simd.h"
+#include "core/resource_manager.h"
+#include "core/scheduler.h"
+#include "core/shape.h"
+#include "core/simulation.h"
+#include "core/util/log.h"
+#include "core/util/random.h"
+#include "core/util/thread_info.h"
+#include "core/util/type.h"
+
+namespace bdm {
+
+// -----------------------------------------------------------------------------
+void MechanicalForcesOpCpuSimd::SetUp() {
+  auto* sim = Simulation::GetActive();
+  auto* grid = dynamic_cast<UniformGridEnvironment*>(sim->GetEnvironment());
+  auto* rm = sim->GetResourceManager();
+
+  if (!grid) {
+    Log::Fatal(
+        "MechanicalForcesOpCpuSimd::SetUp",
+        "MechanicalForcesOpCpuSimd only works with UniformGridEnvironement.");
+  }
+
+  if (!substeps_warning_shown_ && sim->GetParam()->mechanics_max_substeps > 1) {
+    Log::Warning("MechanicalForcesOpCpuSimd::SetUp",
+                 "Param::mechanics_max_substeps is ignored for the compute "
+                 "target \"cpu_simd\". All agents are integrated with "
+                 "Param::simulation_time_step.");
+    substeps_warning_shown_ = true;
+  }
+
+  auto num_numa_nodes = ThreadInfo::GetInstance()->GetNumaNodes();
+  offset_.resize(num_numa_nodes);
+  offset_[0] = 0;
+  for (int nn = 1; nn < num_numa_nodes; nn++) {
+    offset_[nn] = offset_[nn - 1] + rm->GetNumAgents(nn - 1);
+  }
+
+  // std::vector::resize does not reallocate if the number of agents
+  // decreases. Thus, buffers are reused between iterations.
+  auto num_agents = rm->GetNumAgents();
+  pos_x_.resize(num_agents);
+  pos_y_.resize(num_agents);
+  pos_z_.resize(num_agents);
+  diameter_.resize(num_agents);
+  adherence_.resize(num_agents);
+  mass_.resize(num_agents);
+  tractor_x_.resize(num_agents);
+  tractor_y_.resize(num_agents);
+  tractor_z_.resize(num_agents);
+  box_id_.resize(num_agents);
+  successors_.resize(num_agents);
+  is_static_.resize(num_agents);
+  force_x_.resize(num_agents);
+  force_y_.resize(num_agents);
+  force_z_.resize(num_agents);
+  displacement_x_.resize(num_agents);
+  displacement_y_.resize(num_agents);
+  displacement_z_.resize(num_agents);
+  non_zero_forces_.resize(num_agents);
+
+  auto to_columnar = L2F([&](Agent* agent, AgentHandle ah) {
+    if (agent->GetShape() != Shape::kSphere) {
+      Log::Fatal("MechanicalForcesOpCpuSimd",
+                 "\nWe detected a non-spherical object. This is currently "
+                 "not supported by the compute target cpu_simd.");
+    }
+    auto* cell = bdm_static_cast<Cell*>(agent);
+    auto idx = offset_[ah.GetNumaNode()] + ah.GetElementIdx();
+    const auto& pos = cell->GetPosition();
+    const auto& tf = cell->GetTractorForce();
+    pos_x_[idx] = pos[0];
+    pos_y_[idx] = pos[1];
+    pos_z_[idx] = pos[2];
+    diameter_[idx] = cell->GetDiameter();
+    adherence_[idx] = cell->GetAdherence();
+    mass_[idx] = cell->GetMass();
+    tractor_x_[idx] = tf[0];
+    tractor_y_[idx] = tf[1];
+    tractor_z_[idx] = tf[2];
+    box_id_[idx] = cell->GetBoxIdx();
+    is_static_[idx] = cell->IsStatic();
+    const auto& successor = grid->successors_[ah];
+    successors_[idx] =
+        offset_[successor.GetNumaNode()] + successor.GetElementIdx();
+  });
+  rm->ForEachAgentParallel(1000, to_columnar);
+
+  auto num_boxes = grid->boxes_.size();
+  starts_.resize(num_boxes);
+  lengths_.resize(num_boxes);
+  timestamps_.resize(num_boxes);
+  current_timestamp_ = grid->timestamp_;
+#pragma omp parallel for
+  for (uint64_t i = 0; i < num_boxes; ++i) {
+    auto& box = grid->boxes_[i];
+    timestamps_[i] = box.timestamp_;
+    if (box.timestamp_ == current_timestamp_) {
+      lengths_[i] = box.length_;
+      starts_[i] =
+          offset_[box.start_.GetNumaNode()] + box.start_.GetElementIdx();
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+void MechanicalForcesOpCpuSimd::ResetTime(real_t last_time_run) {
+  // `last_time_run_` stores the time at the end of the iteration.
+  if (last_time_run < 0) {
+    last_time_run_ = 0;
+  } else {
+    last_time_run_ =
+        last_time_run +
+        Simulation::GetActive()->GetParam()->simulation_time_step;
+  }
+}
+
+// -----------------------------------------------------------------------------
+void MechanicalForcesOpCpuSimd::operator()() {
+  auto* sim = Simulation::GetActive();
+  auto* grid = static_cast<UniformGridEnvironment*>(sim->GetEnvironment());
+  auto* param = sim->GetParam();
+
+  real_acc_t search_radius = grid->GetLargestAgentSize();
+  real_acc_t squared_radius = search_radius * search_radius;
+  real_acc_t current_time =
+      (sim->GetScheduler()->GetSimulatedSteps() + 1) *
+      static_cast<real_acc_t>(param->simulation_time_step);
+  real_acc_t dt = current_time - last_time_run_;
+  last_time_run_ = current_time;
+  real_acc_t max_displacement = param->simulation_max_displacement;
+  bool detect_static_agents = param->detect_static_agents;
+  // We take virtual bigger radii to have a distant interaction, to get a
+  // desired density. (see `InteractionForce::ForceBetweenSpheres`)
+  const real_acc_t additional_radius = 10.0 * 0.15;
+
+  uint64_t num_agents = pos_x_.size();
+
+#pragma omp parallel
+  {
+    auto* random = sim->GetRandom();
+    // Neighbor candidates are gathered into contiguous thread-local buffers
+    // to enable vectorization of the force calculation.
+    std::vector<uint32_t> candidates;
+    std::vector<real_acc_t> nb_x;
+    std::vector<real_acc_t> nb_y;
+    std::vector<real_acc_t> nb_z;
+    std::vector<real_acc_t> nb_diameter;
+    FixedSizeVector<uint64_t, 27> boxes;
+
+#pragma omp for schedule(dynamic, 1000)
+    for (uint64_t i = 0; i < num_agents; ++i) {
+      real_acc_t fx = 0;
+      real_acc_t fy = 0;
+      real_acc_t fz = 0;
+      uint32_t non_zero = 0;
+      uint32_t coincident = 0;
+
+      if (!(detect_static_agents && is_static_[i])) {
+        candidates.clear();
+        boxes.clear();
+        grid->GetMooreBoxIndices(&boxes, box_id_[i]);
+        for (uint64_t b = 0; b < boxes.size(); ++b) {
+          auto bidx = boxes[b];
+          if (timestamps_[bidx] != current_timestamp_) {
+            continue;
+          }
+          uint32_t nidx = starts_[bidx];
+          for (uint16_t n = 0; n < lengths_[bidx]; ++n) {
+            if (nidx != i) {
+              candidates.push_back(nidx);
+            }
+            // traverse linked-list
+            nidx = successors_[nidx];
+          }
+        }
+
+        uint64_t num_candidates = candidates.size();
+        nb_x.resize(num_candidates);
+        nb_y.resize(num_candidates);
+        nb_z.resize(num_candidates);
+        nb_diameter.resize(num_candidates);
+        for (uint64_t c = 0; c < num_candidates; ++c) {
+          auto nidx = candidates[c];
+          nb_x[c] = pos_x_[nidx];
+          nb_y[c] = pos_y_[nidx];
+          nb_z[c] = pos_z_[nidx];
+          nb_diameter[c] = diameter_[nidx];
+        }
+
+        const real_acc_t x = pos_x_[i];
+        const real_acc_t y = pos_y_[i];
+        const real_acc_t z = pos_z_[i];
+        const real_acc_t r1 = 0.5 * diameter_[i] + additional_radius;
+        const real_acc_t* px = nb_x.data();
+        const real_acc_t* py = nb_y.data();
+        const real_acc_t* pz = nb_z.data();
+        const real_acc_t* pd = nb_diameter.data();
+
+#pragma omp simd reduction(+ : fx, fy, fz, non_zero, coincident)
+        for (uint64_t c = 0; c < num_candidates; ++c) {
+          real_acc_t comp1 = x - px[c];
+          real_acc_t comp2 = y - py[c];
+          real_acc_t comp3 = z - pz[c];
+          real_acc_t squared_distance =
+              comp1 * comp1 + comp2 * comp2 + comp3 * comp3;
+          real_acc_t r2 = 0.5 * pd[c] + additional_radius;
+          real_acc_t center_distance = std::sqrt(squared_distance);
+          // the overlap distance (how much one penetrates in the other)
+          real_acc_t delta = r1 + r2 - center_distance;
+          bool overlap = squared_distance < squared_radius && delta >= 0;
+          // centers are (almost) at the same location
+          bool same_location = overlap && center_distance < 0.00000001;
+          real_acc_t r = (r1 * r2) / (r1 + r2);
+          // k = 2 (repulsion coeff), gamma = 1 (attraction coeff)
+          real_acc_t f =
+              2 * delta - std::sqrt(r * std::max(delta, real_acc_t(0)));
+          real_acc_t module =
+              (overlap && !same_location) ? f / center_distance : 0;
+          fx += module * comp1;
+          fy += module * comp2;
+          fz += module * comp3;
+          non_zero += (same_location || module != 0) ? 1 : 0;
+          coincident += same_location ? 1 : 0;
+        }
+
+        // Random force for agents at the same location, like in
+        // `InteractionForce::ForceBetweenSpheres`.
+        for (uint32_t c = 0; c < coincident; ++c) {
+          auto force2on1 = random->UniformArray<3>(-3.0, 3.0);
+          fx += force2on1[0];
+          fy += force2on1[1];
+          fz += force2on1[2];
+        }
+      }
+
+      force_x_[i] = fx;
+      force_y_[i] = fy;
+      force_z_[i] = fz;
+      non_zero_forces_[i] = non_zero;
+    }
+
+    // Same as `Cell::CalculateDisplacement` for `kSimdBatchSize` agents at a
+    // time.
+    uint64_t num_batches = (num_agents + kSimdBatchSize - 1) / kSimdBatchSize;
+#pragma omp for schedule(static)
+    for (uint64_t b = 0; b < num_batches; ++b) {
+      uint64_t start = b * kSimdBatchSize;
+      uint64_t n = std::min<uint64_t>(kSimdBatchSize, num_agents - start);
+      RealAcc3xN force;
+      RealAcc3xN movement;
+      force.Load(&force_x_[start], &force_y_[start], &force_z_[start], n);
+      movement.Load(&tractor_x_[start], &tractor_y_[start], &tractor_z_[start],
+                    n);
+      movement *= dt;
+
+      real_acc_t norm_of_force[kSimdBatchSize];
+      force.Norm(norm_of_force);
+      // `mh` is zero if the force does not break the adherence.
+      real_acc_t mh[kSimdBatchSize] = {0};
+      for (uint64_t i = 0; i < n; ++i) {
+        if (norm_of_force[i] > adherence_[start + i]) {
+          mh[i] = dt / mass_[start + i];
+        }
+      }
+      movement.FusedMultiplyAdd(force, mh);
+
+      // Limit the displacement to `max_displacement`
+      real_acc_t norm_of_movement[kSimdBatchSize];
+      movement.Norm(norm_of_movement);
+      real_acc_t scale[kSimdBatchSize];
+#pragma omp simd
+      for (uint64_t i = 0; i < kSimdBatchSize; ++i) {
+        scale[i] = norm_of_force[i] * mh[i] > max_displacement
+                       ? max_displacement / norm_of_movement[i]
+                       : 1;
+      }
+      movement *= scale;
+      movement.Store(&displacement_x_[start], &displacement_y_[start],
+                     &displacement_z_[start], n);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+void MechanicalForcesOpCpuSimd::TearDown() {
+  auto* sim = Simulation::GetActive();
+  auto* param = sim->GetParam();
+  auto update_agents = L2F([&](Agent* agent, AgentHandle ah) {
+    auto idx = offset_[ah.GetNumaNode()] + ah.GetElementIdx();
+    if (non_zero_forces_[idx] > 1) {
+      agent->SetStaticnessNextTimestep(false);
+    }
+    agent->ApplyDisplacement(
+        {displacement_x_[idx], displacement_y_[idx], displacement_z_[idx]});
+    if (param->bound_space) {
+      ApplyBoundingBox(agent, param->bound_space, param->min_bound,
+                       param->max_bound);
+    }
+  });
+  sim->GetResourceManager()->ForEachAgentParallel(1000, update_agents);
+}
+
+}  // namespace bdm
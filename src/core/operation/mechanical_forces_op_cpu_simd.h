@@ -0,0 +1,88 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_OPERATION_MECHANICAL_FORCES_OP_CPU_SIMD_H_
+#define CORE_OPERATION_MECHANICAL_FORCES_OP_CPU_SIMD_H_
+
+#include <vector>
+
+#include "core/agent/agent_handle.h"
+#include "core/operation/operation.h"
+#include "core/operation/operation_registry.h"
+#include "core/real_t.h"
+
+namespace bdm {
+
+/// Defines the 3D physical interactions between spherical agents.\n
+/// Uses the same flattened (structure of arrays) representation of the
+/// agents and the uniform grid as `MechanicalForcesOpCuda`, but executes
+/// the kernel on the CPU with OpenMP threads and SIMD instructions.
+/// Displacements are computed for all agents based on the positions at the
+/// beginning of the operation and written back in bulk in `TearDown`.\n
+/// Selected if `Param::compute_target` is set to "cpu_simd".
+/// Only supports spherical agents and the `UniformGridEnvironment`.
+/// Does not support the adaptive time stepping of
+/// `Param::mechanics_max_substeps`.
+struct MechanicalForcesOpCpuSimd : public StandaloneOperationImpl {
+  BDM_OP_HEADER(MechanicalForcesOpCpuSimd);
+
+ public:
+  void SetUp() override;
+
+  void operator()() override;
+
+  void TearDown() override;
+
+  void ResetTime(real_t last_time_run) override;
+
+ private:
+  /// Start index of each NUMA domain in the flattened arrays.
+  std::vector<AgentHandle::ElementIdx_t> offset_;
+
+  // agent attributes
+  std::vector<real_t> pos_x_;
+  std::vector<real_t> pos_y_;
+  std::vector<real_t> pos_z_;
+  std::vector<real_t> diameter_;
+  std::vector<real_t> adherence_;
+  std::vector<real_t> mass_;
+  std::vector<real_t> tractor_x_;
+  std::vector<real_t> tractor_y_;
+  std::vector<real_t> tractor_z_;
+  std::vector<uint32_t> box_id_;
+  std::vector<uint32_t> successors_;
+  std::vector<char> is_static_;
+
+  // uniform grid
+  std::vector<uint32_t> starts_;
+  std::vector<uint16_t> lengths_;
+  std::vector<uint32_t> timestamps_;
+  uint32_t current_timestamp_ = 0;
+
+  // results
+  std::vector<real_acc_t> force_x_;
+  std::vector<real_acc_t> force_y_;
+  std::vector<real_acc_t> force_z_;
+  std::vector<real_t> displacement_x_;
+  std::vector<real_t> displacement_y_;
+  std::vector<real_t> displacement_z_;
+  std::vector<uint32_t> non_zero_forces_;
+
+  real_acc_t last_time_run_ = 0;
+  bool substeps_warning_shown_ = false;
+};
+
+}  // namespace bdm
+
+#endif  // CORE_OPERATION_MECHANICAL_FORCES_OP_CPU_SIMD_H_
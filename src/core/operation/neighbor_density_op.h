@@ -0,0 +1,229 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_OPERATION_NEIGHBOR_DENSITY_OP_H_
+#define CORE_OPERATION_NEIGHBOR_DENSITY_OP_H_
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "core/agent/agent.h"
+#include "core/environment/environment.h"
+#include "core/environment/uniform_grid_environment.h"
+#include "core/functor.h"
+#include "core/operation/operation.h"
+#include "core/operation/operation_registry.h"
+#include "core/param/param.h"
+#include "core/resource_manager.h"
+#include "core/scheduler.h"
+#include "core/simulation.h"
+#include "core/util/math.h"
+#include "core/util/thread_info.h"
+
+namespace bdm {
+
+/// Computes the number of neighbors of every agent once per iteration.
+/// Behaviors that depend on the crowdedness of an agent (e.g. contact
+/// inhibition, quorum sensing) can read the result instead of iterating
+/// over the neighbors themselves.
+/// The operation is scheduled after the environment has been updated at the
+/// beginning of each iteration if `Param::compute_neighbor_density` is set.
+/// Neighbors are all agents within `Param::neighbor_density_radius`.
+/// If the radius is larger than the boxes of the `UniformGridEnvironment`,
+/// the neighbors are searched in a temporary grid whose boxes are as large as
+/// the radius. Thus, the environment is not modified. Building the temporary
+/// grid costs one pass over all agents and memory for four values per agent.
+/// \code
+/// auto* nd = NeighborDensityOp::GetScheduled();
+/// if (nd->GetNeighborCount(agent) > 10) { ... }
+/// \endcode
+struct NeighborDensityOp : public StandaloneOperationImpl {
+  BDM_OP_HEADER(NeighborDensityOp);
+
+  /// Returns the instance of this operation in the active simulation.
+  static NeighborDensityOp* GetScheduled() {
+    auto* scheduler = Simulation::GetActive()->GetScheduler();
+    auto ops = scheduler->GetOps("neighbor density");
+    if (ops.empty()) {
+      return nullptr;
+    }
+    return ops[0]->GetImplementation<NeighborDensityOp>();
+  }
+
+  void operator()() override {
+    auto* sim = Simulation::GetActive();
+    auto* rm = sim->GetResourceManager();
+    auto* env = sim->GetEnvironment();
+    auto* param = sim->GetParam();
+
+    radius_ = param->neighbor_density_radius > 0
+                  ? param->neighbor_density_radius
+                  : env->GetLargestAgentSize();
+    auto squared_radius = radius_ * radius_;
+
+    // agent-indexed array: one vector for each numa domain
+    auto numa_nodes = ThreadInfo::GetInstance()->GetNumaNodes();
+    counts_.resize(numa_nodes);
+    for (int n = 0; n < numa_nodes; ++n) {
+      counts_[n].resize(rm->GetNumAgents(n));
+    }
+
+    // The uniform grid only searches the surrounding boxes. Thus, its boxes
+    // must be at least as large as the search radius.
+    auto* grid = dynamic_cast<UniformGridEnvironment*>(env);
+    if (grid != nullptr &&
+        squared_radius > grid->GetBoxLength() * grid->GetBoxLength()) {
+      CountWithLocalGrid(rm, squared_radius, param->scheduling_batch_size);
+      return;
+    }
+
+    auto count_neighbors = L2F([&](Agent* agent, AgentHandle ah) {
+      uint32_t count = 0;
+      auto increment = L2F([&](Agent*, real_t) { count++; });
+      env->ForEachNeighbor(increment, *agent, squared_radius);
+      counts_[ah.GetNumaNode()][ah.GetElementIdx()] = count;
+    });
+    rm->ForEachAgentParallel(param->scheduling_batch_size, count_neighbors);
+  }
+
+  /// Returns the number of neighbors of `agent` at the beginning of the
+  /// current iteration. Returns 0 for agents that have been added during
+  /// this iteration.
+  uint32_t GetNeighborCount(const Agent* agent) const {
+    auto* rm = Simulation::GetActive()->GetResourceManager();
+    if (!rm->ContainsAgent(agent->GetUid())) {
+      return 0;
+    }
+    auto ah = rm->GetAgentHandle(agent->GetUid());
+    if (ah.GetNumaNode() >= counts_.size() ||
+        ah.GetElementIdx() >= counts_[ah.GetNumaNode()].size()) {
+      return 0;
+    }
+    return counts_[ah.GetNumaNode()][ah.GetElementIdx()];
+  }
+
+  /// Returns the number of neighbors per volume of the search sphere.
+  real_t GetLocalDensity(const Agent* agent) const {
+    if (radius_ == 0) {
+      return 0;
+    }
+    real_t volume = 4.0 / 3.0 * Math::kPi * radius_ * radius_ * radius_;
+    return GetNeighborCount(agent) / volume;
+  }
+
+  /// Returns the radius that was used in the current iteration.
+  real_t GetRadius() const { return radius_; }
+
+ private:
+  std::vector<std::vector<uint32_t>> counts_;
+  real_t radius_ = 0;
+
+  /// Counts the neighbors in a temporary grid with box length `radius_`.
+  /// Agents are sorted by box with a counting sort. Afterwards, the agents
+  /// of a box are stored contiguously.
+  void CountWithLocalGrid(ResourceManager* rm, real_t squared_radius,
+                          uint64_t batch_size) {
+    auto numa_nodes = counts_.size();
+    std::vector<uint64_t> offsets(numa_nodes + 1, 0);
+    for (uint64_t n = 0; n < numa_nodes; ++n) {
+      offsets[n + 1] = offsets[n] + counts_[n].size();
+    }
+    auto num_agents = offsets[numa_nodes];
+    if (num_agents == 0) {
+      return;
+    }
+
+    std::vector<Real3> positions(num_agents);
+    rm->ForEachAgent([&](Agent* agent, AgentHandle ah) {
+      positions[offsets[ah.GetNumaNode()] + ah.GetElementIdx()] =
+          agent->GetPosition();
+    });
+
+    Real3 min = positions[0];
+    Real3 max = positions[0];
+    for (auto& pos : positions) {
+      for (int d = 0; d < 3; ++d) {
+        min[d] = std::min(min[d], pos[d]);
+        max[d] = std::max(max[d], pos[d]);
+      }
+    }
+    std::array<uint64_t, 3> dims;
+    for (int d = 0; d < 3; ++d) {
+      dims[d] = static_cast<uint64_t>((max[d] - min[d]) / radius_) + 1;
+    }
+    auto box_coord = [&](const Real3& pos, int d) {
+      return std::min(static_cast<uint64_t>((pos[d] - min[d]) / radius_),
+                      dims[d] - 1);
+    };
+    auto box_idx = [&](uint64_t x, uint64_t y, uint64_t z) {
+      return (z * dims[1] + y) * dims[0] + x;
+    };
+
+    // starts[b]..starts[b + 1] is the range of box b in sorted
+    std::vector<uint64_t> boxes(num_agents);
+    std::vector<uint64_t> starts(dims[0] * dims[1] * dims[2] + 1, 0);
+    for (uint64_t i = 0; i < num_agents; ++i) {
+      const auto& pos = positions[i];
+      boxes[i] =
+          box_idx(box_coord(pos, 0), box_coord(pos, 1), box_coord(pos, 2));
+      starts[boxes[i] + 1]++;
+    }
+    for (uint64_t b = 1; b < starts.size(); ++b) {
+      starts[b] += starts[b - 1];
+    }
+    std::vector<uint64_t> sorted(num_agents);
+    {
+      auto next = starts;
+      for (uint64_t i = 0; i < num_agents; ++i) {
+        sorted[next[boxes[i]]++] = i;
+      }
+    }
+
+    auto count_neighbors = L2F([&](Agent*, AgentHandle ah) {
+      auto idx = offsets[ah.GetNumaNode()] + ah.GetElementIdx();
+      const auto& pos = positions[idx];
+      std::array<uint64_t, 3> coord = {
+          {box_coord(pos, 0), box_coord(pos, 1), box_coord(pos, 2)}};
+      uint32_t count = 0;
+      for (uint64_t z = coord[2] > 0 ? coord[2] - 1 : 0;
+           z <= std::min(coord[2] + 1, dims[2] - 1); ++z) {
+        for (uint64_t y = coord[1] > 0 ? coord[1] - 1 : 0;
+             y <= std::min(coord[1] + 1, dims[1] - 1); ++y) {
+          for (uint64_t x = coord[0] > 0 ? coord[0] - 1 : 0;
+               x <= std::min(coord[0] + 1, dims[0] - 1); ++x) {
+            auto b = box_idx(x, y, z);
+            for (uint64_t s = starts[b]; s < starts[b + 1]; ++s) {
+              auto other = sorted[s];
+              const auto& other_pos = positions[other];
+              real_t dx = other_pos[0] - pos[0];
+              real_t dy = other_pos[1] - pos[1];
+              real_t dz = other_pos[2] - pos[2];
+              if (other != idx &&
+                  dx * dx + dy * dy + dz * dz < squared_radius) {
+                count++;
+              }
+            }
+          }
+        }
+      }
+      counts_[ah.GetNumaNode()][ah.GetElementIdx()] = count;
+    });
+    rm->ForEachAgentParallel(batch_size, count_neighbors);
+  }
+};
+
+}  // namespace bdm
+
+#endif  // CORE_OPERATION_NEIGHBOR_DENSITY_OP_H_
@@ -50,6 +50,14 @@ void Operation::operator()(Agent *agent) {
 
 void Operation::operator()() { (*implementations_[active_target_])(); }
 
+void Operation::operator()(Agent *agent, const IterationContext &ctxt) {
+  (*implementations_[active_target_])(agent, ctxt);
+}
+
+void Operation::operator()(const IterationContext &ctxt) {
+  (*implementations_[active_target_])(ctxt);
+}
+
 void Operation::AddOperationImpl(OpComputeTarget target, OperationImpl *impl) {
   if (implementations_.size() < static_cast<size_t>(target + 1)) {
     implementations_.resize(target + 1, nullptr);
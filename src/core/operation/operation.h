@@ -21,13 +21,15 @@
 #include <vector>
 
 #include "core/functor.h"
+#include "core/real_t.h"
 #include "core/util/log.h"
 
 namespace bdm {
 
 class Agent;
+struct IterationContext;
 
-enum OpComputeTarget { kCpu, kCuda, kOpenCl };
+enum OpComputeTarget { kCpu, kCuda, kOpenCl, kCpuSimd };
 
 inline std::string OpComputeTargetString(OpComputeTarget t) {
   switch (t) {
@@ -37,6 +39,8 @@ inline std::string OpComputeTargetString(OpComputeTarget t) {
       return "kCuda";
     case OpComputeTarget::kOpenCl:
       return "kOpenCl";
+    case OpComputeTarget::kCpuSimd:
+      return "kCpuSimd";
     default:
       return "Invalid";
   }
@@ -57,6 +61,25 @@ struct OperationImpl {
 
   virtual void operator()() = 0;
 
+  /// Same as `operator()(Agent*)`, but with the state of the current iteration
+  /// for the calling thread. Override this function to avoid lookups through
+  /// `Simulation::GetActive()`. The default implementation ignores `ctxt`.
+  virtual void operator()(Agent *agent, const IterationContext &ctxt) {
+    (*this)(agent);
+  }
+
+  /// Same as `operator()()`, but with the state of the current iteration.
+  /// The default implementation ignores `ctxt`.
+  virtual void operator()(const IterationContext &ctxt) { (*this)(); }
+
+  /// Called if the simulated time was reset (e.g. by
+  /// `SimulationSnapshot::Restore`). `last_time_run` is the simulated time
+  /// (`Scheduler::GetSimulatedTime`) of the last execution of this operation
+  /// before the new point in time, or negative if the operation has not been
+  /// executed before. Operations that compute their time step
+  /// from the time of their last execution must override this function.
+  virtual void ResetTime(real_t last_time_run) {}
+
   /// Operation implementations can be cloned. This function should return a
   /// copy of the operation implementation
   virtual OperationImpl *Clone() = 0;
@@ -67,6 +90,15 @@ struct OperationImpl {
   /// Returns whether or not this operations is a stand-alone operation
   virtual bool IsStandalone() = 0;
 
+  /// Returns whether or not this operation can be listed in
+  /// `Param::concurrent_ops`.\n
+  /// Concurrent operations run on a separate OpenMP thread team whose thread
+  /// ids overlap with the ones of the main thread team. Thus, they must not
+  /// use state that is indexed by the thread id (e.g.
+  /// `ThreadInfo::GetMyThreadId`, execution contexts, random number
+  /// generators, or the creation and removal of agents).
+  virtual bool SupportsConcurrentExecution() { return false; }
+
   /// The target that this operation implementation is supposed to run on
   OpComputeTarget target_ = kCpu;
 };
@@ -125,6 +157,14 @@ struct Operation {
   /// objects (such as updating diffusion grids)
   void operator()();
 
+  /// Same as `operator()(Agent*)`. Forwards the state of the current
+  /// iteration to the implementation.
+  void operator()(Agent *agent, const IterationContext &ctxt);
+
+  /// Same as `operator()()`. Forwards the state of the current iteration to
+  /// the implementation.
+  void operator()(const IterationContext &ctxt);
+
   /// Add an operation implementation for the specified compute target
   ///
   /// @param[in]  target  The compute target
@@ -166,6 +206,10 @@ struct Operation {
     return implementations_[active_target_]->IsStandalone();
   }
 
+  bool SupportsConcurrentExecution() {
+    return implementations_[active_target_]->SupportsConcurrentExecution();
+  }
+
   /// Forwards call to implementation's Setup function
   void SetUp();
 
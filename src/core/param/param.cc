@@ -104,6 +104,31 @@ json UnflattenGroups(const json& j_flattened, const json& j_original) {
   return j_return;
 }
 
+// -----------------------------------------------------------------------------
+/// Returns the merge patch (https://tools.ietf.org/html/rfc7386) that turns
+/// `source` into `target`. Arrays cannot be patched element-wise and are
+/// therefore replaced as a whole.
+json CreateMergePatch(const json& source, const json& target) {
+  if (!source.is_object() || !target.is_object()) {
+    return target;
+  }
+  json patch = json::object();
+  for (auto it = source.begin(); it != source.end(); ++it) {
+    if (target.find(it.key()) == target.end()) {
+      patch[it.key()] = nullptr;
+    }
+  }
+  for (auto it = target.begin(); it != target.end(); ++it) {
+    auto src = source.find(it.key());
+    if (src == source.end()) {
+      patch[it.key()] = it.value();
+    } else if (*src != it.value()) {
+      patch[it.key()] = CreateMergePatch(*src, it.value());
+    }
+  }
+  return patch;
+}
+
 // -----------------------------------------------------------------------------
 std::string Param::ToJsonString() const {
   // If you segfault here, try running the unit tests to find the root cause
@@ -145,6 +170,19 @@ void Param::MergeJsonPatch(const std::string& patch) {
   Restore(std::move(*restored));
 }
 
+// -----------------------------------------------------------------------------
+std::string Param::GetJsonMergePatch(const std::string& base_json) const {
+  try {
+    auto j_base = json::parse(base_json);
+    auto j_current = json::parse(ToJsonString());
+    return CreateMergePatch(j_base, j_current).dump();
+  } catch (std::exception& e) {
+    Log::Fatal("Param::GetJsonMergePatch",
+               Concat("Couldn't create the json merge patch.\n", e.what()));
+    return std::string();
+  }
+}
+
 // -----------------------------------------------------------------------------
 void AssignThreadSafetyMechanism(const std::shared_ptr<cpptoml::table>& config,
                                  Param* param) {
@@ -229,12 +267,24 @@ void Param::AssignFromConfig(const std::shared_ptr<cpptoml::table>& config) {
   BDM_ASSIGN_CONFIG_VALUE(environment, "simulation.environment");
   BDM_ASSIGN_CONFIG_VALUE(nanoflann_depth, "simulation.nanoflann_depth");
   BDM_ASSIGN_CONFIG_VALUE(unibn_bucketsize, "simulation.unibn_bucketsize");
+  BDM_ASSIGN_CONFIG_VALUE(linear_octree_leaf_size,
+                          "simulation.linear_octree_leaf_size");
   BDM_ASSIGN_CONFIG_VALUE(backup_file, "simulation.backup_file");
   BDM_ASSIGN_CONFIG_VALUE(restore_file, "simulation.restore_file");
   BDM_ASSIGN_CONFIG_VALUE(backup_interval, "simulation.backup_interval");
+  BDM_ASSIGN_CONFIG_VALUE(time_series_stream_file,
+                          "simulation.time_series_stream_file");
+  BDM_ASSIGN_CONFIG_VALUE(time_series_max_points_in_memory,
+                          "simulation.time_series_max_points_in_memory");
   BDM_ASSIGN_CONFIG_VALUE(simulation_time_step, "simulation.time_step");
   BDM_ASSIGN_CONFIG_VALUE(simulation_max_displacement,
                           "simulation.max_displacement");
+  BDM_ASSIGN_CONFIG_VALUE(mechanics_max_substeps,
+                          "simulation.mechanics_max_substeps");
+  BDM_ASSIGN_CONFIG_VALUE(compute_neighbor_density,
+                          "simulation.compute_neighbor_density");
+  BDM_ASSIGN_CONFIG_VALUE(neighbor_density_radius,
+                          "simulation.neighbor_density_radius");
   BDM_ASSIGN_CONFIG_VALUE(min_bound, "simulation.min_bound");
   BDM_ASSIGN_CONFIG_VALUE(max_bound, "simulation.max_bound");
   BDM_ASSIGN_CONFIG_VALUE(diffusion_boundary_condition,
@@ -340,6 +390,8 @@ void Param::AssignFromConfig(const std::shared_ptr<cpptoml::table>& config) {
                           "performance.scheduling_batch_size");
   BDM_ASSIGN_CONFIG_VALUE(detect_static_agents,
                           "performance.detect_static_agents");
+  BDM_ASSIGN_CONFIG_VALUE(detect_static_boxes,
+                          "performance.detect_static_boxes");
   BDM_ASSIGN_CONFIG_VALUE(cache_neighbors, "performance.cache_neighbors");
   BDM_ASSIGN_CONFIG_VALUE(use_bdm_mem_mgr, "performance.use_bdm_mem_mgr");
   BDM_ASSIGN_CONFIG_VALUE(mem_mgr_aligned_pages_shift,
@@ -350,6 +402,23 @@ void Param::AssignFromConfig(const std::shared_ptr<cpptoml::table>& config) {
                           "performance.mem_mgr_max_mem_per_thread_factor");
   BDM_ASSIGN_CONFIG_VALUE(minimize_memory_while_rebalancing,
                           "performance.minimize_memory_while_rebalancing");
+  BDM_ASSIGN_CONFIG_VALUE(weighted_load_balancing,
+                          "performance.weighted_load_balancing");
+  BDM_ASSIGN_CONFIG_VALUE(defer_agent_deletion,
+                          "performance.defer_agent_deletion");
+  BDM_ASSIGN_CONFIG_VALUE(neighbor_prefetch_distance,
+                          "performance.neighbor_prefetch_distance");
+  if (config->get_table("performance")) {
+    auto ops = config->get_table("performance")
+                   ->get_array_of<std::string>("concurrent_ops");
+    if (ops) {
+      concurrent_ops = *ops;
+    }
+  }
+  BDM_ASSIGN_CONFIG_VALUE(concurrent_op_threads,
+                          "performance.concurrent_op_threads");
+  BDM_ASSIGN_CONFIG_VALUE(agent_uid_compaction_threshold,
+                          "performance.agent_uid_compaction_threshold");
   AssignMappedDataArrayMode(config, this);
 
   // development group
@@ -55,10 +55,18 @@ struct Param {
   /// `ToJsonString()`.
   void MergeJsonPatch(const std::string& patch);
 
+  /// Returns the JSON merge patch (https://tools.ietf.org/html/rfc7386)
+  /// that turns `base_json` into this parameter. `base_json` must have been
+  /// created with `ToJsonString()`. Applying the result with
+  /// `MergeJsonPatch` to the parameter that `base_json` was created from
+  /// yields a copy of this parameter.
+  std::string GetJsonMergePatch(const std::string& base_json) const;
+
   template <typename TParamGroup>
   const TParamGroup* Get() const {
-    if (groups_.find(TParamGroup::kUid) != groups_.end()) {
-      return bdm_static_cast<const TParamGroup*>(groups_.at(TParamGroup::kUid));
+    auto it = groups_.find(TParamGroup::kUid);
+    if (it != groups_.end()) {
+      return bdm_static_cast<const TParamGroup*>(it->second);
     } else {
       Log::Error("TParamGroup::Get",
                  "Couldn't find the requested group parameter.");
@@ -68,8 +76,9 @@ struct Param {
 
   template <typename TParamGroup>
   TParamGroup* Get() {
-    if (groups_.find(TParamGroup::kUid) != groups_.end()) {
-      return bdm_static_cast<TParamGroup*>(groups_.at(TParamGroup::kUid));
+    auto it = groups_.find(TParamGroup::kUid);
+    if (it != groups_.end()) {
+      return bdm_static_cast<TParamGroup*>(it->second);
     } else {
       Log::Error("TParamGroup::Get",
                  "Couldn't find the requested group parameter.");
@@ -114,7 +123,7 @@ struct Param {
 
   /// The method used to query the environment of a simulation object.
   /// Default value: `"uniform_grid"`\n
-  /// Other allowed values: `"kd_tree", "octree"`\n
+  /// Other allowed values: `"kd_tree", "octree", "linear_octree"`\n
   /// TOML config file:
   ///
   ///     [simulation]
@@ -139,6 +148,15 @@ struct Param {
   ///     unibn_bucketsize = 16
   uint32_t unibn_bucketsize = 16;
 
+  /// The maximum number of agents in a leaf of the linear octree if it's set
+  /// as the environment (see Param::environment).\n
+  /// Default value: `16`\n
+  /// TOML config file:
+  ///
+  ///     [simulation]
+  ///     linear_octree_leaf_size = 16
+  uint32_t linear_octree_leaf_size = 16;
+
   /// If set to true (default), BioDynaMo will automatically delete all contents
   /// inside `Param::output_dir` at the beginning of the simulation.
   /// Use with caution in combination with `Param::output_dir`. If you do not
@@ -176,6 +194,31 @@ struct Param {
   ///     backup_interval = 1800  # backup every half an hour
   uint32_t backup_interval = 1800;
 
+  /// File name to which the data points collected by the simulation's
+  /// TimeSeries are streamed during the simulation (CSV file with columns
+  /// `id,x,y`).\n
+  /// Path is relative to `Param::output_dir`.\n
+  /// In a multi-simulation, workers send their data points to the manager,
+  /// which writes them to `w<worker-id>-<time_series_stream_file>` in the
+  /// working directory.\n
+  /// Default value: `""` (no streaming)\n
+  /// TOML config file:
+  ///
+  ///     [simulation]
+  ///     time_series_stream_file = "time-series.csv"
+  /// \see experimental::TimeSeries::StreamTo
+  std::string time_series_stream_file = "";
+
+  /// Number of data points per entry that the simulation's TimeSeries keeps
+  /// in memory. Older data points are discarded after they have been
+  /// streamed (see `Param::time_series_stream_file`).\n
+  /// Default value: `0` (keep all data points)\n
+  /// TOML config file:
+  ///
+  ///     [simulation]
+  ///     time_series_max_points_in_memory = 0
+  uint64_t time_series_max_points_in_memory = 0;
+
   /// Time between two simulation steps, in hours.
   /// Default value: `0.01`\n
   /// TOML config file:
@@ -193,6 +236,41 @@ struct Param {
   ///     max_displacement = 3.0
   real_t simulation_max_displacement = 3.0;
 
+  /// Maximum number of substeps of the adaptive time stepping for mechanics.
+  /// The "mechanical forces" operation integrates agents whose displacement
+  /// is limited by `simulation_max_displacement` (e.g. highly compressed
+  /// agents) with 2, 4, 8, ... substeps, while all other agents advance with
+  /// `simulation_time_step`. All agents are synchronized at the end of each
+  /// time step. Set to 1 to disable the adaptive time stepping.
+  /// Only supported by the compute target "cpu". The compute target
+  /// "cpu_simd" ignores this parameter and prints a warning.\n
+  /// Default value: `1`\n
+  /// TOML config file:
+  ///
+  ///     [simulation]
+  ///     mechanics_max_substeps = 1
+  uint64_t mechanics_max_substeps = 1;
+
+  /// If set to true, the operation "neighbor density" computes the number of
+  /// neighbors of every agent at the beginning of each iteration.
+  /// Behaviors can read the result with `NeighborDensityOp` instead of
+  /// iterating over their neighbors themselves.\n
+  /// Default value: `false`\n
+  /// TOML config file:
+  ///
+  ///     [simulation]
+  ///     compute_neighbor_density = false
+  bool compute_neighbor_density = false;
+
+  /// Search radius of the operation "neighbor density".\n
+  /// The value `0` uses the size of the largest agent.\n
+  /// Default value: `0`\n
+  /// TOML config file:
+  ///
+  ///     [simulation]
+  ///     neighbor_density_radius = 0
+  real_t neighbor_density_radius = 0;
+
   enum BoundSpaceMode {
     /// The simulation space grows to encapsulate all agents.
     kOpen = 0,
@@ -467,6 +545,24 @@ struct Param {
   ///     detect_static_agents = false
   bool detect_static_agents = false;
 
+  /// Determines the granularity of the static agent detection
+  /// (see `detect_static_agents`).
+  /// If set to true, the `UniformGridEnvironment` tracks staticness per box
+  /// instead of propagating it from agent to agent with neighbor searches.
+  /// A box is static if no agent in it or in its adjacent boxes moved, grew,
+  /// was added or was removed. All agents in non-static boxes are woken up.
+  /// The operations "propagate staticness" and
+  /// "propagate staticness agentop" are not scheduled in this mode.
+  /// The operation "mechanical forces" skips agents in static boxes.\n
+  /// Has no effect if `detect_static_agents` is false or another environment
+  /// is used.\n
+  /// Default value: `false`\n
+  /// TOML config file:
+  ///
+  ///     [performance]
+  ///     detect_static_boxes = false
+  bool detect_static_boxes = false;
+
   /// Neighbors of an agent can be cached so to avoid consecutive
   /// searches. This of course only makes sense if there is more than one
   /// `ForEachNeighbor*` operation.\n
@@ -533,6 +629,93 @@ struct Param {
   ///     minimize_memory_while_rebalancing = true
   bool minimize_memory_while_rebalancing = true;
 
+  /// If set to true, load balancing assigns agents to NUMA domains such that
+  /// each domain receives the same estimated amount of work per thread,
+  /// instead of the same number of agents per thread.
+  /// The cost of an agent is estimated by the number of neighbor candidates
+  /// in its surrounding boxes. Thus, agents in dense regions count more than
+  /// agents in sparse regions.
+  /// Only the `UniformGridEnvironment` provides cost estimates. With other
+  /// environments, agents are distributed by count.\n
+  /// Default value: `false`\n
+  /// TOML config file:
+  ///
+  ///     [performance]
+  ///     weighted_load_balancing = false
+  bool weighted_load_balancing = false;
+
+  /// If set to true, agents removed at the end of an iteration are not
+  /// deleted immediately. `ResourceManager::RemoveAgents` moves them to
+  /// per-thread graveyards, which are emptied in parallel at the beginning
+  /// of the next iteration (see `ResourceManager::EmptyGraveyards`).
+  /// This keeps destructor calls and memory deallocation out of the
+  /// compaction of the agent containers. The memory of removed agents is
+  /// released one iteration later.\n
+  /// Default value: `false`\n
+  /// TOML config file:
+  ///
+  ///     [performance]
+  ///     defer_agent_deletion = false
+  bool defer_agent_deletion = false;
+
+  /// Number of neighbor candidates which are prefetched ahead of their use in
+  /// `UniformGridEnvironment::ForEachNeighbor`. Hides the latency of the
+  /// dependent loads from the agent handle to the agent object.
+  /// The best value depends on the hardware and the agent density.
+  /// Set to 0 to disable software prefetching.\n
+  /// Default value: `8`\n
+  /// TOML config file:
+  ///
+  ///     [performance]
+  ///     neighbor_prefetch_distance = 8
+  uint64_t neighbor_prefetch_distance = 8;
+
+  /// Names of standalone operations that are executed concurrently with the
+  /// subsequent operations of the same iteration.
+  /// Concurrent operations run on a persistent worker thread with its own
+  /// OpenMP thread team (see `concurrent_op_threads`).
+  /// Operations that depend on the result of a concurrent operation wait for
+  /// it to finish (see `Scheduler::AddOpDependency`). Agent operations,
+  /// "load balancing", "tear down iteration", "compact agent uids",
+  /// "update environment", and the end of the iteration wait for all
+  /// concurrent operations.\n
+  /// Only operations that neither access agents, the environment, nor
+  /// thread-indexed state can be listed, e.g. "continuum" (see
+  /// `OperationImpl::SupportsConcurrentExecution`). Thus, the diffusion of
+  /// step n overlaps with the subsequent standalone operations.\n
+  /// Default value: `{}`\n
+  /// TOML config file:
+  ///
+  ///     [performance]
+  ///     concurrent_ops = ["continuum"]
+  std::vector<std::string> concurrent_ops;
+
+  /// Number of OpenMP threads that execute operations listed in
+  /// `concurrent_ops` and integrate asynchronously coupled diffusion grids
+  /// (see `DiffusionGrid::SetMaxStaleness`). These threads are used in
+  /// addition to the threads of the main thread team.\n
+  /// Default value: `1`\n
+  /// TOML config file:
+  ///
+  ///     [performance]
+  ///     concurrent_op_threads = 1
+  uint64_t concurrent_op_threads = 1;
+
+  /// AgentUid indices of removed agents are only reused for new agents.
+  /// After large waves of agent removals, the index space (and all data
+  /// structures indexed by it) can therefore be much larger than the number
+  /// of agents. If the highest AgentUid index exceeds
+  /// `agent_uid_compaction_threshold` times the number of agents, the
+  /// operation "compact agent uids" renumbers all AgentUids densely.
+  /// \see `ResourceManager::CompactAgentUids`\n
+  /// The value `0` disables compaction.\n
+  /// Default value: `0`\n
+  /// TOML config file:
+  ///
+  ///     [performance]
+  ///     agent_uid_compaction_threshold = 0
+  real_t agent_uid_compaction_threshold = 0;
+
   /// MappedDataArrayMode options:
   ///   `kZeroCopy`: access agent data directly only if it is
   ///                requested. \n
@@ -599,7 +782,9 @@ struct Param {
   // experimental group
 
   /// Run the simulation partially on the GPU for improved performance.
-  /// Possible values: "cpu", "cuda", "opencl"
+  /// Possible values: "cpu", "cpu_simd", "cuda", "opencl"\n
+  /// "cpu_simd" runs operations that support it (e.g. "mechanical forces")
+  /// on flattened agent data with OpenMP and SIMD instructions.
   /// Default value: `"cpu"`\n
   /// TOML config file:
   ///     [experimental]
@@ -630,6 +815,7 @@ struct Param {
 
  private:
   friend class DiffusionTest_CopyOldData_Test;
+  friend struct IterationContext;
   static std::unordered_map<ParamGroupUid, std::unique_ptr<ParamGroup>>
       registered_groups_;
   std::unordered_map<ParamGroupUid, ParamGroup*> groups_;
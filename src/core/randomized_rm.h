@@ -16,13 +16,95 @@
 #define CORE_RANDOMIZED_RM_H_
 
 #include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <vector>
 #include "core/resource_manager.h"
-#ifdef LINUX
-#include <parallel/algorithm>
-#endif  // LINUX
+#include "core/simulation.h"
+#include "core/util/random.h"
 
 namespace bdm {
 
+namespace detail {
+
+/// Bijective mapping of the index range [0, size) onto itself:
+/// `i -> (a * i + b) mod size` with `a` and `size` being coprime.
+class AffineIndexPermutation {
+ public:
+  AffineIndexPermutation() = default;
+
+  AffineIndexPermutation(uint64_t size, uint64_t seed_a, uint64_t seed_b)
+      : size_(size) {
+    if (size_ < 2) {
+      return;
+    }
+    a_ = 1 + seed_a % (size_ - 1);
+    while (Gcd(a_, size_) != 1) {
+      a_++;
+    }
+    b_ = seed_b % size_;
+  }
+
+  uint64_t operator()(uint64_t i) const {
+    return size_ < 2 ? i : (a_ * i + b_) % size_;
+  }
+
+ private:
+  uint64_t size_ = 0;
+  uint64_t a_ = 1;
+  uint64_t b_ = 0;
+
+  static uint64_t Gcd(uint64_t a, uint64_t b) {
+    while (b != 0) {
+      auto tmp = a % b;
+      a = b;
+      b = tmp;
+    }
+    return a;
+  }
+};
+
+/// Randomized visit order of the agents in one NUMA domain that preserves
+/// memory locality: The agents are divided into blocks of `kBlockSize`
+/// consecutive elements. The order of the blocks and the order inside each
+/// block are permuted. Elements in the last, incomplete block stay in the
+/// last block.
+class BlockPermutation {
+ public:
+  static constexpr uint64_t kBlockSize = 256;
+
+  BlockPermutation(uint64_t size, const std::array<uint64_t, 6>& seeds)
+      : num_full_blocks_(size / kBlockSize),
+        blocks_(num_full_blocks_, seeds[0], seeds[1]),
+        inner_(kBlockSize, seeds[2], seeds[3]),
+        tail_(size - num_full_blocks_ * kBlockSize, seeds[4], seeds[5]) {}
+
+  uint64_t operator()(uint64_t i) const {
+    auto block = i / kBlockSize;
+    if (block < num_full_blocks_) {
+      return blocks_(block) * kBlockSize + inner_(i % kBlockSize);
+    }
+    auto tail_start = num_full_blocks_ * kBlockSize;
+    return tail_start + tail_(i - tail_start);
+  }
+
+ private:
+  uint64_t num_full_blocks_;
+  AffineIndexPermutation blocks_;
+  AffineIndexPermutation inner_;
+  AffineIndexPermutation tail_;
+};
+
+}  // namespace detail
+
+/// Resource manager that visits the agents in a different random order in
+/// each iteration to avoid artifacts caused by a fixed update order.\n
+/// The agents are not moved in memory. Hence, the memory layout established
+/// by `LoadBalance` and the `AgentUid` to `AgentHandle` map stay intact.
+/// Only the visit order is randomized with a cheap bijective index
+/// permutation (see `detail::BlockPermutation`) that is redrawn in
+/// `EndOfIteration`.
 template <typename TBaseRm>
 class RandomizedRm : public TBaseRm {
  public:
@@ -30,10 +112,56 @@ class RandomizedRm : public TBaseRm {
   RandomizedRm();
   virtual ~RandomizedRm();
 
+  using TBaseRm::ForEachAgent;
+  using TBaseRm::ForEachAgentParallel;
+
+  void ForEachAgent(const std::function<void(Agent*)>& function,
+                    Functor<bool, Agent*>* filter = nullptr) override;
+
+  void ForEachAgent(const std::function<void(Agent*, AgentHandle)>& function,
+                    Functor<bool, Agent*>* filter = nullptr) override;
+
+  void ForEachAgentParallel(Functor<void, Agent*, AgentHandle>& function,
+                            Functor<bool, Agent*>* filter = nullptr) override;
+
+  void ForEachAgentParallel(uint64_t chunk,
+                            Functor<void, Agent*, AgentHandle>& function,
+                            Functor<bool, Agent*>* filter = nullptr) override;
+
   void EndOfIteration() override;
 
  protected:
+  /// Seeds of the permutation in the current iteration
+  std::array<uint64_t, 6> seeds_ = {{0, 0, 0, 0, 0, 0}};  //!
+
   BDM_CLASS_DEF_NV(RandomizedRm, 1);
+
+ private:
+  /// Maps the iteration index to the storage index (`AgentHandle`).
+  struct PermutedFunctor : public Functor<void, Agent*, AgentHandle> {
+    PermutedFunctor(RandomizedRm* rm,
+                    Functor<void, Agent*, AgentHandle>& function,
+                    Functor<bool, Agent*>* filter)
+        : rm_(rm), function_(function), filter_(filter) {
+      for (uint64_t n = 0; n < rm->agents_.size(); ++n) {
+        permutations_.emplace_back(rm->agents_[n].size(), rm->seeds_);
+      }
+    }
+
+    void operator()(Agent*, AgentHandle ah) override {
+      auto n = ah.GetNumaNode();
+      AgentHandle::ElementIdx_t idx = permutations_[n](ah.GetElementIdx());
+      auto* agent = rm_->agents_[n][idx];
+      if (!filter_ || (*filter_)(agent)) {
+        function_(agent, AgentHandle(n, idx));
+      }
+    }
+
+    RandomizedRm* rm_;
+    Functor<void, Agent*, AgentHandle>& function_;
+    Functor<bool, Agent*>* filter_;
+    std::vector<detail::BlockPermutation> permutations_;
+  };
 };
 
 // -----------------------------------------------------------------------------
@@ -44,41 +172,58 @@ RandomizedRm<TBaseRm>::RandomizedRm() = default;
 template <typename TBaseRm>
 RandomizedRm<TBaseRm>::~RandomizedRm() = default;
 
-struct Ubrng {
-  using result_type = uint32_t;
-  Random* random;
-  Ubrng(Random* random) : random(random) {}
-  static constexpr result_type min() { return 0; }
-  static constexpr result_type max() {
-    return std::numeric_limits<result_type>::max();
-  }
-  result_type operator()() {
-    return random->Integer(std::numeric_limits<result_type>::max());
+// -----------------------------------------------------------------------------
+template <typename TBaseRm>
+void RandomizedRm<TBaseRm>::ForEachAgent(
+    const std::function<void(Agent*)>& function,
+    Functor<bool, Agent*>* filter) {
+  ForEachAgent([&](Agent* agent, AgentHandle) { function(agent); }, filter);
+}
+
+// -----------------------------------------------------------------------------
+template <typename TBaseRm>
+void RandomizedRm<TBaseRm>::ForEachAgent(
+    const std::function<void(Agent*, AgentHandle)>& function,
+    Functor<bool, Agent*>* filter) {
+  for (AgentHandle::NumaNode_t n = 0; n < this->agents_.size(); ++n) {
+    auto& numa_agents = this->agents_[n];
+    detail::BlockPermutation permutation(numa_agents.size(), seeds_);
+    for (uint64_t i = 0; i < numa_agents.size(); ++i) {
+      AgentHandle::ElementIdx_t idx = permutation(i);
+      auto* a = numa_agents[idx];
+      if (!filter || (*filter)(a)) {
+        function(a, AgentHandle(n, idx));
+      }
+    }
   }
-};
+}
+
+// -----------------------------------------------------------------------------
+template <typename TBaseRm>
+void RandomizedRm<TBaseRm>::ForEachAgentParallel(
+    Functor<void, Agent*, AgentHandle>& function,
+    Functor<bool, Agent*>* filter) {
+  PermutedFunctor permuted(this, function, filter);
+  TBaseRm::ForEachAgentParallel(permuted);
+}
+
+// -----------------------------------------------------------------------------
+template <typename TBaseRm>
+void RandomizedRm<TBaseRm>::ForEachAgentParallel(
+    uint64_t chunk, Functor<void, Agent*, AgentHandle>& function,
+    Functor<bool, Agent*>* filter) {
+  PermutedFunctor permuted(this, function, filter);
+  TBaseRm::ForEachAgentParallel(chunk, permuted);
+}
 
 // -----------------------------------------------------------------------------
 template <typename TBaseRm>
 void RandomizedRm<TBaseRm>::EndOfIteration() {
   TBaseRm::EndOfIteration();
-  // shuffle
-#pragma omp parallel for schedule(static, 1)
-  for (uint64_t n = 0; n < this->agents_.size(); ++n) {
-#ifdef LINUX
-    __gnu_parallel::random_shuffle(this->agents_[n].begin(),
-                                   this->agents_[n].end());
-#else
-    auto* random = Simulation::GetActive()->GetRandom();
-    std::shuffle(this->agents_[n].begin(), this->agents_[n].end(),
-                 Ubrng(random));
-#endif  // LINUX
+  auto* random = Simulation::GetActive()->GetRandom();
+  for (auto& seed : seeds_) {
+    seed = random->Integer(std::numeric_limits<int>::max());
   }
-
-  // update uid_ah_map_
-  auto update_agent_map = L2F([this](Agent* a, AgentHandle ah) {
-    this->uid_ah_map_.Insert(a->GetUid(), ah);
-  });
-  TBaseRm::ForEachAgentParallel(update_agent_map);
 }
 
 }  // namespace bdm
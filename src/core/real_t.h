@@ -34,6 +34,19 @@ constexpr const char* kRealtName = BDM_STRINGIFY(BDM_REALT);
 
 #endif  // BDM_REALT
 
+/// Floating point type used to accumulate quantities that are summed over
+/// many contributions (e.g. the mechanical forces acting on an agent) or
+/// over many iterations (e.g. the simulated time).\n
+/// Agent state is stored in `real_t`. Building with `-Dreal_t=float`
+/// therefore halves the memory footprint and bandwidth of the agent state,
+/// while the accumulation keeps using double precision (mixed precision).
+/// Define `BDM_REAL_ACC_T` to override the accumulation type.
+#ifndef BDM_REAL_ACC_T
+using real_acc_t = double;
+#else
+using real_acc_t = BDM_REAL_ACC_T;
+#endif  // BDM_REAL_ACC_T
+
 }  // namespace bdm
 
 #endif  // CORE_REAL_H_
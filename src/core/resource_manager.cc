@@ -13,20 +13,49 @@
 // -----------------------------------------------------------------------------
 
 #include "core/resource_manager.h"
+#include <algorithm>
 #include <cmath>
-#ifndef NDEBUG
+#include <cstring>
 #include <set>
-#endif  // NDEBUG
 #include "core/algorithm.h"
+#include "core/behavior/behavior.h"
 #include "core/container/shared_data.h"
 #include "core/environment/environment.h"
 #include "core/simulation.h"
 #include "core/util/partition.h"
 #include "core/util/plot_memory_layout.h"
+#include "core/util/serialization.h"
 #include "core/util/timing.h"
 
 namespace bdm {
 
+namespace {
+
+/// Number of agents that are encoded or decoded together by
+/// `ResourceManager::WriteAgents` and `ResourceManager::ReadAgents`.
+constexpr uint64_t kAgentsPerChunk = 4096;
+
+/// Calls `function` for the agents with index `start` until `end`
+/// (exclusive) if the agents of all NUMA nodes are concatenated.
+/// `offsets[n]` is the index of the first agent of NUMA node `n`.
+template <typename TAgents, typename TFunction>
+void ForEachAgentInRange(TAgents* agents, const std::vector<uint64_t>& offsets,
+                         uint64_t start, uint64_t end,
+                         const TFunction& function) {
+  uint64_t numa = std::upper_bound(offsets.begin(), offsets.end(), start) -
+                  offsets.begin() - 1;
+  uint64_t i = start - offsets[numa];
+  for (uint64_t idx = start; idx < end; ++idx, ++i) {
+    while (i >= (*agents)[numa].size()) {
+      ++numa;
+      i = 0;
+    }
+    function((*agents)[numa][i]);
+  }
+}
+
+}  // namespace
+
 ResourceManager::ResourceManager() {
   // Must be called prior any other function call to libnuma
   if (auto ret = numa_available() == -1) {
@@ -43,6 +72,11 @@ ResourceManager::ResourceManager() {
 }
 
 ResourceManager::~ResourceManager() {
+  for (auto& graveyard : graveyards_) {
+    for (auto* agent : graveyard) {
+      delete agent;
+    }
+  }
   for (auto& el : continuum_models_) {
     delete el.second;
   }
@@ -51,6 +85,9 @@ ResourceManager::~ResourceManager() {
       delete agent;
     }
   }
+  for (auto* behavior : shared_behaviors_) {
+    delete behavior;
+  }
   if (type_index_) {
     delete type_index_;
   }
@@ -246,23 +283,46 @@ void ResourceManager::LoadBalance() {
     PlotNeighborMemoryHistogram(true);
   }
 
+  auto* env = Simulation::GetActive()->GetEnvironment();
+  auto lbi = env->GetLoadBalanceInfo();
+
   // balance agents per numa node according to the number of
   // threads associated with each numa domain
   auto numa_nodes = thread_info_->GetNumaNodes();
   std::vector<uint64_t> agent_per_numa(numa_nodes);
   std::vector<uint64_t> agent_per_numa_cumm(numa_nodes);
-  uint64_t cummulative = 0;
   auto max_threads = thread_info_->GetMaxThreads();
-  for (int n = 1; n < numa_nodes; ++n) {
-    auto threads_in_numa = thread_info_->GetThreadsInNumaNode(n);
-    uint64_t num_agents = GetNumAgents() * threads_in_numa / max_threads;
-    agent_per_numa[n] = num_agents;
-    cummulative += num_agents;
-  }
-  agent_per_numa[0] = GetNumAgents() - cummulative;
-  agent_per_numa_cumm[0] = 0;
-  for (int n = 1; n < numa_nodes; ++n) {
-    agent_per_numa_cumm[n] = agent_per_numa_cumm[n - 1] + agent_per_numa[n - 1];
+  auto total_agents = GetNumAgents();
+  if (param->weighted_load_balancing) {
+    // split the Morton ordered agents at the points where the cummulated
+    // estimated cost matches the share of threads of the previous numa nodes
+    uint64_t threads_before = 0;
+    agent_per_numa_cumm[0] = 0;
+    for (int n = 1; n < numa_nodes; ++n) {
+      threads_before += thread_info_->GetThreadsInNumaNode(n - 1);
+      auto split = lbi->GetCostSplitPoint(
+          static_cast<real_t>(threads_before) / max_threads, total_agents);
+      agent_per_numa_cumm[n] =
+          std::min(std::max(split, agent_per_numa_cumm[n - 1]), total_agents);
+    }
+    for (int n = 0; n < numa_nodes; ++n) {
+      auto end = n + 1 < numa_nodes ? agent_per_numa_cumm[n + 1] : total_agents;
+      agent_per_numa[n] = end - agent_per_numa_cumm[n];
+    }
+  } else {
+    uint64_t cummulative = 0;
+    for (int n = 1; n < numa_nodes; ++n) {
+      auto threads_in_numa = thread_info_->GetThreadsInNumaNode(n);
+      uint64_t num_agents = total_agents * threads_in_numa / max_threads;
+      agent_per_numa[n] = num_agents;
+      cummulative += num_agents;
+    }
+    agent_per_numa[0] = total_agents - cummulative;
+    agent_per_numa_cumm[0] = 0;
+    for (int n = 1; n < numa_nodes; ++n) {
+      agent_per_numa_cumm[n] =
+          agent_per_numa_cumm[n - 1] + agent_per_numa[n - 1];
+    }
   }
 
   // using first touch policy - page will be allocated to the numa domain of
@@ -273,9 +333,6 @@ void ResourceManager::LoadBalance() {
     Log::Fatal("ResourceManager",
                "Run on numa node failed. Return code: ", ret);
   }
-  auto* env = Simulation::GetActive()->GetEnvironment();
-  auto lbi = env->GetLoadBalanceInfo();
-
   const bool minimize_memory = param->minimize_memory_while_rebalancing;
 
 // create new agents
@@ -349,6 +406,11 @@ void ResourceManager::RemoveAgents(
 
   std::vector<uint64_t> remove(numa_nodes);
   std::vector<uint64_t> lowest(numa_nodes);
+  bool defer_deletion =
+      Simulation::GetActive()->GetParam()->defer_agent_deletion;
+  if (defer_deletion) {
+    graveyards_.resize(thread_info_->GetMaxThreads());
+  }
   parallel_remove_.to_right.resize(numa_nodes);
   parallel_remove_.not_to_left.resize(numa_nodes);
   // thread offsets into to_right and not_to_left
@@ -553,25 +615,102 @@ void ResourceManager::RemoveAgents(
       end_del += lowest[nid];
 
       auto* uid_generator = Simulation::GetActive()->GetAgentUidGenerator();
+      auto tid = thread_info_->GetMyThreadId();
+      std::vector<AgentUid> reusable_uids;
+      reusable_uids.reserve(end_del - start_del);
       for (uint64_t i = start_del; i < end_del; ++i) {
         Agent* agent = agents_[nid][i];
         auto uid = agent->GetUid();
         assert(toberemoved.find(uid) != toberemoved.end());
         uid_ah_map_.Remove(uid);
-        uid_generator->ReuseAgentUid(uid);
+        reusable_uids.push_back(uid);
         if (type_index_) {
           // TODO parallelize type_index removal
 #pragma omp critical
           type_index_->Remove(agent);
         }
-        delete agent;
+        if (defer_deletion) {
+          graveyards_[tid].push_back(agent);
+        } else {
+          delete agent;
+        }
       }
+      uid_generator->ReuseAgentUids(reusable_uids);
     }
   }
   // shrink container
   for (uint64_t n = 0; n < agents_.size(); ++n) {
     agents_[n].resize(lowest[n]);
   }
+  // uids of removed agents should be reusable from all threads
+  Simulation::GetActive()->GetAgentUidGenerator()->BalanceReusableUids();
+  MarkEnvironmentOutOfSync();
+}
+
+// -----------------------------------------------------------------------------
+void ResourceManager::EmptyGraveyards() {
+  if (GetNumAgentsInGraveyards() == 0) {
+    return;
+  }
+  // Agents are deleted by the thread that removed them. Thus, the memory
+  // is returned to the free list of the thread (and numa node) that used
+  // the agent last. With one thread per graveyard and a chunk size of one,
+  // graveyard i is emptied by thread i.
+  auto num_threads = thread_info_->GetMaxThreads();
+  assert(graveyards_.size() == static_cast<uint64_t>(num_threads));
+#pragma omp parallel for schedule(static, 1) num_threads(num_threads)
+  for (uint64_t i = 0; i < graveyards_.size(); ++i) {
+    assert(thread_info_->GetMyThreadId() == static_cast<int>(i));
+    auto& graveyard = graveyards_[i];
+    for (auto* agent : graveyard) {
+      delete agent;
+    }
+    graveyard.clear();
+  }
+}
+
+// -----------------------------------------------------------------------------
+void ResourceManager::CompactAgentUids() {
+  auto* agent_uid_generator = Simulation::GetActive()->GetAgentUidGenerator();
+  auto num_agents = GetNumAgents();
+
+  // the new index of an agent is its position in the concatenation of all
+  // numa node containers
+  std::vector<uint64_t> numa_offsets(agents_.size());
+  for (uint64_t n = 1; n < agents_.size(); ++n) {
+    numa_offsets[n] = numa_offsets[n - 1] + agents_[n - 1].size();
+  }
+
+  AgentUidMap<AgentUid> new_uids(agent_uid_generator->GetHighestIndex() + 1);
+  auto assign = L2F([&](Agent* agent, AgentHandle ah) {
+    new_uids.Insert(agent->GetUid(),
+                    AgentUid(static_cast<AgentUid::Index_t>(
+                        numa_offsets[ah.GetNumaNode()] + ah.GetElementIdx())));
+  });
+  ForEachAgentParallel(assign);
+
+  auto update = L2F(
+      [&](Agent* agent, AgentHandle) { agent->UpdateAgentUids(new_uids); });
+  ForEachAgentParallel(update);
+
+  uid_ah_map_.Reset(num_agents * 1.5 + 1);
+  auto rebuild = L2F([&](Agent* agent, AgentHandle ah) {
+    uid_ah_map_.Insert(agent->GetUid(), ah);
+  });
+  ForEachAgentParallel(rebuild);
+
+  agent_uid_generator->Reset(static_cast<AgentUid::Index_t>(num_agents));
+
+  if (type_index_) {
+    delete type_index_;
+    type_index_ = new TypeIndex();
+    type_index_->Reserve(num_agents);
+    for (auto& numa_agents : agents_) {
+      for (auto* agent : numa_agents) {
+        type_index_->Add(agent);
+      }
+    }
+  }
   MarkEnvironmentOutOfSync();
 }
 
@@ -585,6 +724,180 @@ void ResourceManager::SwapAgents(std::vector<std::vector<Agent*>>* agents) {
   agents_.swap(*agents);
 }
 
+void ResourceManager::AddSharedBehavior(Behavior* behavior) {
+  std::lock_guard<Spinlock> guard(shared_behaviors_lock_);
+  shared_behaviors_.push_back(behavior);
+}
+
+// -----------------------------------------------------------------------------
+void ResourceManager::WriteAgents(
+    std::vector<char>* buffer, std::vector<const Agent*>* external_agents,
+    std::vector<const Behavior*>* external_behaviors) const {
+  BinaryWriter writer(buffer);
+  writer.SetExternalObjects(external_agents, external_behaviors);
+  writer.WriteVersion(1);
+
+  // Falling back to ROOT is not thread-safe. If it is needed for at least
+  // one agent, all agents are encoded sequentially.
+  bool all_binary = true;
+  for (auto& numa_agents : agents_) {
+#pragma omp parallel for reduction(&& : all_binary)
+    for (uint64_t i = 0; i < numa_agents.size(); ++i) {
+      all_binary = all_binary && IsBinarySerializable(numa_agents[i]);
+    }
+  }
+
+  // Shared behaviors are written once; agents refer to them by index.
+  // Agents that fall back to ROOT also write their behaviors with ROOT. If
+  // these agents are external objects, the shared behaviors are external
+  // objects as well. Thus, ROOT writes each of them once and resolves the
+  // pointers of the agents to the same object.
+  bool external_shared = !all_binary && external_behaviors != nullptr;
+  std::unordered_map<const Behavior*, uint64_t> shared;
+  writer.Write(static_cast<uint64_t>(shared_behaviors_.size()));
+  for (uint64_t i = 0; i < shared_behaviors_.size(); ++i) {
+    if (external_shared) {
+      WriteExternalBehavior(&writer, shared_behaviors_[i]);
+    } else {
+      WriteBehavior(&writer, shared_behaviors_[i]);
+    }
+    shared[shared_behaviors_[i]] = i;
+  }
+
+  std::vector<uint64_t> offsets(agents_.size() + 1, 0);
+  writer.Write(static_cast<uint64_t>(agents_.size()));
+  for (uint64_t n = 0; n < agents_.size(); ++n) {
+    writer.Write(static_cast<uint64_t>(agents_[n].size()));
+    offsets[n + 1] = offsets[n] + agents_[n].size();
+  }
+  // Chunks can be decoded in parallel if they do not contain ROOT buffers.
+  bool parallel_read = all_binary || (external_agents != nullptr &&
+                                      external_behaviors != nullptr);
+
+  auto num_agents = offsets.back();
+  auto num_chunks = (num_agents + kAgentsPerChunk - 1) / kAgentsPerChunk;
+  std::vector<std::vector<char>> chunks(num_chunks);
+  auto encode = [&](uint64_t c) {
+    BinaryWriter chunk_writer(&chunks[c]);
+    chunk_writer.SetSharedBehaviors(&shared);
+    chunk_writer.SetExternalObjects(external_agents, external_behaviors);
+    auto end = std::min(num_agents, (c + 1) * kAgentsPerChunk);
+    ForEachAgentInRange(&agents_, offsets, c * kAgentsPerChunk, end,
+                        [&](const Agent* agent) {
+                          WriteAgent(&chunk_writer, agent);
+                        });
+  };
+  if (all_binary) {
+#pragma omp parallel for schedule(dynamic, 1)
+    for (uint64_t c = 0; c < num_chunks; ++c) {
+      encode(c);
+    }
+  } else {
+    for (uint64_t c = 0; c < num_chunks; ++c) {
+      encode(c);
+    }
+  }
+
+  writer.Write(parallel_read, static_cast<uint64_t>(num_chunks));
+  std::vector<uint64_t> chunk_offsets(num_chunks + 1, buffer->size() +
+                                                          num_chunks *
+                                                              sizeof(uint64_t));
+  for (uint64_t c = 0; c < num_chunks; ++c) {
+    writer.Write(static_cast<uint64_t>(chunks[c].size()));
+    chunk_offsets[c + 1] = chunk_offsets[c] + chunks[c].size();
+  }
+  buffer->resize(chunk_offsets.back());
+#pragma omp parallel for schedule(dynamic, 1)
+  for (uint64_t c = 0; c < num_chunks; ++c) {
+    std::memcpy(buffer->data() + chunk_offsets[c], chunks[c].data(),
+                chunks[c].size());
+  }
+}
+
+// -----------------------------------------------------------------------------
+void ResourceManager::ReadAgents(
+    const char* data, uint64_t size,
+    const std::vector<Agent*>* external_agents,
+    const std::vector<Behavior*>* external_behaviors) {
+  for (auto& numa_agents : agents_) {
+    if (!numa_agents.empty()) {
+      Log::Fatal("ResourceManager::ReadAgents",
+                 "Agents can only be read into an empty ResourceManager.");
+    }
+  }
+
+  BinaryReader reader(data, size);
+  reader.SetExternalObjects(external_agents, external_behaviors);
+  reader.SetResourceManager(this);
+  reader.ReadVersion(1, "ResourceManager::agents_");
+
+  uint64_t num_shared;
+  reader.Read(num_shared);
+  std::vector<Behavior*> shared(num_shared);
+  for (auto& behavior : shared) {
+    behavior = ReadBehavior(&reader);
+  }
+
+  uint64_t num_numa_nodes;
+  reader.Read(num_numa_nodes);
+  agents_.resize(num_numa_nodes);
+  std::vector<uint64_t> offsets(num_numa_nodes + 1, 0);
+  for (uint64_t n = 0; n < num_numa_nodes; ++n) {
+    uint64_t num_agents;
+    reader.Read(num_agents);
+    agents_[n].resize(num_agents);
+    offsets[n + 1] = offsets[n] + num_agents;
+  }
+
+  bool parallel;
+  uint64_t num_chunks;
+  reader.Read(parallel, num_chunks);
+  std::vector<uint64_t> chunk_offsets(num_chunks + 1);
+  chunk_offsets[0] = reader.GetPosition() + num_chunks * sizeof(uint64_t);
+  for (uint64_t c = 0; c < num_chunks; ++c) {
+    uint64_t chunk_size;
+    reader.Read(chunk_size);
+    chunk_offsets[c + 1] = chunk_offsets[c] + chunk_size;
+  }
+  auto num_agents = offsets.back();
+  if (chunk_offsets.back() != size ||
+      num_chunks != (num_agents + kAgentsPerChunk - 1) / kAgentsPerChunk) {
+    Log::Fatal("ResourceManager::ReadAgents", "The agent data is corrupted.");
+  }
+
+  auto decode = [&](uint64_t c) {
+    BinaryReader chunk_reader(data + chunk_offsets[c],
+                              chunk_offsets[c + 1] - chunk_offsets[c]);
+    chunk_reader.SetSharedBehaviors(&shared);
+    chunk_reader.SetExternalObjects(external_agents, external_behaviors);
+    chunk_reader.SetResourceManager(this);
+    auto end = std::min(num_agents, (c + 1) * kAgentsPerChunk);
+    ForEachAgentInRange(
+        &agents_, offsets, c * kAgentsPerChunk, end,
+        [&](Agent*& agent) { agent = ReadAgent(&chunk_reader); });
+    if (!chunk_reader.AtEnd()) {
+      Log::Fatal("ResourceManager::ReadAgents", "The agent data is corrupted.");
+    }
+  };
+  if (parallel) {
+#pragma omp parallel for schedule(dynamic, 1)
+    for (uint64_t c = 0; c < num_chunks; ++c) {
+      decode(c);
+    }
+  } else {
+    for (uint64_t c = 0; c < num_chunks; ++c) {
+      decode(c);
+    }
+  }
+
+  // This ResourceManager owns the shared behaviors, including those that are
+  // not attached to any agent.
+  std::lock_guard<Spinlock> guard(shared_behaviors_lock_);
+  shared_behaviors_.insert(shared_behaviors_.end(), shared.begin(),
+                           shared.end());
+}
+
+// -----------------------------------------------------------------------------
 void ResourceManager::MarkEnvironmentOutOfSync() {
   auto* env = Simulation::GetActive()->GetEnvironment();
   env->MarkAsOutOfSync();
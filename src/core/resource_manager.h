@@ -32,6 +32,7 @@
 #include "core/agent/agent_handle.h"
 #include "core/agent/agent_uid.h"
 #include "core/agent/agent_uid_generator.h"
+#include "core/behavior/behavior.h"
 #include "core/container/agent_uid_map.h"
 #include "core/diffusion/continuum_interface.h"
 #include "core/diffusion/diffusion_grid.h"
@@ -41,6 +42,7 @@
 #include "core/type_index.h"
 #include "core/util/numa.h"
 #include "core/util/root.h"
+#include "core/util/spinlock.h"
 #include "core/util/thread_info.h"
 #include "core/util/type.h"
 
@@ -71,8 +73,13 @@ class ResourceManager {
         delete agent;
       }
     }
+    for (auto* behavior : shared_behaviors_) {
+      delete behavior;
+    }
     agents_ = std::move(other.agents_);
     agents_lb_.resize(agents_.size());
+    shared_behaviors_ = std::move(other.shared_behaviors_);
+    other.shared_behaviors_.clear();
     continuum_models_ = std::move(other.continuum_models_);
 
     RebuildAgentUidMap();
@@ -418,6 +425,17 @@ class ResourceManager {
     }
   }
 
+  /// Renumbers the AgentUid indices of all agents densely (`0` to
+  /// `GetNumAgents() - 1`) following the current memory order.
+  /// Afterwards, the AgentUid map, the type index, and the reusable uids of
+  /// the AgentUidGenerator are shrunk to the new number of agents.
+  /// AgentPointers stored inside agents are updated through
+  /// `Agent::UpdateAgentUids`. \n
+  /// NB: This method is not thread-safe! It must not be called while
+  /// new agents are pending in the execution contexts. AgentUids that are
+  /// stored outside of agents become invalid.
+  void CompactAgentUids();
+
   virtual void EndOfIteration() {}
 
   /// Adds `new_agents` to `agents_[numa_node]`. `offset` specifies
@@ -484,8 +502,50 @@ class ResourceManager {
   //              node
   void RemoveAgents(const std::vector<std::vector<AgentUid>*>& uids);
 
+  /// Deletes all agents that have been removed by `RemoveAgents` if
+  /// `Param::defer_agent_deletion` is set. Each thread deletes the agents that
+  /// it moved to its graveyard.\n
+  /// NB: Must not be called from within a parallel region.
+  void EmptyGraveyards();
+
+  /// Returns the number of removed agents which have not been deleted yet.
+  uint64_t GetNumAgentsInGraveyards() const {
+    uint64_t num = 0;
+    for (auto& graveyard : graveyards_) {
+      num += graveyard.size();
+    }
+    return num;
+  }
+
   const TypeIndex* GetTypeIndex() const { return type_index_; }
 
+  /// Takes over the ownership of a shared behavior. Shared behaviors are
+  /// deleted together with the ResourceManager.\n
+  /// Thread-safe.
+  /// \see `Behavior::Share`
+  void AddSharedBehavior(Behavior* behavior);
+
+  /// Appends all agents and their behaviors to `buffer` using the binary
+  /// serialization layer (see `BDM_SERIALIZE`). Agents are encoded in
+  /// parallel if all of them support it. Shared behaviors are written only
+  /// once.\n
+  /// Agents and behaviors without binary serialization are appended to
+  /// `external_agents` and `external_behaviors` if they are given (see
+  /// `BinaryWriter::SetExternalObjects`), or embedded as ROOT buffers
+  /// otherwise.
+  void WriteAgents(std::vector<char>* buffer,
+                   std::vector<const Agent*>* external_agents = nullptr,
+                   std::vector<const Behavior*>* external_behaviors =
+                       nullptr) const;
+
+  /// Reads the agents that have been written with `WriteAgents` into this
+  /// ResourceManager, which must not contain any agents. As after a
+  /// restore, the agent uid map and the shared behaviors are only rebuilt
+  /// when this ResourceManager is moved into the one of a simulation.
+  void ReadAgents(const char* data, uint64_t size,
+                  const std::vector<Agent*>* external_agents = nullptr,
+                  const std::vector<Behavior*>* external_behaviors = nullptr);
+
  protected:
   /// Adding and removing agents does not immediately reflect in the state of
   /// the environment. This function sets a flag in the envrionment such that
@@ -494,14 +554,15 @@ class ResourceManager {
 
   /// Maps an AgentUid to its storage location in `agents_` \n
   AgentUidMap<AgentHandle> uid_ah_map_ = AgentUidMap<AgentHandle>(100u);  //!
-  /// Pointer container for all agents
-  std::vector<std::vector<Agent*>> agents_;
+  /// Pointer container for all agents.
+  /// Written with `WriteAgents` by the custom streamer.
+  std::vector<std::vector<Agent*>> agents_;  //!
   /// Container used during load balancing
   std::vector<std::vector<Agent*>> agents_lb_;  //!
 
   ThreadInfo* thread_info_ = ThreadInfo::GetInstance();  //!
 
-  TypeIndex* type_index_ = nullptr;
+  TypeIndex* type_index_ = nullptr;  //!
 
   struct ParallelRemovalAuxData {
     std::vector<std::vector<uint64_t>> to_right;
@@ -511,6 +572,14 @@ class ResourceManager {
   /// auxiliary data required for parallel agent removal
   ParallelRemovalAuxData parallel_remove_;  //!
 
+  /// Agents that have been removed, but not yet deleted.
+  /// One vector per thread. \see `EmptyGraveyards`
+  std::vector<std::vector<Agent*>> graveyards_;  //!
+
+  /// Behaviors that are shared between agents. \see `Behavior::Share`
+  std::vector<Behavior*> shared_behaviors_;  //!
+  Spinlock shared_behaviors_lock_;           //!
+
   friend class SimulationBackup;
   friend std::ostream& operator<<(std::ostream& os, const ResourceManager& rm);
 
@@ -518,7 +587,7 @@ class ResourceManager {
   /// Maps a continuum ID to the pointer to the continuum models
   std::unordered_map<uint64_t, Continuum*> continuum_models_;
 
-  BDM_CLASS_DEF_NV(ResourceManager, 2);
+  BDM_CLASS_DEF_NV(ResourceManager, 3);
 };
 
 inline std::ostream& operator<<(std::ostream& os, const ResourceManager& rm) {
@@ -531,6 +600,72 @@ inline std::ostream& operator<<(std::ostream& os, const ResourceManager& rm) {
   return os;
 }
 
+// The following custom streamer should be visible to rootcling for dictionary
+// generation, but not to the interpreter!
+#if (!defined(__CLING__) || defined(__ROOTCLING__)) && defined(USE_DICT)
+
+// The custom streamer writes the agents with the binary serialization layer,
+// which is considerably faster than ROOT's streamers. Agents and behaviors
+// without binary serialization are written with ROOT after the binary data,
+// so that pointers to continuum models remain valid.
+inline void ResourceManager::Streamer(TBuffer& R__b) {
+  // TBuffer functions take the number of elements as Int_t.
+  constexpr uint64_t kMaxArraySize = 1 << 30;
+  if (R__b.IsReading()) {
+    UInt_t start;
+    UInt_t count;
+    Version_t version = R__b.ReadVersion(&start, &count);
+    if (version < 3) {
+      Log::Fatal("ResourceManager::Streamer",
+                 "The agents of this backup have been written by an older "
+                 "version of BioDynaMo and cannot be restored.");
+    }
+    R__b.ReadClassBuffer(ResourceManager::Class(), this, version, start,
+                         count);
+    Long64_t size;
+    R__b.ReadLong64(size);
+    std::vector<char> data(size);
+    for (uint64_t i = 0; i < data.size(); i += kMaxArraySize) {
+      auto n = std::min(kMaxArraySize, data.size() - i);
+      R__b.ReadFastArray(data.data() + i, static_cast<Int_t>(n));
+    }
+    Long64_t num_external;
+    R__b.ReadLong64(num_external);
+    std::vector<Behavior*> external_behaviors(num_external);
+    for (auto& behavior : external_behaviors) {
+      behavior = static_cast<Behavior*>(R__b.ReadObjectAny(Behavior::Class()));
+    }
+    R__b.ReadLong64(num_external);
+    std::vector<Agent*> external_agents(num_external);
+    for (auto& agent : external_agents) {
+      agent = static_cast<Agent*>(R__b.ReadObjectAny(Agent::Class()));
+    }
+    ReadAgents(data.data(), data.size(), &external_agents,
+               &external_behaviors);
+  } else {
+    R__b.WriteClassBuffer(ResourceManager::Class(), this);
+    std::vector<char> data;
+    std::vector<const Agent*> external_agents;
+    std::vector<const Behavior*> external_behaviors;
+    WriteAgents(&data, &external_agents, &external_behaviors);
+    R__b.WriteLong64(static_cast<Long64_t>(data.size()));
+    for (uint64_t i = 0; i < data.size(); i += kMaxArraySize) {
+      auto n = std::min(kMaxArraySize, data.size() - i);
+      R__b.WriteFastArray(data.data() + i, static_cast<Int_t>(n));
+    }
+    R__b.WriteLong64(static_cast<Long64_t>(external_behaviors.size()));
+    for (auto* behavior : external_behaviors) {
+      R__b.WriteObjectAny(behavior, behavior->IsA());
+    }
+    R__b.WriteLong64(static_cast<Long64_t>(external_agents.size()));
+    for (auto* agent : external_agents) {
+      R__b.WriteObjectAny(agent, agent->IsA());
+    }
+  }
+}
+
+#endif  // !defined(__CLING__) || defined(__ROOTCLING__)
+
 }  // namespace bdm
 
 #endif  // CORE_RESOURCE_MANAGER_H_
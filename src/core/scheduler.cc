@@ -13,12 +13,15 @@
 // -----------------------------------------------------------------------------
 
 #include "core/scheduler.h"
+#include <omp.h>
+#include <cassert>
 #include <chrono>
 #include <iomanip>
 #include <string>
 #include <utility>
 #include "core/execution_context/in_place_exec_ctxt.h"
 #include "core/operation/bound_space_op.h"
+#include "core/operation/concurrent_op_executor.h"
 #include "core/operation/continuum_op.h"
 #include "core/operation/mechanical_forces_op.h"
 #include "core/operation/op_timer.h"
@@ -48,8 +51,8 @@ Scheduler::Scheduler() {
       "mechanical forces", "discretization", "propagate staticness agentop",
       "continuum"};
 
-  std::vector<std::string> pre_scheduled_ops_names = {"set up iteration",
-                                                      "propagate staticness"};
+  std::vector<std::string> pre_scheduled_ops_names = {
+      "set up iteration", "neighbor density", "propagate staticness"};
   // We cannot put sort and balance in the list of scheduled_standalone_ops_,
   // because numa-aware data structures would be invalidated:
   // ```
@@ -61,8 +64,8 @@ Scheduler::Scheduler() {
   // agents that are not yet in the environment (which load balancing
   // relies on)
   std::vector<std::string> post_scheduled_ops_names = {
-      "load balancing", "tear down iteration", "update environment",
-      "visualize", "update time series"};
+      "load balancing",    "tear down iteration", "compact agent uids",
+      "update environment", "visualize",          "update time series"};
 
   protected_op_names_ = {"update staticness",
                          "discretization",
@@ -71,12 +74,27 @@ Scheduler::Scheduler() {
                          "update environment",
                          "tear down iteration"};
 
+  // These operations remove agents, or change the agent storage or the
+  // environment. Hence, they must not overlap with concurrent operations.
+  exclusive_op_names_ = {"load balancing", "tear down iteration",
+                         "compact agent uids", "update environment"};
+
   auto disabled_op_names =
       Simulation::GetActive()->GetParam()->unschedule_default_operations;
-  if (!param->detect_static_agents) {
+  // With box-level staticness detection, the UniformGridEnvironment
+  // propagates staticness during its update.
+  bool static_boxes =
+      param->detect_static_boxes && param->environment == "uniform_grid";
+  if (!param->detect_static_agents || static_boxes) {
     disabled_op_names.push_back("propagate staticness");
     disabled_op_names.push_back("propagate staticness agentop");
   }
+  if (param->agent_uid_compaction_threshold <= 0) {
+    disabled_op_names.push_back("compact agent uids");
+  }
+  if (!param->compute_neighbor_density) {
+    disabled_op_names.push_back("neighbor density");
+  }
 
   std::vector<std::vector<std::string>*> all_op_names;
   all_op_names.push_back(&pre_scheduled_ops_names);
@@ -115,10 +133,20 @@ Scheduler::Scheduler() {
   if (!GetOps("visualize").empty()) {
     GetOps("visualize")[0]->GetImplementation<VisualizationOp>()->Initialize();
   }
+
+  if (!param->concurrent_ops.empty()) {
+    concurrent_executor_ =
+        new ConcurrentOpExecutor(param->concurrent_op_threads);
+  }
+  AddOpDependency("visualize", "continuum");
+  AddOpDependency("update time series", "continuum");
+
   ScheduleOps();
 }
 
 Scheduler::~Scheduler() {
+  // Join the worker thread before the operations are deleted.
+  delete concurrent_executor_;
   for (auto* op : all_ops_) {
     delete op;
   }
@@ -235,6 +263,16 @@ std::vector<Operation*> Scheduler::GetOps(const std::string& name) {
   return ret;
 }
 
+// -----------------------------------------------------------------------------
+void Scheduler::AddOpDependency(const std::string& op_name,
+                                const std::string& dependency_name) {
+  auto& dependencies = op_dependencies_[op_name];
+  if (std::find(dependencies.begin(), dependencies.end(), dependency_name) ==
+      dependencies.end()) {
+    dependencies.push_back(dependency_name);
+  }
+}
+
 // -----------------------------------------------------------------------------
 void Scheduler::SetAgentFilters(
     const std::vector<Functor<bool, Agent*>*>& agent_filters) {
@@ -247,17 +285,17 @@ const std::vector<Functor<bool, Agent*>*>& Scheduler::GetAgentFilters() const {
 }
 
 struct RunAllScheduledOps : Functor<void, Agent*, AgentHandle> {
-  explicit RunAllScheduledOps(std::vector<Operation*>& scheduled_ops)
-      : scheduled_ops_(scheduled_ops) {
-    sim_ = Simulation::GetActive();
-  }
+  RunAllScheduledOps(std::vector<Operation*>& scheduled_ops,
+                     const std::vector<IterationContext>& iteration_contexts)
+      : scheduled_ops_(scheduled_ops), iteration_contexts_(iteration_contexts) {}
 
   void operator()(Agent* agent, AgentHandle ah) override {
-    sim_->GetExecutionContext()->Execute(agent, ah, scheduled_ops_);
+    const auto& ctxt = iteration_contexts_[omp_get_thread_num()];
+    ctxt.exec_ctxt->Execute(agent, ah, scheduled_ops_, ctxt);
   }
 
-  Simulation* sim_;
   std::vector<Operation*>& scheduled_ops_;
+  const std::vector<IterationContext>& iteration_contexts_;
 };
 
 void Scheduler::SetUpOps() {
@@ -271,21 +309,88 @@ void Scheduler::SetUpOps() {
 void Scheduler::TearDownOps() {
   ForEachScheduledOperation([&](Operation* op) {
     if (op->frequency_ != 0 && total_steps_ % op->frequency_ == 0) {
+      if (IsConcurrentOp(op) && concurrent_executor_->IsRunning(op)) {
+        // The operation must not be torn down while it is still running.
+        deferred_tear_down_ops_.push_back(op);
+        return;
+      }
       Timing::Time(op->name_, [&]() { op->TearDown(); });
     }
   });
 }
 
 void Scheduler::RunPreScheduledOps() {
+  UpdateIterationContexts();
   for (auto* pre_op : pre_scheduled_ops_) {
     if (pre_op->frequency_ != 0 && total_steps_ % pre_op->frequency_ == 0) {
-      Timing::Time(pre_op->name_, [&]() { (*pre_op)(); });
+      RunStandaloneOp(pre_op);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+bool Scheduler::IsConcurrentOp(Operation* op) const {
+  if (concurrent_executor_ == nullptr || !op->IsStandalone()) {
+    return false;
+  }
+  const auto& names = Simulation::GetActive()->GetParam()->concurrent_ops;
+  if (std::find(names.begin(), names.end(), op->name_) == names.end()) {
+    return false;
+  }
+  if (!op->SupportsConcurrentExecution()) {
+    Log::Fatal("Scheduler::IsConcurrentOp", "The operation '", op->name_,
+               "' is listed in Param::concurrent_ops, but does not support "
+               "concurrent execution (see "
+               "OperationImpl::SupportsConcurrentExecution).");
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+void Scheduler::RunStandaloneOp(Operation* op) {
+  if (std::find(exclusive_op_names_.begin(), exclusive_op_names_.end(),
+                op->name_) != exclusive_op_names_.end()) {
+    WaitForConcurrentOps();
+  } else if (concurrent_executor_ != nullptr) {
+    auto it = op_dependencies_.find(op->name_);
+    if (it != op_dependencies_.end()) {
+      for (auto* running : all_ops_) {
+        if (std::find(it->second.begin(), it->second.end(), running->name_) !=
+                it->second.end() &&
+            concurrent_executor_->IsRunning(running)) {
+          WaitForConcurrentOps();
+          break;
+        }
+      }
     }
   }
+
+  if (IsConcurrentOp(op)) {
+    concurrent_executor_->Launch(op);
+  } else {
+    const auto& ctxt = iteration_contexts_[omp_get_thread_num()];
+    Timing::Time(op->name_, [&]() { (*op)(ctxt); });
+  }
+}
+
+// -----------------------------------------------------------------------------
+void Scheduler::WaitForConcurrentOps() {
+  if (concurrent_executor_ == nullptr) {
+    return;
+  }
+  auto* param = Simulation::GetActive()->GetParam();
+  concurrent_executor_->Wait(param->statistics ? &op_times_ : nullptr);
+  for (auto* op : deferred_tear_down_ops_) {
+    Timing::Time(op->name_, [&]() { op->TearDown(); });
+  }
+  deferred_tear_down_ops_.clear();
 }
 
 // -----------------------------------------------------------------------------
 void Scheduler::RunAgentOps(Functor<bool, Agent*>* filter) {
+  // Agent operations might access any simulation state.
+  WaitForConcurrentOps();
+
   auto* sim = Simulation::GetActive();
   auto* rm = sim->GetResourceManager();
   auto* param = sim->GetParam();
@@ -303,14 +408,14 @@ void Scheduler::RunAgentOps(Functor<bool, Agent*>* filter) {
   all_exec_ctxts[0]->SetupAgentOpsAll(all_exec_ctxts);
 
   if (param->execution_order == Param::ExecutionOrder::kForEachAgentForEachOp) {
-    RunAllScheduledOps functor(agent_ops);
+    RunAllScheduledOps functor(agent_ops, iteration_contexts_);
     Timing::Time("agent ops", [&]() {
       rm->ForEachAgentParallel(batch_size, functor, filter);
     });
   } else {
     for (auto* op : agent_ops) {
       decltype(agent_ops) ops = {op};
-      RunAllScheduledOps functor(ops);
+      RunAllScheduledOps functor(ops, iteration_contexts_);
       Timing::Time(op->name_, [&]() {
         rm->ForEachAgentParallel(batch_size, functor, filter);
       });
@@ -322,6 +427,7 @@ void Scheduler::RunAgentOps(Functor<bool, Agent*>* filter) {
 
 // -----------------------------------------------------------------------------
 void Scheduler::RunScheduledOps() {
+  UpdateIterationContexts();
   SetUpOps();
 
   // Run the agent operations
@@ -336,7 +442,7 @@ void Scheduler::RunScheduledOps() {
   // Run the column-wise operations
   for (auto* op : scheduled_standalone_ops_) {
     if (op->frequency_ != 0 && total_steps_ % op->frequency_ == 0) {
-      Timing::Time(op->name_, [&]() { (*op)(); });
+      RunStandaloneOp(op);
     }
   }
 
@@ -344,9 +450,10 @@ void Scheduler::RunScheduledOps() {
 }
 
 void Scheduler::RunPostScheduledOps() {
+  UpdateIterationContexts();
   for (auto* post_op : post_scheduled_ops_) {
     if (post_op->frequency_ != 0 && total_steps_ % post_op->frequency_ == 0) {
-      Timing::Time(post_op->name_, [&]() { (*post_op)(); });
+      RunStandaloneOp(post_op);
     }
   }
 }
@@ -366,6 +473,34 @@ void Scheduler::Execute() {
   RunPreScheduledOps();
   RunScheduledOps();
   RunPostScheduledOps();
+  // Concurrent operations must not overlap with the next iteration.
+  WaitForConcurrentOps();
+}
+
+// -----------------------------------------------------------------------------
+const IterationContext& Scheduler::GetIterationContext() const {
+  assert(static_cast<size_t>(omp_get_thread_num()) <
+             iteration_contexts_.size() &&
+         "GetIterationContext must be called during an iteration");
+  return iteration_contexts_[omp_get_thread_num()];
+}
+
+// -----------------------------------------------------------------------------
+void Scheduler::UpdateIterationContexts() {
+  auto* sim = Simulation::GetActive();
+  const auto& all_exec_ctxts = sim->GetAllExecCtxts();
+  if (!iteration_contexts_.empty() &&
+      iteration_contexts_[0].step == total_steps_ &&
+      iteration_contexts_[0].sim == sim &&
+      iteration_contexts_.size() == all_exec_ctxts.size() &&
+      iteration_contexts_[0].exec_ctxt == all_exec_ctxts[0]) {
+    return;
+  }
+  iteration_contexts_.clear();
+  iteration_contexts_.reserve(all_exec_ctxts.size());
+  for (size_t tid = 0; tid < all_exec_ctxts.size(); ++tid) {
+    iteration_contexts_.emplace_back(sim, static_cast<int>(tid));
+  }
 }
 
 void Scheduler::PrintInfo(std::ostream& out) {
@@ -452,6 +587,27 @@ void Scheduler::UpdateSimulatedTime() {
   simulated_time_ += Simulation::GetActive()->GetParam()->simulation_time_step;
 }
 
+void Scheduler::ResetSimulatedTime(uint64_t steps, real_t simulated_time) {
+  total_steps_ = steps;
+  simulated_time_ = simulated_time;
+  auto* param = Simulation::GetActive()->GetParam();
+  for (auto* op : all_ops_) {
+    // The operation was executed last in the last step before `steps` that
+    // is a multiple of its frequency.
+    real_t last_time_run = -1;
+    if (steps != 0 && op->frequency_ != 0) {
+      auto last_step = (steps - 1) / op->frequency_ * op->frequency_;
+      last_time_run =
+          simulated_time - (steps - last_step) * param->simulation_time_step;
+    }
+    for (auto* impl : op->implementations_) {
+      if (impl) {
+        impl->ResetTime(last_time_run);
+      }
+    }
+  }
+}
+
 // TODO(lukas, ahmad) After https://trello.com/c/0D6sHCK4 has been resolved
 // think about a better solution, because some operations are executed twice
 // if Simulate is called with one timestep.
@@ -508,14 +664,17 @@ void Scheduler::ScheduleOps() {
     auto op_type = it->first;
     auto* op = it->second;
 
-    // Enable GPU operation implementations (if available) if CUDA or OpenCL
-    // flags are set
+    // Enable GPU or vectorized CPU operation implementations (if available)
+    // if the corresponding compute target is set
     if (param->compute_target == "cuda" &&
         op->IsComputeTargetSupported(kCuda)) {
       op->SelectComputeTarget(kCuda);
     } else if (param->compute_target == "opencl" &&
                op->IsComputeTargetSupported(kOpenCl)) {
       op->SelectComputeTarget(kOpenCl);
+    } else if (param->compute_target == "cpu_simd" &&
+               op->IsComputeTargetSupported(kCpuSimd)) {
+      op->SelectComputeTarget(kCpuSimd);
     } else {
       op->SelectComputeTarget(kCpu);
     }
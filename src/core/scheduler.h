@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "core/functor.h"
+#include "core/iteration_context.h"
 #include "core/operation/operation.h"
 #include "core/param/param.h"
 #include "core/util/progress_bar.h"
@@ -34,10 +35,12 @@ namespace bdm {
 class SchedulerTest;
 class Agent;
 class SimulationBackup;
+class SimulationSnapshot;
 class VisualizationAdaptor;
 class RootAdaptor;
 struct BoundSpace;
 class MechanicalForcesOp;
+class ConcurrentOpExecutor;
 class DiffusionOp;
 
 enum OpType { kSchedule, kPreSchedule, kPostSchedule };
@@ -103,6 +106,24 @@ class Scheduler {
 
   TimingAggregator* GetOpTimes();
 
+  /// Returns the state of the current iteration for the calling thread.\n
+  /// Only valid while the operations of an iteration are executed. Operations
+  /// and behaviors receive the same object as argument if they override the
+  /// corresponding overload (e.g. `Behavior::Run(Agent*, const
+  /// IterationContext&)`).
+  const IterationContext& GetIterationContext() const;
+
+  /// Declares that the operation `op_name` reads the result of the operation
+  /// `dependency_name`.\n
+  /// Only relevant if `dependency_name` is listed in `Param::concurrent_ops`:
+  /// `op_name` waits until the concurrently running `dependency_name` has
+  /// finished. By default, "visualize" and "update time series" depend on
+  /// "continuum".
+  ///
+  ///     scheduler->AddOpDependency("my analysis op", "continuum");
+  void AddOpDependency(const std::string& op_name,
+                       const std::string& dependency_name);
+
   /// Prints an overview of all pre-scheduled, agent, standalone, and
   /// post-scheduled operations. For each iteration, the scheduler executes
   /// these operations in the order that they appear in the output.
@@ -122,6 +143,7 @@ class Scheduler {
  private:
   friend void RunAgentsTest(Param::MappedDataArrayMode, uint64_t, bool, bool);
   friend SchedulerTest;
+  friend SimulationSnapshot;
 
   SimulationBackup* backup_ = nullptr;
   uint64_t restore_point_;
@@ -158,6 +180,23 @@ class Scheduler {
   /// agent operations will be executed for each agents in the simulation.
   std::vector<Functor<bool, Agent*>*> agent_filters_;  //!
 
+  /// Executes the operations listed in `Param::concurrent_ops`.
+  /// Is a nullptr if the list is empty.
+  ConcurrentOpExecutor* concurrent_executor_ = nullptr;  //!
+  /// Maps operation names to the names of the operations they depend on.
+  /// (see `AddOpDependency`)
+  std::unordered_map<std::string, std::vector<std::string>>
+      op_dependencies_;  //!
+  /// Operations that wait for all concurrent operations before they are
+  /// executed (e.g. because they remove agents).
+  std::vector<std::string> exclusive_op_names_;  //!
+  /// Concurrent operations whose `TearDown` has been postponed until they
+  /// have finished.
+  std::vector<Operation*> deferred_tear_down_ops_;  //!
+  /// State of the current iteration for each thread.
+  /// \see `UpdateIterationContexts`
+  std::vector<IterationContext> iteration_contexts_;  //!
+
   /// Backup the simulation. Backup interval based on `Param::backup_interval`
   void Backup();
 
@@ -168,6 +207,12 @@ class Scheduler {
 
   void UpdateSimulatedTime();
 
+  /// Sets the number of simulated steps and the simulated time, e.g. if the
+  /// simulation was rewound by `SimulationSnapshot::Restore`.
+  /// Operations that compute their time step from the time of their last
+  /// execution are reset accordingly (see `OperationImpl::ResetTime`).
+  void ResetSimulatedTime(uint64_t steps, real_t simulated_time);
+
   // TODO(lukas, ahmad) After https://trello.com/c/0D6sHCK4 has been resolved
   // think about a better solution, because some operations are executed twice
   // if Simulate is called with one timestep.
@@ -220,6 +265,22 @@ class Scheduler {
   void RunPostScheduledOps();
 
   void ScheduleOps();
+
+  /// Runs a standalone operation. Operations listed in
+  /// `Param::concurrent_ops` are launched on the `concurrent_executor_`.
+  /// Waits for concurrent operations `op` depends on.
+  void RunStandaloneOp(Operation* op);
+
+  /// Returns true if `op` is executed by the `concurrent_executor_`.
+  bool IsConcurrentOp(Operation* op) const;
+
+  /// Blocks until all concurrent operations have finished and tears them
+  /// down if necessary.
+  void WaitForConcurrentOps();
+
+  /// Recreates `iteration_contexts_` if they have not been created for the
+  /// current iteration yet.
+  void UpdateIterationContexts();
 };
 
 }  // namespace bdm
@@ -33,6 +33,7 @@
 #include "core/analysis/time_series.h"
 #include "core/environment/environment.h"
 #include "core/environment/kd_tree_environment.h"
+#include "core/environment/linear_octree_environment.h"
 #include "core/environment/octree_environment.h"
 #include "core/environment/uniform_grid_environment.h"
 #include "core/execution_context/in_place_exec_ctxt.h"
@@ -106,6 +107,17 @@ Simulation::Simulation(const std::string& simulation_name,
 }
 
 void Simulation::Restore(Simulation&& restored) {
+  RestoreState(std::move(restored));
+
+  // name_ and unique_name_
+  if (restored.name_ != name_) {
+    InitializeUniqueName(restored.name_);
+    InitializeOutputDir();
+    InitializeTimeSeriesStream();
+  }
+}
+
+void Simulation::RestoreState(Simulation&& restored) {
   // random_
   if (random_.size() != restored.random_.size()) {
     Log::Warning("Simulation", "The restore file (", param_->restore_file,
@@ -127,11 +139,9 @@ void Simulation::Restore(Simulation&& restored) {
   *rm_ = std::move(*restored.rm_);
   restored.rm_ = nullptr;
 
-  *time_series_ = std::move(*restored.time_series_);
-
-  // name_ and unique_name_
-  InitializeUniqueName(restored.name_);
-  InitializeOutputDir();
+  // The copy assignment keeps the stream of this time series. Thus, data
+  // points that have already been streamed are not overwritten.
+  *time_series_ = *restored.time_series_;
 }
 
 std::ostream& operator<<(std::ostream& os, Simulation& sim) {
@@ -335,6 +345,8 @@ void Simulation::InitializeMembers() {
     environment_ = new KDTreeEnvironment();
   } else if (param_->environment == "octree") {
     environment_ = new OctreeEnvironment();
+  } else if (param_->environment == "linear_octree") {
+    environment_ = new LinearOctreeEnvironment();
   } else if (param_->environment == "uniform_grid") {
     environment_ = new UniformGridEnvironment();
   } else {
@@ -344,6 +356,20 @@ void Simulation::InitializeMembers() {
   }
   scheduler_ = new Scheduler();
   time_series_ = new experimental::TimeSeries();
+  InitializeTimeSeriesStream();
+}
+
+void Simulation::InitializeTimeSeriesStream() {
+  using experimental::CsvTimeSeriesSink;
+  using experimental::TimeSeriesSink;
+  time_series_->SetMaxPointsInMemory(param_->time_series_max_points_in_memory);
+  auto& factory = TimeSeriesSink::GetFactory();
+  if (factory) {
+    time_series_->StreamTo(factory());
+  } else if (!param_->time_series_stream_file.empty()) {
+    time_series_->StreamTo(new CsvTimeSeriesSink(
+        Concat(output_dir_, "/", param_->time_series_stream_file)));
+  }
 }
 
 void Simulation::SetEnvironment(Environment* env) {
@@ -438,7 +464,9 @@ void Simulation::InitializeRuntimeParams(
 
   set_param(param_);
 
-  if (!is_gpu_environment_initialized_ && param_->compute_target != "cpu") {
+  if (!is_gpu_environment_initialized_ &&
+      (param_->compute_target == "cuda" ||
+       param_->compute_target == "opencl")) {
     GpuHelper::GetInstance()->InitializeGPUEnvironment();
     is_gpu_environment_initialized_ = true;
   }
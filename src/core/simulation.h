@@ -87,8 +87,16 @@ class Simulation {
 
   /// Copies / moves values from a restored simulation into this object.
   /// Thus, pointers to `rm_`, `param_`, ... are not invalidated.
+  /// The name and the output directory are only initialized again if the
+  /// restored simulation has a different name.
   void Restore(Simulation&& restored);
 
+  /// Same as `Restore`, but only restores the state of the simulation:
+  /// random number generators, parameters, agents and time series.
+  /// The name, the output directory and the time series stream of this
+  /// simulation are kept.
+  void RestoreState(Simulation&& restored);
+
   /// Activates this simulation.
   void Activate();
 
@@ -206,6 +214,10 @@ class Simulation {
   /// Initializes `output_dir_` and creates dir if it does not exist.
   void InitializeOutputDir();
 
+  /// Attaches a sink to `time_series_` if streaming is enabled.
+  /// \see Param::time_series_stream_file
+  void InitializeTimeSeriesStream();
+
   friend SimulationTest;
   friend ParaviewAdaptorTest;
   friend class DiffusionTest_CopyOldData_Test;
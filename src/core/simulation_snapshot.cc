@@ -0,0 +1,114 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/simulation_snapshot.h"
+
+#include <TBufferFile.h>
+
+#include <memory>
+
+#include "core/agent/agent_uid_generator.h"
+#include "core/param/param.h"
+#include "core/resource_manager.h"
+#include "core/scheduler.h"
+#include "core/simulation.h"
+#include "core/simulation_backup.h"
+#include "core/util/compression.h"
+#include "core/util/log.h"
+
+namespace bdm {
+
+// -----------------------------------------------------------------------------
+SimulationSnapshot::SimulationSnapshot(Simulation* sim, int compression) {
+  auto* active = Simulation::GetActive();
+  if (sim == nullptr) {
+    sim = active;
+  }
+  if (sim == nullptr) {
+    Log::Fatal("SimulationSnapshot", "There is no simulation to capture.");
+  }
+  // Streamers of agents and continuum models access the active simulation.
+  sim->Activate();
+
+  auto* scheduler = sim->GetScheduler();
+  steps_ = scheduler->GetSimulatedSteps();
+  time_ = scheduler->GetSimulatedTime();
+  highest_uid_index_ = sim->GetAgentUidGenerator()->GetHighestIndex();
+
+  TBufferFile buffer(TBuffer::kWrite);
+  buffer.WriteObjectAny(sim, Simulation::Class());
+  uncompressed_size_ = buffer.Length();
+  Compress(buffer.Buffer(), buffer.Length(), compression, &data_);
+  data_.shrink_to_fit();
+
+  if (active != nullptr && active != sim) {
+    active->Activate();
+  }
+}
+
+// -----------------------------------------------------------------------------
+void SimulationSnapshot::Restore(Simulation* sim) const {
+  auto* active = Simulation::GetActive();
+  if (sim == nullptr) {
+    sim = active;
+  }
+  sim->Activate();
+
+  SimulationBackup::after_restore_event_.clear();
+  std::unique_ptr<Simulation> restored(Read());
+  MoveInto(sim, restored.get());
+
+  if (active != nullptr && active != sim) {
+    active->Activate();
+  }
+}
+
+// -----------------------------------------------------------------------------
+Simulation* SimulationSnapshot::Fork(const std::string& simulation_name) const {
+  SimulationBackup::after_restore_event_.clear();
+  std::unique_ptr<Simulation> restored(Read());
+  // The environment and the default operations depend on the parameters.
+  // Therefore, they must be known when the simulation is created.
+  auto set_param = [&](Param* param) {
+    param->Restore(Param(*restored->GetParam()));
+  };
+  auto* fork = new Simulation(simulation_name, set_param);
+  MoveInto(fork, restored.get());
+  return fork;
+}
+
+// -----------------------------------------------------------------------------
+Simulation* SimulationSnapshot::Read() const {
+  std::vector<char> data;
+  Decompress(data_.data(), data_.size(), &data);
+  TBufferFile buffer(TBuffer::kRead, static_cast<Int_t>(data.size()),
+                     data.data(), false);
+  return static_cast<Simulation*>(buffer.ReadObjectAny(Simulation::Class()));
+}
+
+// -----------------------------------------------------------------------------
+void SimulationSnapshot::MoveInto(Simulation* sim, Simulation* restored) const {
+  // Agents keep their uids. Uids that have been freed after the snapshot was
+  // taken might belong to restored agents and must not be reused.
+  sim->GetAgentUidGenerator()->Reset(highest_uid_index_);
+  sim->RestoreState(std::move(*restored));
+  sim->GetScheduler()->ResetSimulatedTime(steps_, time_);
+
+  for (auto&& event : SimulationBackup::after_restore_event_) {
+    event();
+  }
+  SimulationBackup::after_restore_event_.clear();
+}
+
+}  // namespace bdm
@@ -0,0 +1,98 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_SIMULATION_SNAPSHOT_H_
+#define CORE_SIMULATION_SNAPSHOT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/agent/agent_uid.h"
+#include "core/real_t.h"
+
+namespace bdm {
+
+class Simulation;
+
+/// Compressed in-memory copy of the state of a simulation.\n
+/// In contrast to `SimulationBackup`, the state is not written to a file.
+/// It can therefore be used to rewind a simulation to an earlier point in
+/// time, or to fork several simulations from the same state within one
+/// process (e.g. to explore different parameters).\n
+/// A snapshot contains the same state as a backup (agents, continuum models,
+/// random number generators, parameters, and time series), and additionally
+/// the number of simulated steps and the simulated time of the scheduler.
+/// Operations and agent filters are not part of the snapshot.
+/// \code
+/// SimulationSnapshot snapshot;
+/// scheduler->Simulate(100);
+/// // go back in time and simulate the same 100 steps again
+/// snapshot.Restore();
+/// scheduler->Simulate(100);
+/// \endcode
+/// Requires ROOT dictionaries (`-Ddict=on`).
+class SimulationSnapshot {
+ public:
+  /// Captures the state of `sim`, or of the active simulation if `sim` is a
+  /// nullptr.\n
+  /// `compression` uses the same encoding as ROOT files
+  /// (100 * algorithm + level). The default uses LZ4 with level 1, which
+  /// favors speed over size. 0 disables compression.
+  explicit SimulationSnapshot(Simulation* sim = nullptr,
+                              int compression = 401);
+
+  /// Replaces the state of `sim`, or of the active simulation if `sim` is a
+  /// nullptr, with the state of this snapshot. Pointers to the
+  /// ResourceManager, Param, ... of `sim` stay valid, but all agents are
+  /// replaced. A snapshot can be restored multiple times.
+  void Restore(Simulation* sim = nullptr) const;
+
+  /// Creates a new simulation with the parameters and state of this
+  /// snapshot. Default operations are scheduled as for every new simulation;
+  /// user-defined operations must be scheduled again.\n
+  /// Like every new simulation, the returned simulation is activated.
+  /// The caller takes ownership.
+  Simulation* Fork(const std::string& simulation_name) const;
+
+  uint64_t GetSimulatedSteps() const { return steps_; }
+
+  real_t GetSimulatedTime() const { return time_; }
+
+  /// Returns the number of bytes that are used to store the state.
+  /// (see `Compress` in core/util/compression.h)
+  uint64_t GetCompressedSize() const { return data_.size(); }
+
+  /// Returns the number of bytes of the serialized state before compression.
+  uint64_t GetUncompressedSize() const { return uncompressed_size_; }
+
+ private:
+  /// Compressed serialized state
+  std::vector<char> data_;
+  uint64_t uncompressed_size_ = 0;
+  uint64_t steps_ = 0;
+  real_t time_ = 0;
+  /// Highest index of an AgentUid in the snapshot.
+  AgentUid::Index_t highest_uid_index_ = 0;
+
+  /// Decompresses the serialized state and deserializes the simulation.
+  Simulation* Read() const;
+
+  /// Moves the state of `restored` into `sim`.
+  void MoveInto(Simulation* sim, Simulation* restored) const;
+};
+
+}  // namespace bdm
+
+#endif  // CORE_SIMULATION_SNAPSHOT_H_
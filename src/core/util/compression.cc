@@ -0,0 +1,129 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/util/compression.h"
+
+#include <Compression.h>
+#include <RZip.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/util/log.h"
+#include "core/util/serialization.h"
+
+namespace bdm {
+
+namespace {
+
+/// Maximum number of bytes that ROOT compresses at once.
+constexpr uint64_t kMaxBlockSize = 0xffffff;
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+void Compress(const char* data, uint64_t size, int compression,
+              std::vector<char>* compressed) {
+  auto num_blocks = (size + kMaxBlockSize - 1) / kMaxBlockSize;
+  auto algorithm = static_cast<ROOT::RCompressionSetting::EAlgorithm::EValues>(
+      compression / 100);
+  int level = compression % 100;
+
+  std::vector<std::vector<char>> blocks(num_blocks);
+  std::vector<char> is_compressed(num_blocks, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+  for (uint64_t i = 0; i < num_blocks; ++i) {
+    auto& block = blocks[i];
+    auto* src = const_cast<char*>(data) + i * kMaxBlockSize;
+    int block_size = static_cast<int>(std::min(kMaxBlockSize,
+                                               size - i * kMaxBlockSize));
+    if (level > 0) {
+      int src_size = block_size;
+      int tgt_size = block_size;
+      int compressed_size = 0;
+      block.resize(block_size);
+      R__zipMultipleAlgorithm(level, &src_size, src, &tgt_size, block.data(),
+                              &compressed_size, algorithm);
+      // `compressed_size` is zero if the compressed block would not be
+      // smaller than the original one.
+      if (compressed_size > 0 && compressed_size < block_size) {
+        block.resize(compressed_size);
+        is_compressed[i] = 1;
+        continue;
+      }
+    }
+    block.assign(src, src + block_size);
+  }
+
+  compressed->clear();
+  BinaryWriter writer(compressed);
+  writer.Write(size, num_blocks);
+  for (uint64_t i = 0; i < num_blocks; ++i) {
+    writer.Write(static_cast<uint32_t>(blocks[i].size()), is_compressed[i]);
+  }
+  for (auto& block : blocks) {
+    writer.WriteBytes(block.data(), block.size());
+  }
+}
+
+// -----------------------------------------------------------------------------
+void Decompress(const char* compressed, uint64_t size,
+                std::vector<char>* data) {
+  BinaryReader reader(compressed, size);
+  uint64_t data_size;
+  uint64_t num_blocks;
+  reader.Read(data_size, num_blocks);
+  std::vector<uint64_t> offsets(num_blocks + 1);
+  std::vector<char> is_compressed(num_blocks);
+  offsets[0] = reader.GetPosition() + num_blocks * (sizeof(uint32_t) + 1);
+  for (uint64_t i = 0; i < num_blocks; ++i) {
+    uint32_t block_size;
+    reader.Read(block_size, is_compressed[i]);
+    offsets[i + 1] = offsets[i] + block_size;
+  }
+  if (offsets.back() != size ||
+      num_blocks != (data_size + kMaxBlockSize - 1) / kMaxBlockSize) {
+    Log::Fatal("Decompress", "The compressed data is corrupted.");
+  }
+
+  data->resize(data_size);
+  std::vector<int> failed(num_blocks, 0);
+#pragma omp parallel for schedule(dynamic, 1)
+  for (uint64_t i = 0; i < num_blocks; ++i) {
+    auto* src = compressed + offsets[i];
+    auto* tgt = data->data() + i * kMaxBlockSize;
+    int block_size = static_cast<int>(std::min(kMaxBlockSize,
+                                               data_size - i * kMaxBlockSize));
+    int src_size = static_cast<int>(offsets[i + 1] - offsets[i]);
+    if (!is_compressed[i]) {
+      failed[i] = src_size != block_size;
+      if (!failed[i]) {
+        std::memcpy(tgt, src, block_size);
+      }
+      continue;
+    }
+    int tgt_size = block_size;
+    int decompressed_size = 0;
+    R__unzip(&src_size,
+             reinterpret_cast<unsigned char*>(const_cast<char*>(src)),
+             &tgt_size, reinterpret_cast<unsigned char*>(tgt),
+             &decompressed_size);
+    failed[i] = decompressed_size != block_size;
+  }
+  if (std::find(failed.begin(), failed.end(), 1) != failed.end()) {
+    Log::Fatal("Decompress", "Failed to decompress the data.");
+  }
+}
+
+}  // namespace bdm
@@ -0,0 +1,38 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_UTIL_COMPRESSION_H_
+#define CORE_UTIL_COMPRESSION_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace bdm {
+
+/// Compresses `size` bytes starting at `data` and stores the result in
+/// `compressed`. The result contains all information that `Decompress`
+/// needs.\n
+/// `compression` uses the same encoding as ROOT files
+/// (100 * algorithm + level, e.g. 404 for LZ4 with level 4). 0 stores the data
+/// without compression. The data is split into blocks that are compressed in
+/// parallel. Blocks that do not get smaller are stored uncompressed.
+void Compress(const char* data, uint64_t size, int compression,
+              std::vector<char>* compressed);
+
+/// Reverses `Compress`. Stores the original data in `data`.
+void Decompress(const char* compressed, uint64_t size, std::vector<char>* data);
+
+}  // namespace bdm
+
+#endif  // CORE_UTIL_COMPRESSION_H_
@@ -24,6 +24,7 @@
 #include "csv.h"
 
 #include "core/util/io.h"
+#include "core/util/log.h"
 
 namespace bdm {
 
@@ -32,9 +33,8 @@ class CSVReader {
  public:
   explicit CSVReader(const std::string& file, int skip = 0) : filename_(file) {
     if (!FileExists(file)) {
-      std::cout << "Error: " << file << " does not exist!" << std::endl;
-      exit(1);
-    };
+      Log::Fatal("CSVReader", file, " does not exist!");
+    }
     rapidcsv::LabelParams labels(skip);
     rapidcsv::SeparatorParams separator;
     rapidcsv::ConverterParams converter(true);
@@ -0,0 +1,210 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <limits>
+
+#include "core/util/log.h"
+#include "core/util/parallel_csv_reader.h"
+#include "core/util/thread_info.h"
+
+namespace bdm {
+
+namespace {
+
+void Trim(const char** begin, const char** end) {
+  while (*begin < *end && std::isspace(static_cast<unsigned char>(**begin))) {
+    (*begin)++;
+  }
+  while (*end > *begin &&
+         std::isspace(static_cast<unsigned char>(*(*end - 1)))) {
+    (*end)--;
+  }
+  if (*end - *begin >= 2 && **begin == '"' && *(*end - 1) == '"') {
+    (*begin)++;
+    (*end)--;
+  }
+}
+
+/// strtod and strtoll require a null-terminated string. Fields inside the
+/// memory-mapped file are not null-terminated, and the last field might end
+/// at the end of the mapping. Therefore, the field is copied.
+template <typename TFunction>
+auto ParseField(const char* begin, const char* end, TFunction parse)
+    -> decltype(parse(nullptr, nullptr)) {
+  char buffer[64];
+  std::string long_field;
+  const char* str = buffer;
+  auto length = static_cast<size_t>(end - begin);
+  if (length < sizeof(buffer)) {
+    std::memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+  } else {
+    long_field.assign(begin, end);
+    str = long_field.c_str();
+  }
+  char* parsed_end = nullptr;
+  auto value = parse(str, &parsed_end);
+  // an empty field or trailing characters are invalid
+  if (length == 0 || parsed_end != str + length) {
+    return std::numeric_limits<decltype(value)>::has_quiet_NaN
+               ? std::numeric_limits<decltype(value)>::quiet_NaN()
+               : decltype(value)(0);
+  }
+  return value;
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+ParallelCSVReader::ParallelCSVReader(const std::string& file, char separator)
+    : filename_(file) {
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd == -1) {
+    Log::Fatal("ParallelCSVReader", "Could not open file ", file);
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1 || file_stat.st_size == 0) {
+    close(fd);
+    Log::Fatal("ParallelCSVReader", "File ", file,
+               " is empty or cannot be read.");
+  }
+  size_ = static_cast<uint64_t>(file_stat.st_size);
+  auto* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid after the file descriptor has been closed
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    Log::Fatal("ParallelCSVReader", "Could not map file ", file,
+               " into memory.");
+  }
+  madvise(mapping, size_, MADV_SEQUENTIAL);
+  data_ = static_cast<const char*>(mapping);
+
+  // header
+  const char* end = data_ + size_;
+  auto* newline = static_cast<const char*>(std::memchr(data_, '\n', size_));
+  const char* header_end = newline != nullptr ? newline : end;
+  const char* header_content_end = header_end;
+  if (header_content_end > data_ && *(header_content_end - 1) == '\r') {
+    header_content_end--;
+  }
+  if (separator == 0) {
+    bool tab = std::find(data_, header_content_end, '\t') != header_content_end;
+    separator = tab ? '\t' : ',';
+  }
+  separator_ = separator;
+  std::vector<Field> fields;
+  SplitLine(data_, header_content_end, &fields);
+  for (auto& field : fields) {
+    column_names_.emplace_back(field.first, field.second);
+  }
+
+  InitializeChunks(std::min(header_end + 1, end), end);
+}
+
+// -----------------------------------------------------------------------------
+ParallelCSVReader::~ParallelCSVReader() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+// -----------------------------------------------------------------------------
+size_t ParallelCSVReader::GetColumnIndex(const std::string& name) const {
+  auto it = std::find(column_names_.begin(), column_names_.end(), name);
+  if (it == column_names_.end()) {
+    Log::Fatal("ParallelCSVReader::GetColumnIndex", "Column ", name,
+               " does not exist in file ", filename_);
+  }
+  return static_cast<size_t>(it - column_names_.begin());
+}
+
+// -----------------------------------------------------------------------------
+void ParallelCSVReader::InitializeChunks(const char* begin, const char* end) {
+  // more chunks than threads to balance the load of lines with different
+  // lengths
+  uint64_t num_chunks = ThreadInfo::GetInstance()->GetMaxThreads() * 4;
+  uint64_t chunk_size = (end - begin) / num_chunks + 1;
+  const char* chunk_begin = begin;
+  while (chunk_begin < end) {
+    const char* chunk_end = chunk_begin + std::min<uint64_t>(
+                                              chunk_size, end - chunk_begin);
+    if (chunk_end < end) {
+      auto* newline = static_cast<const char*>(
+          std::memchr(chunk_end, '\n', end - chunk_end));
+      chunk_end = newline != nullptr ? newline + 1 : end;
+    }
+    chunks_.push_back({chunk_begin, chunk_end});
+    chunk_begin = chunk_end;
+  }
+
+  chunk_rows_.resize(chunks_.size());
+#pragma omp parallel for schedule(dynamic, 1)
+  for (size_t c = 0; c < chunks_.size(); ++c) {
+    uint64_t rows = 0;
+    ForEachLineInRange(chunks_[c].first, chunks_[c].second,
+                       [&](const char*, const char*) { rows++; });
+    chunk_rows_[c] = rows;
+  }
+  // exclusive prefix sum
+  for (auto& rows : chunk_rows_) {
+    auto tmp = rows;
+    rows = num_rows_;
+    num_rows_ += tmp;
+  }
+}
+
+// -----------------------------------------------------------------------------
+void ParallelCSVReader::SplitLine(const char* begin, const char* end,
+                                  std::vector<Field>* fields) const {
+  fields->clear();
+  while (true) {
+    auto* field_end = static_cast<const char*>(
+        std::memchr(begin, separator_, end - begin));
+    if (field_end == nullptr) {
+      field_end = end;
+    }
+    const char* field_begin = begin;
+    const char* trimmed_end = field_end;
+    Trim(&field_begin, &trimmed_end);
+    fields->push_back({field_begin, trimmed_end});
+    if (field_end == end) {
+      break;
+    }
+    begin = field_end + 1;
+  }
+}
+
+// -----------------------------------------------------------------------------
+double ParallelCSVReader::ParseDouble(const char* begin, const char* end) {
+  return ParseField(begin, end, [](const char* str, char** str_end) {
+    return std::strtod(str, str_end);
+  });
+}
+
+// -----------------------------------------------------------------------------
+int64_t ParallelCSVReader::ParseInteger(const char* begin, const char* end) {
+  return ParseField(begin, end, [](const char* str, char** str_end) {
+    return static_cast<int64_t>(std::strtoll(str, str_end, 10));
+  });
+}
+
+}  // namespace bdm
@@ -0,0 +1,193 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_UTIL_PARALLEL_CSV_READER_H_
+#define CORE_UTIL_PARALLEL_CSV_READER_H_
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "core/real_t.h"
+
+namespace bdm {
+
+/// Reads large CSV or TSV files with multiple threads.\n
+/// The file is memory-mapped and split into chunks at line boundaries, which
+/// are parsed in parallel. In contrast to `CSVReader`, the table is never
+/// materialized: `GetColumn` only parses the requested column, and
+/// `ForEachRow` streams the values of the requested columns row by row
+/// (see `ModelInitializer::CreateAgentsFromCsv`).\n
+/// The first line must contain the column names. Empty lines are ignored.
+/// Quoted fields must not contain separators or line breaks.
+/// \code
+/// ParallelCSVReader reader("cells.csv");
+/// auto x = reader.GetColumn<real_t>("x");
+/// reader.ForEachRow({"x", "y", "z"}, [](uint64_t row, const auto& values) {
+///   ...
+/// });
+/// \endcode
+class ParallelCSVReader {
+ public:
+  /// If `separator` is 0, it is determined from the header line: tab if the
+  /// header contains a tab, comma otherwise.
+  explicit ParallelCSVReader(const std::string& file, char separator = 0);
+
+  ~ParallelCSVReader();
+
+  ParallelCSVReader(const ParallelCSVReader&) = delete;
+  ParallelCSVReader& operator=(const ParallelCSVReader&) = delete;
+
+  const std::vector<std::string>& GetColumnNames() const {
+    return column_names_;
+  }
+
+  size_t GetColumnCount() const { return column_names_.size(); }
+
+  /// Returns the number of rows without the header line.
+  uint64_t GetRowCount() const { return num_rows_; }
+
+  /// Returns the index of the column `name`. Fatal if the column does not
+  /// exist.
+  size_t GetColumnIndex(const std::string& name) const;
+
+  /// Parses the column `name` in parallel.
+  /// Empty or invalid entries are NaN for floating point types and 0 for
+  /// integral types.
+  template <typename T>
+  std::vector<T> GetColumn(const std::string& name) const {
+    auto col = GetColumnIndex(name);
+    std::vector<T> column(num_rows_);
+    ForEachLine([&](uint64_t row, const char* begin, const char* end,
+                    std::vector<Field>* fields) {
+      SplitLine(begin, end, fields);
+      auto field = col < fields->size() ? (*fields)[col] : Field{end, end};
+      Parse(field.first, field.second, &column[row]);
+    });
+    return column;
+  }
+
+  /// Calls `lambda(uint64_t row, const std::vector<real_t>& values)` for each
+  /// row. `values` contains the entries of `columns` in the given order.
+  /// Rows are processed in parallel in an unspecified order.
+  template <typename Lambda>
+  void ForEachRow(const std::vector<std::string>& columns,
+                  Lambda lambda) const {
+    std::vector<size_t> indices;
+    for (auto& name : columns) {
+      indices.push_back(GetColumnIndex(name));
+    }
+    ForEachLine([&](uint64_t row, const char* begin, const char* end,
+                    std::vector<Field>* fields) {
+      SplitLine(begin, end, fields);
+      thread_local std::vector<real_t> values;
+      values.resize(indices.size());
+      for (size_t i = 0; i < indices.size(); ++i) {
+        auto col = indices[i];
+        auto field = col < fields->size() ? (*fields)[col] : Field{end, end};
+        Parse(field.first, field.second, &values[i]);
+      }
+      lambda(row, values);
+    });
+  }
+
+ private:
+  using Field = std::pair<const char*, const char*>;
+
+  std::string filename_;
+  const char* data_ = nullptr;
+  uint64_t size_ = 0;
+  char separator_ = ',';
+  std::vector<std::string> column_names_;
+  uint64_t num_rows_ = 0;
+  /// Chunks of the file (without the header line) that start and end at line
+  /// boundaries.
+  std::vector<Field> chunks_;
+  /// Index of the first row in each chunk.
+  std::vector<uint64_t> chunk_rows_;
+
+  /// Splits the data into `chunks_` and counts the rows in each chunk.
+  void InitializeChunks(const char* begin, const char* end);
+
+  /// Calls `lambda(begin, end)` for each non-empty line in [begin, end[.
+  /// A trailing carriage return is removed.
+  template <typename Lambda>
+  static void ForEachLineInRange(const char* begin, const char* end,
+                                 Lambda lambda) {
+    while (begin < end) {
+      auto* newline =
+          static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+      auto* line_end = newline != nullptr ? newline : end;
+      auto* content_end = line_end;
+      if (content_end > begin && *(content_end - 1) == '\r') {
+        content_end--;
+      }
+      if (content_end > begin) {
+        lambda(begin, content_end);
+      }
+      begin = line_end + 1;
+    }
+  }
+
+  /// Calls `lambda(row, begin, end, fields)` for each row in parallel.
+  /// `fields` is a thread-local buffer for `SplitLine`.
+  template <typename Lambda>
+  void ForEachLine(Lambda lambda) const {
+#pragma omp parallel
+    {
+      std::vector<Field> fields;
+#pragma omp for schedule(dynamic, 1)
+      for (size_t c = 0; c < chunks_.size(); ++c) {
+        auto row = chunk_rows_[c];
+        ForEachLineInRange(chunks_[c].first, chunks_[c].second,
+                           [&](const char* begin, const char* end) {
+                             lambda(row++, begin, end, &fields);
+                           });
+      }
+    }
+  }
+
+  /// Splits a line into fields. Surrounding whitespace and quotes are removed.
+  void SplitLine(const char* begin, const char* end,
+                 std::vector<Field>* fields) const;
+
+  static void Parse(const char* begin, const char* end, std::string* value) {
+    value->assign(begin, end);
+  }
+
+  template <typename T>
+  static typename std::enable_if<std::is_floating_point<T>::value>::type Parse(
+      const char* begin, const char* end, T* value) {
+    *value = static_cast<T>(ParseDouble(begin, end));
+  }
+
+  template <typename T>
+  static typename std::enable_if<std::is_integral<T>::value>::type Parse(
+      const char* begin, const char* end, T* value) {
+    *value = static_cast<T>(ParseInteger(begin, end));
+  }
+
+  /// Returns NaN if the field is not a number.
+  static double ParseDouble(const char* begin, const char* end);
+  /// Returns 0 if the field is not a number.
+  static int64_t ParseInteger(const char* begin, const char* end);
+};
+
+}  // namespace bdm
+
+#endif  // CORE_UTIL_PARALLEL_CSV_READER_H_
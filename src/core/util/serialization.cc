@@ -0,0 +1,311 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/util/serialization.h"
+
+#include <TBufferFile.h>
+
+#include <limits>
+
+#include "core/agent/agent.h"
+#include "core/behavior/behavior.h"
+#include "core/diffusion/diffusion_grid.h"
+#include "core/resource_manager.h"
+#include "core/simulation.h"
+#include "core/util/log.h"
+
+namespace bdm {
+
+namespace {
+
+/// Tag that precedes each agent and behavior.
+enum ObjectKind : uint8_t {
+  kNull = 0,
+  /// Written with `BDM_SERIALIZE`; followed by the type id and, if the type
+  /// occurs for the first time, by the type name.
+  kBinary = 1,
+  /// Embedded ROOT buffer; followed by its size.
+  kRoot = 2,
+  /// Index into the list of external objects.
+  kExternal = 3,
+  /// Index into the list of shared behaviors.
+  kShared = 4
+};
+
+constexpr uint64_t kNoContinuum = std::numeric_limits<uint64_t>::max();
+
+void WriteType(BinaryWriter* writer, const BinaryTypeInfo* type) {
+  bool is_new;
+  auto id = writer->GetTypeId(type, &is_new);
+  writer->Write(kBinary, id);
+  if (is_new) {
+    writer->Write(type->name);
+  }
+}
+
+void* CreateObject(BinaryReader* reader, const std::type_info& root) {
+  uint32_t id;
+  reader->Read(id);
+  auto* type = reader->ReadType(id);
+  if (*type->root != root) {
+    Log::Fatal("BinaryReader", "Type '", type->name, "' at position ",
+               reader->GetPosition(), " is not derived from ", root.name(),
+               ".");
+  }
+  return type->create();
+}
+
+void WriteRootObject(BinaryWriter* writer, const void* object, TClass* cl) {
+  TBufferFile buffer(TBuffer::kWrite);
+  buffer.WriteObjectAny(object, cl);
+  writer->Write(kRoot, static_cast<uint64_t>(buffer.Length()));
+  writer->WriteBytes(buffer.Buffer(), buffer.Length());
+}
+
+void* ReadRootObject(BinaryReader* reader, TClass* cl) {
+  uint64_t size;
+  reader->Read(size);
+  std::vector<char> data(size);
+  reader->ReadBytes(data.data(), size);
+  TBufferFile buffer(TBuffer::kRead, static_cast<Int_t>(size), data.data(),
+                     false);
+  return buffer.ReadObjectAny(cl);
+}
+
+template <typename T>
+T* GetElement(const std::vector<T*>* objects, BinaryReader* reader,
+              const char* description) {
+  uint64_t idx;
+  reader->Read(idx);
+  if (objects == nullptr || idx >= objects->size()) {
+    Log::Fatal("BinaryReader", "Reference to ", description, " ", idx,
+               " at position ", reader->GetPosition(),
+               " cannot be resolved.");
+  }
+  return (*objects)[idx];
+}
+
+void InvalidKind(BinaryReader* reader, uint8_t kind) {
+  Log::Fatal("BinaryReader", "Invalid object tag ", static_cast<int>(kind),
+             " at position ", reader->GetPosition() - 1,
+             ". The data is corrupted or has been written by a different "
+             "version of BioDynaMo.");
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+BinaryTypeRegistry* BinaryTypeRegistry::GetInstance() {
+  static BinaryTypeRegistry kInstance;
+  return &kInstance;
+}
+
+// -----------------------------------------------------------------------------
+const BinaryTypeInfo* BinaryTypeRegistry::Register(const char* name,
+                                                   const std::type_info& root,
+                                                   void* (*create)()) {
+  auto& info = types_[name];
+  info.name = name;
+  info.root = &root;
+  info.create = create;
+  return &info;
+}
+
+// -----------------------------------------------------------------------------
+const BinaryTypeInfo* BinaryTypeRegistry::Find(const std::string& name) const {
+  auto it = types_.find(name);
+  return it != types_.end() ? &it->second : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+uint32_t BinaryWriter::GetTypeId(const BinaryTypeInfo* type, bool* is_new) {
+  auto result = type_ids_.emplace(type, type_ids_.size());
+  *is_new = result.second;
+  return result.first->second;
+}
+
+// -----------------------------------------------------------------------------
+void BinaryReader::ReadVersion(uint16_t expected, const char* class_name) {
+  uint16_t version;
+  Read(version);
+  if (version != expected) {
+    Log::Fatal("BinaryReader", "The data of ", class_name,
+               " has been written with version ", version,
+               ", but the current version is ", expected, ".");
+  }
+}
+
+// -----------------------------------------------------------------------------
+const BinaryTypeInfo* BinaryReader::ReadType(uint32_t type_id) {
+  if (type_id < types_.size()) {
+    return types_[type_id];
+  }
+  if (type_id != types_.size()) {
+    Log::Fatal("BinaryReader", "Invalid type id ", type_id, " at position ",
+               pos_, ".");
+  }
+  std::string name;
+  Read(name);
+  auto* type = BinaryTypeRegistry::GetInstance()->Find(name);
+  if (type == nullptr) {
+    Log::Fatal("BinaryReader", "Type '", name,
+               "' is unknown. It must be declared with BDM_SERIALIZE in the "
+               "binary that reads the data.");
+  }
+  types_.push_back(type);
+  return type;
+}
+
+// -----------------------------------------------------------------------------
+ResourceManager* BinaryReader::GetResourceManager() const {
+  return rm_ != nullptr ? rm_ : Simulation::GetActive()->GetResourceManager();
+}
+
+// -----------------------------------------------------------------------------
+void BinaryReader::OutOfBounds(uint64_t size) const {
+  Log::Fatal("BinaryReader", "Attempt to read ", size, " bytes at position ",
+             pos_, ", but the buffer only contains ", size_, " bytes.");
+}
+
+// -----------------------------------------------------------------------------
+void WriteAgent(BinaryWriter* writer, const Agent* agent) {
+  if (agent == nullptr) {
+    writer->Write(kNull);
+  } else if (auto* type = agent->GetBinaryType()) {
+    WriteType(writer, type);
+    agent->WriteBinary(writer);
+  } else if (auto* external = writer->GetExternalAgents()) {
+    writer->Write(kExternal, static_cast<uint64_t>(external->size()));
+    external->push_back(agent);
+  } else {
+    WriteRootObject(writer, agent, agent->IsA());
+  }
+}
+
+// -----------------------------------------------------------------------------
+Agent* ReadAgent(BinaryReader* reader) {
+  uint8_t kind;
+  reader->Read(kind);
+  switch (kind) {
+    case kNull:
+      return nullptr;
+    case kBinary: {
+      auto* agent = static_cast<Agent*>(CreateObject(reader, typeid(Agent)));
+      agent->ReadBinary(reader);
+      return agent;
+    }
+    case kRoot:
+      return static_cast<Agent*>(ReadRootObject(reader, Agent::Class()));
+    case kExternal:
+      return GetElement(reader->GetExternalAgents(), reader, "agent");
+    default:
+      InvalidKind(reader, kind);
+      return nullptr;
+  }
+}
+
+// -----------------------------------------------------------------------------
+void WriteBehavior(BinaryWriter* writer, const Behavior* behavior) {
+  auto* shared = writer->GetSharedBehaviors();
+  if (behavior == nullptr) {
+    writer->Write(kNull);
+    return;
+  } else if (behavior->IsShared() && shared != nullptr) {
+    auto it = shared->find(behavior);
+    if (it != shared->end()) {
+      writer->Write(kShared, it->second);
+      return;
+    }
+  }
+
+  if (auto* type = behavior->GetBinaryType()) {
+    WriteType(writer, type);
+    behavior->WriteBinary(writer);
+  } else if (auto* external = writer->GetExternalBehaviors()) {
+    writer->Write(kExternal, static_cast<uint64_t>(external->size()));
+    external->push_back(behavior);
+  } else {
+    WriteRootObject(writer, behavior, behavior->IsA());
+  }
+}
+
+// -----------------------------------------------------------------------------
+void WriteExternalBehavior(BinaryWriter* writer, const Behavior* behavior) {
+  auto* external = writer->GetExternalBehaviors();
+  if (external == nullptr) {
+    Log::Fatal("WriteExternalBehavior", "No external objects have been set.");
+  }
+  writer->Write(kExternal, static_cast<uint64_t>(external->size()));
+  external->push_back(behavior);
+}
+
+// -----------------------------------------------------------------------------
+Behavior* ReadBehavior(BinaryReader* reader) {
+  uint8_t kind;
+  reader->Read(kind);
+  switch (kind) {
+    case kNull:
+      return nullptr;
+    case kBinary: {
+      auto* behavior =
+          static_cast<Behavior*>(CreateObject(reader, typeid(Behavior)));
+      behavior->ReadBinary(reader);
+      return behavior;
+    }
+    case kRoot:
+      return static_cast<Behavior*>(ReadRootObject(reader, Behavior::Class()));
+    case kExternal:
+      return GetElement(reader->GetExternalBehaviors(), reader, "behavior");
+    case kShared:
+      return GetElement(reader->GetSharedBehaviors(), reader,
+                        "shared behavior");
+    default:
+      InvalidKind(reader, kind);
+      return nullptr;
+  }
+}
+
+// -----------------------------------------------------------------------------
+bool IsBinarySerializable(const Agent* agent) {
+  if (agent->GetBinaryType() == nullptr) {
+    return false;
+  }
+  for (auto* behavior : agent->GetAllBehaviors()) {
+    if (!behavior->IsShared() && behavior->GetBinaryType() == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+void BinarySerializer<DiffusionGrid*>::Write(BinaryWriter* writer,
+                                             DiffusionGrid* const& value) {
+  uint64_t id = value != nullptr
+                    ? static_cast<uint64_t>(value->GetContinuumId())
+                    : kNoContinuum;
+  writer->Write(id);
+}
+
+// -----------------------------------------------------------------------------
+void BinarySerializer<DiffusionGrid*>::Read(BinaryReader* reader,
+                                            DiffusionGrid** value) {
+  uint64_t id;
+  reader->Read(id);
+  *value = id != kNoContinuum
+               ? reader->GetResourceManager()->GetDiffusionGrid(id)
+               : nullptr;
+}
+
+}  // namespace bdm
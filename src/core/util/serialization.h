@@ -0,0 +1,476 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#ifndef CORE_UTIL_SERIALIZATION_H_
+#define CORE_UTIL_SERIALIZATION_H_
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/agent/agent_uid.h"
+#include "core/container/math_array.h"
+#include "core/util/root.h"
+
+namespace bdm {
+
+class Agent;
+class Behavior;
+class DiffusionGrid;
+class ResourceManager;
+class BinaryWriter;
+class BinaryReader;
+
+/// Macro to generate the binary serialization of an agent or behavior.\n
+/// Must be placed after `BDM_AGENT_HEADER` or `BDM_BEHAVIOR_HEADER` and must
+/// list all data members that are declared in this class (not the ones of
+/// the base class). The members are encoded one after the other without any
+/// reflection at runtime, which is considerably faster than ROOT's
+/// streamers. Checkpoints (`SimulationBackup`, `SimulationSnapshot`) use the
+/// generated code for all agents and behaviors that support it and fall back
+/// to ROOT I/O for the remaining ones.
+/// \code
+/// class MyCell : public Cell {
+///   BDM_AGENT_HEADER(MyCell, Cell, 1);
+///   BDM_SERIALIZE(MyCell, 1, cell_type_, color_);
+///   ...
+///  private:
+///   int cell_type_;
+///   Real3 color_;
+/// };
+/// \endcode
+/// @param   class_name scalar class name
+/// @param   class_version_id must be incremented every time the list of
+///          serialized members changes. Data that was written with a
+///          different version cannot be read.
+/// @param   ... data members. Supported are arithmetic types, enums,
+///          std::string, `MathArray`, `AgentUid`, `DiffusionGrid*`, and
+///          `std::vector`, `std::array`, `std::pair`, `std::map` thereof.
+///          Support for further types can be added by specializing
+///          `BinarySerializer`.
+#define BDM_SERIALIZE(class_name, class_version_id, ...)                \
+ public:                                                                \
+  const BinaryTypeInfo* GetBinaryType() const override {               \
+    return typeid(*this) == typeid(class_name)                         \
+               ? BinaryType<class_name>::Get()                         \
+               : nullptr;                                              \
+  }                                                                    \
+                                                                       \
+  void WriteBinary(BinaryWriter* writer) const override {              \
+    Base::WriteBinary(writer);                                         \
+    writer->WriteVersion(class_version_id);                            \
+    writer->Write(__VA_ARGS__);                                        \
+  }                                                                    \
+                                                                       \
+  void ReadBinary(BinaryReader* reader) override {                     \
+    Base::ReadBinary(reader);                                          \
+    reader->ReadVersion(class_version_id, #class_name);                \
+    reader->Read(__VA_ARGS__);                                         \
+  }                                                                    \
+                                                                       \
+ private:
+
+// -----------------------------------------------------------------------------
+/// Describes a type that has been declared with `BDM_SERIALIZE`.
+struct BinaryTypeInfo {
+  /// Identifies the type in the binary format. Data can therefore only be
+  /// read by a binary that was built with the same compiler.
+  std::string name;
+  /// `typeid` of the root of the class hierarchy (`Agent` or `Behavior`).
+  const std::type_info* root;
+  /// Creates an instance whose data members will be overwritten by
+  /// `ReadBinary`. Returns a pointer to the root class.
+  void* (*create)();
+};
+
+/// Maps the names of all types declared with `BDM_SERIALIZE` to their
+/// `BinaryTypeInfo`. Types register themselves during static
+/// initialization.
+class BinaryTypeRegistry {
+ public:
+  static BinaryTypeRegistry* GetInstance();
+
+  const BinaryTypeInfo* Register(const char* name, const std::type_info& root,
+                                 void* (*create)());
+
+  /// Returns nullptr if `name` has not been registered.
+  const BinaryTypeInfo* Find(const std::string& name) const;
+
+ private:
+  std::unordered_map<std::string, BinaryTypeInfo> types_;
+};
+
+/// Registers `T` in the `BinaryTypeRegistry`. `Get` is called from the code
+/// generated by `BDM_SERIALIZE`, which instantiates the static member and
+/// thereby the registration.
+template <typename T>
+class BinaryType {
+ public:
+  static const BinaryTypeInfo* Get() { return info_; }
+
+ private:
+  using Root = typename T::BinaryRoot;
+
+  static const BinaryTypeInfo* info_;
+
+  template <typename U = T>
+  static typename std::enable_if<std::is_constructible<U, TRootIOCtor*>::value,
+                                 U*>::type
+  New() {
+    // Agents: the I/O constructor does not initialize data members that
+    // are read afterwards anyway.
+    return new U(static_cast<TRootIOCtor*>(nullptr));
+  }
+
+  template <typename U = T>
+  static typename std::enable_if<!std::is_constructible<U, TRootIOCtor*>::value,
+                                 U*>::type
+  New() {
+    return new U();
+  }
+
+  static void* Create() { return static_cast<Root*>(New()); }
+};
+
+template <typename T>
+const BinaryTypeInfo* BinaryType<T>::info_ =
+    BinaryTypeRegistry::GetInstance()->Register(typeid(T).name(),
+                                                typeid(Root), &Create);
+
+// -----------------------------------------------------------------------------
+/// Encodes and decodes values of type `T`. Specialize this template to add
+/// support for further types to `BDM_SERIALIZE`.
+template <typename T, typename Enable = void>
+struct BinarySerializer;
+
+/// Appends the binary encoding of values to a buffer.\n
+/// Values are written in the byte order of the host without padding or type
+/// information. Reading them requires the same sequence of types.
+class BinaryWriter {
+ public:
+  explicit BinaryWriter(std::vector<char>* buffer) : buffer_(buffer) {}
+
+  void WriteBytes(const void* data, uint64_t size) {
+    auto pos = buffer_->size();
+    buffer_->resize(pos + size);
+    std::memcpy(buffer_->data() + pos, data, size);
+  }
+
+  template <typename... TArgs>
+  void Write(const TArgs&... values) {
+    int expand[] = {0, (BinarySerializer<TArgs>::Write(this, values), 0)...};
+    (void)expand;
+  }
+
+  void WriteVersion(uint16_t version) { Write(version); }
+
+  /// Returns the id of `type` in this buffer. Sets `is_new` to true if the
+  /// type occurs for the first time. In this case the caller must write
+  /// the type name.
+  uint32_t GetTypeId(const BinaryTypeInfo* type, bool* is_new);
+
+  /// Shared behaviors that have been written before (e.g. by
+  /// `ResourceManager::WriteAgents`). Agents refer to them by their index
+  /// instead of writing them again.
+  void SetSharedBehaviors(
+      const std::unordered_map<const Behavior*, uint64_t>* shared) {
+    shared_behaviors_ = shared;
+  }
+  const std::unordered_map<const Behavior*, uint64_t>* GetSharedBehaviors()
+      const {
+    return shared_behaviors_;
+  }
+
+  /// Agents and behaviors without binary serialization are written with
+  /// ROOT. By default, each of them is embedded as a separate ROOT buffer.
+  /// If these lists are set, the objects are appended to them instead, and
+  /// the caller must write them to a ROOT buffer in the same order. This
+  /// preserves pointers to other objects in that buffer (e.g. continuum
+  /// models).
+  void SetExternalObjects(std::vector<const Agent*>* agents,
+                          std::vector<const Behavior*>* behaviors) {
+    external_agents_ = agents;
+    external_behaviors_ = behaviors;
+  }
+  std::vector<const Agent*>* GetExternalAgents() { return external_agents_; }
+  std::vector<const Behavior*>* GetExternalBehaviors() {
+    return external_behaviors_;
+  }
+
+ private:
+  std::vector<char>* buffer_;
+  std::unordered_map<const BinaryTypeInfo*, uint32_t> type_ids_;
+  const std::unordered_map<const Behavior*, uint64_t>* shared_behaviors_ =
+      nullptr;
+  std::vector<const Agent*>* external_agents_ = nullptr;
+  std::vector<const Behavior*>* external_behaviors_ = nullptr;
+};
+
+/// Decodes values that have been written with `BinaryWriter`.\n
+/// Reading past the end of the buffer is a fatal error.
+class BinaryReader {
+ public:
+  BinaryReader(const char* data, uint64_t size) : data_(data), size_(size) {}
+
+  void ReadBytes(void* data, uint64_t size) {
+    if (size > size_ - pos_) {
+      OutOfBounds(size);
+    }
+    std::memcpy(data, data_ + pos_, size);
+    pos_ += size;
+  }
+
+  template <typename... TArgs>
+  void Read(TArgs&... values) {
+    int expand[] = {0, (BinarySerializer<TArgs>::Read(this, &values), 0)...};
+    (void)expand;
+  }
+
+  /// Reads the version that was written with `BinaryWriter::WriteVersion`.
+  /// Fatal error if it differs from `expected`.
+  void ReadVersion(uint16_t expected, const char* class_name);
+
+  uint64_t GetPosition() const { return pos_; }
+  bool AtEnd() const { return pos_ == size_; }
+
+  /// Returns the type with id `type_id` and reads its name if it occurs for
+  /// the first time.
+  const BinaryTypeInfo* ReadType(uint32_t type_id);
+
+  /// \see `BinaryWriter::SetSharedBehaviors`
+  void SetSharedBehaviors(const std::vector<Behavior*>* shared) {
+    shared_behaviors_ = shared;
+  }
+  const std::vector<Behavior*>* GetSharedBehaviors() const {
+    return shared_behaviors_;
+  }
+
+  /// \see `BinaryWriter::SetExternalObjects`
+  void SetExternalObjects(const std::vector<Agent*>* agents,
+                          const std::vector<Behavior*>* behaviors) {
+    external_agents_ = agents;
+    external_behaviors_ = behaviors;
+  }
+  const std::vector<Agent*>* GetExternalAgents() const {
+    return external_agents_;
+  }
+  const std::vector<Behavior*>* GetExternalBehaviors() const {
+    return external_behaviors_;
+  }
+
+  /// ResourceManager that is used to look up continuum models (e.g. for
+  /// `DiffusionGrid*` members). Defaults to the one of the active
+  /// simulation.
+  void SetResourceManager(ResourceManager* rm) { rm_ = rm; }
+  ResourceManager* GetResourceManager() const;
+
+ private:
+  const char* data_;
+  uint64_t size_;
+  uint64_t pos_ = 0;
+  std::vector<const BinaryTypeInfo*> types_;
+  const std::vector<Behavior*>* shared_behaviors_ = nullptr;
+  const std::vector<Agent*>* external_agents_ = nullptr;
+  const std::vector<Behavior*>* external_behaviors_ = nullptr;
+  ResourceManager* rm_ = nullptr;
+
+  void OutOfBounds(uint64_t size) const;
+};
+
+// -----------------------------------------------------------------------------
+/// Writes an agent including its behaviors. `agent` can be a nullptr.
+void WriteAgent(BinaryWriter* writer, const Agent* agent);
+
+/// Reads an agent that has been written with `WriteAgent`.
+Agent* ReadAgent(BinaryReader* reader);
+
+/// Writes a behavior. `behavior` can be a nullptr.
+void WriteBehavior(BinaryWriter* writer, const Behavior* behavior);
+
+/// Appends `behavior` to the external objects of `writer`, even if it can
+/// be written without ROOT (see `BinaryWriter::SetExternalObjects`).
+/// It can be read with `ReadBehavior`.
+void WriteExternalBehavior(BinaryWriter* writer, const Behavior* behavior);
+
+/// Reads a behavior that has been written with `WriteBehavior`.
+Behavior* ReadBehavior(BinaryReader* reader);
+
+/// Returns true if `agent` and all its behaviors that are not shared can be
+/// written without ROOT (i.e. they are declared with `BDM_SERIALIZE`).
+bool IsBinarySerializable(const Agent* agent);
+
+// -----------------------------------------------------------------------------
+// BinarySerializer specializations
+
+template <typename T>
+struct BinarySerializer<T, typename std::enable_if<std::is_arithmetic<T>::value ||
+                                                   std::is_enum<T>::value>::type> {
+  static void Write(BinaryWriter* writer, const T& value) {
+    writer->WriteBytes(&value, sizeof(T));
+  }
+  static void Read(BinaryReader* reader, T* value) {
+    reader->ReadBytes(value, sizeof(T));
+  }
+};
+
+template <>
+struct BinarySerializer<std::string> {
+  static void Write(BinaryWriter* writer, const std::string& value) {
+    writer->Write(static_cast<uint64_t>(value.size()));
+    writer->WriteBytes(value.data(), value.size());
+  }
+  static void Read(BinaryReader* reader, std::string* value) {
+    uint64_t size;
+    reader->Read(size);
+    value->resize(size);
+    reader->ReadBytes(&(*value)[0], size);
+  }
+};
+
+template <typename T>
+struct BinarySerializer<std::vector<T>> {
+  // Arrays of numbers are copied at once.
+  static constexpr bool kBulk =
+      std::is_arithmetic<T>::value && !std::is_same<T, bool>::value;
+
+  static void Write(BinaryWriter* writer, const std::vector<T>& value) {
+    writer->Write(static_cast<uint64_t>(value.size()));
+    WriteElements(writer, value);
+  }
+  static void Read(BinaryReader* reader, std::vector<T>* value) {
+    uint64_t size;
+    reader->Read(size);
+    value->resize(size);
+    ReadElements(reader, value);
+  }
+
+ private:
+  template <bool B = kBulk>
+  static typename std::enable_if<B>::type WriteElements(
+      BinaryWriter* writer, const std::vector<T>& value) {
+    writer->WriteBytes(value.data(), value.size() * sizeof(T));
+  }
+  template <bool B = kBulk>
+  static typename std::enable_if<!B>::type WriteElements(
+      BinaryWriter* writer, const std::vector<T>& value) {
+    for (const T& el : value) {
+      writer->Write(el);
+    }
+  }
+  template <bool B = kBulk>
+  static typename std::enable_if<B>::type ReadElements(BinaryReader* reader,
+                                                       std::vector<T>* value) {
+    reader->ReadBytes(value->data(), value->size() * sizeof(T));
+  }
+  template <bool B = kBulk>
+  static typename std::enable_if<!B>::type ReadElements(BinaryReader* reader,
+                                                        std::vector<T>* value) {
+    for (uint64_t i = 0; i < value->size(); ++i) {
+      T el;
+      reader->Read(el);
+      (*value)[i] = std::move(el);
+    }
+  }
+};
+
+template <typename T, std::size_t N>
+struct BinarySerializer<MathArray<T, N>> {
+  static void Write(BinaryWriter* writer, const MathArray<T, N>& value) {
+    for (std::size_t i = 0; i < N; ++i) {
+      writer->Write(value[i]);
+    }
+  }
+  static void Read(BinaryReader* reader, MathArray<T, N>* value) {
+    for (std::size_t i = 0; i < N; ++i) {
+      reader->Read((*value)[i]);
+    }
+  }
+};
+
+template <typename T, std::size_t N>
+struct BinarySerializer<std::array<T, N>> {
+  static void Write(BinaryWriter* writer, const std::array<T, N>& value) {
+    for (const T& el : value) {
+      writer->Write(el);
+    }
+  }
+  static void Read(BinaryReader* reader, std::array<T, N>* value) {
+    for (T& el : *value) {
+      reader->Read(el);
+    }
+  }
+};
+
+template <typename T1, typename T2>
+struct BinarySerializer<std::pair<T1, T2>> {
+  static void Write(BinaryWriter* writer, const std::pair<T1, T2>& value) {
+    writer->Write(value.first, value.second);
+  }
+  static void Read(BinaryReader* reader, std::pair<T1, T2>* value) {
+    reader->Read(value->first, value->second);
+  }
+};
+
+template <typename TKey, typename TValue>
+struct BinarySerializer<std::map<TKey, TValue>> {
+  static void Write(BinaryWriter* writer,
+                    const std::map<TKey, TValue>& value) {
+    writer->Write(static_cast<uint64_t>(value.size()));
+    for (auto& el : value) {
+      writer->Write(el.first, el.second);
+    }
+  }
+  static void Read(BinaryReader* reader, std::map<TKey, TValue>* value) {
+    uint64_t size;
+    reader->Read(size);
+    value->clear();
+    for (uint64_t i = 0; i < size; ++i) {
+      TKey key;
+      reader->Read(key);
+      reader->Read((*value)[key]);
+    }
+  }
+};
+
+template <>
+struct BinarySerializer<AgentUid> {
+  static void Write(BinaryWriter* writer, const AgentUid& value) {
+    writer->Write(value.GetIndex(), value.GetReused());
+  }
+  static void Read(BinaryReader* reader, AgentUid* value) {
+    AgentUid::Index_t index;
+    AgentUid::Reused_t reused;
+    reader->Read(index, reused);
+    *value = AgentUid(index, reused);
+  }
+};
+
+/// Diffusion grids are written as their continuum id and are looked up in
+/// `BinaryReader::GetResourceManager()`.
+template <>
+struct BinarySerializer<DiffusionGrid*> {
+  static void Write(BinaryWriter* writer, DiffusionGrid* const& value);
+  static void Read(BinaryReader* reader, DiffusionGrid** value);
+};
+
+}  // namespace bdm
+
+#endif  // CORE_UTIL_SERIALIZATION_H_
@@ -24,6 +24,7 @@
 
 #include "core/simulation.h"
 #include "core/util/math.h"
+#include "core/util/serialization.h"
 
 namespace bdm {
 
@@ -46,6 +47,15 @@ class TimingAggregator {
     descriptions_.push_back(text);
   }
 
+  /// Writes all timings with the binary serialization layer.
+  void WriteBinary(BinaryWriter* writer) const {
+    writer->Write(timings_, descriptions_);
+  }
+
+  void ReadBinary(BinaryReader* reader) {
+    reader->Read(timings_, descriptions_);
+  }
+
   int operator[](std::string idx) {
     auto sum = std::accumulate(timings_[idx].begin(), timings_[idx].end(), 0);
     return sum;
@@ -131,6 +131,13 @@ void NeuriteElement::CriticalRegion(std::vector<AgentPointer<>>* aptrs) {
   }
 }
 
+void NeuriteElement::UpdateAgentUids(const AgentUidMap<AgentUid>& new_uids) {
+  Base::UpdateAgentUids(new_uids);
+  mother_.UpdateUid(new_uids);
+  daughter_left_.UpdateUid(new_uids);
+  daughter_right_.UpdateUid(new_uids);
+}
+
 std::set<std::string> NeuriteElement::GetRequiredVisDataMembers() const {
   return {"mass_location_", "diameter_", "actual_length_", "spring_axis_"};
 }
@@ -69,6 +69,8 @@ class NeuriteElement : public Agent, public NeuronOrNeurite {
 
   void CriticalRegion(std::vector<AgentPointer<>>* aptrs) override;
 
+  void UpdateAgentUids(const AgentUidMap<AgentUid>& new_uids) override;
+
   Shape GetShape() const override { return Shape::kCylinder; }
 
   /// Returns the data members that are required to visualize this simulation
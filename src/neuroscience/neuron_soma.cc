@@ -74,6 +74,20 @@ void NeuronSoma::CriticalRegion(std::vector<AgentPointer<>>* aptrs) {
   }
 }
 
+void NeuronSoma::UpdateAgentUids(const AgentUidMap<AgentUid>& new_uids) {
+  Base::UpdateAgentUids(new_uids);
+  for (auto& daughter : daughters_) {
+    daughter.UpdateUid(new_uids);
+  }
+  std::unordered_map<AgentUid, Real3> daughters_coord;
+  for (auto& el : daughters_coord_) {
+    if (new_uids.Contains(el.first)) {
+      daughters_coord[new_uids[el.first]] = el.second;
+    }
+  }
+  daughters_coord_.swap(daughters_coord);
+}
+
 NeuriteElement* NeuronSoma::ExtendNewNeurite(const Real3& direction,
                                              NeuriteElement* prototype) {
   auto dir = direction + GetPosition();
@@ -42,8 +42,23 @@ if [ ! -z ${GITHUB_ACTIONS+x} ]; then
   fi
 fi
 
-# start simulation
-mpirun -np 2 $GHA_CENTOS_ALLOW_ROOT ./multi_simulation_test --config=optim.json
-
+# start simulation with two workers
+# The first task emulates a lost worker (see SimParam::hang_marker). Its task
+# must be re-dispatched to the other worker after the deadline.
+mpirun -np 3 $GHA_CENTOS_ALLOW_ROOT ./multi_simulation_test --config=optim.json
 RETURN_CODE=$?
-exit $RETURN_CODE
+if [ $RETURN_CODE != 0 ]; then
+  exit $RETURN_CODE
+fi
+
+# A restarted campaign takes all results from the checkpoint file
+mpirun -np 3 $GHA_CENTOS_ALLOW_ROOT ./multi_simulation_test --config=optim.json \
+  | tee restart.log
+RETURN_CODE=${PIPESTATUS[0]}
+if [ $RETURN_CODE != 0 ]; then
+  exit $RETURN_CODE
+fi
+if grep -q "Processing parameters" restart.log; then
+  echo "Restarted campaign did not skip the completed tasks"
+  exit 1
+fi
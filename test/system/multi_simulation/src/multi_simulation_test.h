@@ -17,6 +17,7 @@
 
 #include <unistd.h>
 #include <chrono>
+#include <fstream>
 #include <thread>
 
 #include "biodynamo.h"
@@ -33,6 +34,9 @@ struct SimParam : public ParamGroup {
   int param1 = 0;
   int param2 = 0;
   int param3 = 0;
+  // If set, the first simulation that finds no file at this path creates it
+  // and hangs, to emulate a lost worker.
+  std::string hang_marker;
 };
 
 inline int Simulate(int argc, const char** argv, TimeSeries* result,
@@ -45,12 +49,21 @@ inline int Simulate(int argc, const char** argv, TimeSeries* result,
 
   auto* sparam = simulation.GetParam()->Get<SimParam>();
 
+  if (!sparam->hang_marker.empty() &&
+      !std::ifstream(sparam->hang_marker).good()) {
+    std::ofstream(sparam->hang_marker) << "hang";
+    std::cout << "Emulating a lost worker" << std::endl;
+    std::this_thread::sleep_for(std::chrono::hours(1));
+  }
+
   // Emulate a simulation
   std::this_thread::sleep_for(100ms);
 
   result->Add("param1", {0}, {static_cast<real_t>(sparam->param1)});
   result->Add("param2", {0}, {static_cast<real_t>(sparam->param2)});
   result->Add("param3", {0}, {static_cast<real_t>(sparam->param3)});
+  // Must not be sent to the master. See `OptimizationParam::result_columns`.
+  result->Add("not-requested", {0}, {1});
 
   std::cout << "Processing parameters: [" << sparam->param1 << ", "
             << sparam->param2 << ", " << sparam->param3 << "]" << std::endl;
@@ -59,16 +59,21 @@ struct TestAlgorithm : public Algorithm {
 
       // Check results
       int failed = 0;
-      if (std::abs(expected_result.GetXValues("param1")[0] -
-                   obtained_result.GetXValues("param1")[0]) > 1e-9) {
+      if (obtained_result.Contains("not-requested")) {
         failed = 1;
       }
-      if (std::abs(expected_result.GetXValues("param2")[0] -
-                   obtained_result.GetXValues("param2")[0]) > 1e-9) {
-        failed = 1;
+      for (auto* param : {"param1", "param2", "param3"}) {
+        if (!obtained_result.Contains(param) ||
+            std::abs(expected_result.GetXValues(param)[0] -
+                     obtained_result.GetXValues(param)[0]) > 1e-9) {
+          failed = 1;
+        }
       }
-      if (std::abs(expected_result.GetXValues("param3")[0] -
-                   obtained_result.GetXValues("param3")[0]) > 1e-9) {
+      // The simulation truncates the log-range values of param3 to int
+      if (std::abs(expected_result.GetYValues("param1")[0] -
+                   obtained_result.GetYValues("param1")[0]) > 1e-9 ||
+          std::abs(expected_result.GetYValues("param2")[0] -
+                   obtained_result.GetYValues("param2")[0]) > 1e-9) {
         failed = 1;
       }
 
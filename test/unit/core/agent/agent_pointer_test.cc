@@ -13,7 +13,6 @@
 // -----------------------------------------------------------------------------
 
 #include "unit/core/agent/agent_pointer_test.h"
-#include "core/randomized_rm.h"  // for bdm::Ubrng
 #include "unit/test_util/io_test.h"
 
 namespace bdm {
@@ -105,6 +105,48 @@ TEST(AgentTest, BehaviorUpdate) {
   EXPECT_TRUE(dynamic_cast<Growth*>(copy_behaviors[0]) != nullptr);
 }
 
+TEST(AgentTest, SharedBehavior) {
+  Simulation simulation(TEST_NAME);
+
+  auto* g = new Growth();
+  g->Share();
+  EXPECT_TRUE(g->IsShared());
+
+  TestAgent cell;
+  cell.AddBehavior(g);
+
+  // copies reference the same instance
+  TestAgent copy(cell);
+  ASSERT_EQ(1u, copy.GetAllBehaviors().size());
+  EXPECT_EQ(g, copy.GetAllBehaviors()[0]);
+
+  // new agents reference the same instance
+  CellDivisionEvent event(1, 2, 3);
+  event.existing_agent = &cell;
+  TestAgent daughter;
+  daughter.Initialize(event);
+  cell.Update(event);
+  ASSERT_EQ(1u, daughter.GetAllBehaviors().size());
+  EXPECT_EQ(g, daughter.GetAllBehaviors()[0]);
+  ASSERT_EQ(1u, cell.GetAllBehaviors().size());
+  EXPECT_EQ(g, cell.GetAllBehaviors()[0]);
+
+  // copy-on-write
+  auto* own = dynamic_cast<Growth*>(daughter.UnshareBehavior(g));
+  ASSERT_TRUE(own != nullptr);
+  EXPECT_TRUE(own != g);
+  EXPECT_FALSE(own->IsShared());
+  EXPECT_EQ(own, daughter.GetAllBehaviors()[0]);
+  own->growth_rate_ = 2;
+  EXPECT_NEAR(0.5, g->growth_rate_, abs_error<real_t>::value);
+
+  // removing a shared behavior does not delete it
+  copy.RemoveBehavior(g);
+  EXPECT_EQ(0u, copy.GetAllBehaviors().size());
+  cell.RunBehaviors();
+  EXPECT_NEAR(10.5, cell.GetDiameter(), abs_error<real_t>::value);
+}
+
 TEST(AgentTest, RemoveSingleBehavior) {
   Simulation simulation(TEST_NAME);
 
@@ -14,6 +14,8 @@
 
 #include "core/agent/agent_uid_generator.h"
 #include <gtest/gtest.h>
+#include <set>
+#include <vector>
 #include "core/resource_manager.h"
 #include "core/simulation.h"
 #include "unit/test_util/io_test.h"
@@ -43,6 +45,42 @@ TEST(AgentUidGeneratorTest, NormalAndDefragmentationMode) {
   }
 }
 
+TEST(AgentUidGeneratorTest, BalanceReusableUids) {
+  AgentUidGenerator generator;
+
+  auto* tinfo = ThreadInfo::GetInstance();
+  auto max_threads = tinfo->GetMaxThreads();
+  for (int i = 0; i < max_threads; ++i) {
+    generator.GenerateUid();
+  }
+
+  // all uids are freed by the same thread
+  for (int i = 0; i < max_threads; ++i) {
+    generator.ReuseAgentUid(AgentUid(i));
+  }
+  generator.BalanceReusableUids();
+
+  // each thread reuses one of them
+  std::vector<AgentUid> reused(max_threads);
+#pragma omp parallel for schedule(static, 1)
+  for (int i = 0; i < max_threads; ++i) {
+    reused[i] = generator.GenerateUid();
+  }
+  std::set<AgentUid::Index_t> indices;
+  for (auto& uid : reused) {
+    EXPECT_EQ(1u, uid.GetReused());
+    indices.insert(uid.GetIndex());
+  }
+  EXPECT_EQ(static_cast<uint64_t>(max_threads), indices.size());
+  EXPECT_EQ(AgentUid(max_threads), generator.GenerateUid());
+
+  // reset
+  generator.ReuseAgentUid(AgentUid(0));
+  generator.Reset(5);
+  EXPECT_EQ(5u, generator.GetHighestIndex());
+  EXPECT_EQ(AgentUid(5), generator.GenerateUid());
+}
+
 #ifdef USE_DICT
 TEST_F(IOTest, AgentUidGenerator) {
   AgentUidGenerator test;
@@ -15,6 +15,7 @@
 
 #include "core/algorithm.h"
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <unordered_map>
 #include <vector>
 
@@ -133,4 +134,21 @@ TEST(BinarySearch, DuplicatesLarge) {
   }
 }
 
+// -----------------------------------------------------------------------------
+TEST(ParallelRadixSort, Stable) {
+  // keys with equal high digits; the second element records the input order
+  std::vector<std::pair<uint64_t, uint64_t>> v;
+  for (uint64_t i = 0; i < 10000; ++i) {
+    v.push_back({(i * 7919) % 1000 + (uint64_t(1) << 40), i});
+  }
+  auto expected = v;
+  std::stable_sort(
+      expected.begin(), expected.end(),
+      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  std::vector<std::pair<uint64_t, uint64_t>> buffer;
+  ParallelRadixSort(&v, &buffer, [](const auto& p) { return p.first; }, 63);
+  EXPECT_EQ(expected, v);
+}
+
 }  // namespace bdm
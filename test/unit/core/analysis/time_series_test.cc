@@ -15,6 +15,9 @@
 #include "core/analysis/time_series.h"
 #include <TMath.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "core/agent/cell.h"
 #include "core/behavior/behavior.h"
 #include "core/behavior/stateless_behavior.h"
@@ -426,6 +429,20 @@ TEST(TimeSeries, MergeDifferentNumberOfXValues) {
   EXPECT_EQ(0u, merged.Size());
 }
 
+// -----------------------------------------------------------------------------
+TEST(TimeSeries, MergeDifferentNumberOfYValues) {
+  std::vector<TimeSeries> tss(2);
+  tss[0].Add("entry-0", {1, 2}, {3, 4});
+  tss[1].Add("entry-0", {1, 2}, {6});
+
+  TimeSeries merged;
+  TimeSeries::Merge(&merged, tss,
+                    [](const std::vector<real_t>& all_y_values, real_t* y,
+                       real_t* el, real_t* eh) {});
+
+  EXPECT_EQ(0u, merged.Size());
+}
+
 // -----------------------------------------------------------------------------
 TEST(TimeSeries, Merge) {
   std::vector<TimeSeries> tss(3);
@@ -462,6 +479,96 @@ TEST(TimeSeries, Merge) {
   EXPECT_NEAR(5.0, eh[1], abs_error<real_t>::value);
 }
 
+// -----------------------------------------------------------------------------
+TEST(TimeSeries, MergeBuiltInReducers) {
+  std::vector<TimeSeries> tss(3);
+  tss[0].Add("entry-0", {1, 2}, {2, 5});
+  tss[1].Add("entry-0", {1, 2}, {4, 8});
+  tss[2].Add("entry-0", {1, 2}, {1, 13});
+
+  TimeSeries merged;
+  TimeSeries::Merge(&merged, tss, TimeSeries::MergeReducer::kMedianMinMax);
+  EXPECT_EQ(1u, merged.Size());
+  EXPECT_EQ((std::vector<real_t>{1, 2}), merged.GetXValues("entry-0"));
+  EXPECT_VEC_NEAR(merged.GetYValues("entry-0"), {2, 8});
+  EXPECT_VEC_NEAR(merged.GetYErrorLow("entry-0"), {1, 3});
+  EXPECT_VEC_NEAR(merged.GetYErrorHigh("entry-0"), {2, 5});
+
+  TimeSeries merged_mean;
+  TimeSeries::Merge(&merged_mean, tss, TimeSeries::MergeReducer::kMean);
+  EXPECT_VEC_NEAR(merged_mean.GetYValues("entry-0"), {7.0 / 3, 26.0 / 3});
+  EXPECT_VEC_NEAR(merged_mean.GetYErrorLow("entry-0"), {0, 0});
+  EXPECT_VEC_NEAR(merged_mean.GetYErrorHigh("entry-0"), {0, 0});
+
+  TimeSeries merged_std;
+  TimeSeries::Merge(&merged_std, tss, TimeSeries::MergeReducer::kMeanStd);
+  EXPECT_VEC_NEAR(merged_std.GetYValues("entry-0"), {7.0 / 3, 26.0 / 3});
+  std::vector<real_t> std_dev = {static_cast<real_t>(std::sqrt(7.0 / 3)),
+                                 static_cast<real_t>(std::sqrt(49.0 / 3))};
+  EXPECT_VEC_NEAR(merged_std.GetYErrorLow("entry-0"), std_dev);
+  EXPECT_VEC_NEAR(merged_std.GetYErrorHigh("entry-0"), std_dev);
+}
+
+// -----------------------------------------------------------------------------
+TEST(TimeSeries, MergeBuiltInReducersLargeEnsemble) {
+  // More data points than processed together by the built-in reducers
+  constexpr uint64_t kNumPoints = 1000;
+  std::vector<TimeSeries> tss(101);
+  std::vector<real_t> x(kNumPoints);
+  for (uint64_t i = 0; i < kNumPoints; ++i) {
+    x[i] = i;
+  }
+  for (uint64_t j = 0; j < tss.size(); ++j) {
+    std::vector<real_t> y(kNumPoints);
+    for (uint64_t i = 0; i < kNumPoints; ++i) {
+      y[i] = static_cast<real_t>((j * 37 + i * 11) % 101);
+    }
+    tss[j].Add("entry-0", x, y);
+  }
+
+  TimeSeries merged;
+  TimeSeries::Merge(&merged, tss, TimeSeries::MergeReducer::kMedianQuantiles,
+                    0.1, 0.9);
+  TimeSeries expected;
+  TimeSeries::Merge(
+      &expected, tss,
+      [](const std::vector<real_t>& all_y_values, real_t* y, real_t* el,
+         real_t* eh) {
+        auto sorted = all_y_values;
+        std::sort(sorted.begin(), sorted.end());
+        *y = sorted[50];
+        *el = *y - sorted[10];
+        *eh = sorted[90] - *y;
+      });
+
+  ASSERT_EQ(kNumPoints, merged.GetYValues("entry-0").size());
+  EXPECT_VEC_NEAR(merged.GetYValues("entry-0"),
+                  expected.GetYValues("entry-0"));
+  EXPECT_VEC_NEAR(merged.GetYErrorLow("entry-0"),
+                  expected.GetYErrorLow("entry-0"));
+  EXPECT_VEC_NEAR(merged.GetYErrorHigh("entry-0"),
+                  expected.GetYErrorHigh("entry-0"));
+}
+
+// -----------------------------------------------------------------------------
+TEST(TimeSeries, ComputeError) {
+  TimeSeries ts1;
+  ts1.Add("entry-0", {1, 2}, {2, 5});
+  ts1.Add("entry-1", {1}, {1});
+  TimeSeries ts2;
+  ts2.Add("entry-0", {1, 2}, {4, 8});
+  ts2.Add("entry-1", {1}, {3});
+
+  EXPECT_NEAR((4.0 + 9.0) / 2 + 4.0, TimeSeries::ComputeError(ts1, ts2),
+              abs_error<real_t>::value);
+
+  TimeSeries ts3;
+  ts3.Add("entry-0", {1, 3}, {2, 5});
+  ts3.Add("entry-1", {1}, {1});
+  EXPECT_EQ(std::numeric_limits<real_t>::infinity(),
+            TimeSeries::ComputeError(ts1, ts3));
+}
+
 // -----------------------------------------------------------------------------
 TEST(TimeSeries, AssignmentOperator) {
   TimeSeries ts;
@@ -489,5 +596,91 @@ TEST(TimeSeries, MoveAssignmentOperator) {
   EXPECT_TRUE(ts2.Contains("my-entry"));
 }
 
+// -----------------------------------------------------------------------------
+TEST(TimeSeries, WriteAndReadBinary) {
+  TimeSeries ts;
+  ts.Add("entry-1", {1, 2}, {3, 4}, {0.1, 0.2}, {0.3, 0.4});
+  ts.Add("entry-2", {5}, {6});
+  ts.Add("entry-3", {7}, {8});
+
+  std::vector<char> buffer;
+  BinaryWriter writer(&buffer);
+  ts.WriteBinary(&writer, {"entry-1", "entry-3"});
+
+  TimeSeries restored;
+  BinaryReader reader(buffer.data(), buffer.size());
+  restored.ReadBinary(&reader);
+  EXPECT_TRUE(reader.AtEnd());
+
+  EXPECT_EQ(2u, restored.Size());
+  EXPECT_FALSE(restored.Contains("entry-2"));
+  EXPECT_EQ(ts.GetXValues("entry-1"), restored.GetXValues("entry-1"));
+  EXPECT_EQ(ts.GetYValues("entry-1"), restored.GetYValues("entry-1"));
+  EXPECT_EQ(ts.GetYErrorLow("entry-1"), restored.GetYErrorLow("entry-1"));
+  EXPECT_EQ(ts.GetYErrorHigh("entry-1"), restored.GetYErrorHigh("entry-1"));
+  EXPECT_EQ(ts.GetYValues("entry-3"), restored.GetYValues("entry-3"));
+}
+
+// -----------------------------------------------------------------------------
+struct TestSink : public TimeSeriesSink {
+  explicit TestSink(std::vector<TimeSeriesPoint>* points) : points_(points) {}
+  void Write(const std::vector<TimeSeriesPoint>& batch) override {
+    points_->insert(points_->end(), batch.begin(), batch.end());
+  }
+  std::vector<TimeSeriesPoint>* points_;
+};
+
+TEST(TimeSeries, StreamToAndMaxPointsInMemory) {
+  Simulation sim(TEST_NAME);
+  sim.GetResourceManager()->AddAgent(new Cell());
+
+  auto* ts = sim.GetTimeSeries();
+  auto get_num_agents = [](Simulation* sim) {
+    return static_cast<real_t>(sim->GetResourceManager()->GetNumAgents());
+  };
+  ts->AddCollector("num-agents", get_num_agents);
+  ts->Add("experimental-data", {1, 2, 3}, {4, 5, 6});
+
+  std::vector<TimeSeriesPoint> points;
+  ts->StreamTo(new TestSink(&points), 3);
+  ts->SetMaxPointsInMemory(2);
+
+  sim.GetScheduler()->Simulate(5);
+  ts->FlushStream();
+
+  auto* param = sim.GetParam();
+  ASSERT_EQ(5u, points.size());
+  for (uint64_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ("num-agents", points[i].id);
+    EXPECT_NEAR(i * param->simulation_time_step, points[i].x,
+                abs_error<real_t>::value);
+    EXPECT_NEAR(1.0, points[i].y, abs_error<real_t>::value);
+  }
+
+  // only the last two data points are kept in memory
+  const auto& xvals = ts->GetXValues("num-agents");
+  ASSERT_EQ(2u, xvals.size());
+  EXPECT_NEAR(3 * param->simulation_time_step, xvals[0],
+              abs_error<real_t>::value);
+  EXPECT_NEAR(4 * param->simulation_time_step, xvals[1],
+              abs_error<real_t>::value);
+  EXPECT_EQ(2u, ts->GetYValues("num-agents").size());
+  // entries without collector are not affected
+  EXPECT_EQ(3u, ts->GetXValues("experimental-data").size());
+}
+
+// -----------------------------------------------------------------------------
+TEST(TimeSeriesSink, PackUnpack) {
+  std::vector<TimeSeriesPoint> batch = {{"a", 1, 2}, {"entry-b", 3, 4}};
+  auto buffer = TimeSeriesSink::Pack(batch);
+  auto unpacked = TimeSeriesSink::Unpack(buffer.data(), buffer.size());
+  ASSERT_EQ(2u, unpacked.size());
+  for (uint64_t i = 0; i < batch.size(); ++i) {
+    EXPECT_EQ(batch[i].id, unpacked[i].id);
+    EXPECT_EQ(batch[i].x, unpacked[i].x);
+    EXPECT_EQ(batch[i].y, unpacked[i].y);
+  }
+}
+
 }  // namespace experimental
 }  // namespace bdm
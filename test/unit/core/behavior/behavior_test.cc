@@ -14,6 +14,8 @@
 
 #include "core/behavior/behavior.h"
 #include <gtest/gtest.h>
+#include "core/simulation.h"
+#include "unit/test_util/test_util.h"
 
 namespace bdm {
 
@@ -133,6 +135,37 @@ TEST(BehaviorTest, RemoveOnEventList) {
   }
 }
 
+TEST(BehaviorTest, CopyAndMoveDoNotTransferSharedState) {
+  Simulation simulation(TEST_NAME);
+
+  auto* shared = new TestBehavior();
+  shared->AlwaysCopyToNew();
+  shared->Share();
+
+  TestBehavior copy(*shared);
+  EXPECT_FALSE(copy.IsShared());
+  EXPECT_TRUE(copy.WillBeCopied(1));
+
+  TestBehavior moved(std::move(copy));
+  EXPECT_FALSE(moved.IsShared());
+  EXPECT_TRUE(moved.WillBeCopied(1));
+
+  TestBehavior assigned;
+  assigned = *shared;
+  EXPECT_FALSE(assigned.IsShared());
+  EXPECT_TRUE(assigned.WillBeCopied(1));
+
+  TestBehavior move_assigned;
+  move_assigned = std::move(assigned);
+  EXPECT_FALSE(move_assigned.IsShared());
+  EXPECT_TRUE(move_assigned.WillBeCopied(1));
+
+  // the shared instance is still owned by the ResourceManager
+  *shared = TestBehavior();
+  EXPECT_TRUE(shared->IsShared());
+  EXPECT_FALSE(shared->WillBeCopied(1));
+}
+
 TEST(NewAgentEventUidGeneratorTest, All) {
   auto uef = NewAgentEventUidGenerator::GetInstance();
 
@@ -0,0 +1,131 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/behavior/intracellular_network.h"
+#include <cmath>
+#include "core/agent/cell.h"
+#include "core/resource_manager.h"
+#include "core/scheduler.h"
+#include "gtest/gtest.h"
+#include "unit/test_util/io_test.h"
+#include "unit/test_util/test_util.h"
+
+namespace bdm {
+
+TEST(IntracellularNetworkTest, IntegrateAllAgents) {
+  auto set_param = [](auto* param) {
+    param->numerical_ode_solver = Param::NumericalODESolver::kRK4;
+    param->simulation_time_step = 0.1;
+  };
+  Simulation simulation(TEST_NAME, set_param);
+  auto* rm = simulation.GetResourceManager();
+
+  // A -> B with rate constant 1
+  auto model = std::make_shared<OdeModel>(
+      std::vector<std::string>{"A", "B"}, std::vector<real_t>{100, 0},
+      [](real_t, const real_t* x, real_t* dxdt) {
+        dxdt[0] = -x[0];
+        dxdt[1] = x[0];
+      });
+  auto network = IntracellularNetwork::Create(model);
+
+  // more agents than fit into one block
+  constexpr uint64_t kNumAgents = 2500;
+  std::vector<AgentUid> uids;
+  for (uint64_t i = 0; i < kNumAgents; ++i) {
+    auto* cell = new Cell({i * 20.0, 0, 0});
+    cell->SetDiameter(10);
+    cell->AddBehavior(new IntracellularBehavior(network));
+    uids.push_back(cell->GetUid());
+    rm->AddAgent(cell);
+  }
+  EXPECT_EQ(kNumAgents, network->GetNumAgents());
+
+  simulation.GetScheduler()->Simulate(10);
+
+  rm->ForEachAgent([&](Agent* agent) {
+    auto* ib =
+        bdm_static_cast<IntracellularBehavior*>(agent->GetAllBehaviors()[0]);
+    EXPECT_NEAR(100 * std::exp(-1.0), ib->GetAmount("A"), 1e-3);
+    EXPECT_NEAR(100 * (1 - std::exp(-1.0)), ib->GetAmount(1), 1e-3);
+  });
+
+  // copies (e.g. daughter cells) inherit the amounts
+  auto* ib = bdm_static_cast<IntracellularBehavior*>(
+      rm->GetAgent(uids[0])->GetAllBehaviors()[0]);
+  ib->SetAmount(0, 42);
+  {
+    IntracellularBehavior copy(*ib);
+    EXPECT_EQ(kNumAgents + 1, network->GetNumAgents());
+    EXPECT_REAL_EQ(42, copy.GetAmount(0));
+    copy.SetAmount(0, 3);
+    EXPECT_REAL_EQ(42, ib->GetAmount(0));
+  }
+  EXPECT_EQ(kNumAgents, network->GetNumAgents());
+
+  // removed agents release their slot
+  rm->RemoveAgent(uids[1]);
+  EXPECT_EQ(kNumAgents - 1, network->GetNumAgents());
+}
+
+TEST(IntracellularNetworkDeathTest, UnknownOdeSolver) {
+  auto set_param = [](auto* param) {
+    param->numerical_ode_solver = static_cast<Param::NumericalODESolver>(0);
+  };
+  Simulation simulation(TEST_NAME, set_param);
+
+  OdeModel model({"A"}, {1}, [](real_t, const real_t* x, real_t* dxdt) {
+    dxdt[0] = -x[0];
+  });
+  real_t amounts[] = {1};
+  EXPECT_DEATH_IF_SUPPORTED(
+      model.Integrate(simulation.GetParam(), 0, 0.1, amounts),
+      ".*Unknown numerical ODE solver.*");
+}
+
+#ifdef USE_DICT
+
+TEST_F(IOTest, IntracellularBehavior) {
+  Simulation simulation(TEST_NAME);
+  auto model = std::make_shared<OdeModel>(
+      std::vector<std::string>{"A", "B"}, std::vector<real_t>{100, 0},
+      [](real_t, const real_t* x, real_t* dxdt) {});
+  auto other = IntracellularNetwork::Create(model);
+  auto network = IntracellularNetwork::Create(model);
+
+  IntracellularBehavior ib(network);
+  ib.SetAmount(0, 3);
+  ib.SetAmount(1, 4);
+
+  IntracellularBehavior* restored = nullptr;
+  BackupAndRestore(ib, &restored);
+
+  // The restored behavior is connected to the network at the same position.
+  ASSERT_TRUE(restored->IsConnected());
+  EXPECT_EQ(network.get(), restored->GetNetwork());
+  EXPECT_EQ(2u, network->GetNumAgents());
+  EXPECT_EQ(0u, other->GetNumAgents());
+  EXPECT_REAL_EQ(3, restored->GetAmount(0));
+  EXPECT_REAL_EQ(4, restored->GetAmount(1));
+  // The amounts are not shared with the original behavior.
+  restored->SetAmount(0, 5);
+  EXPECT_REAL_EQ(3, ib.GetAmount(0));
+
+  delete restored;
+  EXPECT_EQ(1u, network->GetNumAgents());
+}
+
+#endif  // USE_DICT
+
+}  // namespace bdm
@@ -0,0 +1,69 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "gtest/gtest.h"
+
+#include "core/container/math_array_3xn.h"
+#include "core/util/math.h"
+#include "unit/test_util/test_util.h"
+
+namespace bdm {
+
+TEST(MathArray3xN, SameResultAsMathArray) {
+  Real3 a[kSimdBatchSize];
+  Real3 b[kSimdBatchSize];
+  for (uint64_t i = 0; i < kSimdBatchSize; ++i) {
+    a[i] = {1.0 + i, 2.0 - i, 0.5 * i};
+    b[i] = {-3.0 + i, 0.25 * i, 4.0};
+  }
+  Real3xN ba;
+  Real3xN bb;
+  ba.Load(a, kSimdBatchSize);
+  bb.Load(b, kSimdBatchSize);
+
+  real_t dot[kSimdBatchSize];
+  real_t norm[kSimdBatchSize];
+  ba.Dot(bb, dot);
+  ba.Norm(norm);
+  auto cross = ba.Cross(bb);
+  auto fma = ba;
+  fma.FusedMultiplyAdd(bb, 2);
+  auto normalized = ba;
+  normalized.Normalize();
+
+  for (uint64_t i = 0; i < kSimdBatchSize; ++i) {
+    EXPECT_REAL_EQ(a[i] * b[i], dot[i]);
+    EXPECT_REAL_EQ(a[i].Norm(), norm[i]);
+    EXPECT_ARR_NEAR(Math::CrossProduct(a[i], b[i]), cross.Get(i));
+    EXPECT_ARR_NEAR(a[i] + b[i] * 2, fma.Get(i));
+    EXPECT_ARR_NEAR(a[i].GetNormalizedArray(), normalized.Get(i));
+  }
+}
+
+TEST(MathArray3xN, PartialBatch) {
+  Real3 a[3] = {{1, 0, 0}, {0, 2, 0}, {0, 0, 3}};
+  Real3xN batch;
+  batch.Load(a, 3);
+  // Unused lanes are zero and are not changed by `Normalize`
+  batch.Normalize();
+  EXPECT_ARR_NEAR(Real3({1, 1, 1}), batch.Sum());
+
+  real_t x[3], y[3], z[3];
+  batch.Store(x, y, z, 3);
+  EXPECT_REAL_EQ(1, x[0]);
+  EXPECT_REAL_EQ(1, y[1]);
+  EXPECT_REAL_EQ(1, z[2]);
+}
+
+}  // namespace bdm
@@ -15,6 +15,7 @@
 #include <fstream>
 
 #include "core/agent/cell.h"
+#include "core/behavior/stateless_behavior.h"
 #include "core/diffusion/diffusion_grid.h"
 #include "core/diffusion/euler_grid.h"
 #include "core/diffusion/runge_kutta_grid.h"
@@ -486,6 +487,93 @@ TEST(DiffusionTest, ChangeConcentrationByLogistic) {
   delete dgrid;
 }
 
+TEST(DiffusionTest, AsynchronousStep) {
+  auto set_param = [](auto* param) {
+    param->bound_space = Param::BoundSpaceMode::kClosed;
+    param->min_bound = -100;
+    param->max_bound = 100;
+  };
+  Simulation simulation(TEST_NAME, set_param);
+  simulation.GetEnvironment()->Update();
+  DiffusionGrid* dgrid = new EulerGrid(0, "Kalium", 0.4, 0, 50);
+  dgrid->Initialize();
+  dgrid->SetMaxStaleness(2);
+  EXPECT_TRUE(dgrid->IsAsynchronouslyCoupled());
+
+  Real3 pos({{0, 0, 0}});
+  dgrid->ChangeConcentrationBy(pos, 1.5);
+
+  // changes are buffered until the end of the asynchronous step
+  auto idx = dgrid->GetBoxIndex(pos);
+  dgrid->BeginAsynchronousStep();
+  dgrid->ChangeConcentrationBy(pos, 0.5);
+  EXPECT_REAL_EQ(1.5, dgrid->GetValue(pos));
+  EXPECT_REAL_EQ(1.5, dgrid->GetAllConcentrations()[idx]);
+  dgrid->EndAsynchronousStep();
+  EXPECT_REAL_EQ(2.0, dgrid->GetValue(pos));
+  EXPECT_REAL_EQ(2.0, dgrid->GetAllConcentrations()[idx]);
+
+  // the snapshot is reused for two iterations
+  dgrid->BeginAsynchronousStep();
+  EXPECT_REAL_EQ(1.5, dgrid->GetValue(pos));
+  dgrid->EndAsynchronousStep();
+
+  dgrid->BeginAsynchronousStep();
+  EXPECT_REAL_EQ(2.0, dgrid->GetValue(pos));
+  dgrid->EndAsynchronousStep();
+
+  delete dgrid;
+}
+
+// Concentrations that are read by agents during the asynchronous step
+std::vector<real_t> async_secretion_reads;
+
+// Reads the concentration at the position of the agent and secretes 1.
+void ReadAndSecrete(Agent* agent) {
+  auto* dgrid =
+      Simulation::GetActive()->GetResourceManager()->GetDiffusionGrid(0);
+  async_secretion_reads.push_back(dgrid->GetValue(agent->GetPosition()));
+  dgrid->ChangeConcentrationBy(agent->GetPosition(), 1);
+}
+
+// The ContinuumOp integrates asynchronously coupled grids concurrently with
+// the agent operations. Secretions of an iteration are applied after the
+// integration and are thus integrated one iteration later.
+TEST(DiffusionTest, AsynchronousContinuumOp) {
+  auto set_param = [](auto* param) {
+    param->bound_space = Param::BoundSpaceMode::kClosed;
+    param->min_bound = -100;
+    param->max_bound = 100;
+  };
+  Simulation simulation(TEST_NAME, set_param);
+  auto* rm = simulation.GetResourceManager();
+  ModelInitializer::DefineSubstance(0, "Kalium", 0, 10, 10);
+  rm->GetDiffusionGrid(0)->SetMaxStaleness(1);
+
+  auto* cell = new Cell({0, 0, 0});
+  cell->SetDiameter(10);
+  cell->AddBehavior(new StatelessBehavior(ReadAndSecrete));
+  rm->AddAgent(cell);
+
+  async_secretion_reads.clear();
+  simulation.GetScheduler()->Simulate(3);
+
+  // Step 0 does not integrate (delta_t = 0) and is thus synchronous.
+  // Afterwards, each step decays the concentration of the last step and
+  // adds the secretion of this step afterwards.
+  real_t decay = 1 - 10 * simulation.GetParam()->simulation_time_step;
+  real_t c1 = 1;
+  real_t c2 = c1 * decay + 1;
+  real_t c3 = c2 * decay + 1;
+  ASSERT_EQ(3u, async_secretion_reads.size());
+  EXPECT_REAL_EQ(0, async_secretion_reads[0]);
+  // Agents read the snapshot from the beginning of the step.
+  EXPECT_REAL_EQ(c1, async_secretion_reads[1]);
+  EXPECT_REAL_EQ(c2, async_secretion_reads[2]);
+
+  EXPECT_REAL_EQ(c3, rm->GetDiffusionGrid(0)->GetValue({0, 0, 0}));
+}
+
 #ifdef USE_DICT
 
 // Test if all the data members of the diffusion grid are correctly serialized
@@ -0,0 +1,156 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/environment/linear_octree_environment.h"
+#include "core/agent/cell.h"
+#include "unit/core/count_neighbor_functor.h"
+#include "unit/test_util/test_util.h"
+
+#include "gtest/gtest.h"
+
+namespace bdm {
+namespace linear_octree_environment_test_internal {
+
+void CellFactory(ResourceManager* rm, size_t cells_per_dim) {
+  const real_t space = 20;
+  rm->Reserve(cells_per_dim * cells_per_dim * cells_per_dim);
+  for (size_t i = 0; i < cells_per_dim; i++) {
+    for (size_t j = 0; j < cells_per_dim; j++) {
+      for (size_t k = 0; k < cells_per_dim; k++) {
+        Cell* cell = new Cell({k * space, j * space, i * space});
+        cell->SetDiameter(30);
+        rm->AddAgent(cell);
+      }
+    }
+  }
+}
+
+struct FillNeighborList : public Functor<void, Agent*, real_t> {
+  std::unordered_map<AgentUid, std::vector<AgentUid>>* neighbors_;
+  AgentUid uid_;
+  FillNeighborList(
+      std::unordered_map<AgentUid, std::vector<AgentUid>>* neighbors,
+      AgentUid uid)
+      : neighbors_(neighbors), uid_(uid) {}
+
+  void operator()(Agent* neighbor, real_t squared_distance) override {
+    auto nuid = neighbor->GetUid();
+    if (uid_ != nuid) {
+      (*neighbors_)[uid_].push_back(nuid);
+    }
+  }
+};
+
+TEST(LinearOctreeTest, Setup) {
+  auto set_param = [](auto* param) { param->environment = "linear_octree"; };
+  Simulation simulation(TEST_NAME, set_param);
+  auto* rm = simulation.GetResourceManager();
+  auto* grid = dynamic_cast<LinearOctreeEnvironment*>(simulation.GetEnvironment());
+
+  EXPECT_NE(nullptr, grid);
+
+  CellFactory(rm, 4);
+
+  grid->Update();
+
+  std::unordered_map<AgentUid, std::vector<AgentUid>> neighbors;
+  neighbors.reserve(rm->GetNumAgents());
+
+  // Lambda that fills a vector of neighbors for each cell (excluding itself)
+  real_t search_radius_squared = 1201;
+  rm->ForEachAgent([&](Agent* so) {
+    auto uid = so->GetUid();
+    FillNeighborList fill_neighbor_list(&neighbors, uid);
+    grid->ForEachNeighbor(fill_neighbor_list, *so, search_radius_squared);
+  });
+
+  std::vector<AgentUid> expected_0 = {AgentUid(1),  AgentUid(4),  AgentUid(5),
+                                      AgentUid(16), AgentUid(17), AgentUid(20),
+                                      AgentUid(21)};
+  std::vector<AgentUid> expected_4 = {AgentUid(0),  AgentUid(1),  AgentUid(5),
+                                      AgentUid(8),  AgentUid(9),  AgentUid(16),
+                                      AgentUid(17), AgentUid(20), AgentUid(21),
+                                      AgentUid(24), AgentUid(25)};
+  std::vector<AgentUid> expected_42 = {
+      AgentUid(21), AgentUid(22), AgentUid(23), AgentUid(25), AgentUid(26),
+      AgentUid(27), AgentUid(29), AgentUid(30), AgentUid(31), AgentUid(37),
+      AgentUid(38), AgentUid(39), AgentUid(41), AgentUid(43), AgentUid(45),
+      AgentUid(46), AgentUid(47), AgentUid(53), AgentUid(54), AgentUid(55),
+      AgentUid(57), AgentUid(58), AgentUid(59), AgentUid(61), AgentUid(62),
+      AgentUid(63)};
+  std::vector<AgentUid> expected_63 = {AgentUid(42), AgentUid(43), AgentUid(46),
+                                       AgentUid(47), AgentUid(58), AgentUid(59),
+                                       AgentUid(62)};
+
+  std::sort(neighbors[AgentUid(0)].begin(), neighbors[AgentUid(0)].end());
+  std::sort(neighbors[AgentUid(4)].begin(), neighbors[AgentUid(4)].end());
+  std::sort(neighbors[AgentUid(42)].begin(), neighbors[AgentUid(42)].end());
+  std::sort(neighbors[AgentUid(63)].begin(), neighbors[AgentUid(63)].end());
+
+  EXPECT_EQ(expected_0, neighbors[AgentUid(0)]);
+  EXPECT_EQ(expected_4, neighbors[AgentUid(4)]);
+  EXPECT_EQ(expected_42, neighbors[AgentUid(42)]);
+  EXPECT_EQ(expected_63, neighbors[AgentUid(63)]);
+}
+
+// Tests if ForEachNeighbor of the respective environment finds the correct
+// number of neighbors. The same test is implemented for the other
+// environments.
+TEST(LinearOctreeTest, FindAllNeighbors) {
+  auto set_param = [](auto* param) {
+    param->environment = "linear_octree";
+    param->unschedule_default_operations = {"load balancing",
+                                            "mechanical forces"};
+  };
+  Simulation simulation(TEST_NAME, set_param);
+
+  // Please consult the definition of the fuction for more information.
+  TestNeighborSearch(simulation);
+}
+
+TEST(LinearOctreeTest, Nodes) {
+  auto set_param = [](auto* param) {
+    param->environment = "linear_octree";
+    param->linear_octree_leaf_size = 4;
+  };
+  Simulation simulation(TEST_NAME, set_param);
+  auto* rm = simulation.GetResourceManager();
+  auto* env =
+      dynamic_cast<LinearOctreeEnvironment*>(simulation.GetEnvironment());
+
+  CellFactory(rm, 5);
+  env->Update();
+
+  const auto& nodes = env->GetNodes();
+  ASSERT_LT(1u, nodes.size());
+  EXPECT_EQ(0u, nodes[0].begin);
+  EXPECT_EQ(125u, nodes[0].end);
+  EXPECT_REAL_EQ(0, nodes[0].min[0]);
+  EXPECT_REAL_EQ(80, nodes[0].max[2]);
+  uint64_t agents_in_leaves = 0;
+  for (const auto& node : nodes) {
+    if (node.num_children == 0) {
+      EXPECT_GE(4u, node.end - node.begin);
+      agents_in_leaves += node.end - node.begin;
+      continue;
+    }
+    // children partition the range of their parent
+    EXPECT_EQ(node.begin, nodes[node.first_child].begin);
+    EXPECT_EQ(node.end, nodes[node.first_child + node.num_children - 1].end);
+  }
+  EXPECT_EQ(125u, agents_in_leaves);
+}
+
+}  // namespace linear_octree_environment_test_internal
+}  // namespace bdm
@@ -13,6 +13,7 @@
 // -----------------------------------------------------------------------------
 
 #include "core/environment/uniform_grid_environment.h"
+#include <algorithm>
 #include <sstream>
 #include <string>
 #include "core/agent/cell.h"
@@ -221,6 +222,174 @@ TEST(UniformGridEnvironmentTest, UpdateGrid) {
   RunUpdateGridTest(&simulation);
 }
 
+TEST(UniformGridEnvironmentTest, StaticBoxes) {
+  auto set_param = [](Param* param) {
+    param->detect_static_agents = true;
+    param->detect_static_boxes = true;
+  };
+  Simulation simulation(TEST_NAME, set_param);
+  auto* rm = simulation.GetResourceManager();
+  auto* grid =
+      static_cast<UniformGridEnvironment*>(simulation.GetEnvironment());
+
+  // 3x3x3 cells which are too far apart to be in adjacent boxes
+  const real_t space = 100;
+  for (size_t i = 0; i < 3; i++) {
+    for (size_t j = 0; j < 3; j++) {
+      for (size_t k = 0; k < 3; k++) {
+        Cell* cell = new Cell({k * space, j * space, i * space});
+        cell->SetDiameter(10);
+        rm->AddAgent(cell);
+      }
+    }
+  }
+
+  // All boxes are woken up after the first update
+  grid->IterationUpdate();
+  rm->ForEachAgent([&](Agent* agent) {
+    EXPECT_FALSE(grid->IsBoxStatic(agent->GetBoxIdx()));
+    EXPECT_FALSE(agent->GetStaticnessNextTimestep());
+  });
+
+  // emulate the beginning of the next iteration and move the center cell
+  rm->ForEachAgent(
+      [](Agent* agent) { agent->SetStaticnessNextTimestep(true); });
+  auto* center = rm->GetAgent(AgentUid(13));
+  center->SetPosition(center->GetPosition() + Real3{0.1, 0, 0});
+  grid->IterationUpdate();
+
+  rm->ForEachAgent([&](Agent* agent) {
+    bool moved = agent->GetUid() == AgentUid(13);
+    EXPECT_EQ(!moved, grid->IsBoxStatic(agent->GetBoxIdx()));
+    EXPECT_EQ(!moved, agent->GetStaticnessNextTimestep());
+  });
+
+  // next iteration: a cell that does not determine the grid dimensions is
+  // removed. Its box is empty afterwards and has no non-empty neighbor boxes.
+  rm->ForEachAgent(
+      [](Agent* agent) { agent->SetStaticnessNextTimestep(true); });
+  rm->RemoveAgent(AgentUid(14));
+  grid->IterationUpdate();
+
+  rm->ForEachAgent([&](Agent* agent) {
+    EXPECT_TRUE(grid->IsBoxStatic(agent->GetBoxIdx()));
+    EXPECT_TRUE(agent->GetStaticnessNextTimestep());
+  });
+}
+
+// Additional updates in the same iteration must not put the boxes of agents
+// to sleep that changed before the update at the end of the iteration.
+TEST(UniformGridEnvironmentTest, StaticBoxesMultipleUpdates) {
+  auto set_param = [](Param* param) {
+    param->detect_static_agents = true;
+    param->detect_static_boxes = true;
+  };
+  Simulation simulation(TEST_NAME, set_param);
+  auto* rm = simulation.GetResourceManager();
+  auto* grid =
+      static_cast<UniformGridEnvironment*>(simulation.GetEnvironment());
+
+  const real_t space = 100;
+  for (size_t i = 0; i < 3; i++) {
+    Cell* cell = new Cell({i * space, 0, 0});
+    cell->SetDiameter(10);
+    rm->AddAgent(cell);
+  }
+  grid->IterationUpdate();
+  rm->ForEachAgent(
+      [](Agent* agent) { agent->SetStaticnessNextTimestep(true); });
+  grid->IterationUpdate();
+
+  // move the center cell in this iteration
+  rm->ForEachAgent(
+      [](Agent* agent) { agent->SetStaticnessNextTimestep(true); });
+  auto* center = rm->GetAgent(AgentUid(1));
+  center->SetPosition(center->GetPosition() + Real3{0.1, 0, 0});
+  grid->IterationUpdate();
+  EXPECT_FALSE(grid->IsBoxStatic(center->GetBoxIdx()));
+
+  // two more updates before the agent operations of the next iteration
+  grid->ForcedUpdate();
+  grid->ForcedUpdate();
+  rm->ForEachAgent([&](Agent* agent) {
+    bool moved = agent->GetUid() == AgentUid(1);
+    EXPECT_EQ(!moved, grid->IsBoxStatic(agent->GetBoxIdx()));
+    EXPECT_EQ(!moved, agent->GetStaticnessNextTimestep());
+  });
+
+  // nothing changed in the next iteration
+  rm->ForEachAgent(
+      [](Agent* agent) { agent->SetStaticnessNextTimestep(true); });
+  grid->IterationUpdate();
+  grid->ForcedUpdate();
+  rm->ForEachAgent([&](Agent* agent) {
+    EXPECT_TRUE(grid->IsBoxStatic(agent->GetBoxIdx()));
+  });
+}
+
+TEST(UniformGridEnvironmentTest, CostSplitPoint) {
+  auto set_param = [](Param* param) { param->weighted_load_balancing = true; };
+  Simulation simulation(TEST_NAME, set_param);
+  auto* rm = simulation.GetResourceManager();
+  auto* grid =
+      static_cast<UniformGridEnvironment*>(simulation.GetEnvironment());
+
+  // dense cluster of 4x4x4 cells and a sparse lattice of 3x3x3 cells
+  for (size_t i = 0; i < 4; i++) {
+    for (size_t j = 0; j < 4; j++) {
+      for (size_t k = 0; k < 4; k++) {
+        Cell* cell = new Cell({k * 3.0, j * 3.0, i * 3.0});
+        cell->SetDiameter(10);
+        rm->AddAgent(cell);
+      }
+    }
+  }
+  for (size_t i = 0; i < 3; i++) {
+    for (size_t j = 0; j < 3; j++) {
+      for (size_t k = 0; k < 3; k++) {
+        Cell* cell = new Cell({60 + k * 40.0, 60 + j * 40.0, 60 + i * 40.0});
+        cell->SetDiameter(10);
+        rm->AddAgent(cell);
+      }
+    }
+  }
+  grid->ForcedUpdate();
+  auto* lbi = grid->GetLoadBalanceInfo();
+  uint64_t num_agents = rm->GetNumAgents();
+
+  // estimated cost of each agent in the order of the load balancing
+  std::vector<uint64_t> costs;
+  auto collect = L2F([&](Iterator<AgentHandle>* it) {
+    while (it->HasNext()) {
+      auto* agent = rm->GetAgent(it->Next());
+      uint64_t neighbors = 0;
+      auto count = L2F([&](Agent*) { neighbors++; });
+      grid->ForEachNeighbor(count, *agent, nullptr);
+      // neighbor candidates including the agent itself plus one
+      costs.push_back(neighbors + 2);
+    }
+  });
+  lbi->CallHandleIteratorConsumer(0, num_agents, collect);
+  ASSERT_EQ(num_agents, costs.size());
+  uint64_t total = 0;
+  uint64_t max_cost = 0;
+  for (auto cost : costs) {
+    total += cost;
+    max_cost = std::max(max_cost, cost);
+  }
+
+  EXPECT_EQ(0u, lbi->GetCostSplitPoint(0, num_agents));
+  EXPECT_EQ(num_agents, lbi->GetCostSplitPoint(1, num_agents));
+  for (real_t fraction : {0.25, 0.5, 0.75}) {
+    auto split = lbi->GetCostSplitPoint(fraction, num_agents);
+    uint64_t cost_before = 0;
+    for (uint64_t i = 0; i < split; i++) {
+      cost_before += costs[i];
+    }
+    EXPECT_NEAR(fraction * total, cost_before, max_cost);
+  }
+}
+
 TEST(UniformGridEnvironmentTest, NoRaceConditionDuringUpdate) {
   Simulation simulation(TEST_NAME);
   auto* rm = simulation.GetResourceManager();
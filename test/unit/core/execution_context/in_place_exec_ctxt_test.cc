@@ -19,7 +19,6 @@
 #include "core/execution_context/in_place_exec_ctxt.h"
 #include "core/model_initializer.h"
 #include "core/operation/operation_registry.h"
-#include "core/randomized_rm.h"  // for bdm::Ubrng
 #include "unit/test_util/test_agent.h"
 #include "unit/test_util/test_util.h"
 
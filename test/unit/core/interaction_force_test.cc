@@ -408,4 +408,38 @@ TEST(InteractionForce, SphereLongCylinderHorizontalpD) {
   EXPECT_ARR_NEAR4({0, -0.5, 0, 0}, result2);
 }
 
+/// Tests that the batched calculation returns the same forces as
+/// `Calculate` for overlapping, non-overlapping, and cylindrical neighbors.
+TEST(InteractionForce, CalculateBatch) {
+  neuroscience::InitModule();
+  Simulation simulation(TEST_NAME);
+
+  Cell cell({1.1, 1.0, 0.9});
+  cell.SetDiameter(8);
+  std::vector<Cell> cells;
+  for (int i = 0; i < 11; ++i) {
+    cells.emplace_back(Real3({1.5 * i, 0.5 * i, -0.2 * i}));
+    cells.back().SetDiameter(4 + i % 3);
+  }
+  NeuriteElement cylinder;
+  cylinder.SetMassLocation({2, 2, 2});
+  cylinder.SetSpringAxis({0, 0, 3});
+  cylinder.SetActualLength(3);
+  cylinder.SetDiameter(1);
+
+  std::vector<Agent*> neighbors;
+  for (auto& c : cells) {
+    neighbors.push_back(&c);
+  }
+  neighbors.insert(neighbors.begin() + 5, &cylinder);
+
+  InteractionForce force;
+  std::vector<Real4> results(neighbors.size());
+  force.CalculateBatch(&cell, neighbors.data(), neighbors.size(),
+                       results.data());
+  for (uint64_t i = 0; i < neighbors.size(); ++i) {
+    EXPECT_ARR_NEAR4(force.Calculate(&cell, neighbors[i]), results[i]);
+  }
+}
+
 }  // namespace bdm
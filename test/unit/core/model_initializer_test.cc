@@ -13,6 +13,7 @@
 // -----------------------------------------------------------------------------
 
 #include "core/model_initializer.h"
+#include <fstream>
 #include "core/agent/cell.h"
 #include "core/behavior/behavior.h"
 #include "core/resource_manager.h"
@@ -102,6 +103,27 @@ TEST(ModelInitializerTest, CreateAgents) {
   Verify(&simulation, 3u, {{1, 2, 3}, {101, 202, 303}, {-12, -32, 4}});
 }
 
+TEST(ModelInitializerTest, CreateAgentsFromCsv) {
+  Simulation simulation(TEST_NAME);
+
+  std::string file = Concat(TEST_NAME, ".csv");
+  {
+    std::ofstream ofs(file);
+    ofs << "x,y,z,diameter\n1,2,3,10\n101,202,303,20\n-12,-32,4,30\n";
+  }
+  ParallelCSVReader reader(file);
+  ModelInitializer::CreateAgentsFromCsv(
+      reader, {"x", "y", "z", "diameter"},
+      [](const std::vector<real_t>& values) {
+        Cell* cell = new Cell({values[0], values[1], values[2]});
+        cell->SetDiameter(values[3]);
+        return cell;
+      });
+  remove(file.c_str());
+
+  Verify(&simulation, 3u, {{1, 2, 3}, {101, 202, 303}, {-12, -32, 4}});
+}
+
 TEST(ModelInitializerTest, CreateAgentsRandom) {
   Simulation simulation(TEST_NAME);
   auto* rm = simulation.GetResourceManager();
@@ -0,0 +1,86 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/multi_simulation/campaign_checkpoint.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include "unit/test_util/test_util.h"
+
+namespace bdm {
+namespace experimental {
+
+static const char* kDefaultParams = "{\"a\":0}";
+
+// -----------------------------------------------------------------------------
+TEST(CampaignCheckpointTest, Restart) {
+  std::string file = Concat(TEST_NAME, ".bin");
+  std::remove(file.c_str());
+
+  {
+    CampaignCheckpoint checkpoint(file, kDefaultParams);
+    std::vector<char> result;
+    EXPECT_FALSE(checkpoint.Lookup("{\"a\":1}", &result));
+    checkpoint.Append("{\"a\":1}", {1, 2});
+    checkpoint.Append("{\"a\":1}", {3});
+    checkpoint.Append("{\"a\":2}", {4});
+    EXPECT_EQ(3u, checkpoint.Size());
+    // Results of this run are not returned again
+    EXPECT_FALSE(checkpoint.Lookup("{\"a\":1}", &result));
+  }
+
+  // Simulate a manager that died while it was writing a record
+  {
+    std::ofstream ofs(file, std::ios::binary | std::ios::app);
+    ofs.write("\x10\x00", 2);
+  }
+
+  CampaignCheckpoint restarted(file, kDefaultParams);
+  EXPECT_EQ(3u, restarted.Size());
+  std::vector<char> result;
+  EXPECT_TRUE(restarted.Lookup("{\"a\":1}", &result));
+  EXPECT_EQ((std::vector<char>{1, 2}), result);
+  EXPECT_TRUE(restarted.Lookup("{\"a\":1}", &result));
+  EXPECT_EQ((std::vector<char>{3}), result);
+  EXPECT_FALSE(restarted.Lookup("{\"a\":1}", &result));
+  EXPECT_TRUE(restarted.Lookup("{\"a\":2}", &result));
+  EXPECT_EQ((std::vector<char>{4}), result);
+  EXPECT_FALSE(restarted.Lookup("{\"a\":3}", &result));
+
+  // New records are appended after the last complete one
+  restarted.Append("{\"a\":3}", {5});
+  CampaignCheckpoint restarted2(file, kDefaultParams);
+  EXPECT_EQ(4u, restarted2.Size());
+  EXPECT_TRUE(restarted2.Lookup("{\"a\":3}", &result));
+  EXPECT_EQ((std::vector<char>{5}), result);
+
+  std::remove(file.c_str());
+}
+
+// -----------------------------------------------------------------------------
+TEST(CampaignCheckpointDeathTest, DifferentDefaultParams) {
+  std::string file = Concat(TEST_NAME, ".bin");
+  std::remove(file.c_str());
+  {
+    CampaignCheckpoint checkpoint(file, kDefaultParams);
+    checkpoint.Append("{\"a\":1}", {1});
+  }
+  ASSERT_DEATH(
+      { CampaignCheckpoint checkpoint(file, "{\"a\":2}"); },
+      ".*has been written by a campaign with different default parameters.*");
+  std::remove(file.c_str());
+}
+
+}  // namespace experimental
+}  // namespace bdm
@@ -100,6 +100,9 @@ void RunTest(OpComputeTarget mode) {
       case kCuda:
         param->compute_target = "cuda";
         break;
+      case kCpuSimd:
+        param->compute_target = "cpu_simd";
+        break;
       default:
         return;
     }
@@ -177,6 +180,8 @@ void RunTest(OpComputeTarget mode) {
   EXPECT_NEAR(1.1, cell1->GetMass(), kEps);
 }
 
+TEST(MechanicalForcesOpGpuTest, ComputeSoaCpuSimd) { RunTest(kCpuSimd); }
+
 #ifdef USE_CUDA
 TEST(MechanicalForcesOpGpuTest, ComputeSoaCuda) { RunTest(kCuda); }
 #endif
@@ -194,6 +199,9 @@ void RunTest2(OpComputeTarget mode) {
       case kCuda:
         param->compute_target = "cuda";
         break;
+      case kCpuSimd:
+        param->compute_target = "cpu_simd";
+        break;
       default:
         return;
     }
@@ -276,6 +284,8 @@ void RunTest2(OpComputeTarget mode) {
   // clang-format on
 }
 
+TEST(MechanicalForcesOpGpuTest, ComputeSoaNewCpuSimd) { RunTest2(kCpuSimd); }
+
 #ifdef USE_CUDA
 TEST(MechanicalForcesOpGpuTest, ComputeSoaNewCuda) { RunTest2(kCuda); }
 #endif
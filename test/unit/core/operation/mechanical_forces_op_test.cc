@@ -21,10 +21,65 @@ namespace mechanical_forces_op_test_internal {
 TEST(DisplacementOpTest, ComputeUniformGrid) { RunTest("uniform_grid"); }
 TEST(DisplacementOpTest, ComputeKDTree) { RunTest("kd_tree"); }
 TEST(DisplacementOpTest, ComputeOctree) { RunTest("octree"); }
+TEST(DisplacementOpTest, ComputeLinearOctree) { RunTest("linear_octree"); }
 
 TEST(DisplacementOpTest, ComputeNewUniformGrid) { RunTest2("uniform_grid"); }
 TEST(DisplacementOpTest, ComputeNewKDTree) { RunTest2("kd_tree"); }
 TEST(DisplacementOpTest, ComputeNewOctree) { RunTest2("octree"); }
+TEST(DisplacementOpTest, ComputeNewLinearOctree) {
+  RunTest2("linear_octree");
+}
+
+TEST(DisplacementOpTest, SubCycling) {
+  // The displacement of the compressed cell is limited without substeps.
+  EXPECT_NEAR(0.1, RunSubCycleTest(1), abs_error<real_t>::value);
+  // Each substep is limited, but the forces are recalculated after each one.
+  auto distance = RunSubCycleTest(8);
+  EXPECT_GT(distance, 0.1 + abs_error<real_t>::value);
+  EXPECT_LE(distance, 8 * 0.1 + abs_error<real_t>::value);
+}
+
+TEST(DisplacementOpTest, SkipStaticBoxes) {
+  auto set_param = [](Param* param) {
+    param->detect_static_agents = true;
+    param->detect_static_boxes = true;
+  };
+  Simulation simulation(TEST_NAME, set_param);
+  auto* rm = simulation.GetResourceManager();
+  auto* grid =
+      static_cast<UniformGridEnvironment*>(simulation.GetEnvironment());
+
+  Cell* cell = new Cell({0, 0, 0});
+  cell->SetDiameter(10);
+  rm->AddAgent(cell);
+  Cell* anchor = new Cell({100, 100, 100});
+  anchor->SetDiameter(10);
+  rm->AddAgent(anchor);
+
+  // The first update wakes up all boxes. Nothing changes until the second
+  // update.
+  grid->IterationUpdate();
+  rm->ForEachAgent(
+      [](Agent* agent) { agent->SetStaticnessNextTimestep(true); });
+  grid->IterationUpdate();
+  ASSERT_TRUE(grid->IsBoxStatic(cell->GetBoxIdx()));
+
+  // The tractor force would move the cell if it was processed.
+  cell->SetTractorForce({1, 0, 0});
+  cell->SetPropagateStaticness(false);
+
+  auto uid = cell->GetUid();
+  auto* ctxt = simulation.GetExecutionContext();
+  auto* op = NewOperation("mechanical forces");
+  ctxt->Execute(cell, rm->GetAgentHandle(uid), {op});
+  EXPECT_ARR_NEAR(cell->GetPosition(), {0, 0, 0});
+
+  // Agents that changed in the current iteration are processed.
+  cell->SetPropagateStaticness();
+  ctxt->Execute(cell, rm->GetAgentHandle(uid), {op});
+  EXPECT_GT(cell->GetPosition()[0], 0);
+  delete op;
+}
 
 }  // namespace mechanical_forces_op_test_internal
 }  // namespace bdm
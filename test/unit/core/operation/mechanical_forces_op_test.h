@@ -161,6 +161,36 @@ inline void RunTest2(const std::string& environment) {
   delete mechanical_forces_op;
 }
 
+// Moves a highly compressed cell with `Param::mechanics_max_substeps`
+// and returns the distance it moved.
+inline real_t RunSubCycleTest(uint64_t max_substeps) {
+  auto set_param = [&](auto* param) {
+    param->simulation_max_displacement = 0.1;
+    param->mechanics_max_substeps = max_substeps;
+  };
+  Simulation simulation("mechanical_forces_op_test_RunSubCycleTest",
+                        set_param);
+  auto* rm = simulation.GetResourceManager();
+
+  Cell* cell0 = new Cell({0, 0, 0});
+  cell0->SetDiameter(10);
+  cell0->SetAdherence(0);
+  cell0->SetMass(1);
+  rm->AddAgent(cell0);
+  Cell* cell1 = new Cell({0, 1, 0});
+  cell1->SetDiameter(10);
+  rm->AddAgent(cell1);
+  simulation.GetEnvironment()->Update();
+
+  auto uid = cell0->GetUid();
+  auto* ctxt = simulation.GetExecutionContext();
+  auto* op = NewOperation("mechanical forces");
+  ctxt->Execute(rm->GetAgent(uid), rm->GetAgentHandle(uid), {op});
+  delete op;
+
+  return rm->GetAgent(uid)->GetPosition().Norm();
+}
+
 }  // namespace mechanical_forces_op_test_internal
 }  // namespace bdm
 
@@ -0,0 +1,69 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/operation/neighbor_density_op.h"
+#include <gtest/gtest.h>
+#include "core/agent/cell.h"
+#include "unit/test_util/test_util.h"
+
+namespace bdm {
+
+// -----------------------------------------------------------------------------
+TEST(NeighborDensityOp, NotScheduledByDefault) {
+  Simulation sim(TEST_NAME);
+  EXPECT_EQ(nullptr, NeighborDensityOp::GetScheduled());
+}
+
+// -----------------------------------------------------------------------------
+TEST(NeighborDensityOp, NeighborCount) {
+  // The search radius is larger than the agents, and thus larger than the
+  // boxes of the uniform grid that are determined from the agent size.
+  // Hence, the neighbors are searched in a temporary grid.
+  auto set_param = [](Param* param) {
+    param->compute_neighbor_density = true;
+    param->neighbor_density_radius = 25;
+    param->unschedule_default_operations = {"mechanical forces"};
+  };
+  Simulation sim(TEST_NAME, set_param);
+  auto* rm = sim.GetResourceManager();
+
+  std::vector<Cell*> cells;
+  for (auto& pos : std::vector<Real3>{
+           {0, 0, 0}, {10, 0, 0}, {20, 0, 0}, {44, 0, 0}, {100, 0, 0}}) {
+    cells.push_back(new Cell(pos));
+    cells.back()->SetDiameter(10);
+    rm->AddAgent(cells.back());
+  }
+
+  sim.GetScheduler()->Simulate(1);
+
+  auto* op = NeighborDensityOp::GetScheduled();
+  ASSERT_NE(nullptr, op);
+  EXPECT_REAL_EQ(25, op->GetRadius());
+  auto* grid = dynamic_cast<UniformGridEnvironment*>(sim.GetEnvironment());
+  ASSERT_NE(nullptr, grid);
+  // The box length of the environment is not changed by the operation.
+  EXPECT_GT(25, grid->GetBoxLength());
+  EXPECT_EQ(2u, op->GetNeighborCount(cells[0]));
+  EXPECT_EQ(2u, op->GetNeighborCount(cells[1]));
+  EXPECT_EQ(3u, op->GetNeighborCount(cells[2]));
+  EXPECT_EQ(1u, op->GetNeighborCount(cells[3]));
+  EXPECT_EQ(0u, op->GetNeighborCount(cells[4]));
+
+  real_t volume = 4.0 / 3.0 * Math::kPi * 25 * 25 * 25;
+  EXPECT_NEAR(3 / volume, op->GetLocalDensity(cells[2]),
+              abs_error<real_t>::value);
+}
+
+}  // namespace bdm
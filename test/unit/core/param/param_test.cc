@@ -99,6 +99,32 @@ TEST(ParamTest, RestoreFromJson) {
   EXPECT_EQ(-10, test_param->test_param3);
 }
 
+// -----------------------------------------------------------------------------
+TEST(ParamTest, GetJsonMergePatch) {
+  Param::RegisterParamGroup(new TestParamGroup());
+  Param base;
+  auto base_json = base.ToJsonString();
+
+  Param param = base;
+  EXPECT_EQ("{}", param.GetJsonMergePatch(base_json));
+
+  param.simulation_time_step = 1.0;
+  param.visualize_agents["Cell"] = {"type"};
+  param.Get<TestParamGroup>()->test_param3 = -10;
+  auto patch = json::parse(param.GetJsonMergePatch(base_json));
+  EXPECT_EQ(2u, patch.size());
+  EXPECT_EQ(1u, patch["bdm::TestParamGroup"].size());
+  EXPECT_EQ(-10, patch["bdm::TestParamGroup"]["test_param3"].get<int>());
+
+  Param restored = base;
+  restored.MergeJsonPatch(patch.dump());
+  EXPECT_REAL_EQ(real_t(1.0), restored.simulation_time_step);
+  EXPECT_EQ(1u, restored.visualize_agents.size());
+  EXPECT_EQ(1u, restored.visualize_agents["Cell"].size());
+  EXPECT_EQ(-10, restored.Get<TestParamGroup>()->test_param3);
+  EXPECT_EQ(42u, restored.Get<TestParamGroup>()->test_param2);
+}
+
 TEST(ParamTest, OptimizationParam) {
   Param param;
   auto* opt_param = param.Get<OptimizationParam>();
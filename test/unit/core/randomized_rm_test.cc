@@ -69,4 +69,59 @@ TEST(RandomizedRm, Basics) {
   EXPECT_EQ(called_copy1, called);
 }
 
+TEST(RandomizedRm, StorageOrderIsPreserved) {
+  Simulation simulation(TEST_NAME);
+  int n = 1000;
+  auto* rm = new RandomizedRm<ResourceManager>();
+  simulation.SetResourceManager(rm);
+
+  for (int i = 0; i < n; i++) {
+    rm->AddAgent(new TestAgent(i));
+  }
+  std::vector<Agent*> storage;
+  rm->ResourceManager::ForEachAgent(
+      [&](Agent* a, AgentHandle) { storage.push_back(a); });
+
+  rm->EndOfIteration();
+
+  // every agent is visited exactly once with its correct handle
+  std::vector<int> visits(n);
+  auto functor = L2F([&](Agent* a, AgentHandle ah) {
+#pragma omp atomic
+    visits[bdm_static_cast<TestAgent*>(a)->GetData()]++;
+    EXPECT_EQ(a, rm->GetAgent(ah));
+  });
+  rm->ForEachAgentParallel(functor);
+  rm->ForEachAgentParallel(10, functor);
+  for (int i = 0; i < n; ++i) {
+    EXPECT_EQ(2, visits[i]);
+  }
+
+  // the visit order differs from the storage order, but agents have not
+  // been moved
+  std::vector<Agent*> visited;
+  rm->ForEachAgent([&](Agent* a) { visited.push_back(a); });
+  EXPECT_NE(storage, visited);
+  std::vector<Agent*> storage_after;
+  rm->ResourceManager::ForEachAgent(
+      [&](Agent* a, AgentHandle) { storage_after.push_back(a); });
+  EXPECT_EQ(storage, storage_after);
+  for (int i = 0; i < n; ++i) {
+    EXPECT_EQ(i, bdm_static_cast<TestAgent*>(storage[i])->GetData());
+  }
+}
+
+TEST(RandomizedRm, BlockPermutationIsBijective) {
+  for (uint64_t size : {0, 1, 2, 255, 256, 257, 1000, 4096}) {
+    detail::BlockPermutation permutation(size, {{7, 3, 100, 42, 5, 11}});
+    std::vector<bool> hit(size, false);
+    for (uint64_t i = 0; i < size; ++i) {
+      auto idx = permutation(i);
+      ASSERT_LT(idx, size);
+      EXPECT_FALSE(hit[idx]);
+      hit[idx] = true;
+    }
+  }
+}
+
 }  // namespace bdm
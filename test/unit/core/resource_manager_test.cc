@@ -146,6 +146,8 @@ TEST(ResourceManagerTest, ForEachAgentParallel) {
 
 #ifdef USE_DICT
 TEST(ResourceManagerTest, IO) { RunIOTest(); }
+
+TEST(ResourceManagerTest, IOExternalObjects) { RunIOExternalObjectsTest(); }
 #endif  // USE_DICT
 
 TEST(ResourceManagerTest, PushBackAndGetAgentTest) {
@@ -293,4 +295,76 @@ TEST(ResourceManagerTest, ParallelAgentRemoval_LargeScale75) {
   });
 }
 
+// -----------------------------------------------------------------------------
+TEST(ResourceManagerTest, DeferredAgentDeletion) {
+  auto set_param = [](Param* param) { param->defer_agent_deletion = true; };
+  Simulation simulation(TEST_NAME, set_param);
+
+  auto construct = [](const Real3& pos) {
+    auto* agent = new TestAgent(pos);
+    agent->SetDiameter(10);
+    return agent;
+  };
+  ModelInitializer::Grid3D(4, 20, construct);
+
+  auto* rm = simulation.GetResourceManager();
+  simulation.GetScheduler()->Simulate(1);
+
+  std::vector<bool> remove(rm->GetNumAgents());
+  for (uint64_t i = 0; i < remove.size(); ++i) {
+    remove[i] = i % 2 == 0;
+  }
+  DeleteFunctor f(remove);
+  rm->ForEachAgentParallel(f);
+  simulation.GetScheduler()->Simulate(1);
+
+  // removed agents are not deleted before the next iteration
+  EXPECT_EQ(32u, rm->GetNumAgents());
+  EXPECT_EQ(32u, rm->GetNumAgentsInGraveyards());
+  for (uint64_t i = 0; i < remove.size(); ++i) {
+    auto uid = AgentUid(i);
+    EXPECT_EQ(!remove[i], rm->ContainsAgent(uid));
+    if (!remove[i]) {
+      EXPECT_EQ(uid, rm->GetAgent(uid)->GetUid());
+    }
+  }
+
+  simulation.GetScheduler()->Simulate(1);
+  EXPECT_EQ(32u, rm->GetNumAgents());
+  EXPECT_EQ(0u, rm->GetNumAgentsInGraveyards());
+}
+
+TEST(ResourceManagerTest, CompactAgentUids) {
+  Simulation simulation(TEST_NAME);
+  auto* rm = simulation.GetResourceManager();
+  auto* uid_generator = simulation.GetAgentUidGenerator();
+
+  std::vector<AgentUid> uids;
+  for (int i = 0; i < 100; i++) {
+    auto* agent = new TestAgent(i);
+    uids.push_back(agent->GetUid());
+    rm->AddAgent(agent);
+  }
+  for (int i = 0; i < 100; i += 2) {
+    rm->RemoveAgent(uids[i]);
+  }
+  EXPECT_EQ(50u, rm->GetNumAgents());
+
+  rm->CompactAgentUids();
+
+  EXPECT_EQ(50u, uid_generator->GetHighestIndex());
+  EXPECT_FALSE(rm->ContainsAgent(uids[99]));
+  std::set<int> data;
+  rm->ForEachAgent([&](Agent* a) {  // NOLINT
+    EXPECT_GT(50u, a->GetUid().GetIndex());
+    EXPECT_EQ(a, rm->GetAgent(a->GetUid()));
+    data.insert(bdm_static_cast<TestAgent*>(a)->GetData());
+  });
+  EXPECT_EQ(50u, data.size());
+  for (int i = 1; i < 100; i += 2) {
+    EXPECT_TRUE(data.find(i) != data.end());
+  }
+  EXPECT_EQ(AgentUid(50u), uid_generator->GenerateUid());
+}
+
 }  // namespace bdm
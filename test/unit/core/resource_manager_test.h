@@ -19,6 +19,9 @@
 #include <unordered_map>
 #include <vector>
 #include "core/agent/agent.h"
+#include "core/agent/cell.h"
+#include "core/behavior/behavior.h"
+#include "core/behavior/secretion.h"
 #include "core/diffusion/euler_grid.h"
 #include "core/environment/environment.h"
 #include "core/resource_manager.h"
@@ -57,6 +60,20 @@ class B : public TestAgent {
   real_t data_;
 };
 
+/// Behavior without `BDM_SERIALIZE` that refers to a diffusion grid.
+struct DiffusionGridBehavior : public Behavior {
+  BDM_BEHAVIOR_HEADER(DiffusionGridBehavior, Behavior, 1);
+
+  DiffusionGridBehavior() = default;
+  explicit DiffusionGridBehavior(DiffusionGrid* dgrid) : dgrid_(dgrid) {}
+
+  virtual ~DiffusionGridBehavior() = default;
+
+  void Run(Agent* agent) override {}
+
+  DiffusionGrid* dgrid_ = nullptr;
+};
+
 inline void RunForEachAgentTest() {
   const real_t kEpsilon = abs_error<real_t>::value;
   Simulation simulation("RunForEachAgentTest");
@@ -649,6 +666,76 @@ inline void RunIOTest() {
   remove(ROOTFILE);
 }
 
+/// Agents and behaviors without `BDM_SERIALIZE` fall back to ROOT. Shared
+/// behaviors and diffusion grids must still be restored exactly once.
+inline void RunIOExternalObjectsTest() {
+  Simulation simulation("ResourceManagerTest-RunIOExternalObjectsTest");
+  auto* rm = simulation.GetResourceManager();
+  remove(ROOTFILE);
+
+  // setup
+  auto* dgrid = new EulerGrid(0, "Kalium", 0.4, 0, 2);
+  rm->AddContinuum(dgrid);
+
+  auto* shared = new Secretion(dgrid, 3);
+  shared->Share();
+  // Not attached to any agent.
+  auto* unattached = new Secretion(dgrid, 4);
+  unattached->Share();
+
+  auto* agent = new A(12);
+  agent->AddBehavior(shared);
+  agent->AddBehavior(new DiffusionGridBehavior(dgrid));
+  rm->AddAgent(agent);
+  auto* cell = new Cell(10);
+  cell->AddBehavior(shared);
+  rm->AddAgent(cell);
+
+  // backup
+  WritePersistentObject(ROOTFILE, "rm", *rm, "new");
+
+  // restore
+  ResourceManager* restored_rm = nullptr;
+  GetPersistentObject(ROOTFILE, "rm", restored_rm);
+  *rm = std::move(*restored_rm);
+  delete restored_rm;
+
+  // validate
+  ASSERT_EQ(2u, rm->GetNumAgents());
+  auto* restored_dgrid = rm->GetDiffusionGrid(0);
+  ASSERT_TRUE(restored_dgrid != nullptr);
+
+  A* restored_agent = nullptr;
+  Cell* restored_cell = nullptr;
+  rm->ForEachAgent([&](Agent* a) {
+    if (auto* tmp = dynamic_cast<A*>(a)) {
+      restored_agent = tmp;
+    } else {
+      restored_cell = dynamic_cast<Cell*>(a);
+    }
+  });
+  ASSERT_TRUE(restored_agent != nullptr);
+  ASSERT_TRUE(restored_cell != nullptr);
+  EXPECT_EQ(12, restored_agent->GetData());
+
+  auto& agent_behaviors = restored_agent->GetAllBehaviors();
+  auto& cell_behaviors = restored_cell->GetAllBehaviors();
+  ASSERT_EQ(2u, agent_behaviors.size());
+  ASSERT_EQ(1u, cell_behaviors.size());
+  EXPECT_EQ(agent_behaviors[0], cell_behaviors[0]);
+
+  auto* restored_shared = dynamic_cast<Secretion*>(agent_behaviors[0]);
+  ASSERT_TRUE(restored_shared != nullptr);
+  EXPECT_TRUE(restored_shared->IsShared());
+
+  auto* dgrid_behavior =
+      dynamic_cast<DiffusionGridBehavior*>(agent_behaviors[1]);
+  ASSERT_TRUE(dgrid_behavior != nullptr);
+  EXPECT_EQ(restored_dgrid, dgrid_behavior->dgrid_);
+
+  remove(ROOTFILE);
+}
+
 }  // namespace bdm
 
 #endif  // UNIT_CORE_RESOURCE_MANAGER_TEST_H_
@@ -13,6 +13,11 @@
 // -----------------------------------------------------------------------------
 
 #include "unit/core/scheduler_test.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "core/behavior/behavior.h"
+#include "core/behavior/stateless_behavior.h"
 #include "core/environment/uniform_grid_environment.h"
 #include "core/model_initializer.h"
 #include "core/operation/operation_registry.h"
@@ -532,6 +537,115 @@ TEST_F(SchedulerTest, DisableDefaultOperations) {
                         "discretization") != scheduled_agent_ops.end());
 }
 
+struct SlowConcurrentOp : public StandaloneOperationImpl {
+  BDM_OP_HEADER(SlowConcurrentOp);
+  bool SupportsConcurrentExecution() override { return true; }
+  void operator()() override {
+    thread_id_ = std::this_thread::get_id();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    finished_ = true;
+  }
+  static std::atomic<bool> finished_;
+  static std::thread::id thread_id_;
+};
+
+std::atomic<bool> SlowConcurrentOp::finished_;
+std::thread::id SlowConcurrentOp::thread_id_;
+
+BDM_REGISTER_OP(SlowConcurrentOp, "slow concurrent op", kCpu)
+
+struct DependentOp : public StandaloneOperationImpl {
+  BDM_OP_HEADER(DependentOp);
+  void operator()() override {
+    dependency_finished_ = SlowConcurrentOp::finished_;
+  }
+  static bool dependency_finished_;
+};
+
+bool DependentOp::dependency_finished_ = false;
+
+BDM_REGISTER_OP(DependentOp, "dependent op", kCpu)
+
+// Test for Param::concurrent_ops
+TEST(Scheduler, ConcurrentOps) {
+  auto set_param = [](Param* param) {
+    param->concurrent_ops = {"slow concurrent op"};
+  };
+  Simulation simulation(TEST_NAME, set_param);
+  simulation.GetResourceManager()->AddAgent(new TestAgent());
+  auto* scheduler = simulation.GetScheduler();
+  scheduler->ScheduleOp(NewOperation("slow concurrent op"));
+  scheduler->ScheduleOp(NewOperation("dependent op"), kPostSchedule);
+  scheduler->AddOpDependency("dependent op", "slow concurrent op");
+
+  SlowConcurrentOp::finished_ = false;
+  DependentOp::dependency_finished_ = false;
+  scheduler->Simulate(1);
+
+  EXPECT_NE(std::this_thread::get_id(), SlowConcurrentOp::thread_id_);
+  EXPECT_TRUE(DependentOp::dependency_finished_);
+  EXPECT_TRUE(SlowConcurrentOp::finished_);
+}
+
+struct AgentStorageObserverOp : public StandaloneOperationImpl {
+  BDM_OP_HEADER(AgentStorageObserverOp);
+  bool SupportsConcurrentExecution() override { return true; }
+  void operator()() override {
+    auto* rm = Simulation::GetActive()->GetResourceManager();
+    auto before = AgentPointers(rm);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    unchanged_ = unchanged_ && before == AgentPointers(rm);
+  }
+  static std::vector<Agent*> AgentPointers(ResourceManager* rm) {
+    std::vector<Agent*> agents;
+    rm->ForEachAgent([&](Agent* agent) { agents.push_back(agent); });
+    return agents;
+  }
+  static bool unchanged_;
+};
+
+bool AgentStorageObserverOp::unchanged_ = true;
+
+BDM_REGISTER_OP(AgentStorageObserverOp, "agent storage observer", kCpu)
+
+// Concurrent operations must not overlap with agent removal and load
+// balancing.
+TEST(Scheduler, ConcurrentOpsDoNotOverlapAgentRemoval) {
+  auto set_param = [](Param* param) {
+    param->concurrent_ops = {"agent storage observer"};
+  };
+  Simulation simulation(TEST_NAME, set_param);
+  auto* rm = simulation.GetResourceManager();
+  for (uint64_t i = 0; i < 100; ++i) {
+    auto* agent = new TestAgent({i * 10.0, 0, 0});
+    if (i % 2 == 0) {
+      agent->AddBehavior(new StatelessBehavior(
+          [](Agent* agent) { agent->RemoveFromSimulation(); }));
+    }
+    rm->AddAgent(agent);
+  }
+  auto* scheduler = simulation.GetScheduler();
+  scheduler->GetOps("load balancing")[0]->frequency_ = 1;
+  scheduler->ScheduleOp(NewOperation("agent storage observer"));
+
+  AgentStorageObserverOp::unchanged_ = true;
+  scheduler->Simulate(2);
+
+  EXPECT_TRUE(AgentStorageObserverOp::unchanged_);
+  EXPECT_EQ(50u, rm->GetNumAgents());
+}
+
+TEST(SchedulerDeathTest, UnsupportedConcurrentOp) {
+  auto set_param = [](Param* param) {
+    param->concurrent_ops = {"dependent op"};
+  };
+  Simulation simulation(TEST_NAME, set_param);
+  auto* scheduler = simulation.GetScheduler();
+  scheduler->ScheduleOp(NewOperation("dependent op"));
+  EXPECT_DEATH_IF_SUPPORTED(scheduler->Simulate(1),
+                            ".*does not support concurrent execution.*");
+}
+
 TEST(Scheduler, SimulateUntil) {
   Simulation simulation(TEST_NAME);
   simulation.GetResourceManager()->AddAgent(new TestAgent());
@@ -669,4 +783,83 @@ TEST(Scheduler, ForEachOpForEachAgent_ExecutionOrder) {
   EXPECT_EQ(AgentUid(1), execution_order[3].second);
 }
 
+// -----------------------------------------------------------------------------
+/// Returns true if `ctxt` matches the state of the active simulation for the
+/// calling thread.
+inline bool IsValidIterationContext(const IterationContext& ctxt) {
+  auto* sim = Simulation::GetActive();
+  auto* scheduler = sim->GetScheduler();
+  return ctxt.sim == sim && ctxt.param == sim->GetParam() &&
+         ctxt.scheduler == scheduler &&
+         ctxt.env == sim->GetEnvironment() &&
+         ctxt.exec_ctxt == sim->GetExecutionContext() &&
+         ctxt.random == sim->GetRandom() &&
+         ctxt.thread_id == omp_get_thread_num() &&
+         ctxt.step == scheduler->GetSimulatedSteps() &&
+         ctxt.dt == sim->GetParam()->simulation_time_step &&
+         &ctxt == &scheduler->GetIterationContext();
+}
+
+struct IterationContextTestOp : public AgentOperationImpl {
+  BDM_OP_HEADER(IterationContextTestOp);
+
+  void operator()(Agent* agent) override { fallback_calls_++; }
+
+  void operator()(Agent* agent, const IterationContext& ctxt) override {
+    if (IsValidIterationContext(ctxt)) {
+      valid_calls_++;
+    }
+  }
+
+  static std::atomic<uint64_t> fallback_calls_;
+  static std::atomic<uint64_t> valid_calls_;
+};
+
+std::atomic<uint64_t> IterationContextTestOp::fallback_calls_;
+std::atomic<uint64_t> IterationContextTestOp::valid_calls_;
+
+BDM_REGISTER_OP(IterationContextTestOp, "iteration context test op", kCpu)
+
+struct IterationContextTestBehavior : public Behavior {
+  BDM_BEHAVIOR_HEADER(IterationContextTestBehavior, Behavior, 1);
+
+  void Run(Agent* agent) override { fallback_calls_++; }
+
+  void Run(Agent* agent, const IterationContext& ctxt) override {
+    if (IsValidIterationContext(ctxt)) {
+      valid_calls_++;
+    }
+  }
+
+  static std::atomic<uint64_t> fallback_calls_;
+  static std::atomic<uint64_t> valid_calls_;
+};
+
+std::atomic<uint64_t> IterationContextTestBehavior::fallback_calls_;
+std::atomic<uint64_t> IterationContextTestBehavior::valid_calls_;
+
+TEST(Scheduler, IterationContext) {
+  Simulation simulation(TEST_NAME);
+  auto* rm = simulation.GetResourceManager();
+  for (int i = 0; i < 10; ++i) {
+    auto* cell = new Cell(10);
+    cell->SetPosition({i * 20.0, 0, 0});
+    cell->AddBehavior(new IterationContextTestBehavior());
+    rm->AddAgent(cell);
+  }
+  auto* scheduler = simulation.GetScheduler();
+  scheduler->ScheduleOp(NewOperation("iteration context test op"));
+
+  IterationContextTestOp::fallback_calls_ = 0;
+  IterationContextTestOp::valid_calls_ = 0;
+  IterationContextTestBehavior::fallback_calls_ = 0;
+  IterationContextTestBehavior::valid_calls_ = 0;
+  scheduler->Simulate(3);
+
+  EXPECT_EQ(0u, IterationContextTestOp::fallback_calls_);
+  EXPECT_EQ(30u, IterationContextTestOp::valid_calls_);
+  EXPECT_EQ(0u, IterationContextTestBehavior::fallback_calls_);
+  EXPECT_EQ(30u, IterationContextTestBehavior::valid_calls_);
+}
+
 }  // namespace bdm
@@ -14,8 +14,10 @@
 
 #include "core/simulation_backup.h"
 
+#include <fstream>
 #include <string>
 #include "core/agent/cell.h"
+#include "core/analysis/time_series.h"
 #include "core/resource_manager.h"
 #include "core/util/io.h"
 #include "gtest/gtest.h"
@@ -143,6 +145,58 @@ TEST(SimulationBackupTest, BackupAndRestore) {
   remove(ROOTFILE);
 }
 
+TEST(SimulationBackupTest, RestoreKeepsStreamedTimeSeries) {
+  remove(ROOTFILE);
+  auto count_lines = [](const std::string& filename,
+                        const std::string& content) {
+    std::ifstream ifs(filename);
+    std::string line;
+    uint64_t count = 0;
+    while (std::getline(ifs, line)) {
+      if (line.find(content) != std::string::npos) {
+        count++;
+      }
+    }
+    return count;
+  };
+  auto set_param = [](Param* param) {
+    param->remove_output_dir_contents = false;
+    param->time_series_stream_file = "time-series.csv";
+  };
+  std::string csv_file;
+  {
+    Simulation simulation(TEST_NAME, set_param);
+    simulation.GetResourceManager()->AddAgent(new Cell());
+    simulation.GetTimeSeries()->AddCollector(
+        "num-agents", [](Simulation* sim) {
+          return static_cast<real_t>(sim->GetResourceManager()->GetNumAgents());
+        });
+    simulation.GetScheduler()->Simulate(3);
+    simulation.GetTimeSeries()->FlushStream();
+    csv_file = Concat(simulation.GetOutputDir(), "/time-series.csv");
+
+    SimulationBackup backup(ROOTFILE, "");
+    backup.Backup(3);
+  }
+  ASSERT_EQ(4u, count_lines(csv_file, ""));
+
+  // restore in a new simulation with the same output directory
+  {
+    Simulation simulation(TEST_NAME, set_param);
+    SimulationBackup restore("", ROOTFILE);
+    restore.Restore();
+    simulation.GetScheduler()->Simulate(2);
+    simulation.GetTimeSeries()->FlushStream();
+  }
+
+  // The rows of the first run are still in the file and the header was not
+  // written a second time.
+  EXPECT_EQ(1u, count_lines(csv_file, "id,x,y"));
+  EXPECT_EQ(5u, count_lines(csv_file, "num-agents"));
+
+  remove(ROOTFILE);
+}
+
 }  // namespace bdm
 
 #endif  // USE_DICT
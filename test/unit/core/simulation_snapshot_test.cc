@@ -0,0 +1,154 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/simulation_snapshot.h"
+
+#include <fstream>
+#include <memory>
+#include "core/agent/cell.h"
+#include "core/analysis/time_series.h"
+#include "core/resource_manager.h"
+#include "core/scheduler.h"
+#include "core/simulation.h"
+#include "core/util/random.h"
+#include "gtest/gtest.h"
+#include "unit/test_util/test_util.h"
+
+#ifdef USE_DICT
+
+namespace bdm {
+
+TEST(SimulationSnapshotTest, Rewind) {
+  Simulation simulation(TEST_NAME);
+  auto* rm = simulation.GetResourceManager();
+  auto* scheduler = simulation.GetScheduler();
+  auto* random = simulation.GetRandom();
+
+  for (int i = 0; i < 10; ++i) {
+    auto* cell = new Cell(10);
+    cell->SetPosition({i * 5.0, 0, 0});
+    rm->AddAgent(cell);
+  }
+  scheduler->Simulate(3);
+
+  SimulationSnapshot snapshot;
+  EXPECT_EQ(3u, snapshot.GetSimulatedSteps());
+  EXPECT_LE(snapshot.GetCompressedSize(), snapshot.GetUncompressedSize());
+  auto expected_random = random->Uniform();
+  std::vector<Real3> expected_positions;
+  rm->ForEachAgent(
+      [&](Agent* agent) { expected_positions.push_back(agent->GetPosition()); });
+
+  rm->AddAgent(new Cell(10));
+  scheduler->Simulate(5);
+  EXPECT_EQ(8u, scheduler->GetSimulatedSteps());
+
+  snapshot.Restore();
+  EXPECT_EQ(rm, simulation.GetResourceManager());
+  EXPECT_EQ(3u, scheduler->GetSimulatedSteps());
+  EXPECT_REAL_EQ(snapshot.GetSimulatedTime(), scheduler->GetSimulatedTime());
+  EXPECT_REAL_EQ(expected_random, random->Uniform());
+  ASSERT_EQ(10u, rm->GetNumAgents());
+  uint64_t i = 0;
+  rm->ForEachAgent([&](Agent* agent) {
+    EXPECT_ARR_NEAR(expected_positions[i++], agent->GetPosition());
+  });
+
+  // A snapshot can be restored multiple times.
+  scheduler->Simulate(2);
+  snapshot.Restore();
+  EXPECT_EQ(3u, scheduler->GetSimulatedSteps());
+  EXPECT_EQ(10u, rm->GetNumAgents());
+}
+
+void RunRewindKeepsOutputDirTest(bool remove_output_dir_contents) {
+  auto set_param = [&](Param* param) {
+    param->remove_output_dir_contents = remove_output_dir_contents;
+    param->time_series_stream_file = "time-series.csv";
+  };
+  Simulation simulation("SimulationSnapshotTest_RewindKeepsOutputDir",
+                        set_param);
+  auto* scheduler = simulation.GetScheduler();
+  auto output_dir = simulation.GetOutputDir();
+  auto unique_name = simulation.GetUniqueName();
+  auto result_file = Concat(output_dir, "/result.txt");
+  std::ofstream(result_file) << "result";
+  simulation.GetTimeSeries()->AddCollector(
+      "steps", [](Simulation* sim) {
+        return static_cast<real_t>(sim->GetScheduler()->GetSimulatedSteps());
+      });
+  scheduler->Simulate(2);
+
+  SimulationSnapshot snapshot;
+  for (int i = 0; i < 2; ++i) {
+    scheduler->Simulate(2);
+    snapshot.Restore();
+    EXPECT_EQ(output_dir, simulation.GetOutputDir());
+    EXPECT_EQ(unique_name, simulation.GetUniqueName());
+    EXPECT_TRUE(FileExists(result_file));
+  }
+
+  // Data points that were streamed before the rewinds are still in the file.
+  simulation.GetTimeSeries()->FlushStream();
+  std::ifstream ifs(Concat(output_dir, "/time-series.csv"));
+  std::string line;
+  uint64_t num_lines = 0;
+  while (std::getline(ifs, line)) {
+    num_lines++;
+  }
+  // Header + 2 + 2 * 2 data points
+  EXPECT_EQ(7u, num_lines);
+}
+
+TEST(SimulationSnapshotTest, RewindKeepsOutputDir) {
+  RunRewindKeepsOutputDirTest(true);
+}
+
+TEST(SimulationSnapshotTest, RewindKeepsOutputDirWithoutRemovingContents) {
+  RunRewindKeepsOutputDirTest(false);
+}
+
+TEST(SimulationSnapshotTest, Fork) {
+  auto simulation = std::make_unique<Simulation>(
+      TEST_NAME, [](Param* param) { param->simulation_time_step = 0.5; });
+  auto* rm = simulation->GetResourceManager();
+  for (int i = 0; i < 5; ++i) {
+    rm->AddAgent(new Cell(10));
+  }
+  simulation->GetScheduler()->Simulate(2);
+
+  // Without compression, only the block headers are added.
+  SimulationSnapshot snapshot(simulation.get(), 0);
+  EXPECT_LT(snapshot.GetUncompressedSize(), snapshot.GetCompressedSize());
+  EXPECT_GE(snapshot.GetUncompressedSize() + 32,
+            snapshot.GetCompressedSize());
+
+  std::unique_ptr<Simulation> fork(snapshot.Fork("fork"));
+  EXPECT_EQ(fork.get(), Simulation::GetActive());
+  EXPECT_EQ(0u, fork->GetUniqueName().find("fork"));
+  EXPECT_NE(simulation->GetOutputDir(), fork->GetOutputDir());
+  EXPECT_REAL_EQ(0.5, fork->GetParam()->simulation_time_step);
+  EXPECT_EQ(5u, fork->GetResourceManager()->GetNumAgents());
+  EXPECT_EQ(2u, fork->GetScheduler()->GetSimulatedSteps());
+
+  fork->GetScheduler()->Simulate(3);
+  EXPECT_EQ(5u, fork->GetScheduler()->GetSimulatedSteps());
+  EXPECT_EQ(2u, simulation->GetScheduler()->GetSimulatedSteps());
+  EXPECT_EQ(5u, rm->GetNumAgents());
+  fork.reset();
+}
+
+}  // namespace bdm
+
+#endif  // USE_DICT
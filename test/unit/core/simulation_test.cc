@@ -85,6 +85,7 @@ class SimulationTest : public ::testing::Test {
       "mem_mgr_growth_rate = 1.123\n"
       "mem_mgr_max_mem_per_thread_factor = 3\n"
       "minimize_memory_while_rebalancing = false\n"
+      "agent_uid_compaction_threshold = 2.5\n"
       "mapped_data_array_mode = \"cache\"\n"
       "\n"
       "[development]\n"
@@ -179,6 +180,8 @@ class SimulationTest : public ::testing::Test {
     EXPECT_NEAR(1.123, param->mem_mgr_growth_rate, abs_error<real_t>::value);
     EXPECT_EQ(3u, param->mem_mgr_max_mem_per_thread_factor);
     EXPECT_FALSE(param->minimize_memory_while_rebalancing);
+    EXPECT_NEAR(2.5, param->agent_uid_compaction_threshold,
+                abs_error<real_t>::value);
     EXPECT_EQ(Param::MappedDataArrayMode::kCache,
               param->mapped_data_array_mode);
 
@@ -0,0 +1,47 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/util/compression.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace bdm {
+
+void RunCompressionTest(uint64_t size, int compression) {
+  std::vector<char> data(size);
+  for (uint64_t i = 0; i < size; ++i) {
+    data[i] = static_cast<char>(i % 7);
+  }
+
+  std::vector<char> compressed;
+  Compress(data.data(), data.size(), compression, &compressed);
+  if (compression != 0 && size > 1000) {
+    EXPECT_LT(compressed.size(), data.size());
+  }
+
+  std::vector<char> decompressed;
+  Decompress(compressed.data(), compressed.size(), &decompressed);
+  EXPECT_EQ(data, decompressed);
+}
+
+TEST(CompressionTest, Empty) { RunCompressionTest(0, 404); }
+
+TEST(CompressionTest, Uncompressed) { RunCompressionTest(10000, 0); }
+
+TEST(CompressionTest, Lz4) { RunCompressionTest(10000, 404); }
+
+// More than one block
+TEST(CompressionTest, MultipleBlocks) { RunCompressionTest(40000000, 101); }
+
+}  // namespace bdm
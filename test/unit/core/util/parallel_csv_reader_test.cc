@@ -0,0 +1,83 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/util/parallel_csv_reader.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <fstream>
+#include <vector>
+#include "core/util/string.h"
+#include "unit/test_util/test_util.h"
+
+namespace bdm {
+
+TEST(ParallelCSVReaderTest, GetColumn) {
+  std::string file = "parallel_csv_reader_test.csv";
+  constexpr uint64_t kRows = 10000;
+  {
+    std::ofstream ofs(file);
+    ofs << "id, x ,name\r\n";
+    for (uint64_t i = 0; i < kRows; ++i) {
+      ofs << i << "," << i * 0.5 << ",\"cell" << i << "\"\r\n";
+    }
+    // empty lines are skipped, empty fields are NaN
+    ofs << "\n" << kRows << ",,";
+  }
+
+  ParallelCSVReader reader(file);
+  EXPECT_EQ(std::vector<std::string>({"id", "x", "name"}),
+            reader.GetColumnNames());
+  EXPECT_EQ(kRows + 1, reader.GetRowCount());
+
+  auto id = reader.GetColumn<uint64_t>("id");
+  auto x = reader.GetColumn<real_t>("x");
+  auto name = reader.GetColumn<std::string>("name");
+  ASSERT_EQ(kRows + 1, id.size());
+  for (uint64_t i = 0; i < kRows; ++i) {
+    EXPECT_EQ(i, id[i]);
+    EXPECT_REAL_EQ(i * 0.5, x[i]);
+    EXPECT_EQ(Concat("cell", i), name[i]);
+  }
+  EXPECT_EQ(kRows, id[kRows]);
+  EXPECT_TRUE(std::isnan(x[kRows]));
+  EXPECT_EQ("", name[kRows]);
+
+  // rows are streamed with the requested columns in the given order
+  std::vector<real_t> sum(kRows + 1);
+  reader.ForEachRow({"x", "id"},
+                    [&](uint64_t row, const std::vector<real_t>& values) {
+                      sum[row] = values[0] + values[1];
+                    });
+  for (uint64_t i = 0; i < kRows; ++i) {
+    EXPECT_REAL_EQ(i * 1.5, sum[i]);
+  }
+
+  remove(file.c_str());
+}
+
+TEST(ParallelCSVReaderTest, TabSeparated) {
+  std::string file = "parallel_csv_reader_test.tsv";
+  {
+    std::ofstream ofs(file);
+    ofs << "a\tb\n1\t-2\n3\t4";
+  }
+
+  ParallelCSVReader reader(file);
+  EXPECT_EQ(2u, reader.GetColumnCount());
+  EXPECT_EQ(std::vector<int>({-2, 4}), reader.GetColumn<int>("b"));
+
+  remove(file.c_str());
+}
+
+}  // namespace bdm
@@ -0,0 +1,122 @@
+// -----------------------------------------------------------------------------
+//
+// Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+// BioDynaMo collaboration. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+//
+// See the LICENSE file distributed with this work for details.
+// See the NOTICE file distributed with this work for additional information
+// regarding copyright ownership.
+//
+// -----------------------------------------------------------------------------
+
+#include "core/util/serialization.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "core/agent/cell.h"
+#include "core/behavior/growth_division.h"
+#include "core/resource_manager.h"
+#include "core/simulation.h"
+#include "unit/test_util/test_util.h"
+
+namespace bdm {
+
+enum class SerializationTestEnum : uint8_t { kA, kB };
+
+TEST(SerializationTest, Values) {
+  std::vector<char> buffer;
+  BinaryWriter writer(&buffer);
+  writer.Write(3, 1.5, std::string("foo"), std::vector<real_t>{1, 2, 3},
+               Real3{4, 5, 6}, std::make_pair(7u, std::string("bar")),
+               SerializationTestEnum::kB, AgentUid(8, 9));
+
+  int i;
+  double d;
+  std::string s;
+  std::vector<real_t> v;
+  Real3 r;
+  std::pair<unsigned, std::string> p;
+  SerializationTestEnum e;
+  AgentUid uid;
+  BinaryReader reader(buffer.data(), buffer.size());
+  reader.Read(i, d, s, v, r, p, e, uid);
+
+  EXPECT_TRUE(reader.AtEnd());
+  EXPECT_EQ(3, i);
+  EXPECT_EQ(1.5, d);
+  EXPECT_EQ("foo", s);
+  EXPECT_EQ((std::vector<real_t>{1, 2, 3}), v);
+  EXPECT_ARR_NEAR(r, {4, 5, 6});
+  EXPECT_EQ(7u, p.first);
+  EXPECT_EQ("bar", p.second);
+  EXPECT_EQ(SerializationTestEnum::kB, e);
+  EXPECT_EQ(AgentUid(8, 9), uid);
+}
+
+TEST(SerializationTest, Agents) {
+  Simulation simulation(TEST_NAME);
+  auto* rm = simulation.GetResourceManager();
+
+  auto* shared = new GrowthDivision(10, 20);
+  shared->Share();
+  // More agents than `kAgentsPerChunk` to encode several chunks.
+  constexpr uint64_t kNumAgents = 10000;
+  for (uint64_t i = 0; i < kNumAgents; ++i) {
+    auto* cell = new Cell(i + 1);
+    cell->SetPosition({i * 1.0, 2, 3});
+    cell->AddBehavior(shared);
+    if (i % 2 == 0) {
+      cell->AddBehavior(new GrowthDivision(i, 1));
+    }
+    rm->AddAgent(cell);
+  }
+  std::vector<AgentUid> uids;
+  rm->ForEachAgent([&](Agent* agent) { uids.push_back(agent->GetUid()); });
+
+  std::vector<char> buffer;
+  rm->WriteAgents(&buffer);
+
+  ResourceManager restored(static_cast<TRootIOCtor*>(nullptr));
+  restored.ReadAgents(buffer.data(), buffer.size());
+  *rm = std::move(restored);
+
+  ASSERT_EQ(kNumAgents, rm->GetNumAgents());
+  uint64_t idx = 0;
+  Behavior* restored_shared = nullptr;
+  rm->ForEachAgent([&](Agent* agent) {
+    auto* cell = dynamic_cast<Cell*>(agent);
+    ASSERT_TRUE(cell != nullptr);
+    EXPECT_EQ(uids[idx], cell->GetUid());
+    auto& behaviors = cell->GetAllBehaviors();
+    auto diameter = cell->GetDiameter();
+    EXPECT_ARR_NEAR(cell->GetPosition(), {diameter - 1, 2, 3});
+    auto i = static_cast<uint64_t>(diameter) - 1;
+    ASSERT_EQ(i % 2 == 0 ? 2u : 1u, behaviors.size());
+    EXPECT_TRUE(behaviors[0]->IsShared());
+    if (restored_shared == nullptr) {
+      restored_shared = behaviors[0];
+    }
+    EXPECT_EQ(restored_shared, behaviors[0]);
+    if (behaviors.size() == 2) {
+      EXPECT_FALSE(behaviors[1]->IsShared());
+      EXPECT_TRUE(dynamic_cast<GrowthDivision*>(behaviors[1]) != nullptr);
+    }
+    idx++;
+  });
+}
+
+TEST(SerializationDeathTest, VersionMismatch) {
+  std::vector<char> buffer;
+  BinaryWriter writer(&buffer);
+  writer.WriteVersion(2);
+  BinaryReader reader(buffer.data(), buffer.size());
+  EXPECT_DEATH_IF_SUPPORTED(reader.ReadVersion(1, "Foo"),
+                            ".*The data of Foo has been written with version "
+                            "2, but the current version is 1.*");
+}
+
+}  // namespace bdm
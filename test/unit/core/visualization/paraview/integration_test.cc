@@ -148,6 +148,15 @@ TEST(FLAKY_ParaviewIntegrationTest, ExportDiffusionGridLoadWithoutPVSM) {
       std::max(max_threads - 1, 1), std::max(max_threads - 1, 1), true, false));
 }
 
+// -----------------------------------------------------------------------------
+TEST(ParaviewIntegrationTest, GlyphLevelOfDetail) {
+  std::stringstream cmd;
+  std::string pv_dir = std::getenv("ParaView_DIR");
+  cmd << pv_dir << "/bin/pvbatch "
+      << GetPythonScriptPath("validate_glyph_lod.py");
+  EXPECT_EQ(0, system(cmd.str().c_str()));
+}
+
 // Insitu-visualization not supported on macOS. Thus, we do not run these test
 // on macOS.
 #ifndef __APPLE__
@@ -0,0 +1,74 @@
+# -----------------------------------------------------------------------------
+#
+# Copyright (C) 2021 CERN & University of Surrey for the benefit of the
+# BioDynaMo collaboration. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+#
+# See the LICENSE file distributed with this work for details.
+# See the NOTICE file distributed with this work for additional information
+# regarding copyright ownership.
+#
+# -----------------------------------------------------------------------------
+
+# Runs BDMGlyph offscreen on a small point set and validates the number of
+# output points and cells with and without low resolution glyphs.
+# Usage: pvbatch validate_glyph_lod.py
+
+import sys
+from paraview.simple import *
+
+num_points = 100
+
+def Counts(source):
+    data = paraview.servermanager.Fetch(source)
+    return data.GetNumberOfPoints(), data.GetNumberOfCells()
+
+def Validate(condition, message):
+    if not condition:
+        print("ERROR", message)
+        sys.exit(1)
+
+points = PointSource(NumberOfPoints=num_points, Radius=100)
+sphere = Sphere(ThetaResolution=16, PhiResolution=16)
+sphere_points, sphere_cells = Counts(sphere)
+
+glyph = BDMGlyph(Input=points, GlyphType='Sphere')
+glyph.GlyphType.ThetaResolution = 16
+glyph.GlyphType.PhiResolution = 16
+glyph.GlyphMode = 'All Points'
+glyph.ScaleFactor = 1
+Validate(glyph.LODThreshold == 0,
+         "LODThreshold is {0} by default. Expected: 0".format(
+             glyph.LODThreshold))
+
+# Without LOD every point gets the full resolution glyph
+glyph_points, glyph_cells = Counts(glyph)
+Validate(glyph_points == num_points * sphere_points,
+         "Number of points without LOD: {0}. Expected: {1}".format(
+             glyph_points, num_points * sphere_points))
+Validate(glyph_cells == num_points * sphere_cells,
+         "Number of cells without LOD: {0}. Expected: {1}".format(
+             glyph_cells, num_points * sphere_cells))
+
+# The threshold is not exceeded
+glyph.LODThreshold = num_points
+glyph_points, glyph_cells = Counts(glyph)
+Validate(glyph_cells == num_points * sphere_cells,
+         "Number of cells below the LOD threshold: {0}. Expected: {1}".format(
+             glyph_cells, num_points * sphere_cells))
+
+# Low resolution glyphs
+glyph.LODThreshold = num_points - 1
+glyph.LODTargetReduction = 0.8
+glyph_points, glyph_cells = Counts(glyph)
+Validate(glyph_points % num_points == 0 and glyph_cells % num_points == 0,
+         "Low resolution glyphs differ: {0} points, {1} cells".format(
+             glyph_points, glyph_cells))
+Validate(0 < glyph_cells < num_points * sphere_cells * 0.5,
+         "Number of cells with LOD: {0}. Expected less than {1}".format(
+             glyph_cells, num_points * sphere_cells * 0.5))
+Validate(glyph_points < num_points * sphere_points,
+         "Number of points with LOD: {0}. Expected less than {1}".format(
+             glyph_points, num_points * sphere_points))
@@ -15,10 +15,13 @@
 #ifndef UNIT_TEST_UTIL_TEST_UTIL_H_
 #define UNIT_TEST_UTIL_TEST_UTIL_H_
 
+#include <cstdint>
+#include <limits>
 #include <type_traits>
 #include "gtest/gtest.h"
 
 #include "core/container/math_array.h"
+#include "core/util/random.h"
 
 namespace bdm {
 
@@ -98,6 +101,21 @@ void EXPECT_ARR_EQ(const std::array<T, N>& expected,  // NOLINT
     }                                                                \
   }(__VA_ARGS__);
 
+// -----------------------------------------------------------------------------
+/// Uniform random bit generator that can be passed to `std::shuffle`.
+struct Ubrng {
+  using result_type = uint32_t;
+  Random* random;
+  Ubrng(Random* random) : random(random) {}
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+  result_type operator()() {
+    return random->Integer(std::numeric_limits<result_type>::max());
+  }
+};
+
 // -----------------------------------------------------------------------------
 /// Mangled test name.\n
 /// Only works within test class, since the implementation relies on `this`.